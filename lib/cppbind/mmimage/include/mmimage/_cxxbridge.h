@@ -934,6 +934,7 @@ namespace mmimage {
   struct Box2F32;
   struct ImageRegionRectangle;
   struct PixelF32x4;
+  struct PixelF16x4;
   struct PixelF64x2;
   enum class BufferDataType : ::std::uint8_t;
   struct ShimImagePixelBuffer;
@@ -1128,6 +1129,18 @@ struct PixelF32x4 final {
 };
 #endif // CXXBRIDGE1_STRUCT_mmimage$PixelF32x4
 
+#ifndef CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+#define CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+struct PixelF16x4 final {
+  ::std::uint16_t r;
+  ::std::uint16_t g;
+  ::std::uint16_t b;
+  ::std::uint16_t a;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+
 #ifndef CXXBRIDGE1_STRUCT_mmimage$PixelF64x2
 #define CXXBRIDGE1_STRUCT_mmimage$PixelF64x2
 struct PixelF64x2 final {
@@ -1165,6 +1178,8 @@ struct ShimImagePixelBuffer final : public ::rust::Opaque {
   MMIMAGE_API_EXPORT ::std::size_t element_count() const noexcept;
   MMIMAGE_API_EXPORT ::rust::Slice<const ::mmimage::PixelF32x4> as_slice_f32x4() const noexcept;
   MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF32x4> as_slice_f32x4_mut() noexcept;
+  MMIMAGE_API_EXPORT ::rust::Slice<const ::mmimage::PixelF16x4> as_slice_f16x4() const noexcept;
+  MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF16x4> as_slice_f16x4_mut() noexcept;
   MMIMAGE_API_EXPORT void resize(::mmimage::BufferDataType data_type, ::std::size_t image_width, ::std::size_t image_height, ::std::size_t num_channels) noexcept;
   ~ShimImagePixelBuffer() = delete;
 
@@ -1233,6 +1248,8 @@ MMIMAGE_API_EXPORT ::rust::Box<::mmimage::ShimImageMetaData> shim_create_image_m
 
 MMIMAGE_API_EXPORT bool shim_image_read_pixels_exr_f32x4(::rust::Str file_path, bool vertical_flip, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data, ::rust::Box<::mmimage::ShimImagePixelBuffer> &out_pixel_buffer) noexcept;
 
+MMIMAGE_API_EXPORT bool shim_image_read_pixels_exr_f16x4(::rust::Str file_path, bool vertical_flip, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data, ::rust::Box<::mmimage::ShimImagePixelBuffer> &out_pixel_buffer) noexcept;
+
 MMIMAGE_API_EXPORT bool shim_image_read_metadata_exr(::rust::Str file_path, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data) noexcept;
 
 MMIMAGE_API_EXPORT bool shim_image_write_pixels_exr_f32x4(::rust::Str file_path, ::mmimage::ImageExrEncoder exr_encoder, const ::rust::Box<::mmimage::ShimImageMetaData> &in_meta_data, const ::rust::Box<::mmimage::ShimImagePixelBuffer> &in_pixel_buffer) noexcept;
@@ -0,0 +1,375 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#ifndef MM_IMAGE_IMAGE_CACHE_CORE_H
+#define MM_IMAGE_IMAGE_CACHE_CORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace mmimage {
+
+// The bookkeeping of a Least-Recently-Used (LRU) image cache, without
+// any knowledge of what the cached values are, or how the values are
+// allocated and deallocated (that is left to the owner of the cache).
+//
+// Each item is stored in a hash map node, and the nodes are linked
+// together (intrusively) into the LRU list and into a list per
+// group. Each item points back to its group, so inserting, finding,
+// evicting and erasing an item are all constant time (O(1))
+// operations.
+//
+// Items and groups are identified by hash values (of the file path
+// and group name), given by the caller. Two file paths may have the
+// same hash value, so the lookups given an item name (the file path)
+// also compare the name stored in the item, and treat a different
+// name as a missing item.
+//
+// NOTE: This class is not thread-safe.
+template <typename Value>
+class ImageCacheCore {
+public:
+    using Key = uint64_t;
+    using GroupKey = uint64_t;
+
+private:
+    struct Group;
+
+    struct Item {
+        Key key;
+        Value value;
+        size_t byte_count;
+        std::string name;
+        Group *group;
+
+        // The 'previous' item is less recently used, and the 'next'
+        // item is more recently used.
+        Item *lru_prev;
+        Item *lru_next;
+
+        Item *group_prev;
+        Item *group_next;
+    };
+
+    struct Group {
+        GroupKey key;
+        std::string name;
+        size_t item_count;
+        Item *first_item;
+    };
+
+    using ItemMap = std::unordered_map<Key, Item>;
+    using GroupMap = std::unordered_map<GroupKey, Group>;
+
+public:
+    ImageCacheCore()
+        : m_used_bytes(0), m_lru_first(nullptr), m_lru_last(nullptr) {}
+
+    // The nodes point into each other, so the cache cannot be copied.
+    ImageCacheCore(ImageCacheCore const &) = delete;
+    void operator=(ImageCacheCore const &) = delete;
+
+    size_t used_bytes() const { return m_used_bytes; }
+    size_t item_count() const { return m_item_map.size(); }
+    size_t group_count() const { return m_group_map.size(); }
+    bool empty() const { return m_item_map.empty(); }
+
+    bool contains(const Key key) const {
+        return m_item_map.find(key) != m_item_map.end();
+    }
+
+    bool contains(const Key key, const std::string &item_name) const {
+        auto search = m_item_map.find(key);
+        return (search != m_item_map.end()) &&
+               (search->second.name == item_name);
+    }
+
+    // Insert a new item as the most recently used item.
+    //
+    // Returns false if the key is already in the cache, and the
+    // cache is not changed.
+    bool insert(const GroupKey group_key, const std::string &group_name,
+                const Key key, const std::string &item_name,
+                const Value &value, const size_t byte_count) {
+        auto item_pair = m_item_map.insert(std::make_pair(key, Item()));
+        if (!item_pair.second) {
+            return false;
+        }
+        Item &item = item_pair.first->second;
+        item.key = key;
+        item.value = value;
+        item.byte_count = byte_count;
+        item.name = item_name;
+        item.lru_prev = nullptr;
+        item.lru_next = nullptr;
+        item.group_prev = nullptr;
+        item.group_next = nullptr;
+
+        auto group_pair =
+            m_group_map.insert(std::make_pair(group_key, Group()));
+        Group &group = group_pair.first->second;
+        if (group_pair.second) {
+            group.key = group_key;
+            group.name = group_name;
+            group.item_count = 0;
+            group.first_item = nullptr;
+        }
+        item.group = &group;
+        link_group(group, item);
+        link_lru_last(item);
+
+        m_used_bytes += byte_count;
+        return true;
+    }
+
+    // Find the item value, and make it the most recently used item.
+    //
+    // Returns nullptr if the key is not in the cache. The pointer is
+    // valid until the item is erased.
+    Value *find(const Key key) {
+        auto search = m_item_map.find(key);
+        if (search == m_item_map.end()) {
+            return nullptr;
+        }
+        Item &item = search->second;
+        unlink_lru(item);
+        link_lru_last(item);
+        return &item.value;
+    }
+
+    // Find the item value with the key and item name, and make it the
+    // most recently used item.
+    //
+    // Returns nullptr if the key is not in the cache, or the item
+    // with the key has a different name.
+    Value *find(const Key key, const std::string &item_name) {
+        auto search = m_item_map.find(key);
+        if ((search == m_item_map.end()) ||
+            (search->second.name != item_name)) {
+            return nullptr;
+        }
+        Item &item = search->second;
+        unlink_lru(item);
+        link_lru_last(item);
+        return &item.value;
+    }
+
+    // Find the item value without changing the LRU order.
+    const Value *peek(const Key key) const {
+        auto search = m_item_map.find(key);
+        if (search == m_item_map.end()) {
+            return nullptr;
+        }
+        return &search->second.value;
+    }
+
+    // Find the least recently used item, without changing the LRU
+    // order.
+    //
+    // Returns nullptr if the cache is empty.
+    const Value *peek_least_recently_used(Key &out_key) const {
+        if (m_lru_first == nullptr) {
+            return nullptr;
+        }
+        out_key = m_lru_first->key;
+        return &m_lru_first->value;
+    }
+
+    // Remove the item from the cache, returning the removed value so
+    // the caller can deallocate it.
+    //
+    // Returns false if the key is not in the cache.
+    bool erase(const Key key, Value &out_value) {
+        auto search = m_item_map.find(key);
+        if (search == m_item_map.end()) {
+            return false;
+        }
+        erase_item(search, out_value);
+        return true;
+    }
+
+    // Remove the item with the key and item name from the cache,
+    // returning the removed value so the caller can deallocate it.
+    //
+    // Returns false if the key is not in the cache, or the item with
+    // the key has a different name.
+    bool erase(const Key key, const std::string &item_name,
+               Value &out_value) {
+        auto search = m_item_map.find(key);
+        if ((search == m_item_map.end()) ||
+            (search->second.name != item_name)) {
+            return false;
+        }
+        erase_item(search, out_value);
+        return true;
+    }
+
+    // Remove the least recently used item from the cache, returning
+    // the removed key and value so the caller can deallocate it.
+    //
+    // Returns false if the cache is empty.
+    bool evict_least_recently_used(Key &out_key, Value &out_value) {
+        if (m_lru_first == nullptr) {
+            return false;
+        }
+        out_key = m_lru_first->key;
+        auto search = m_item_map.find(out_key);
+        erase_item(search, out_value);
+        return true;
+    }
+
+    void group_names(std::vector<std::string> &out_group_names) const {
+        out_group_names.clear();
+        out_group_names.reserve(m_group_map.size());
+        for (auto it = m_group_map.begin(); it != m_group_map.end(); ++it) {
+            out_group_names.push_back(it->second.name);
+        }
+    }
+
+    size_t group_item_count(const GroupKey group_key) const {
+        auto search = m_group_map.find(group_key);
+        if (search == m_group_map.end()) {
+            return 0;
+        }
+        return search->second.item_count;
+    }
+
+    // Returns false if the group is not in the cache.
+    bool group_item_names(const GroupKey group_key,
+                          std::vector<std::string> &out_item_names) const {
+        out_item_names.clear();
+        auto search = m_group_map.find(group_key);
+        if (search == m_group_map.end()) {
+            return false;
+        }
+        const Group &group = search->second;
+        out_item_names.reserve(group.item_count);
+        for (const Item *item = group.first_item; item != nullptr;
+             item = item->group_next) {
+            out_item_names.push_back(item->name);
+        }
+        return true;
+    }
+
+    // Returns false if the group is not in the cache.
+    bool group_item_keys(const GroupKey group_key,
+                         std::vector<Key> &out_item_keys) const {
+        out_item_keys.clear();
+        auto search = m_group_map.find(group_key);
+        if (search == m_group_map.end()) {
+            return false;
+        }
+        const Group &group = search->second;
+        out_item_keys.reserve(group.item_count);
+        for (const Item *item = group.first_item; item != nullptr;
+             item = item->group_next) {
+            out_item_keys.push_back(item->key);
+        }
+        return true;
+    }
+
+private:
+    void link_lru_last(Item &item) {
+        item.lru_prev = m_lru_last;
+        item.lru_next = nullptr;
+        if (m_lru_last != nullptr) {
+            m_lru_last->lru_next = &item;
+        } else {
+            m_lru_first = &item;
+        }
+        m_lru_last = &item;
+    }
+
+    void unlink_lru(Item &item) {
+        if (item.lru_prev != nullptr) {
+            item.lru_prev->lru_next = item.lru_next;
+        } else {
+            m_lru_first = item.lru_next;
+        }
+        if (item.lru_next != nullptr) {
+            item.lru_next->lru_prev = item.lru_prev;
+        } else {
+            m_lru_last = item.lru_prev;
+        }
+        item.lru_prev = nullptr;
+        item.lru_next = nullptr;
+    }
+
+    void link_group(Group &group, Item &item) {
+        item.group_prev = nullptr;
+        item.group_next = group.first_item;
+        if (group.first_item != nullptr) {
+            group.first_item->group_prev = &item;
+        }
+        group.first_item = &item;
+        group.item_count += 1;
+    }
+
+    void unlink_group(Group &group, Item &item) {
+        if (item.group_prev != nullptr) {
+            item.group_prev->group_next = item.group_next;
+        } else {
+            group.first_item = item.group_next;
+        }
+        if (item.group_next != nullptr) {
+            item.group_next->group_prev = item.group_prev;
+        }
+        item.group_prev = nullptr;
+        item.group_next = nullptr;
+        group.item_count -= 1;
+    }
+
+    void erase_item(typename ItemMap::iterator item_iterator,
+                    Value &out_value) {
+        Item &item = item_iterator->second;
+        unlink_lru(item);
+
+        Group *group = item.group;
+        unlink_group(*group, item);
+        if (group->item_count == 0) {
+            // Groups without any items are removed.
+            m_group_map.erase(group->key);
+        }
+
+        m_used_bytes -= item.byte_count;
+        out_value = item.value;
+        m_item_map.erase(item_iterator);
+    }
+
+    size_t m_used_bytes;
+
+    // Nodes of std::unordered_map are never moved (even when
+    // re-hashing), so the items and groups can point to each other.
+    ItemMap m_item_map;
+    GroupMap m_group_map;
+
+    // The 'first' item is the least recently used, the 'last' item is
+    // the most recently used.
+    Item *m_lru_first;
+    Item *m_lru_last;
+};
+
+}  // namespace mmimage
+
+#endif  // MM_IMAGE_IMAGE_CACHE_CORE_H
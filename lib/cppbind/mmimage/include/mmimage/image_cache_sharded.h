@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#ifndef MM_IMAGE_IMAGE_CACHE_SHARDED_H
+#define MM_IMAGE_IMAGE_CACHE_SHARDED_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "image_cache_core.h"
+
+namespace mmimage {
+
+// A thread-safe Least-Recently-Used (LRU) image cache.
+//
+// The key space is split into a fixed number of shards, each shard
+// is an 'ImageCacheCore' guarded by its own mutex, so threads reading
+// and writing different images rarely wait on each other. A single
+// byte budget is shared by all the shards; the thread that inserts
+// an item evicts the least recently used items (across all shards)
+// until the cache fits within the budget again.
+//
+// As with 'ImageCacheCore', the values are not owned by the cache.
+// Any values removed from the cache are given back to the caller to
+// be deallocated, after the shard lock has been released.
+//
+// NOTE: A value returned by 'find()' is a copy, and another thread may
+// evict the item at any time after 'find()' returns. Values that
+// refer to memory must share ownership of it (for example with
+// 'std::shared_ptr'), so a value held by a reader stays valid after
+// it has been evicted.
+template <typename Value>
+class ImageCacheSharded {
+public:
+    using Key = uint64_t;
+    using GroupKey = uint64_t;
+
+    static const size_t shard_count = 16;
+
+private:
+    struct Entry {
+        Value value;
+        size_t byte_count;
+
+        // A global counter value, incremented each time an item is
+        // used, to compare the LRU items of different shards.
+        uint64_t last_used;
+    };
+
+    using Core = ImageCacheCore<Entry>;
+
+    struct Shard {
+        // 'mutable' so the const query methods can lock the shard.
+        mutable std::mutex mutex;
+        Core core;
+    };
+
+public:
+    ImageCacheSharded()
+        : m_capacity_bytes(0)
+        , m_item_count_minimum(0)
+        , m_used_bytes(0)
+        , m_item_count(0)
+        , m_use_counter(0) {}
+
+    ImageCacheSharded(ImageCacheSharded const &) = delete;
+    void operator=(ImageCacheSharded const &) = delete;
+
+    size_t capacity_bytes() const { return m_capacity_bytes.load(); }
+    size_t item_count_minimum() const { return m_item_count_minimum.load(); }
+
+    // The bytes used by items in the cache, and the bytes reserved by
+    // items that are being inserted.
+    size_t used_bytes() const { return m_used_bytes.load(); }
+    size_t item_count() const { return m_item_count.load(); }
+    bool empty() const { return m_item_count.load() == 0; }
+
+    // Set the byte budget, evicting items until the cache fits.
+    void set_capacity_bytes(const size_t value,
+                            std::vector<Value> &out_evicted_values) {
+        m_capacity_bytes.store(value);
+        ImageCacheSharded::evict_enough_for_new_item(0, out_evicted_values);
+    }
+
+    void set_item_count_minimum(const size_t value) {
+        m_item_count_minimum.store(value);
+    }
+
+    bool contains(const Key key) const {
+        const Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.core.contains(key);
+    }
+
+    bool contains(const Key key, const std::string &item_name) const {
+        const Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        return shard.core.contains(key, item_name);
+    }
+
+    // Insert an item as the most recently used item, replacing the
+    // item with the same key, if any (even if the replaced item has a
+    // different name).
+    //
+    // Items are evicted to keep the cache within the byte budget,
+    // unless the cache holds 'item_count_minimum' items or less.
+    //
+    // The replaced and evicted values are appended to
+    // 'out_evicted_values'.
+    void insert(const GroupKey group_key, const std::string &group_name,
+                const Key key, const std::string &item_name,
+                const Value &value, const size_t byte_count,
+                std::vector<Value> &out_evicted_values) {
+        Shard &shard = shard_for_key(key);
+        ImageCacheSharded::erase_from_shard(shard, key, out_evicted_values);
+
+        // Reserve the bytes before evicting, so that threads inserting
+        // at the same time cannot all see the same free space.
+        m_used_bytes.fetch_add(byte_count);
+        ImageCacheSharded::evict_enough_for_new_item(0, out_evicted_values);
+
+        Entry entry;
+        entry.value = value;
+        entry.byte_count = byte_count;
+        entry.last_used = m_use_counter.fetch_add(1);
+
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry old_entry;
+        if (shard.core.erase(key, old_entry)) {
+            // Another thread inserted the same key while this thread
+            // was evicting.
+            m_used_bytes.fetch_sub(old_entry.byte_count);
+            m_item_count.fetch_sub(1);
+            out_evicted_values.push_back(old_entry.value);
+        }
+        shard.core.insert(group_key, group_name, key, item_name, entry,
+                          byte_count);
+        m_item_count.fetch_add(1);
+    }
+
+    // Find the item value, and make it the most recently used item.
+    //
+    // Returns false if the key is not in the cache.
+    bool find(const Key key, Value &out_value) {
+        Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry *entry = shard.core.find(key);
+        if (entry == nullptr) {
+            return false;
+        }
+        entry->last_used = m_use_counter.fetch_add(1);
+        out_value = entry->value;
+        return true;
+    }
+
+    // Find the item value with the key and item name, and make it the
+    // most recently used item.
+    //
+    // Returns false if the key is not in the cache, or the item with
+    // the key has a different name.
+    bool find(const Key key, const std::string &item_name,
+              Value &out_value) {
+        Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry *entry = shard.core.find(key, item_name);
+        if (entry == nullptr) {
+            return false;
+        }
+        entry->last_used = m_use_counter.fetch_add(1);
+        out_value = entry->value;
+        return true;
+    }
+
+    // Remove the item from the cache, returning the removed value so
+    // the caller can deallocate it.
+    //
+    // Returns false if the key is not in the cache.
+    bool erase(const Key key, Value &out_value) {
+        Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry entry;
+        if (!shard.core.erase(key, entry)) {
+            return false;
+        }
+        m_used_bytes.fetch_sub(entry.byte_count);
+        m_item_count.fetch_sub(1);
+        out_value = entry.value;
+        return true;
+    }
+
+    // Remove the item with the key and item name from the cache,
+    // returning the removed value so the caller can deallocate it.
+    //
+    // Returns false if the key is not in the cache, or the item with
+    // the key has a different name.
+    bool erase(const Key key, const std::string &item_name,
+               Value &out_value) {
+        Shard &shard = shard_for_key(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry entry;
+        if (!shard.core.erase(key, item_name, entry)) {
+            return false;
+        }
+        m_used_bytes.fetch_sub(entry.byte_count);
+        m_item_count.fetch_sub(1);
+        out_value = entry.value;
+        return true;
+    }
+
+    // Remove all the items in the group, appending the removed values
+    // to 'out_erased_values'.
+    //
+    // Returns false if the group is not in the cache.
+    bool erase_group(const GroupKey group_key,
+                     std::vector<Value> &out_erased_values) {
+        bool group_found = false;
+        std::vector<Key> item_keys;
+        for (Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (!shard.core.group_item_keys(group_key, item_keys)) {
+                continue;
+            }
+            group_found = true;
+            for (const Key item_key : item_keys) {
+                Entry entry;
+                shard.core.erase(item_key, entry);
+                m_used_bytes.fetch_sub(entry.byte_count);
+                m_item_count.fetch_sub(1);
+                out_erased_values.push_back(entry.value);
+            }
+        }
+        return group_found;
+    }
+
+    // Remove the least recently used item of all the shards,
+    // returning the removed key and value so the caller can
+    // deallocate it.
+    //
+    // Returns false if the cache has 'item_count_minimum' items or
+    // less.
+    bool evict_least_recently_used(Key &out_key, Value &out_value) {
+        if (m_item_count.load() <= m_item_count_minimum.load()) {
+            return false;
+        }
+
+        // Only one shard is locked at a time. Another thread may
+        // use the chosen item before it is evicted, in which case the
+        // next least recently used item of the shard is evicted.
+        Shard *oldest_shard = nullptr;
+        uint64_t oldest_last_used = std::numeric_limits<uint64_t>::max();
+        for (Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            Key key = 0;
+            const Entry *entry = shard.core.peek_least_recently_used(key);
+            if ((entry != nullptr) && (entry->last_used < oldest_last_used)) {
+                oldest_last_used = entry->last_used;
+                oldest_shard = &shard;
+            }
+        }
+        if (oldest_shard == nullptr) {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(oldest_shard->mutex);
+        Entry entry;
+        if (!oldest_shard->core.evict_least_recently_used(out_key, entry)) {
+            return false;
+        }
+        m_used_bytes.fetch_sub(entry.byte_count);
+        m_item_count.fetch_sub(1);
+        out_value = entry.value;
+        return true;
+    }
+
+    // Evict items until 'new_memory_chunk_size' more bytes fit in the
+    // byte budget, appending the evicted values to
+    // 'out_evicted_values'.
+    //
+    // Returns false if not enough items could be evicted.
+    bool evict_enough_for_new_item(const size_t new_memory_chunk_size,
+                                   std::vector<Value> &out_evicted_values) {
+        while ((m_used_bytes.load() + new_memory_chunk_size) >
+               m_capacity_bytes.load()) {
+            Key key = 0;
+            Value value;
+            if (!ImageCacheSharded::evict_least_recently_used(key, value)) {
+                return false;
+            }
+            out_evicted_values.push_back(value);
+        }
+        return true;
+    }
+
+    size_t group_count() const {
+        std::vector<std::string> names;
+        ImageCacheSharded::group_names(names);
+        return names.size();
+    }
+
+    void group_names(std::vector<std::string> &out_group_names) const {
+        std::unordered_set<std::string> unique_names;
+        std::vector<std::string> shard_names;
+        for (const Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            shard.core.group_names(shard_names);
+            unique_names.insert(shard_names.begin(), shard_names.end());
+        }
+        out_group_names.assign(unique_names.begin(), unique_names.end());
+    }
+
+    size_t group_item_count(const GroupKey group_key) const {
+        size_t count = 0;
+        for (const Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            count += shard.core.group_item_count(group_key);
+        }
+        return count;
+    }
+
+    // Returns false if the group is not in the cache.
+    bool group_item_names(const GroupKey group_key,
+                          std::vector<std::string> &out_item_names) const {
+        out_item_names.clear();
+        bool group_found = false;
+        std::vector<std::string> shard_names;
+        for (const Shard &shard : m_shards) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.core.group_item_names(group_key, shard_names)) {
+                group_found = true;
+                out_item_names.insert(out_item_names.end(),
+                                      shard_names.begin(), shard_names.end());
+            }
+        }
+        return group_found;
+    }
+
+private:
+    // The keys are expected to be hashes already, but the low bits
+    // are mixed with the high bits in case they are not.
+    static size_t shard_index(const Key key) {
+        const uint64_t mixed = (key ^ (key >> 32)) * 0x9E3779B97F4A7C15ULL;
+        return static_cast<size_t>(mixed >> 32) % shard_count;
+    }
+
+    Shard &shard_for_key(const Key key) {
+        return m_shards[shard_index(key)];
+    }
+
+    const Shard &shard_for_key(const Key key) const {
+        return m_shards[shard_index(key)];
+    }
+
+    void erase_from_shard(Shard &shard, const Key key,
+                          std::vector<Value> &out_erased_values) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        Entry entry;
+        if (shard.core.erase(key, entry)) {
+            m_used_bytes.fetch_sub(entry.byte_count);
+            m_item_count.fetch_sub(1);
+            out_erased_values.push_back(entry.value);
+        }
+    }
+
+    std::atomic<size_t> m_capacity_bytes;
+    std::atomic<size_t> m_item_count_minimum;
+    std::atomic<size_t> m_used_bytes;
+    std::atomic<size_t> m_item_count;
+    std::atomic<uint64_t> m_use_counter;
+
+    std::array<Shard, shard_count> m_shards;
+};
+
+}  // namespace mmimage
+
+#endif  // MM_IMAGE_IMAGE_CACHE_SHARDED_H
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#ifndef MM_IMAGE_IMAGE_DISK_CACHE_H
+#define MM_IMAGE_IMAGE_DISK_CACHE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "_symbol_export.h"
+#include "image_cache_core.h"
+
+namespace mmimage {
+
+// The size and layout of the pixels stored in a disk cache file.
+struct DiskCacheImageInfo {
+    DiskCacheImageInfo()
+        : width(0), height(0), num_channels(0), bytes_per_channel(0) {}
+
+    uint32_t width;
+    uint32_t height;
+    uint8_t num_channels;
+    uint8_t bytes_per_channel;
+
+    size_t byte_count() const {
+        return static_cast<size_t>(width) * static_cast<size_t>(height) *
+               static_cast<size_t>(num_channels) *
+               static_cast<size_t>(bytes_per_channel);
+    }
+};
+
+// A Least-Recently-Used (LRU) cache of decoded image pixels, stored
+// as files in a directory (ideally on a fast local disk).
+//
+// Decoding compressed image files (such as DWAA or PIZ EXR files, or
+// JPEG files) on network storage is much slower than reading the raw
+// pixels back from a local disk, so decoded pixels are written to the
+// disk cache to be re-used in later sessions.
+//
+// Each file holds a small header and the raw (uncompressed) pixels.
+// The files are named by a key made from the source file path,
+// modification time and size, so a changed source file is never read
+// from an out-of-date cache file.
+//
+// Files are written by background threads, and the least recently
+// used files are deleted when the total size of the files is over the
+// capacity. When the cache is created, the files already in the
+// directory are added to the cache, ordered by the file modification
+// time (reading a file from the cache updates the time).
+//
+// This class is thread-safe.
+class ImageDiskCache {
+public:
+    using Key = uint64_t;
+
+    // The maximum bytes of pixels waiting to be written. Writes are
+    // skipped when the writer threads fall this far behind, because
+    // the pixels can always be decoded again.
+    static const size_t max_pending_write_bytes =
+        static_cast<size_t>(2048) * 1024 * 1024;
+
+    // A 'thread_count' of zero uses the number of hardware threads.
+    MMIMAGE_API_EXPORT
+    ImageDiskCache(const std::string &directory_path,
+                   const size_t capacity_bytes, const size_t thread_count);
+
+    // Waits for all queued writes to finish.
+    MMIMAGE_API_EXPORT
+    ~ImageDiskCache();
+
+    ImageDiskCache(ImageDiskCache const &) = delete;
+    void operator=(ImageDiskCache const &) = delete;
+
+    // Make the key for the source image file.
+    //
+    // Returns false if the source file does not exist.
+    MMIMAGE_API_EXPORT
+    static bool make_key(const std::string &source_file_path, Key &out_key);
+
+    MMIMAGE_API_EXPORT
+    const std::string &directory_path() const { return m_directory_path; }
+
+    // The path of the cache file for the key (the file may not
+    // exist).
+    MMIMAGE_API_EXPORT
+    std::string file_path(const Key key) const;
+
+    MMIMAGE_API_EXPORT
+    size_t capacity_bytes() const;
+    MMIMAGE_API_EXPORT
+    size_t used_bytes() const;
+    MMIMAGE_API_EXPORT
+    size_t item_count() const;
+
+    // Set the capacity, deleting the least recently used files until
+    // the cache fits.
+    MMIMAGE_API_EXPORT
+    void set_capacity_bytes(const size_t value);
+
+    // Write the pixels into the cache.
+    //
+    // With 'background' the pixels are copied and written by the
+    // writer threads, otherwise the file is written before returning.
+    //
+    // Returns false if the pixels were not written (or queued).
+    MMIMAGE_API_EXPORT
+    bool write(const Key key, const DiskCacheImageInfo &info,
+               const void *pixel_data, const bool background);
+
+    // Block until all queued writes have finished.
+    MMIMAGE_API_EXPORT
+    void wait_for_writes();
+
+    // Is the key in the cache? Marks the key as the most recently
+    // used.
+    MMIMAGE_API_EXPORT
+    bool find(const Key key);
+
+    // Read the header of the cache file.
+    MMIMAGE_API_EXPORT
+    bool read_info(const Key key, DiskCacheImageInfo &out_info);
+
+    // Read the pixels of the cache file into 'out_pixel_data', which
+    // must hold 'info.byte_count()' bytes.
+    MMIMAGE_API_EXPORT
+    bool read_pixels(const Key key, const DiskCacheImageInfo &info,
+                     void *out_pixel_data);
+
+private:
+    struct WriteItem {
+        Key key;
+        DiskCacheImageInfo info;
+        std::vector<uint8_t> pixels;
+    };
+
+    void scan_directory();
+    bool write_file(const Key key, const DiskCacheImageInfo &info,
+                    const void *pixel_data);
+    void add_file(const Key key, const size_t file_byte_count);
+    void remove_file(const Key key);
+    void evict_files();
+    void run_writer();
+
+    std::string m_directory_path;
+
+    // Guards the index of the files.
+    mutable std::mutex m_index_mutex;
+    size_t m_capacity_bytes;
+    ImageCacheCore<size_t> m_index;
+
+    // Guards the writes queue.
+    std::mutex m_write_mutex;
+    std::condition_variable m_write_condition;
+    std::condition_variable m_idle_condition;
+    std::deque<WriteItem> m_write_queue;
+    size_t m_pending_write_bytes;
+    size_t m_running_write_count;
+    bool m_stopping;
+
+    std::vector<std::thread> m_threads;
+};
+
+}  // namespace mmimage
+
+#endif  // MM_IMAGE_IMAGE_DISK_CACHE_H
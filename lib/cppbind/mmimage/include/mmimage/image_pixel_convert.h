@@ -0,0 +1,62 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#ifndef MM_IMAGE_IMAGE_PIXEL_CONVERT_H
+#define MM_IMAGE_IMAGE_PIXEL_CONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "_symbol_export.h"
+
+namespace mmimage {
+
+// Convert between 32-bit floats and the bits of 16-bit (half)
+// floats, rounding to the nearest half float.
+MMIMAGE_API_EXPORT
+uint16_t convert_f32_to_f16(const float value);
+MMIMAGE_API_EXPORT
+float convert_f16_to_f32(const uint16_t value);
+
+// Copy the first 'out_num_channels' channels of each pixel, for
+// example to remove the alpha channel of RGBA pixels.
+//
+// 'out_num_channels' must be less than or equal to 'in_num_channels'.
+MMIMAGE_API_EXPORT
+void copy_pixels_f32(const float *in_pixels, const size_t pixel_count,
+                     const size_t in_num_channels,
+                     const size_t out_num_channels, float *out_pixels);
+
+// Convert 32-bit float pixels to 8-bit unsigned normalised integers,
+// with the values clamped between 0.0 and 1.0. No colour space
+// conversion is done.
+//
+// 'out_num_channels' must be less than or equal to 'in_num_channels'.
+MMIMAGE_API_EXPORT
+void convert_pixels_f32_to_u8(const float *in_pixels,
+                              const size_t pixel_count,
+                              const size_t in_num_channels,
+                              const size_t out_num_channels,
+                              uint8_t *out_pixels);
+
+}  // namespace mmimage
+
+#endif  // MM_IMAGE_IMAGE_PIXEL_CONVERT_H
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#ifndef MM_IMAGE_IMAGE_PREFETCH_H
+#define MM_IMAGE_IMAGE_PREFETCH_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "_symbol_export.h"
+
+namespace mmimage {
+
+// Get the frame numbers to prefetch around the playhead, in the
+// order they should be read.
+//
+// The frames nearest to the playhead are read first, alternating
+// forward and backward, with frames after the playhead before frames
+// that are the same distance before the playhead. Frames outside
+// 'start_frame' to 'end_frame' (inclusive) are skipped.
+MMIMAGE_API_EXPORT
+void prefetch_window_frames(const int32_t playhead_frame,
+                            const int32_t frames_forward,
+                            const int32_t frames_backward,
+                            const int32_t start_frame,
+                            const int32_t end_frame,
+                            std::vector<int32_t> &out_frames);
+
+// Reads image files on a pool of background threads, in priority
+// order.
+//
+// The images are read by a function given by the caller, which is
+// expected to store the pixels into a (thread-safe) cache, and to
+// return early if the image is already cached.
+//
+// Items are queued per group (such as an image sequence). Queuing
+// new items for a group cancels the items of the group that have not
+// started yet, so when the playhead jumps, the frames around the old
+// playhead position are not read.
+class ImagePrefetcher {
+public:
+    // Called on the background threads; must be thread-safe.
+    //
+    // Returns false if the image could not be read.
+    using ReadFunction = std::function<bool(const std::string &group_name,
+                                            const std::string &file_path)>;
+
+    // A 'thread_count' of zero uses the number of hardware threads.
+    MMIMAGE_API_EXPORT
+    ImagePrefetcher(ReadFunction read_function, const size_t thread_count);
+
+    // Cancels the queued items, and waits for the running items to
+    // finish.
+    MMIMAGE_API_EXPORT
+    ~ImagePrefetcher();
+
+    ImagePrefetcher(ImagePrefetcher const &) = delete;
+    void operator=(ImagePrefetcher const &) = delete;
+
+    // Replace the queued items of the group with 'file_paths', read
+    // in the order given (the first file path has the highest
+    // priority).
+    //
+    // File paths that are being read already are not queued again.
+    MMIMAGE_API_EXPORT
+    void prefetch(const std::string &group_name,
+                  const std::vector<std::string> &file_paths);
+
+    // Remove the queued items of the group.
+    MMIMAGE_API_EXPORT
+    void cancel(const std::string &group_name);
+
+    // Remove all queued items.
+    MMIMAGE_API_EXPORT
+    void cancel_all();
+
+    // Block until all queued items have been read.
+    MMIMAGE_API_EXPORT
+    void wait_for_prefetch();
+
+    MMIMAGE_API_EXPORT
+    size_t thread_count() const { return m_threads.size(); }
+
+    // The number of items that are queued or being read.
+    MMIMAGE_API_EXPORT
+    size_t pending_count() const;
+
+    // The number of items read (or failed to be read) since the
+    // prefetcher was created.
+    MMIMAGE_API_EXPORT
+    size_t read_count() const;
+    MMIMAGE_API_EXPORT
+    size_t failed_count() const;
+
+private:
+    struct Item {
+        std::string group_name;
+        std::string file_path;
+    };
+
+    // Items with a lower priority value are read first. Items with
+    // the same priority are read in the order they were queued.
+    using Queue = std::multimap<size_t, Item>;
+
+    void remove_queued_items(const std::string &group_name);
+    void run_worker();
+
+    ReadFunction m_read_function;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queue_condition;
+    std::condition_variable m_idle_condition;
+    Queue m_queue;
+    std::unordered_set<std::string> m_running_file_paths;
+    size_t m_read_count;
+    size_t m_failed_count;
+    bool m_stopping;
+
+    std::vector<std::thread> m_threads;
+};
+
+}  // namespace mmimage
+
+#endif  // MM_IMAGE_IMAGE_PREFETCH_H
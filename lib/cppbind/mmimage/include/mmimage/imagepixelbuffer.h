@@ -67,6 +67,12 @@ public:
     MMIMAGE_API_EXPORT
     rust::Slice<PixelF32x4> as_slice_f32x4_mut() noexcept;
 
+    MMIMAGE_API_EXPORT
+    const rust::Slice<const PixelF16x4> as_slice_f16x4() noexcept;
+
+    MMIMAGE_API_EXPORT
+    rust::Slice<PixelF16x4> as_slice_f16x4_mut() noexcept;
+
     MMIMAGE_API_EXPORT
     void resize(const BufferDataType data_type, const size_t image_width,
                 const size_t image_height, const size_t num_channels) noexcept;
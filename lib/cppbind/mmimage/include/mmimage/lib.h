@@ -46,6 +46,13 @@ bool image_read_pixels_exr_f32x4(const rust::Str& file_path,
                                  ImageMetaData& out_meta_data,
                                  ImagePixelBuffer& out_pixel_data);
 
+// Read the EXR pixels as 16-bit (half) floats, using half the
+// memory of 'image_read_pixels_exr_f32x4'.
+bool image_read_pixels_exr_f16x4(const rust::Str& file_path,
+                                 const bool vertical_flip,
+                                 ImageMetaData& out_meta_data,
+                                 ImagePixelBuffer& out_pixel_data);
+
 bool image_write_pixels_exr_f32x4(const rust::Str& file_path,
                                   ImageExrEncoder exr_encoder,
                                   ImageMetaData& in_meta_data,
@@ -988,6 +988,7 @@ namespace mmimage {
   struct Box2F32;
   struct ImageRegionRectangle;
   struct PixelF32x4;
+  struct PixelF16x4;
   struct PixelF64x2;
   enum class BufferDataType : ::std::uint8_t;
   struct ShimImagePixelBuffer;
@@ -1182,6 +1183,18 @@ struct PixelF32x4 final {
 };
 #endif // CXXBRIDGE1_STRUCT_mmimage$PixelF32x4
 
+#ifndef CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+#define CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+struct PixelF16x4 final {
+  ::std::uint16_t r;
+  ::std::uint16_t g;
+  ::std::uint16_t b;
+  ::std::uint16_t a;
+
+  using IsRelocatable = ::std::true_type;
+};
+#endif // CXXBRIDGE1_STRUCT_mmimage$PixelF16x4
+
 #ifndef CXXBRIDGE1_STRUCT_mmimage$PixelF64x2
 #define CXXBRIDGE1_STRUCT_mmimage$PixelF64x2
 struct PixelF64x2 final {
@@ -1219,6 +1232,8 @@ struct ShimImagePixelBuffer final : public ::rust::Opaque {
   MMIMAGE_API_EXPORT ::std::size_t element_count() const noexcept;
   MMIMAGE_API_EXPORT ::rust::Slice<const ::mmimage::PixelF32x4> as_slice_f32x4() const noexcept;
   MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF32x4> as_slice_f32x4_mut() noexcept;
+  MMIMAGE_API_EXPORT ::rust::Slice<const ::mmimage::PixelF16x4> as_slice_f16x4() const noexcept;
+  MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF16x4> as_slice_f16x4_mut() noexcept;
   MMIMAGE_API_EXPORT void resize(::mmimage::BufferDataType data_type, ::std::size_t image_width, ::std::size_t image_height, ::std::size_t num_channels) noexcept;
   ~ShimImagePixelBuffer() = delete;
 
@@ -1351,6 +1366,10 @@ bool mmimage$cxxbridge1$PixelF64x2$operator$ge(const PixelF64x2 &, const PixelF6
 
 ::rust::repr::Fat mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f32x4_mut(::mmimage::ShimImagePixelBuffer &self) noexcept;
 
+::rust::repr::Fat mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f16x4(const ::mmimage::ShimImagePixelBuffer &self) noexcept;
+
+::rust::repr::Fat mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f16x4_mut(::mmimage::ShimImagePixelBuffer &self) noexcept;
+
 void mmimage$cxxbridge1$ShimImagePixelBuffer$resize(::mmimage::ShimImagePixelBuffer &self, ::mmimage::BufferDataType data_type, ::std::size_t image_width, ::std::size_t image_height, ::std::size_t num_channels) noexcept;
 
 ::mmimage::ShimImagePixelBuffer *mmimage$cxxbridge1$shim_create_image_pixel_buffer_box() noexcept;
@@ -1433,6 +1452,8 @@ void mmimage$cxxbridge1$ShimImageMetaData$as_string(const ::mmimage::ShimImageMe
 
 bool mmimage$cxxbridge1$shim_image_read_pixels_exr_f32x4(::rust::Str file_path, bool vertical_flip, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data, ::rust::Box<::mmimage::ShimImagePixelBuffer> &out_pixel_buffer) noexcept;
 
+bool mmimage$cxxbridge1$shim_image_read_pixels_exr_f16x4(::rust::Str file_path, bool vertical_flip, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data, ::rust::Box<::mmimage::ShimImagePixelBuffer> &out_pixel_buffer) noexcept;
+
 bool mmimage$cxxbridge1$shim_image_read_metadata_exr(::rust::Str file_path, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data) noexcept;
 
 bool mmimage$cxxbridge1$shim_image_write_pixels_exr_f32x4(::rust::Str file_path, ::mmimage::ImageExrEncoder exr_encoder, const ::rust::Box<::mmimage::ShimImageMetaData> &in_meta_data, const ::rust::Box<::mmimage::ShimImagePixelBuffer> &in_pixel_buffer) noexcept;
@@ -1710,6 +1731,14 @@ MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF32x4> ShimImagePixelBuffer::as
   return ::rust::impl<::rust::Slice<::mmimage::PixelF32x4>>::slice(mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f32x4_mut(*this));
 }
 
+MMIMAGE_API_EXPORT ::rust::Slice<const ::mmimage::PixelF16x4> ShimImagePixelBuffer::as_slice_f16x4() const noexcept {
+  return ::rust::impl<::rust::Slice<const ::mmimage::PixelF16x4>>::slice(mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f16x4(*this));
+}
+
+MMIMAGE_API_EXPORT ::rust::Slice<::mmimage::PixelF16x4> ShimImagePixelBuffer::as_slice_f16x4_mut() noexcept {
+  return ::rust::impl<::rust::Slice<::mmimage::PixelF16x4>>::slice(mmimage$cxxbridge1$ShimImagePixelBuffer$as_slice_f16x4_mut(*this));
+}
+
 MMIMAGE_API_EXPORT void ShimImagePixelBuffer::resize(::mmimage::BufferDataType data_type, ::std::size_t image_width, ::std::size_t image_height, ::std::size_t num_channels) noexcept {
   mmimage$cxxbridge1$ShimImagePixelBuffer$resize(*this, data_type, image_width, image_height, num_channels);
 }
@@ -1884,6 +1913,10 @@ MMIMAGE_API_EXPORT bool shim_image_read_pixels_exr_f32x4(::rust::Str file_path,
   return mmimage$cxxbridge1$shim_image_read_pixels_exr_f32x4(file_path, vertical_flip, out_meta_data, out_pixel_buffer);
 }
 
+MMIMAGE_API_EXPORT bool shim_image_read_pixels_exr_f16x4(::rust::Str file_path, bool vertical_flip, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data, ::rust::Box<::mmimage::ShimImagePixelBuffer> &out_pixel_buffer) noexcept {
+  return mmimage$cxxbridge1$shim_image_read_pixels_exr_f16x4(file_path, vertical_flip, out_meta_data, out_pixel_buffer);
+}
+
 MMIMAGE_API_EXPORT bool shim_image_read_metadata_exr(::rust::Str file_path, ::rust::Box<::mmimage::ShimImageMetaData> &out_meta_data) noexcept {
   return mmimage$cxxbridge1$shim_image_read_metadata_exr(file_path, out_meta_data);
 }
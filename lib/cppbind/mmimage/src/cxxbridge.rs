@@ -187,6 +187,16 @@ pub mod ffi {
         a: f32,
     }
 
+    // A pixel of 16-bit (half) floats, stored as the bits of each
+    // 'f16' value, because C++ has no 16-bit float type.
+    #[derive(Debug, Copy, Clone)]
+    struct PixelF16x4 {
+        r: u16,
+        g: u16,
+        b: u16,
+        a: u16,
+    }
+
     #[derive(Debug, Copy, Clone, PartialEq, PartialOrd)]
     struct PixelF64x2 {
         x: f64,
@@ -222,6 +232,8 @@ pub mod ffi {
 
         pub fn as_slice_f32x4(&self) -> &[PixelF32x4];
         pub fn as_slice_f32x4_mut(&mut self) -> &mut [PixelF32x4];
+        pub fn as_slice_f16x4(&self) -> &[PixelF16x4];
+        pub fn as_slice_f16x4_mut(&mut self) -> &mut [PixelF16x4];
 
         pub fn resize(
             &mut self,
@@ -289,6 +301,13 @@ pub mod ffi {
             out_pixel_buffer: &mut Box<ShimImagePixelBuffer>,
         ) -> bool;
 
+        fn shim_image_read_pixels_exr_f16x4(
+            file_path: &str,
+            vertical_flip: bool,
+            out_meta_data: &mut Box<ShimImageMetaData>,
+            out_pixel_buffer: &mut Box<ShimImagePixelBuffer>,
+        ) -> bool;
+
         fn shim_image_read_metadata_exr(
             file_path: &str,
             out_meta_data: &mut Box<ShimImageMetaData>,
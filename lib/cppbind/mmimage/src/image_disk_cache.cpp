@@ -0,0 +1,535 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include <mmimage/image_disk_cache.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#ifdef _WIN32  // Windows MSVC
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <direct.h>  // _mkdir
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/utime.h>  // _utime
+#include <windows.h>    // FindFirstFileA, FindNextFileA
+#else                   // Linux and MacOS
+#include <dirent.h>     // opendir, readdir
+#include <sys/stat.h>   // stat, mkdir
+#include <sys/types.h>
+#include <utime.h>  // utime
+#endif
+
+namespace mmimage {
+
+namespace {
+
+// Every cache file starts with this header.
+//
+// All values are stored little-endian.
+const char kFileMagic[8] = {'M', 'M', 'I', 'M', 'G', 'C', 'A', 'C'};
+const uint32_t kFileVersion = 1;
+const size_t kFileHeaderByteCount = 32;
+const char kFileExtension[] = ".mmimg";
+const char kTempFileExtension[] = ".tmp";
+
+// The items in the index all use the same group.
+const uint64_t kIndexGroupKey = 0;
+const char kIndexGroupName[] = "disk";
+
+// FNV-1a hash, the same on every platform and in every session (unlike
+// 'std::hash'), so the file names stay valid.
+uint64_t hash_bytes(const void *data, const size_t byte_count,
+                    const uint64_t seed) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < byte_count; i++) {
+        hash ^= static_cast<uint64_t>(bytes[i]);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void write_u32(uint8_t *out_bytes, const uint32_t value) {
+    for (size_t i = 0; i < 4; i++) {
+        out_bytes[i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+void write_u64(uint8_t *out_bytes, const uint64_t value) {
+    for (size_t i = 0; i < 8; i++) {
+        out_bytes[i] = static_cast<uint8_t>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+uint32_t read_u32(const uint8_t *bytes) {
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; i++) {
+        value |= static_cast<uint32_t>(bytes[i]) << (i * 8);
+    }
+    return value;
+}
+
+uint64_t read_u64(const uint8_t *bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(bytes[i]) << (i * 8);
+    }
+    return value;
+}
+
+bool get_file_stat(const std::string &file_path, int64_t &out_modify_time,
+                   uint64_t &out_byte_count) {
+#ifdef _WIN32
+    struct _stat64 file_stat;
+    if (_stat64(file_path.c_str(), &file_stat) != 0) {
+        return false;
+    }
+#else
+    struct stat file_stat;
+    if (stat(file_path.c_str(), &file_stat) != 0) {
+        return false;
+    }
+#endif
+    out_modify_time = static_cast<int64_t>(file_stat.st_mtime);
+    out_byte_count = static_cast<uint64_t>(file_stat.st_size);
+    return true;
+}
+
+// Create the directory and all the parent directories.
+void make_directories(const std::string &directory_path) {
+    for (size_t i = 1; i <= directory_path.size(); i++) {
+        const bool at_end = i == directory_path.size();
+        if (!at_end && (directory_path[i] != '/') &&
+            (directory_path[i] != '\\')) {
+            continue;
+        }
+        const std::string parent_path = directory_path.substr(0, i);
+#ifdef _WIN32
+        _mkdir(parent_path.c_str());
+#else
+        mkdir(parent_path.c_str(), 0755);
+#endif
+    }
+}
+
+void list_directory(const std::string &directory_path,
+                    std::vector<std::string> &out_file_names) {
+    out_file_names.clear();
+#ifdef _WIN32
+    const std::string pattern = directory_path + "\\*";
+    WIN32_FIND_DATAA find_data;
+    HANDLE find_handle = FindFirstFileA(pattern.c_str(), &find_data);
+    if (find_handle == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    do {
+        out_file_names.push_back(find_data.cFileName);
+    } while (FindNextFileA(find_handle, &find_data) != 0);
+    FindClose(find_handle);
+#else
+    DIR *directory = opendir(directory_path.c_str());
+    if (directory == nullptr) {
+        return;
+    }
+    struct dirent *entry = nullptr;
+    while ((entry = readdir(directory)) != nullptr) {
+        out_file_names.push_back(entry->d_name);
+    }
+    closedir(directory);
+#endif
+}
+
+// Set the file modification time to now, so the LRU order is kept
+// between sessions.
+void touch_file(const std::string &file_path) {
+#ifdef _WIN32
+    _utime(file_path.c_str(), nullptr);
+#else
+    utime(file_path.c_str(), nullptr);
+#endif
+}
+
+// Replace the 'to' file with the 'from' file, so readers never see a
+// partially written file.
+bool replace_file(const std::string &from_file_path,
+                  const std::string &to_file_path) {
+#ifdef _WIN32
+    // Renaming on Windows fails if the destination exists.
+    std::remove(to_file_path.c_str());
+#endif
+    return std::rename(from_file_path.c_str(), to_file_path.c_str()) == 0;
+}
+
+bool ends_with(const std::string &value, const char *suffix) {
+    const size_t suffix_size = std::strlen(suffix);
+    return (value.size() >= suffix_size) &&
+           (value.compare(value.size() - suffix_size, suffix_size, suffix) ==
+            0);
+}
+
+// Parse "0123456789abcdef.mmimg" file names into the key.
+bool parse_file_name(const std::string &file_name, uint64_t &out_key) {
+    const size_t hex_digit_count = 16;
+    if ((file_name.size() != hex_digit_count + std::strlen(kFileExtension)) ||
+        !ends_with(file_name, kFileExtension)) {
+        return false;
+    }
+    const std::string hex_string = file_name.substr(0, hex_digit_count);
+    char *end = nullptr;
+    out_key = std::strtoull(hex_string.c_str(), &end, 16);
+    return (end != nullptr) && (*end == '\0');
+}
+
+// Read and check the header of an open cache file.
+bool read_file_header(std::FILE *file, const uint64_t key,
+                      DiskCacheImageInfo &out_info) {
+    uint8_t header[kFileHeaderByteCount];
+    if (std::fread(header, 1, kFileHeaderByteCount, file) !=
+        kFileHeaderByteCount) {
+        return false;
+    }
+    if ((std::memcmp(header, kFileMagic, sizeof(kFileMagic)) != 0) ||
+        (read_u32(header + 8) != kFileVersion) ||
+        (read_u64(header + 24) != key)) {
+        return false;
+    }
+    out_info.width = read_u32(header + 12);
+    out_info.height = read_u32(header + 16);
+    out_info.num_channels = header[20];
+    out_info.bytes_per_channel = header[21];
+    return true;
+}
+
+}  // namespace
+
+ImageDiskCache::ImageDiskCache(const std::string &directory_path,
+                               const size_t capacity_bytes,
+                               const size_t thread_count)
+    : m_directory_path(directory_path)
+    , m_capacity_bytes(capacity_bytes)
+    , m_pending_write_bytes(0)
+    , m_running_write_count(0)
+    , m_stopping(false) {
+    make_directories(m_directory_path);
+    ImageDiskCache::scan_directory();
+    {
+        std::lock_guard<std::mutex> lock(m_index_mutex);
+        ImageDiskCache::evict_files();
+    }
+
+    size_t count = thread_count;
+    if (count == 0) {
+        count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    count = std::max<size_t>(count, 1);
+
+    m_threads.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        m_threads.emplace_back(&ImageDiskCache::run_writer, this);
+    }
+}
+
+ImageDiskCache::~ImageDiskCache() {
+    ImageDiskCache::wait_for_writes();
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        m_stopping = true;
+    }
+    m_write_condition.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool ImageDiskCache::make_key(const std::string &source_file_path,
+                              Key &out_key) {
+    int64_t modify_time = 0;
+    uint64_t byte_count = 0;
+    if (!get_file_stat(source_file_path, modify_time, byte_count)) {
+        return false;
+    }
+
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    hash = hash_bytes(source_file_path.data(), source_file_path.size(), hash);
+    hash = hash_bytes(&modify_time, sizeof(modify_time), hash);
+    hash = hash_bytes(&byte_count, sizeof(byte_count), hash);
+    out_key = hash;
+    return true;
+}
+
+std::string ImageDiskCache::file_path(const Key key) const {
+    char file_name[32];
+    std::snprintf(file_name, sizeof(file_name), "%016llx%s",
+                  static_cast<unsigned long long>(key), kFileExtension);
+    return m_directory_path + "/" + file_name;
+}
+
+size_t ImageDiskCache::capacity_bytes() const {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    return m_capacity_bytes;
+}
+
+size_t ImageDiskCache::used_bytes() const {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    return m_index.used_bytes();
+}
+
+size_t ImageDiskCache::item_count() const {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    return m_index.item_count();
+}
+
+void ImageDiskCache::set_capacity_bytes(const size_t value) {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    m_capacity_bytes = value;
+    ImageDiskCache::evict_files();
+}
+
+bool ImageDiskCache::write(const Key key, const DiskCacheImageInfo &info,
+                           const void *pixel_data, const bool background) {
+    const size_t byte_count = info.byte_count();
+    if ((pixel_data == nullptr) || (byte_count == 0)) {
+        return false;
+    }
+    if (!background) {
+        return ImageDiskCache::write_file(key, info, pixel_data);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        if ((m_pending_write_bytes + byte_count) > max_pending_write_bytes) {
+            return false;
+        }
+        m_pending_write_bytes += byte_count;
+    }
+
+    // Copy the pixels without holding the lock.
+    WriteItem item;
+    item.key = key;
+    item.info = info;
+    const uint8_t *bytes = static_cast<const uint8_t *>(pixel_data);
+    item.pixels.assign(bytes, bytes + byte_count);
+
+    {
+        std::lock_guard<std::mutex> lock(m_write_mutex);
+        m_write_queue.push_back(std::move(item));
+    }
+    m_write_condition.notify_one();
+    return true;
+}
+
+void ImageDiskCache::wait_for_writes() {
+    std::unique_lock<std::mutex> lock(m_write_mutex);
+    m_idle_condition.wait(lock, [this] {
+        return (m_pending_write_bytes == 0) && (m_running_write_count == 0);
+    });
+}
+
+bool ImageDiskCache::find(const Key key) {
+    {
+        std::lock_guard<std::mutex> lock(m_index_mutex);
+        if (m_index.find(key) == nullptr) {
+            return false;
+        }
+    }
+    touch_file(ImageDiskCache::file_path(key));
+    return true;
+}
+
+bool ImageDiskCache::read_info(const Key key, DiskCacheImageInfo &out_info) {
+    std::FILE *file = std::fopen(ImageDiskCache::file_path(key).c_str(), "rb");
+    if (file == nullptr) {
+        ImageDiskCache::remove_file(key);
+        return false;
+    }
+    const bool ok = read_file_header(file, key, out_info);
+    std::fclose(file);
+    if (!ok) {
+        ImageDiskCache::remove_file(key);
+    }
+    return ok;
+}
+
+bool ImageDiskCache::read_pixels(const Key key, const DiskCacheImageInfo &info,
+                                 void *out_pixel_data) {
+    std::FILE *file = std::fopen(ImageDiskCache::file_path(key).c_str(), "rb");
+    if (file == nullptr) {
+        ImageDiskCache::remove_file(key);
+        return false;
+    }
+
+    DiskCacheImageInfo file_info;
+    bool ok = read_file_header(file, key, file_info) &&
+              (file_info.byte_count() == info.byte_count());
+    if (ok) {
+        const size_t byte_count = info.byte_count();
+        ok = std::fread(out_pixel_data, 1, byte_count, file) == byte_count;
+    }
+    std::fclose(file);
+    if (!ok) {
+        ImageDiskCache::remove_file(key);
+    }
+    return ok;
+}
+
+void ImageDiskCache::scan_directory() {
+    struct FoundFile {
+        int64_t modify_time;
+        Key key;
+        size_t byte_count;
+    };
+
+    std::vector<std::string> file_names;
+    list_directory(m_directory_path, file_names);
+
+    std::vector<FoundFile> found_files;
+    for (const std::string &file_name : file_names) {
+        const std::string path = m_directory_path + "/" + file_name;
+        if (file_name.find(kTempFileExtension) != std::string::npos) {
+            // Left behind by a write that did not finish.
+            std::remove(path.c_str());
+            continue;
+        }
+
+        FoundFile found_file;
+        uint64_t byte_count = 0;
+        if (!parse_file_name(file_name, found_file.key) ||
+            !get_file_stat(path, found_file.modify_time, byte_count)) {
+            continue;
+        }
+        found_file.byte_count = static_cast<size_t>(byte_count);
+        found_files.push_back(found_file);
+    }
+
+    // The least recently used files are inserted first.
+    std::sort(found_files.begin(), found_files.end(),
+              [](const FoundFile &a, const FoundFile &b) {
+                  return a.modify_time < b.modify_time;
+              });
+
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    for (const FoundFile &found_file : found_files) {
+        m_index.insert(kIndexGroupKey, kIndexGroupName, found_file.key,
+                       std::string(), found_file.byte_count,
+                       found_file.byte_count);
+    }
+}
+
+bool ImageDiskCache::write_file(const Key key, const DiskCacheImageInfo &info,
+                                const void *pixel_data) {
+    // Each write uses a unique temporary file, so the same key can
+    // be written by two threads at once.
+    static std::atomic<uint64_t> temp_file_counter(0);
+    const std::string final_file_path = ImageDiskCache::file_path(key);
+    const std::string temp_file_path =
+        final_file_path + kTempFileExtension +
+        std::to_string(temp_file_counter.fetch_add(1));
+
+    uint8_t header[kFileHeaderByteCount];
+    std::memset(header, 0, kFileHeaderByteCount);
+    std::memcpy(header, kFileMagic, sizeof(kFileMagic));
+    write_u32(header + 8, kFileVersion);
+    write_u32(header + 12, info.width);
+    write_u32(header + 16, info.height);
+    header[20] = info.num_channels;
+    header[21] = info.bytes_per_channel;
+    write_u64(header + 24, key);
+
+    std::FILE *file = std::fopen(temp_file_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const size_t byte_count = info.byte_count();
+    bool ok = std::fwrite(header, 1, kFileHeaderByteCount, file) ==
+              kFileHeaderByteCount;
+    ok = ok && (std::fwrite(pixel_data, 1, byte_count, file) == byte_count);
+    ok = (std::fclose(file) == 0) && ok;
+    if (!ok || !replace_file(temp_file_path, final_file_path)) {
+        std::remove(temp_file_path.c_str());
+        return false;
+    }
+
+    ImageDiskCache::add_file(key, kFileHeaderByteCount + byte_count);
+    return true;
+}
+
+void ImageDiskCache::add_file(const Key key, const size_t file_byte_count) {
+    std::lock_guard<std::mutex> lock(m_index_mutex);
+    size_t old_byte_count = 0;
+    m_index.erase(key, old_byte_count);
+    m_index.insert(kIndexGroupKey, kIndexGroupName, key, std::string(),
+                   file_byte_count, file_byte_count);
+    ImageDiskCache::evict_files();
+}
+
+void ImageDiskCache::remove_file(const Key key) {
+    {
+        std::lock_guard<std::mutex> lock(m_index_mutex);
+        size_t byte_count = 0;
+        m_index.erase(key, byte_count);
+    }
+    std::remove(ImageDiskCache::file_path(key).c_str());
+}
+
+// Must be called with 'm_index_mutex' locked.
+void ImageDiskCache::evict_files() {
+    while (!m_index.empty() && (m_index.used_bytes() > m_capacity_bytes)) {
+        Key key = 0;
+        size_t byte_count = 0;
+        m_index.evict_least_recently_used(key, byte_count);
+        std::remove(ImageDiskCache::file_path(key).c_str());
+    }
+}
+
+void ImageDiskCache::run_writer() {
+    std::unique_lock<std::mutex> lock(m_write_mutex);
+    while (true) {
+        m_write_condition.wait(
+            lock, [this] { return m_stopping || !m_write_queue.empty(); });
+        if (m_write_queue.empty()) {
+            // Stopping.
+            break;
+        }
+
+        WriteItem item = std::move(m_write_queue.front());
+        m_write_queue.pop_front();
+        m_running_write_count += 1;
+
+        lock.unlock();
+        ImageDiskCache::write_file(item.key, item.info, item.pixels.data());
+        lock.lock();
+
+        m_running_write_count -= 1;
+        m_pending_write_bytes -= item.info.byte_count();
+        if ((m_pending_write_bytes == 0) && (m_running_write_count == 0)) {
+            m_idle_condition.notify_all();
+        }
+    }
+}
+
+}  // namespace mmimage
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include <mmimage/image_pixel_convert.h>
+
+#include <cstring>
+
+namespace mmimage {
+
+uint16_t convert_f32_to_f16(const float value) {
+    uint32_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t exponent = (bits >> 23) & 0xFF;
+    uint32_t mantissa = bits & 0x007FFFFF;
+
+    if (exponent == 0xFF) {
+        // Infinity stays infinity, NaN stays NaN.
+        const uint32_t nan_bit = (mantissa != 0) ? 0x0200 : 0;
+        return static_cast<uint16_t>(sign | 0x7C00 | nan_bit |
+                                     (mantissa >> 13));
+    }
+
+    const int32_t half_exponent = static_cast<int32_t>(exponent) - 127 + 15;
+    if (half_exponent >= 0x1F) {
+        // Too large for a half float.
+        return static_cast<uint16_t>(sign | 0x7C00);
+    }
+
+    if (half_exponent <= 0) {
+        // A denormalised half float, or zero.
+        if (half_exponent < -10) {
+            return static_cast<uint16_t>(sign);
+        }
+        mantissa |= 0x00800000;
+        const uint32_t shift = static_cast<uint32_t>(14 - half_exponent);
+        uint32_t half_mantissa = mantissa >> shift;
+
+        // Round to nearest, ties to even.
+        const uint32_t remainder = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if ((remainder > halfway) ||
+            ((remainder == halfway) && (half_mantissa & 1))) {
+            half_mantissa += 1;
+        }
+        return static_cast<uint16_t>(sign | half_mantissa);
+    }
+
+    uint32_t half = sign | (static_cast<uint32_t>(half_exponent) << 10) |
+                    (mantissa >> 13);
+
+    // Round to nearest, ties to even. A carry out of the mantissa
+    // correctly increments the exponent (up to infinity).
+    const uint32_t remainder = mantissa & 0x1FFF;
+    if ((remainder > 0x1000) || ((remainder == 0x1000) && (half & 1))) {
+        half += 1;
+    }
+    return static_cast<uint16_t>(half);
+}
+
+float convert_f16_to_f32(const uint16_t value) {
+    const uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x03FF;
+
+    uint32_t bits = 0;
+    if (exponent == 0x1F) {
+        // Infinity or NaN.
+        bits = sign | 0x7F800000 | (mantissa << 13);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Normalise the denormalised half float.
+        exponent = 127 - 15 + 1;
+        while ((mantissa & 0x0400) == 0) {
+            mantissa <<= 1;
+            exponent -= 1;
+        }
+        mantissa &= 0x03FF;
+        bits = sign | (exponent << 23) | (mantissa << 13);
+    }
+
+    float result = 0.0f;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void copy_pixels_f32(const float *in_pixels, const size_t pixel_count,
+                     const size_t in_num_channels,
+                     const size_t out_num_channels, float *out_pixels) {
+    if (in_num_channels == out_num_channels) {
+        std::memcpy(out_pixels, in_pixels,
+                    pixel_count * in_num_channels * sizeof(float));
+        return;
+    }
+
+    for (size_t i = 0; i < pixel_count; i++) {
+        const float *in_pixel = in_pixels + (i * in_num_channels);
+        float *out_pixel = out_pixels + (i * out_num_channels);
+        for (size_t c = 0; c < out_num_channels; c++) {
+            out_pixel[c] = in_pixel[c];
+        }
+    }
+}
+
+void convert_pixels_f32_to_u8(const float *in_pixels,
+                              const size_t pixel_count,
+                              const size_t in_num_channels,
+                              const size_t out_num_channels,
+                              uint8_t *out_pixels) {
+    for (size_t i = 0; i < pixel_count; i++) {
+        const float *in_pixel = in_pixels + (i * in_num_channels);
+        uint8_t *out_pixel = out_pixels + (i * out_num_channels);
+        for (size_t c = 0; c < out_num_channels; c++) {
+            const float value = in_pixel[c];
+            // Written so that NaN values become zero.
+            float clamped_value = 0.0f;
+            if (value >= 1.0f) {
+                clamped_value = 1.0f;
+            } else if (value > 0.0f) {
+                clamped_value = value;
+            }
+            out_pixel[c] =
+                static_cast<uint8_t>((clamped_value * 255.0f) + 0.5f);
+        }
+    }
+}
+
+}  // namespace mmimage
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include <mmimage/image_prefetch.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace mmimage {
+
+void prefetch_window_frames(const int32_t playhead_frame,
+                            const int32_t frames_forward,
+                            const int32_t frames_backward,
+                            const int32_t start_frame,
+                            const int32_t end_frame,
+                            std::vector<int32_t> &out_frames) {
+    out_frames.clear();
+    if ((playhead_frame >= start_frame) && (playhead_frame <= end_frame)) {
+        out_frames.push_back(playhead_frame);
+    }
+
+    const int32_t max_distance =
+        std::max(std::max(frames_forward, frames_backward), 0);
+    for (int32_t distance = 1; distance <= max_distance; distance++) {
+        const int32_t forward_frame = playhead_frame + distance;
+        if ((distance <= frames_forward) && (forward_frame >= start_frame) &&
+            (forward_frame <= end_frame)) {
+            out_frames.push_back(forward_frame);
+        }
+
+        const int32_t backward_frame = playhead_frame - distance;
+        if ((distance <= frames_backward) && (backward_frame >= start_frame) &&
+            (backward_frame <= end_frame)) {
+            out_frames.push_back(backward_frame);
+        }
+    }
+}
+
+ImagePrefetcher::ImagePrefetcher(ReadFunction read_function,
+                                 const size_t thread_count)
+    : m_read_function(std::move(read_function))
+    , m_read_count(0)
+    , m_failed_count(0)
+    , m_stopping(false) {
+    size_t count = thread_count;
+    if (count == 0) {
+        count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    count = std::max<size_t>(count, 1);
+
+    m_threads.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        m_threads.emplace_back(&ImagePrefetcher::run_worker, this);
+    }
+}
+
+ImagePrefetcher::~ImagePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+        m_stopping = true;
+    }
+    m_queue_condition.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ImagePrefetcher::prefetch(const std::string &group_name,
+                               const std::vector<std::string> &file_paths) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ImagePrefetcher::remove_queued_items(group_name);
+
+        for (size_t priority = 0; priority < file_paths.size(); priority++) {
+            const std::string &file_path = file_paths[priority];
+            if (m_running_file_paths.count(file_path) > 0) {
+                continue;
+            }
+            Item item;
+            item.group_name = group_name;
+            item.file_path = file_path;
+            m_queue.insert(std::make_pair(priority, std::move(item)));
+        }
+    }
+    m_queue_condition.notify_all();
+    m_idle_condition.notify_all();
+}
+
+void ImagePrefetcher::cancel(const std::string &group_name) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ImagePrefetcher::remove_queued_items(group_name);
+    }
+    m_idle_condition.notify_all();
+}
+
+void ImagePrefetcher::cancel_all() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_queue.clear();
+    }
+    m_idle_condition.notify_all();
+}
+
+void ImagePrefetcher::wait_for_prefetch() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle_condition.wait(lock, [this] {
+        return m_queue.empty() && m_running_file_paths.empty();
+    });
+}
+
+size_t ImagePrefetcher::pending_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + m_running_file_paths.size();
+}
+
+size_t ImagePrefetcher::read_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_read_count;
+}
+
+size_t ImagePrefetcher::failed_count() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_failed_count;
+}
+
+// Must be called with 'm_mutex' locked.
+void ImagePrefetcher::remove_queued_items(const std::string &group_name) {
+    for (auto it = m_queue.begin(); it != m_queue.end();) {
+        if (it->second.group_name == group_name) {
+            it = m_queue.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void ImagePrefetcher::run_worker() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true) {
+        m_queue_condition.wait(
+            lock, [this] { return m_stopping || !m_queue.empty(); });
+        if (m_stopping) {
+            break;
+        }
+
+        auto it = m_queue.begin();
+        const Item item = std::move(it->second);
+        m_queue.erase(it);
+        if (!m_running_file_paths.insert(item.file_path).second) {
+            // Another thread is reading the same file already.
+            continue;
+        }
+
+        lock.unlock();
+        const bool read_ok = m_read_function(item.group_name, item.file_path);
+        lock.lock();
+
+        m_running_file_paths.erase(item.file_path);
+        m_read_count += 1;
+        m_failed_count += static_cast<size_t>(!read_ok);
+        if (m_queue.empty() && m_running_file_paths.empty()) {
+            m_idle_condition.notify_all();
+        }
+    }
+}
+
+}  // namespace mmimage
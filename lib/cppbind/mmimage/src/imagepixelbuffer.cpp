@@ -80,4 +80,13 @@ rust::Slice<PixelF32x4> ImagePixelBuffer::as_slice_f32x4_mut() noexcept {
     return inner_->as_slice_f32x4_mut();
 }
 
+const rust::Slice<const PixelF16x4>
+ImagePixelBuffer::as_slice_f16x4() noexcept {
+    return inner_->as_slice_f16x4();
+}
+
+rust::Slice<PixelF16x4> ImagePixelBuffer::as_slice_f16x4_mut() noexcept {
+    return inner_->as_slice_f16x4_mut();
+}
+
 }  // namespace mmimage
@@ -19,6 +19,7 @@
 //
 
 use crate::cxxbridge::ffi::BufferDataType as BindBufferDataType;
+use crate::cxxbridge::ffi::PixelF16x4 as BindPixelF16x4;
 use crate::cxxbridge::ffi::PixelF32x4 as BindPixelF32x4;
 use mmimage_rust::pixelbuffer::BufferDataType as CoreBufferDataType;
 use mmimage_rust::pixelbuffer::ImagePixelBuffer as CoreImagePixelBuffer;
@@ -119,6 +120,32 @@ impl ShimImagePixelBuffer {
         }
     }
 
+    pub fn as_slice_f16x4(&self) -> &[BindPixelF16x4] {
+        let slice = self.inner.as_slice_f16x4();
+        // SAFETY: We assume that the BindPixelF16x4's memory layout is
+        // exactly the same as (f16, f16, f16, f16), because each f16
+        // is stored as the bits of a u16.
+        unsafe {
+            std::slice::from_raw_parts(
+                slice.as_ptr() as *const BindPixelF16x4,
+                slice.len(),
+            )
+        }
+    }
+
+    pub fn as_slice_f16x4_mut(&mut self) -> &mut [BindPixelF16x4] {
+        let slice = self.inner.as_slice_f16x4_mut();
+        // SAFETY: We assume that the BindPixelF16x4's memory layout is
+        // exactly the same as (f16, f16, f16, f16), because each f16
+        // is stored as the bits of a u16.
+        unsafe {
+            std::slice::from_raw_parts_mut(
+                slice.as_mut_ptr() as *mut BindPixelF16x4,
+                slice.len(),
+            )
+        }
+    }
+
     pub fn resize(
         &mut self,
         data_type: BindBufferDataType,
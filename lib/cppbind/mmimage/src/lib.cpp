@@ -56,6 +56,21 @@ bool image_read_pixels_exr_f32x4(const rust::Str& file_path,
     return result;
 }
 
+bool image_read_pixels_exr_f16x4(const rust::Str& file_path,
+                                 const bool vertical_flip,
+                                 ImageMetaData& out_meta_data,
+                                 ImagePixelBuffer& out_pixel_data) {
+    auto pixel_data = out_pixel_data.get_inner();
+    auto meta_data = out_meta_data.get_inner();
+
+    bool result = shim_image_read_pixels_exr_f16x4(file_path, vertical_flip,
+                                                   meta_data, pixel_data);
+
+    out_pixel_data.set_inner(pixel_data);
+    out_meta_data.set_inner(meta_data);
+    return result;
+}
+
 bool image_write_pixels_exr_f32x4(const rust::Str& file_path,
                                   ImageExrEncoder exr_encoder,
                                   ImageMetaData& in_meta_data,
@@ -29,6 +29,7 @@ pub mod imagemetadata;
 pub mod imagepixelbuffer;
 
 use mmimage_rust::image_read_metadata_exr as core_image_read_metadata_exr;
+use mmimage_rust::image_read_pixels_exr_f16x4 as core_image_read_pixels_exr_f16x4;
 use mmimage_rust::image_read_pixels_exr_f32x4 as core_image_read_pixels_exr_f32x4;
 use mmimage_rust::image_write_pixels_exr_f32x4 as core_image_write_pixels_exr_f32x4;
 
@@ -62,6 +63,23 @@ pub fn shim_image_read_pixels_exr_f32x4(
     true
 }
 
+pub fn shim_image_read_pixels_exr_f16x4(
+    file_path: &str,
+    vertical_flip: bool,
+    out_meta_data: &mut Box<ShimImageMetaData>,
+    out_pixel_buffer: &mut Box<ShimImagePixelBuffer>,
+) -> bool {
+    // TODO: How to return errors? An enum perhaps?
+    let image = core_image_read_pixels_exr_f16x4(file_path, vertical_flip);
+    if let Err(_err) = image {
+        return false;
+    }
+    let (meta_data, pixel_buffer) = image.unwrap();
+    out_meta_data.set_inner(meta_data);
+    out_pixel_buffer.set_inner(pixel_buffer);
+    true
+}
+
 pub fn shim_image_write_pixels_exr_f32x4(
     file_path: &str,
     exr_encoder: BindImageExrEncoder,
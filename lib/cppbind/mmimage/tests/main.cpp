@@ -28,6 +28,12 @@
 #include "test_b.h"
 #include "test_c.h"
 #include "test_d.h"
+#include "test_e.h"
+#include "test_f.h"
+#include "test_g.h"
+#include "test_h.h"
+#include "test_i.h"
+#include "test_j.h"
 
 void print_help(const char *exec_file) {
     std::cout
@@ -65,16 +71,34 @@ int main(int argc, char *argv[]) {
     }
     const char *dir_path = argv[1];
 
-    if (!test_a("mmimage_test_a:", dir_path)) {
+    if (test_a("mmimage_test_a:", dir_path) != 0) {
         return 1;
     }
-    if (!test_b("mmimage_test_b:", dir_path)) {
+    if (test_b("mmimage_test_b:", dir_path) != 0) {
         return 1;
     }
-    if (!test_c("mmimage_test_c:", dir_path)) {
+    if (test_c("mmimage_test_c:", dir_path) != 0) {
         return 1;
     }
-    if (!test_d("mmimage_test_d:", dir_path)) {
+    if (test_d("mmimage_test_d:", dir_path) != 0) {
+        return 1;
+    }
+    if (test_e("mmimage_test_e:") != 0) {
+        return 1;
+    }
+    if (test_f("mmimage_test_f:") != 0) {
+        return 1;
+    }
+    if (test_g("mmimage_test_g:") != 0) {
+        return 1;
+    }
+    if (test_h("mmimage_test_h:", dir_path) != 0) {
+        return 1;
+    }
+    if (test_i("mmimage_test_i:", dir_path) != 0) {
+        return 1;
+    }
+    if (test_j("mmimage_test_j:", dir_path) != 0) {
         return 1;
     }
     return 0;
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_e.h"
+
+#include <mmimage/image_cache_core.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace mmimg = mmimage;
+
+using TestCache = mmimg::ImageCacheCore<int>;
+
+#define TEST_E_CHECK(test_name, condition)                                \
+    if (!(condition)) {                                                   \
+        std::cerr << test_name << " FAILED: " #condition " (line "        \
+                  << __LINE__ << ")" << std::endl;                        \
+        return false;                                                     \
+    }
+
+static bool test_e_insert_find(const char *test_name) {
+    TestCache cache;
+    TEST_E_CHECK(test_name, cache.insert(10, "group", 1, "a", 100, 4));
+    TEST_E_CHECK(test_name, cache.insert(10, "group", 2, "b", 200, 8));
+    TEST_E_CHECK(test_name, !cache.insert(10, "group", 2, "b", 300, 8));
+    TEST_E_CHECK(test_name, cache.item_count() == 2);
+    TEST_E_CHECK(test_name, cache.group_count() == 1);
+    TEST_E_CHECK(test_name, cache.used_bytes() == 12);
+
+    const int *value = cache.find(2);
+    TEST_E_CHECK(test_name, value != nullptr);
+    TEST_E_CHECK(test_name, *value == 200);
+    TEST_E_CHECK(test_name, cache.find(3) == nullptr);
+    TEST_E_CHECK(test_name, cache.contains(1));
+    TEST_E_CHECK(test_name, !cache.contains(3));
+    return true;
+}
+
+static bool test_e_evict_order(const char *test_name) {
+    TestCache cache;
+    for (uint64_t i = 1; i <= 4; i++) {
+        TEST_E_CHECK(test_name, cache.insert(10, "group", i, "item",
+                                             static_cast<int>(i), 1));
+    }
+
+    // Item 1 becomes the most recently used, so 2 is evicted first.
+    TEST_E_CHECK(test_name, cache.find(1) != nullptr);
+    // Peeking does not change the order.
+    TEST_E_CHECK(test_name, cache.peek(2) != nullptr);
+
+    const uint64_t expected_keys[4] = {2, 3, 4, 1};
+    for (int i = 0; i < 4; i++) {
+        TestCache::Key key = 0;
+        int value = 0;
+        TEST_E_CHECK(test_name, cache.evict_least_recently_used(key, value));
+        TEST_E_CHECK(test_name, key == expected_keys[i]);
+        TEST_E_CHECK(test_name, value == static_cast<int>(expected_keys[i]));
+    }
+
+    TestCache::Key key = 0;
+    int value = 0;
+    TEST_E_CHECK(test_name, !cache.evict_least_recently_used(key, value));
+    TEST_E_CHECK(test_name, cache.empty());
+    TEST_E_CHECK(test_name, cache.group_count() == 0);
+    TEST_E_CHECK(test_name, cache.used_bytes() == 0);
+    return true;
+}
+
+static bool test_e_erase_groups(const char *test_name) {
+    TestCache cache;
+    TEST_E_CHECK(test_name, cache.insert(10, "group_a", 1, "a1", 1, 1));
+    TEST_E_CHECK(test_name, cache.insert(10, "group_a", 2, "a2", 2, 1));
+    TEST_E_CHECK(test_name, cache.insert(10, "group_a", 3, "a3", 3, 1));
+    TEST_E_CHECK(test_name, cache.insert(20, "group_b", 4, "b1", 4, 1));
+    TEST_E_CHECK(test_name, cache.group_count() == 2);
+    TEST_E_CHECK(test_name, cache.group_item_count(10) == 3);
+    TEST_E_CHECK(test_name, cache.group_item_count(20) == 1);
+    TEST_E_CHECK(test_name, cache.group_item_count(30) == 0);
+
+    // Erase from the middle of the group.
+    int value = 0;
+    TEST_E_CHECK(test_name, cache.erase(2, value));
+    TEST_E_CHECK(test_name, value == 2);
+    TEST_E_CHECK(test_name, !cache.erase(2, value));
+    TEST_E_CHECK(test_name, cache.group_item_count(10) == 2);
+
+    std::vector<std::string> names;
+    TEST_E_CHECK(test_name, cache.group_item_names(10, names));
+    std::sort(names.begin(), names.end());
+    TEST_E_CHECK(test_name, names.size() == 2);
+    TEST_E_CHECK(test_name, names[0] == "a1");
+    TEST_E_CHECK(test_name, names[1] == "a3");
+    TEST_E_CHECK(test_name, !cache.group_item_names(30, names));
+
+    cache.group_names(names);
+    std::sort(names.begin(), names.end());
+    TEST_E_CHECK(test_name, names.size() == 2);
+    TEST_E_CHECK(test_name, names[0] == "group_a");
+
+    // Erasing the last item of a group removes the group.
+    TEST_E_CHECK(test_name, cache.erase(4, value));
+    TEST_E_CHECK(test_name, cache.group_count() == 1);
+
+    std::vector<TestCache::Key> keys;
+    TEST_E_CHECK(test_name, cache.group_item_keys(10, keys));
+    for (const TestCache::Key key : keys) {
+        TEST_E_CHECK(test_name, cache.erase(key, value));
+    }
+    TEST_E_CHECK(test_name, cache.empty());
+    TEST_E_CHECK(test_name, cache.group_count() == 0);
+
+    // The LRU list is still valid after erasing.
+    TEST_E_CHECK(test_name, cache.insert(10, "group_a", 5, "a5", 5, 1));
+    TestCache::Key key = 0;
+    TEST_E_CHECK(test_name, cache.evict_least_recently_used(key, value));
+    TEST_E_CHECK(test_name, key == 5);
+    return true;
+}
+
+// Two file paths with the same hash value are different items.
+static bool test_e_name_collision(const char *test_name) {
+    TestCache cache;
+    TEST_E_CHECK(test_name, cache.insert(10, "group", 1, "a.exr", 100, 4));
+    TEST_E_CHECK(test_name, cache.contains(1, "a.exr"));
+    TEST_E_CHECK(test_name, !cache.contains(1, "b.exr"));
+
+    const int *value = cache.find(1, "a.exr");
+    TEST_E_CHECK(test_name, value != nullptr);
+    TEST_E_CHECK(test_name, *value == 100);
+    TEST_E_CHECK(test_name, cache.find(1, "b.exr") == nullptr);
+
+    int erased_value = 0;
+    TEST_E_CHECK(test_name, !cache.erase(1, "b.exr", erased_value));
+    TEST_E_CHECK(test_name, cache.item_count() == 1);
+    TEST_E_CHECK(test_name, cache.erase(1, "a.exr", erased_value));
+    TEST_E_CHECK(test_name, erased_value == 100);
+    TEST_E_CHECK(test_name, cache.empty());
+    return true;
+}
+
+int test_e(const char *test_name) {
+    if (!test_e_insert_find(test_name)) {
+        return 1;
+    }
+    if (!test_e_evict_order(test_name)) {
+        return 1;
+    }
+    if (!test_e_erase_groups(test_name)) {
+        return 1;
+    }
+    if (!test_e_name_collision(test_name)) {
+        return 1;
+    }
+    std::cout << test_name << " passed." << std::endl;
+    return 0;
+}
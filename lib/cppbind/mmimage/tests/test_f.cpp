@@ -0,0 +1,182 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_f.h"
+
+#include <mmimage/image_cache_core.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace mmimg = mmimage;
+
+namespace {
+
+using Key = uint64_t;
+
+// The previous ImageCache bookkeeping, with a 'std::list' of keys, and
+// groups as sets of file path strings. Erasing an item is linear in
+// the number of items.
+struct ListCache {
+    std::list<Key> key_list;
+    std::unordered_map<Key, std::pair<std::list<Key>::iterator, int>> item_map;
+    std::unordered_map<std::string, std::unordered_set<std::string>> group_map;
+
+    void insert(const std::string &group_name, const std::string &file_path,
+                const int value) {
+        const Key key = std::hash<std::string>()(file_path);
+        auto it = key_list.insert(key_list.end(), key);
+        item_map.insert(std::make_pair(key, std::make_pair(it, value)));
+        group_map[group_name].insert(file_path);
+    }
+
+    bool find(const Key key) {
+        auto search = item_map.find(key);
+        if (search == item_map.end()) {
+            return false;
+        }
+        key_list.splice(key_list.end(), key_list, search->second.first);
+        return true;
+    }
+
+    void remove_from_groups(const Key key) {
+        for (auto it = group_map.begin(); it != group_map.end();) {
+            auto &values_set = it->second;
+            for (auto it2 = values_set.begin(); it2 != values_set.end();) {
+                if (std::hash<std::string>()(*it2) == key) {
+                    it2 = values_set.erase(it2);
+                } else {
+                    ++it2;
+                }
+            }
+            if (values_set.empty()) {
+                it = group_map.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    void evict() {
+        const Key key = key_list.front();
+        item_map.erase(key);
+        key_list.pop_front();
+        remove_from_groups(key);
+    }
+
+    void erase(const Key key) {
+        if (item_map.erase(key) == 0) {
+            return;
+        }
+        key_list.remove(key);
+        remove_from_groups(key);
+    }
+};
+
+struct CoreCache {
+    mmimg::ImageCacheCore<int> core;
+
+    void insert(const std::string &group_name, const std::string &file_path,
+                const int value) {
+        const Key key = std::hash<std::string>()(file_path);
+        const Key group_key = std::hash<std::string>()(group_name);
+        core.insert(group_key, group_name, key, file_path, value, 1);
+    }
+
+    bool find(const Key key) { return core.find(key) != nullptr; }
+
+    void evict() {
+        Key key = 0;
+        int value = 0;
+        core.evict_least_recently_used(key, value);
+    }
+
+    void erase(const Key key) {
+        int value = 0;
+        core.erase(key, value);
+    }
+};
+
+// Scrub forward over an image sequence with a cache that holds
+// 'capacity' frames, evicting one frame for each new frame, and
+// erasing (re-loading) every 10th frame.
+template <typename Cache>
+float scrub_image_sequence(const std::vector<std::string> &file_paths,
+                           const size_t capacity, const size_t scrub_count) {
+    const std::string group_name = "/plates/shot.####.exr";
+    Cache cache;
+    size_t item_count = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < scrub_count; i++) {
+        const std::string &file_path = file_paths[i % file_paths.size()];
+        const Key key = std::hash<std::string>()(file_path);
+        if (cache.find(key)) {
+            if ((i % 10) == 0) {
+                cache.erase(key);
+                cache.insert(group_name, file_path, static_cast<int>(i));
+            }
+            continue;
+        }
+        if (item_count >= capacity) {
+            cache.evict();
+            item_count--;
+        }
+        cache.insert(group_name, file_path, static_cast<int>(i));
+        item_count++;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::chrono::duration<float> duration = end - start;
+    return duration.count();
+}
+
+}  // namespace
+
+int test_f(const char *test_name) {
+    const size_t frame_count = 6000;
+    std::vector<std::string> file_paths;
+    file_paths.reserve(frame_count);
+    for (size_t i = 0; i < frame_count; i++) {
+        file_paths.push_back("/plates/shot." + std::to_string(1001 + i) +
+                             ".exr");
+    }
+
+    const size_t capacities[3] = {300, 1000, 3000};
+    for (const size_t capacity : capacities) {
+        const size_t scrub_count = frame_count * 2;
+        const float list_seconds = scrub_image_sequence<ListCache>(
+            file_paths, capacity, scrub_count);
+        const float core_seconds = scrub_image_sequence<CoreCache>(
+            file_paths, capacity, scrub_count);
+        std::cout << test_name << " capacity=" << capacity
+                  << " frames=" << scrub_count << " list=" << list_seconds
+                  << "s core=" << core_seconds << "s" << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_g.h"
+
+#include <mmimage/image_cache_sharded.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mmimg = mmimage;
+
+namespace {
+
+// Stands in for the image pixels; the key is stored so a value can
+// be checked against the key it was found with.
+struct Payload {
+    Payload() : key(0), byte_count(0) {}
+    Payload(const uint64_t key, const size_t byte_count)
+        : key(key), byte_count(byte_count) {}
+
+    uint64_t key;
+    size_t byte_count;
+};
+
+using TestCache = mmimg::ImageCacheSharded<Payload>;
+
+const size_t kThreadCount = 8;
+const size_t kOperationsPerThread = 50000;
+const size_t kKeyCount = 4096;
+const size_t kGroupCount = 16;
+const size_t kMaxItemBytes = 1024;
+const size_t kCapacityBytes = 256 * kMaxItemBytes;
+
+struct SharedState {
+    SharedState() : live_bytes(0), max_used_bytes(0), failed(false) {}
+
+    // The bytes inserted minus the bytes evicted and erased, counted
+    // by the threads (not the cache).
+    std::atomic<int64_t> live_bytes;
+    std::atomic<size_t> max_used_bytes;
+    std::atomic<bool> failed;
+};
+
+void release_values(const std::vector<Payload> &values, SharedState &state) {
+    for (const Payload &value : values) {
+        state.live_bytes.fetch_sub(static_cast<int64_t>(value.byte_count));
+    }
+}
+
+void hammer_cache(TestCache &cache, SharedState &state,
+                  const uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> key_distribution(1, kKeyCount);
+    std::uniform_int_distribution<size_t> bytes_distribution(1,
+                                                             kMaxItemBytes);
+    std::uniform_int_distribution<int> operation_distribution(0, 99);
+
+    std::vector<Payload> removed_values;
+    for (size_t i = 0; i < kOperationsPerThread; i++) {
+        const uint64_t key = key_distribution(generator);
+        const uint64_t group_key = key % kGroupCount;
+        const int operation = operation_distribution(generator);
+
+        removed_values.clear();
+        if (operation < 60) {
+            Payload value;
+            if (cache.find(key, value) && (value.key != key)) {
+                state.failed.store(true);
+            }
+        } else if (operation < 95) {
+            const size_t byte_count = bytes_distribution(generator);
+            state.live_bytes.fetch_add(static_cast<int64_t>(byte_count));
+            cache.insert(group_key, std::to_string(group_key), key,
+                         std::to_string(key), Payload(key, byte_count),
+                         byte_count, removed_values);
+        } else if (operation < 99) {
+            Payload value;
+            if (cache.erase(key, value)) {
+                removed_values.push_back(value);
+            }
+        } else {
+            cache.erase_group(group_key, removed_values);
+        }
+        release_values(removed_values, state);
+
+        // The budget may only be exceeded by the items that other
+        // threads are inserting at the same time.
+        const size_t used_bytes = cache.used_bytes();
+        size_t max_used_bytes = state.max_used_bytes.load();
+        while ((used_bytes > max_used_bytes) &&
+               !state.max_used_bytes.compare_exchange_weak(max_used_bytes,
+                                                           used_bytes)) {
+        }
+    }
+}
+
+// Values that own memory, the same as the pixels of the CPU image
+// cache.
+using SharedPayload = std::shared_ptr<std::vector<uint64_t>>;
+using SharedTestCache = mmimg::ImageCacheSharded<SharedPayload>;
+
+const size_t kSharedValueCount = 256;
+
+// Finds values and uses them after other threads may have evicted
+// them, which is only valid because the found value shares ownership
+// of the memory with the cache.
+void hold_found_values(SharedTestCache &cache, std::atomic<bool> &failed,
+                       const uint32_t seed) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<size_t> key_distribution(1, kKeyCount);
+    std::uniform_int_distribution<int> operation_distribution(0, 99);
+
+    std::vector<SharedPayload> removed_values;
+    for (size_t i = 0; i < (kOperationsPerThread / 10); i++) {
+        const uint64_t key = key_distribution(generator);
+        const uint64_t group_key = key % kGroupCount;
+
+        removed_values.clear();
+        if (operation_distribution(generator) < 50) {
+            SharedPayload value;
+            if (!cache.find(key, value)) {
+                continue;
+            }
+            std::this_thread::yield();
+            for (const uint64_t item : *value) {
+                if (item != key) {
+                    failed.store(true);
+                }
+            }
+        } else {
+            auto value =
+                std::make_shared<std::vector<uint64_t>>(kSharedValueCount, key);
+            const size_t byte_count = kSharedValueCount * sizeof(uint64_t);
+            cache.insert(group_key, std::to_string(group_key), key,
+                         std::to_string(key), value, byte_count,
+                         removed_values);
+        }
+    }
+}
+
+}  // namespace
+
+#define TEST_G_CHECK(test_name, condition)                                \
+    if (!(condition)) {                                                   \
+        std::cerr << test_name << " FAILED: " #condition " (line "        \
+                  << __LINE__ << ")" << std::endl;                        \
+        return 1;                                                         \
+    }
+
+int test_g(const char *test_name) {
+    TestCache cache;
+    std::vector<Payload> removed_values;
+    cache.set_capacity_bytes(kCapacityBytes, removed_values);
+    cache.set_item_count_minimum(1);
+
+    SharedState state;
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    threads.reserve(kThreadCount);
+    for (size_t i = 0; i < kThreadCount; i++) {
+        threads.emplace_back(hammer_cache, std::ref(cache), std::ref(state),
+                             static_cast<uint32_t>(i + 1));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    const auto end = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(end - start).count();
+
+    TEST_G_CHECK(test_name, !state.failed.load());
+    TEST_G_CHECK(test_name, cache.used_bytes() <= kCapacityBytes);
+    TEST_G_CHECK(test_name, state.max_used_bytes.load() <=
+                                (kCapacityBytes + (kThreadCount *
+                                                   kMaxItemBytes)));
+    TEST_G_CHECK(test_name, state.live_bytes.load() ==
+                                static_cast<int64_t>(cache.used_bytes()));
+
+    // Evicting everything must give back every byte that was inserted.
+    cache.set_item_count_minimum(0);
+    removed_values.clear();
+    cache.set_capacity_bytes(0, removed_values);
+    release_values(removed_values, state);
+    TEST_G_CHECK(test_name, cache.empty());
+    TEST_G_CHECK(test_name, cache.used_bytes() == 0);
+    TEST_G_CHECK(test_name, cache.group_count() == 0);
+    TEST_G_CHECK(test_name, state.live_bytes.load() == 0);
+
+    // Hold found values while other threads evict them.
+    SharedTestCache shared_cache;
+    std::vector<SharedPayload> shared_removed_values;
+    shared_cache.set_capacity_bytes(
+        16 * kSharedValueCount * sizeof(uint64_t), shared_removed_values);
+    std::atomic<bool> shared_failed(false);
+    threads.clear();
+    for (size_t i = 0; i < kThreadCount; i++) {
+        threads.emplace_back(hold_found_values, std::ref(shared_cache),
+                             std::ref(shared_failed),
+                             static_cast<uint32_t>(i + 1));
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    TEST_G_CHECK(test_name, !shared_failed.load());
+
+    const size_t operation_count = kThreadCount * kOperationsPerThread;
+    std::cout << test_name << " threads=" << kThreadCount
+              << " operations=" << operation_count << " seconds=" << seconds
+              << " max_used_bytes=" << state.max_used_bytes.load()
+              << " capacity_bytes=" << kCapacityBytes << std::endl;
+    std::cout << test_name << " passed." << std::endl;
+    return 0;
+}
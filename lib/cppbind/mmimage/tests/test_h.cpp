@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_h.h"
+
+#include <mmimage/image_cache_sharded.h>
+#include <mmimage/image_prefetch.h>
+#include <mmimage/mmimage.h>
+
+#include <condition_variable>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace mmimg = mmimage;
+
+namespace {
+
+// Blocks the first read until it is released, so that items can be
+// queued while a read is running.
+struct ReadGate {
+    ReadGate() : started(false), released(false) {}
+
+    bool read(const std::string &file_path) {
+        std::unique_lock<std::mutex> lock(mutex);
+        read_file_paths.push_back(file_path);
+        started = true;
+        condition.notify_all();
+        condition.wait(lock, [this] { return released; });
+        return true;
+    }
+
+    void wait_until_started() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return started; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        released = true;
+        condition.notify_all();
+    }
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool started;
+    bool released;
+    std::vector<std::string> read_file_paths;
+};
+
+using PixelVector = std::vector<mmimg::PixelF32x4>;
+using PixelCache = mmimg::ImageCacheSharded<std::shared_ptr<PixelVector>>;
+
+std::string frame_file_path(const char *dir_path, const int32_t frame) {
+    char frame_string[16];
+    std::snprintf(frame_string, sizeof(frame_string), "%04d", frame);
+    return join_path(dir_path, "/test_prefetch.", frame_string, ".out.exr");
+}
+
+// Each image is filled with the frame number, so the cached pixels
+// can be checked against the frame.
+bool write_frame_image(const std::string &file_path, const int32_t frame) {
+    auto meta_data = mmimg::ImageMetaData();
+    auto exr_encoder = mmimg::ImageExrEncoder{
+        mmimg::ExrCompression::kZIP1,
+        mmimg::ExrPixelLayout{mmimg::ExrPixelLayoutMode::kScanLines, 0, 0},
+        mmimg::ExrLineOrder::kIncreasing,
+    };
+
+    const size_t image_width = 64;
+    const size_t image_height = 32;
+    const size_t num_channels = 4;
+    auto pixel_buffer = mmimg::ImagePixelBuffer();
+    pixel_buffer.resize(mmimg::BufferDataType::kF32, image_width, image_height,
+                        num_channels);
+
+    const float value = static_cast<float>(frame);
+    rust::Slice<mmimg::PixelF32x4> raw_data_mut =
+        pixel_buffer.as_slice_f32x4_mut();
+    for (size_t i = 0; i < raw_data_mut.size(); i++) {
+        raw_data_mut[i] = mmimg::PixelF32x4{value, value, value, 1.0f};
+    }
+
+    const rust::Str output_file_path(file_path.c_str());
+    return mmimg::image_write_pixels_exr_f32x4(output_file_path, exr_encoder,
+                                               meta_data, pixel_buffer);
+}
+
+bool read_frame_image(PixelCache &cache, const std::string &group_name,
+                      const std::string &file_path) {
+    const uint64_t key = std::hash<std::string>()(file_path);
+    if (cache.contains(key)) {
+        return true;
+    }
+
+    auto meta_data = mmimg::ImageMetaData();
+    auto pixel_buffer = mmimg::ImagePixelBuffer();
+    const bool vertical_flip = false;
+    const rust::Str input_file_path(file_path.c_str());
+    const bool read_ok = mmimg::image_read_pixels_exr_f32x4(
+        input_file_path, vertical_flip, meta_data, pixel_buffer);
+    if (!read_ok) {
+        return false;
+    }
+
+    const rust::Slice<const mmimg::PixelF32x4> slice =
+        pixel_buffer.as_slice_f32x4();
+    auto pixels = std::make_shared<PixelVector>(slice.begin(), slice.end());
+    const size_t byte_count = pixels->size() * sizeof(mmimg::PixelF32x4);
+    const uint64_t group_key = std::hash<std::string>()(group_name);
+
+    // The evicted pixels are freed when the last reference is released.
+    std::vector<std::shared_ptr<PixelVector>> evicted_values;
+    cache.insert(group_key, group_name, key, file_path, pixels, byte_count,
+                 evicted_values);
+    return true;
+}
+
+bool is_frame_cached(PixelCache &cache, const char *dir_path,
+                     const int32_t frame) {
+    const std::string file_path = frame_file_path(dir_path, frame);
+    const uint64_t key = std::hash<std::string>()(file_path);
+    std::shared_ptr<PixelVector> pixels;
+    if (!cache.find(key, pixels) || !pixels || pixels->empty()) {
+        return false;
+    }
+    return pixels->front().r == static_cast<float>(frame);
+}
+
+}  // namespace
+
+#define TEST_H_CHECK(test_name, condition)                                \
+    if (!(condition)) {                                                   \
+        std::cerr << test_name << " FAILED: " #condition " (line "        \
+                  << __LINE__ << ")" << std::endl;                        \
+        return false;                                                     \
+    }
+
+static bool test_h_window_frames(const char *test_name) {
+    std::vector<int32_t> frames;
+    mmimg::prefetch_window_frames(10, 3, 2, 1, 100, frames);
+    const std::vector<int32_t> expected_frames = {10, 11, 9, 12, 8, 13};
+    TEST_H_CHECK(test_name, frames == expected_frames);
+
+    // The window is clipped to the frame range.
+    mmimg::prefetch_window_frames(2, 10, 3, 1, 5, frames);
+    const std::vector<int32_t> expected_clipped_frames = {2, 3, 1, 4, 5};
+    TEST_H_CHECK(test_name, frames == expected_clipped_frames);
+    return true;
+}
+
+static bool test_h_priority_and_cancel(const char *test_name) {
+    ReadGate gate;
+    const size_t thread_count = 1;
+    mmimg::ImagePrefetcher prefetcher(
+        [&gate](const std::string & /*group_name*/,
+                const std::string &file_path) { return gate.read(file_path); },
+        thread_count);
+
+    // Block the only thread on the first item.
+    prefetcher.prefetch("seq1", {"a0", "a1", "a2"});
+    gate.wait_until_started();
+
+    // Items of different groups with the same priority are read in
+    // the order they were queued.
+    prefetcher.prefetch("seq2", {"b0", "b1"});
+
+    // The playhead of 'seq3' jumps, so the first items are cancelled
+    // before they are read.
+    prefetcher.prefetch("seq3", {"c0", "c1", "c2", "c3"});
+    prefetcher.prefetch("seq3", {"d0"});
+    TEST_H_CHECK(test_name, prefetcher.pending_count() == 6);
+
+    gate.release();
+    prefetcher.wait_for_prefetch();
+
+    const std::vector<std::string> expected_file_paths = {"a0", "b0", "d0",
+                                                          "a1", "b1", "a2"};
+    TEST_H_CHECK(test_name, gate.read_file_paths == expected_file_paths);
+    TEST_H_CHECK(test_name, prefetcher.pending_count() == 0);
+    TEST_H_CHECK(test_name, prefetcher.read_count() == 6);
+    TEST_H_CHECK(test_name, prefetcher.failed_count() == 0);
+
+    // Waiting with nothing queued must not block.
+    prefetcher.wait_for_prefetch();
+    return true;
+}
+
+static bool test_h_read_images(const char *test_name, const char *dir_path) {
+    const int32_t start_frame = 1;
+    const int32_t end_frame = 24;
+    for (int32_t frame = start_frame; frame <= end_frame; frame++) {
+        const std::string file_path = frame_file_path(dir_path, frame);
+        TEST_H_CHECK(test_name, write_frame_image(file_path, frame));
+    }
+
+    PixelCache cache;
+    std::vector<std::shared_ptr<PixelVector>> evicted_values;
+    cache.set_capacity_bytes(256 * 1024 * 1024, evicted_values);
+
+    const std::string group_name = "test_prefetch.####.out.exr";
+    const size_t thread_count = 4;
+    mmimg::ImagePrefetcher prefetcher(
+        [&cache](const std::string &item_group_name,
+                 const std::string &file_path) {
+            return read_frame_image(cache, item_group_name, file_path);
+        },
+        thread_count);
+
+    const int32_t frames_forward = 4;
+    const int32_t frames_backward = 2;
+    std::vector<int32_t> frames;
+    std::vector<std::string> file_paths;
+    for (const int32_t playhead_frame : {6, 20}) {
+        mmimg::prefetch_window_frames(playhead_frame, frames_forward,
+                                      frames_backward, start_frame, end_frame,
+                                      frames);
+        file_paths.clear();
+        for (const int32_t frame : frames) {
+            file_paths.push_back(frame_file_path(dir_path, frame));
+        }
+        prefetcher.prefetch(group_name, file_paths);
+        prefetcher.wait_for_prefetch();
+
+        for (const int32_t frame : frames) {
+            TEST_H_CHECK(test_name, is_frame_cached(cache, dir_path, frame));
+        }
+    }
+    TEST_H_CHECK(test_name, prefetcher.failed_count() == 0);
+    TEST_H_CHECK(test_name, cache.item_count() == 14);
+    TEST_H_CHECK(test_name, !is_frame_cached(cache, dir_path, 12));
+    TEST_H_CHECK(test_name, cache.group_item_count(std::hash<std::string>()(
+                                group_name)) == 14);
+
+    std::cout << test_name << " thread_count=" << prefetcher.thread_count()
+              << " read_count=" << prefetcher.read_count()
+              << " cached_bytes=" << cache.used_bytes() << std::endl;
+    return true;
+}
+
+int test_h(const char *test_name, const char *dir_path) {
+    if (!test_h_window_frames(test_name)) {
+        return 1;
+    }
+    if (!test_h_priority_and_cancel(test_name)) {
+        return 1;
+    }
+    if (!test_h_read_images(test_name, dir_path)) {
+        return 1;
+    }
+    std::cout << test_name << " passed." << std::endl;
+    return 0;
+}
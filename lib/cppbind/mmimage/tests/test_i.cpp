@@ -0,0 +1,391 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_i.h"
+
+#include <mmimage/image_disk_cache.h>
+#include <mmimage/mmimage.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace mmimg = mmimage;
+
+namespace {
+
+using Key = mmimg::ImageDiskCache::Key;
+
+mmimg::DiskCacheImageInfo make_info(const uint32_t width,
+                                    const uint32_t height) {
+    mmimg::DiskCacheImageInfo info;
+    info.width = width;
+    info.height = height;
+    info.num_channels = 4;
+    info.bytes_per_channel = sizeof(float);
+    return info;
+}
+
+std::vector<float> make_pixels(const mmimg::DiskCacheImageInfo &info,
+                               const float value) {
+    return std::vector<float>(info.byte_count() / sizeof(float), value);
+}
+
+// Opening a cache with zero capacity deletes all the files.
+void clear_disk_cache(const std::string &directory_path) {
+    mmimg::ImageDiskCache cache(directory_path, 0, 1);
+}
+
+bool write_text_file(const std::string &file_path, const char *text) {
+    std::FILE *file = std::fopen(file_path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const size_t byte_count = std::strlen(text);
+    const bool ok = std::fwrite(text, 1, byte_count, file) == byte_count;
+    return (std::fclose(file) == 0) && ok;
+}
+
+bool file_exists(const std::string &file_path) {
+    std::FILE *file = std::fopen(file_path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fclose(file);
+    return true;
+}
+
+std::string frame_file_path(const char *dir_path, const int32_t frame) {
+    char frame_string[16];
+    std::snprintf(frame_string, sizeof(frame_string), "%04d", frame);
+    return join_path(dir_path, "/test_disk_cache.", frame_string, ".out.exr");
+}
+
+// A noisy image compresses (and decompresses) like a real plate.
+bool write_frame_image(const std::string &file_path, const int32_t frame,
+                       const size_t image_width, const size_t image_height) {
+    auto meta_data = mmimg::ImageMetaData();
+    auto exr_encoder = mmimg::ImageExrEncoder{
+        mmimg::ExrCompression::kPIZ,
+        mmimg::ExrPixelLayout{mmimg::ExrPixelLayoutMode::kScanLines, 0, 0},
+        mmimg::ExrLineOrder::kIncreasing,
+    };
+
+    const size_t num_channels = 4;
+    auto pixel_buffer = mmimg::ImagePixelBuffer();
+    pixel_buffer.resize(mmimg::BufferDataType::kF32, image_width, image_height,
+                        num_channels);
+
+    uint32_t random_state = static_cast<uint32_t>(frame) + 1;
+    rust::Slice<mmimg::PixelF32x4> raw_data_mut =
+        pixel_buffer.as_slice_f32x4_mut();
+    for (size_t i = 0; i < raw_data_mut.size(); i++) {
+        random_state = (random_state * 1664525u) + 1013904223u;
+        const float value = static_cast<float>(random_state >> 8) /
+                            static_cast<float>(1 << 24);
+        raw_data_mut[i] = mmimg::PixelF32x4{value, value * 0.5f,
+                                            static_cast<float>(frame), 1.0f};
+    }
+
+    const rust::Str output_file_path(file_path.c_str());
+    return mmimg::image_write_pixels_exr_f32x4(output_file_path, exr_encoder,
+                                               meta_data, pixel_buffer);
+}
+
+bool read_frame_image(const std::string &file_path,
+                      mmimg::ImagePixelBuffer &out_pixel_buffer) {
+    auto meta_data = mmimg::ImageMetaData();
+    const bool vertical_flip = false;
+    const rust::Str input_file_path(file_path.c_str());
+    return mmimg::image_read_pixels_exr_f32x4(input_file_path, vertical_flip,
+                                              meta_data, out_pixel_buffer);
+}
+
+}  // namespace
+
+#define TEST_I_CHECK(test_name, condition)                                \
+    if (!(condition)) {                                                   \
+        std::cerr << test_name << " FAILED: " #condition " (line "        \
+                  << __LINE__ << ")" << std::endl;                        \
+        return false;                                                     \
+    }
+
+static bool test_i_read_write(const char *test_name,
+                              const std::string &cache_dir_path) {
+    clear_disk_cache(cache_dir_path);
+    mmimg::ImageDiskCache cache(cache_dir_path, 1024 * 1024, 1);
+    TEST_I_CHECK(test_name, cache.item_count() == 0);
+
+    const Key key = 42;
+    TEST_I_CHECK(test_name, !cache.find(key));
+
+    const mmimg::DiskCacheImageInfo info = make_info(16, 8);
+    const std::vector<float> pixels = make_pixels(info, 0.25f);
+    const bool background = false;
+    TEST_I_CHECK(test_name, cache.write(key, info, pixels.data(), background));
+    TEST_I_CHECK(test_name, cache.find(key));
+    TEST_I_CHECK(test_name, file_exists(cache.file_path(key)));
+    TEST_I_CHECK(test_name, cache.item_count() == 1);
+    TEST_I_CHECK(test_name, cache.used_bytes() > info.byte_count());
+
+    mmimg::DiskCacheImageInfo read_info;
+    TEST_I_CHECK(test_name, cache.read_info(key, read_info));
+    TEST_I_CHECK(test_name, read_info.width == 16);
+    TEST_I_CHECK(test_name, read_info.height == 8);
+    TEST_I_CHECK(test_name, read_info.num_channels == 4);
+    TEST_I_CHECK(test_name, read_info.bytes_per_channel == sizeof(float));
+
+    std::vector<float> read_pixels(pixels.size(), 0.0f);
+    TEST_I_CHECK(test_name,
+                 cache.read_pixels(key, read_info, read_pixels.data()));
+    TEST_I_CHECK(test_name, read_pixels == pixels);
+
+    // A cache file that cannot be read is removed from the cache.
+    TEST_I_CHECK(test_name,
+                 write_text_file(cache.file_path(key), "not an image"));
+    TEST_I_CHECK(test_name, !cache.read_info(key, read_info));
+    TEST_I_CHECK(test_name, !cache.find(key));
+    TEST_I_CHECK(test_name, !file_exists(cache.file_path(key)));
+    TEST_I_CHECK(test_name, cache.item_count() == 0);
+    return true;
+}
+
+static bool test_i_evict(const char *test_name,
+                         const std::string &cache_dir_path) {
+    clear_disk_cache(cache_dir_path);
+
+    const mmimg::DiskCacheImageInfo info = make_info(16, 16);
+    const std::vector<float> pixels = make_pixels(info, 1.0f);
+    const bool background = false;
+
+    // Measure the size of one file, then make room for three files.
+    size_t file_byte_count = 0;
+    {
+        mmimg::ImageDiskCache cache(cache_dir_path, 1024 * 1024, 1);
+        TEST_I_CHECK(test_name,
+                     cache.write(1, info, pixels.data(), background));
+        file_byte_count = cache.used_bytes();
+    }
+    clear_disk_cache(cache_dir_path);
+
+    mmimg::ImageDiskCache cache(cache_dir_path, file_byte_count * 3, 1);
+    TEST_I_CHECK(test_name, cache.write(1, info, pixels.data(), background));
+    TEST_I_CHECK(test_name, cache.write(2, info, pixels.data(), background));
+    TEST_I_CHECK(test_name, cache.write(3, info, pixels.data(), background));
+    TEST_I_CHECK(test_name, cache.item_count() == 3);
+
+    // Key 2 is now the least recently used.
+    TEST_I_CHECK(test_name, cache.find(1));
+    TEST_I_CHECK(test_name, cache.write(4, info, pixels.data(), background));
+    TEST_I_CHECK(test_name, cache.item_count() == 3);
+    TEST_I_CHECK(test_name, cache.find(1));
+    TEST_I_CHECK(test_name, !cache.find(2));
+    TEST_I_CHECK(test_name, !file_exists(cache.file_path(2)));
+    TEST_I_CHECK(test_name, cache.find(3));
+    TEST_I_CHECK(test_name, cache.find(4));
+    TEST_I_CHECK(test_name, cache.used_bytes() == file_byte_count * 3);
+
+    // Lowering the capacity deletes the least recently used files.
+    cache.set_capacity_bytes(file_byte_count);
+    TEST_I_CHECK(test_name, cache.item_count() == 1);
+    TEST_I_CHECK(test_name, cache.find(4));
+    TEST_I_CHECK(test_name, !file_exists(cache.file_path(1)));
+    TEST_I_CHECK(test_name, !file_exists(cache.file_path(3)));
+    return true;
+}
+
+static bool test_i_reopen(const char *test_name,
+                          const std::string &cache_dir_path) {
+    clear_disk_cache(cache_dir_path);
+
+    const mmimg::DiskCacheImageInfo info = make_info(32, 16);
+    const size_t item_count = 16;
+    size_t used_bytes = 0;
+    {
+        const size_t thread_count = 4;
+        mmimg::ImageDiskCache cache(cache_dir_path, 64 * 1024 * 1024,
+                                    thread_count);
+        const bool background = true;
+        for (size_t i = 0; i < item_count; i++) {
+            const std::vector<float> pixels =
+                make_pixels(info, static_cast<float>(i));
+            TEST_I_CHECK(test_name,
+                         cache.write(i, info, pixels.data(), background));
+        }
+        cache.wait_for_writes();
+        TEST_I_CHECK(test_name, cache.item_count() == item_count);
+        used_bytes = cache.used_bytes();
+
+        // Left behind by a crash, while writing.
+        TEST_I_CHECK(test_name, write_text_file(cache.file_path(100) + ".tmp0",
+                                                "unfinished"));
+    }
+
+    // The files written by the previous session are found again.
+    mmimg::ImageDiskCache cache(cache_dir_path, 64 * 1024 * 1024, 1);
+    TEST_I_CHECK(test_name, cache.item_count() == item_count);
+    TEST_I_CHECK(test_name, cache.used_bytes() == used_bytes);
+    TEST_I_CHECK(test_name, !file_exists(cache.file_path(100) + ".tmp0"));
+
+    const Key key = 7;
+    mmimg::DiskCacheImageInfo read_info;
+    std::vector<float> read_pixels(info.byte_count() / sizeof(float), 0.0f);
+    TEST_I_CHECK(test_name, cache.find(key));
+    TEST_I_CHECK(test_name, cache.read_info(key, read_info));
+    TEST_I_CHECK(test_name,
+                 cache.read_pixels(key, read_info, read_pixels.data()));
+    TEST_I_CHECK(test_name, read_pixels == make_pixels(info, 7.0f));
+    return true;
+}
+
+static bool test_i_make_key(const char *test_name, const char *dir_path) {
+    const std::string file_path =
+        join_path(dir_path, "/test_disk_cache_key.out.txt");
+    TEST_I_CHECK(test_name, write_text_file(file_path, "version one"));
+
+    Key key_a = 0;
+    Key key_b = 0;
+    TEST_I_CHECK(test_name, mmimg::ImageDiskCache::make_key(file_path, key_a));
+    TEST_I_CHECK(test_name, mmimg::ImageDiskCache::make_key(file_path, key_b));
+    TEST_I_CHECK(test_name, key_a == key_b);
+
+    // A changed source file must not match the old cache file.
+    TEST_I_CHECK(test_name, write_text_file(file_path, "version number two"));
+    TEST_I_CHECK(test_name, mmimg::ImageDiskCache::make_key(file_path, key_b));
+    TEST_I_CHECK(test_name, key_a != key_b);
+
+    const std::string missing_file_path =
+        join_path(dir_path, "/test_disk_cache_missing.out.txt");
+    TEST_I_CHECK(test_name,
+                 !mmimg::ImageDiskCache::make_key(missing_file_path, key_b));
+    return true;
+}
+
+// Compare decoding the EXR files (a cold cache) with reading the
+// pixels from the disk cache (a warm cache).
+static bool test_i_benchmark(const char *test_name, const char *dir_path,
+                             const std::string &cache_dir_path) {
+    clear_disk_cache(cache_dir_path);
+
+    const int32_t frame_count = 24;
+    const size_t image_width = 1024;
+    const size_t image_height = 512;
+    std::vector<std::string> file_paths;
+    for (int32_t frame = 1; frame <= frame_count; frame++) {
+        const std::string file_path = frame_file_path(dir_path, frame);
+        TEST_I_CHECK(test_name, write_frame_image(file_path, frame,
+                                                  image_width, image_height));
+        file_paths.push_back(file_path);
+    }
+
+    const size_t thread_count = 2;
+    mmimg::ImageDiskCache cache(cache_dir_path,
+                                static_cast<size_t>(1024) * 1024 * 1024,
+                                thread_count);
+
+    std::chrono::duration<double> cold_duration(0.0);
+    {
+        auto pixel_buffer = mmimg::ImagePixelBuffer();
+        const auto start_time = std::chrono::steady_clock::now();
+        for (const std::string &file_path : file_paths) {
+            Key key = 0;
+            TEST_I_CHECK(test_name,
+                         mmimg::ImageDiskCache::make_key(file_path, key));
+            TEST_I_CHECK(test_name, !cache.find(key));
+            TEST_I_CHECK(test_name, read_frame_image(file_path, pixel_buffer));
+
+            mmimg::DiskCacheImageInfo info;
+            info.width = static_cast<uint32_t>(pixel_buffer.image_width());
+            info.height = static_cast<uint32_t>(pixel_buffer.image_height());
+            info.num_channels =
+                static_cast<uint8_t>(pixel_buffer.num_channels());
+            info.bytes_per_channel = sizeof(float);
+            const bool background = true;
+            const mmimg::PixelF32x4 *pixel_data =
+                pixel_buffer.as_slice_f32x4().data();
+            TEST_I_CHECK(test_name,
+                         cache.write(key, info, pixel_data, background));
+        }
+        cold_duration = std::chrono::steady_clock::now() - start_time;
+    }
+    cache.wait_for_writes();
+    TEST_I_CHECK(test_name,
+                 cache.item_count() == static_cast<size_t>(frame_count));
+
+    std::chrono::duration<double> warm_duration(0.0);
+    {
+        std::vector<mmimg::PixelF32x4> pixels;
+        const auto start_time = std::chrono::steady_clock::now();
+        for (int32_t frame = 1; frame <= frame_count; frame++) {
+            const std::string &file_path = file_paths[frame - 1];
+            Key key = 0;
+            TEST_I_CHECK(test_name,
+                         mmimg::ImageDiskCache::make_key(file_path, key));
+            TEST_I_CHECK(test_name, cache.find(key));
+
+            mmimg::DiskCacheImageInfo info;
+            TEST_I_CHECK(test_name, cache.read_info(key, info));
+            TEST_I_CHECK(test_name, info.width == image_width);
+            TEST_I_CHECK(test_name, info.height == image_height);
+            pixels.resize(info.byte_count() / sizeof(mmimg::PixelF32x4));
+            TEST_I_CHECK(test_name,
+                         cache.read_pixels(key, info, pixels.data()));
+            TEST_I_CHECK(test_name,
+                         pixels.front().b == static_cast<float>(frame));
+        }
+        warm_duration = std::chrono::steady_clock::now() - start_time;
+    }
+
+    std::cout << test_name << " frames=" << frame_count
+              << " resolution=" << image_width << "x" << image_height
+              << " cold_seconds=" << cold_duration.count()
+              << " warm_seconds=" << warm_duration.count() << std::endl;
+
+    clear_disk_cache(cache_dir_path);
+    return true;
+}
+
+int test_i(const char *test_name, const char *dir_path) {
+    const std::string cache_dir_path =
+        join_path(dir_path, "/test_disk_cache.out");
+    if (!test_i_read_write(test_name, cache_dir_path)) {
+        return 1;
+    }
+    if (!test_i_evict(test_name, cache_dir_path)) {
+        return 1;
+    }
+    if (!test_i_reopen(test_name, cache_dir_path)) {
+        return 1;
+    }
+    if (!test_i_make_key(test_name, dir_path)) {
+        return 1;
+    }
+    if (!test_i_benchmark(test_name, dir_path, cache_dir_path)) {
+        return 1;
+    }
+    std::cout << test_name << " passed." << std::endl;
+    return 0;
+}
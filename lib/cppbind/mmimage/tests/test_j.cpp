@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_j.h"
+
+#include <mmimage/image_pixel_convert.h>
+#include <mmimage/mmimage.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "common.h"
+
+namespace mmimg = mmimage;
+
+#define TEST_J_CHECK(test_name, condition)                                \
+    if (!(condition)) {                                                   \
+        std::cerr << test_name << " FAILED: " #condition " (line "        \
+                  << __LINE__ << ")" << std::endl;                        \
+        return false;                                                     \
+    }
+
+static bool test_j_half_float(const char *test_name) {
+    // Values that are exactly representable as half floats.
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(0.0f) == 0x0000);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(-0.0f) == 0x8000);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(1.0f) == 0x3C00);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(-2.0f) == 0xC000);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(0.5f) == 0x3800);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(65504.0f) == 0x7BFF);
+
+    // Smallest denormalised half float.
+    const float half_denorm_min = std::ldexp(1.0f, -24);
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f32_to_f16(half_denorm_min) == 0x0001);
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f16_to_f32(0x0001) == half_denorm_min);
+
+    // Rounding to nearest, ties to even.
+    const float one_ulp = std::ldexp(1.0f, -10);
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f32_to_f16(1.0f + (one_ulp * 0.5f)) ==
+                     0x3C00);
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f32_to_f16(1.0f + (one_ulp * 1.5f)) ==
+                     0x3C02);
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f32_to_f16(1.0f + (one_ulp * 0.75f)) ==
+                     0x3C01);
+
+    // Out of range values.
+    const float infinity = std::numeric_limits<float>::infinity();
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(65520.0f) == 0x7C00);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(infinity) == 0x7C00);
+    TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(-infinity) == 0xFC00);
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    TEST_J_CHECK(test_name,
+                 std::isnan(mmimg::convert_f16_to_f32(
+                     mmimg::convert_f32_to_f16(nan))));
+    TEST_J_CHECK(test_name,
+                 mmimg::convert_f32_to_f16(std::ldexp(1.0f, -26)) == 0x0000);
+
+    // Every finite half float converts to a float and back without
+    // change.
+    for (uint32_t i = 0; i < 0x10000; i++) {
+        const uint16_t half = static_cast<uint16_t>(i);
+        if ((half & 0x7C00) == 0x7C00) {
+            continue;
+        }
+        const float value = mmimg::convert_f16_to_f32(half);
+        TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(value) == half);
+    }
+    return true;
+}
+
+static bool test_j_convert_pixels(const char *test_name) {
+    const size_t pixel_count = 2;
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    const std::vector<float> pixels = {
+        0.0f, 0.5f, 1.0f, 0.25f,  // pixel 0
+        -1.0f, 2.0f, nan, 1.0f,   // pixel 1
+    };
+
+    std::vector<float> rgb_pixels(pixel_count * 3);
+    mmimg::copy_pixels_f32(pixels.data(), pixel_count, 4, 3,
+                           rgb_pixels.data());
+    TEST_J_CHECK(test_name, rgb_pixels[0] == 0.0f);
+    TEST_J_CHECK(test_name, rgb_pixels[2] == 1.0f);
+    TEST_J_CHECK(test_name, rgb_pixels[3] == -1.0f);
+    TEST_J_CHECK(test_name, rgb_pixels[4] == 2.0f);
+
+    std::vector<uint8_t> rgba_u8_pixels(pixel_count * 4);
+    mmimg::convert_pixels_f32_to_u8(pixels.data(), pixel_count, 4, 4,
+                                    rgba_u8_pixels.data());
+    const std::vector<uint8_t> expected_rgba_u8_pixels = {
+        0, 128, 255, 64,  // pixel 0
+        0, 255, 0, 255,   // pixel 1
+    };
+    TEST_J_CHECK(test_name, rgba_u8_pixels == expected_rgba_u8_pixels);
+
+    std::vector<uint8_t> rgb_u8_pixels(pixel_count * 3);
+    mmimg::convert_pixels_f32_to_u8(pixels.data(), pixel_count, 4, 3,
+                                    rgb_u8_pixels.data());
+    const std::vector<uint8_t> expected_rgb_u8_pixels = {
+        0, 128, 255,  // pixel 0
+        0, 255, 0,    // pixel 1
+    };
+    TEST_J_CHECK(test_name, rgb_u8_pixels == expected_rgb_u8_pixels);
+    return true;
+}
+
+// The half float pixels read from an EXR file must match the 32-bit
+// float pixels of the same file, rounded to half floats.
+static bool test_j_read_exr_f16x4(const char *test_name,
+                                  const char *dir_path) {
+    const std::string file_path =
+        join_path(dir_path, "/Beachball/singlepart.0001", ".exr");
+    const rust::Str input_file_path(file_path.c_str());
+    const bool vertical_flip = false;
+
+    auto meta_data_f32 = mmimg::ImageMetaData();
+    auto pixel_buffer_f32 = mmimg::ImagePixelBuffer();
+    TEST_J_CHECK(test_name,
+                 mmimg::image_read_pixels_exr_f32x4(
+                     input_file_path, vertical_flip, meta_data_f32,
+                     pixel_buffer_f32));
+
+    auto meta_data_f16 = mmimg::ImageMetaData();
+    auto pixel_buffer_f16 = mmimg::ImagePixelBuffer();
+    TEST_J_CHECK(test_name,
+                 mmimg::image_read_pixels_exr_f16x4(
+                     input_file_path, vertical_flip, meta_data_f16,
+                     pixel_buffer_f16));
+
+    TEST_J_CHECK(test_name, pixel_buffer_f16.image_width() ==
+                                pixel_buffer_f32.image_width());
+    TEST_J_CHECK(test_name, pixel_buffer_f16.image_height() ==
+                                pixel_buffer_f32.image_height());
+    TEST_J_CHECK(test_name, pixel_buffer_f16.data_type() ==
+                                mmimg::BufferDataType::kF16);
+
+    rust::Slice<const mmimg::PixelF32x4> slice_f32 =
+        pixel_buffer_f32.as_slice_f32x4();
+    rust::Slice<const mmimg::PixelF16x4> slice_f16 =
+        pixel_buffer_f16.as_slice_f16x4();
+    TEST_J_CHECK(test_name, slice_f16.size() == slice_f32.size());
+    for (size_t i = 0; i < slice_f32.size(); i++) {
+        const mmimg::PixelF32x4 &pixel_f32 = slice_f32[i];
+        const mmimg::PixelF16x4 &pixel_f16 = slice_f16[i];
+        TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(pixel_f32.r) ==
+                                    pixel_f16.r);
+        TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(pixel_f32.g) ==
+                                    pixel_f16.g);
+        TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(pixel_f32.b) ==
+                                    pixel_f16.b);
+        TEST_J_CHECK(test_name, mmimg::convert_f32_to_f16(pixel_f32.a) ==
+                                    pixel_f16.a);
+    }
+
+    std::cout << test_name << " f32 bytes: "
+              << (slice_f32.size() * sizeof(mmimg::PixelF32x4))
+              << " f16 bytes: "
+              << (slice_f16.size() * sizeof(mmimg::PixelF16x4)) << std::endl;
+    return true;
+}
+
+int test_j(const char *test_name, const char *dir_path) {
+    if (!test_j_half_float(test_name)) {
+        return 1;
+    }
+    if (!test_j_convert_pixels(test_name)) {
+        return 1;
+    }
+    if (!test_j_read_exr_f16x4(test_name, dir_path)) {
+        return 1;
+    }
+    std::cout << test_name << " passed." << std::endl;
+    return 0;
+}
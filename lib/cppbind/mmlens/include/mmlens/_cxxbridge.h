@@ -766,6 +766,12 @@ MMLENS_API_EXPORT ::rust::Box<::mmlens::ShimDistortionLayers> shim_read_lens_fil
 
 MMLENS_API_EXPORT ::std::int32_t initialize_global_thread_pool(::std::int32_t num_threads) noexcept;
 
+MMLENS_API_EXPORT void set_parallel_tile_size(::std::size_t tile_width, ::std::size_t tile_height) noexcept;
+
+MMLENS_API_EXPORT ::std::size_t get_parallel_tile_width() noexcept;
+
+MMLENS_API_EXPORT ::std::size_t get_parallel_tile_height() noexcept;
+
 MMLENS_API_EXPORT void apply_identity_to_f64_multithread(::mmlens::DistortionDirection direction, ::std::size_t image_width, ::std::size_t image_height, double *out_data_ptr, ::std::size_t out_data_size, ::std::size_t out_data_stride, ::mmlens::CameraParameters camera_parameters, double film_back_radius_cm, ::mmlens::Parameters3deClassic lens_parameters) noexcept;
 
 MMLENS_API_EXPORT void apply_identity_to_f32_multithread(::mmlens::DistortionDirection direction, ::std::size_t image_width, ::std::size_t image_height, float *out_data_ptr, ::std::size_t out_data_size, ::std::size_t out_data_stride, ::mmlens::CameraParameters camera_parameters, double film_back_radius_cm, ::mmlens::Parameters3deClassic lens_parameters) noexcept;
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Pre-computed inverse lens distortion grids, used as the initial
+ * guess when re-distorting points.
+ */
+
+#ifndef MM_LENS_DISTORTION_GUESS_GRID_H
+#define MM_LENS_DISTORTION_GUESS_GRID_H
+
+#include <mmcore/mmdata.h>
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace mmlens {
+
+// The number of grid cells along each axis of an inverse guess grid.
+const size_t kInverseGuessGridResolution = 32;
+
+// A regular grid of inverse lens distortion ('eval_inv') values,
+// stored at the vertices of the grid in diagonal-normalized
+// coordinates.
+//
+// A grid is built for the points of a single re-distortion call
+// (see 'get_inverse_guess_grid'), and is immutable once constructed,
+// so it can be shared between the threads of the call without
+// locking.
+class InverseGuessGrid {
+public:
+    // 'vertex_values' holds (resolution + 1) * (resolution + 1)
+    // pairs of X and Y values, in row-major order. Invalid vertices
+    // are expected to be NaN.
+    InverseGuessGrid(const double min_x, const double min_y,
+                     const double step_x, const double step_y,
+                     const size_t resolution,
+                     std::vector<double> vertex_values)
+        : m_min_x(min_x)
+        , m_min_y(min_y)
+        , m_inverse_step_x(1.0 / step_x)
+        , m_inverse_step_y(1.0 / step_y)
+        , m_resolution(resolution)
+        , m_vertex_values(std::move(vertex_values)) {}
+
+    size_t resolution() const { return m_resolution; }
+
+    // Bilinearly interpolate the grid values at 'point_dn'.
+    //
+    // Returns false if the point is outside the grid, or if any of
+    // the surrounding vertices are invalid.
+    bool lookup(const mmdata::Vector2D& point_dn,
+                mmdata::Vector2D& out_guess_dn) const {
+        const double resolution = static_cast<double>(m_resolution);
+        const double fx = (point_dn.x_ - m_min_x) * m_inverse_step_x;
+        const double fy = (point_dn.y_ - m_min_y) * m_inverse_step_y;
+        // Written so that NaN values fail the test.
+        if (!(fx >= 0.0 && fx <= resolution && fy >= 0.0 &&
+              fy <= resolution)) {
+            return false;
+        }
+
+        size_t ix = static_cast<size_t>(fx);
+        size_t iy = static_cast<size_t>(fy);
+        if (ix >= m_resolution) {
+            ix = m_resolution - 1;
+        }
+        if (iy >= m_resolution) {
+            iy = m_resolution - 1;
+        }
+        const double tx = fx - static_cast<double>(ix);
+        const double ty = fy - static_cast<double>(iy);
+
+        const size_t row_stride = (m_resolution + 1) * 2;
+        const double* v00 =
+            m_vertex_values.data() + (iy * row_stride) + (ix * 2);
+        const double* v10 = v00 + 2;
+        const double* v01 = v00 + row_stride;
+        const double* v11 = v01 + 2;
+
+        const double x0 = v00[0] + ((v10[0] - v00[0]) * tx);
+        const double x1 = v01[0] + ((v11[0] - v01[0]) * tx);
+        const double y0 = v00[1] + ((v10[1] - v00[1]) * tx);
+        const double y1 = v01[1] + ((v11[1] - v01[1]) * tx);
+        const double guess_x = x0 + ((x1 - x0) * ty);
+        const double guess_y = y0 + ((y1 - y0) * ty);
+        if (!std::isfinite(guess_x) || !std::isfinite(guess_y)) {
+            return false;
+        }
+
+        out_guess_dn = mmdata::Vector2D(guess_x, guess_y);
+        return true;
+    }
+
+private:
+    double m_min_x;
+    double m_min_y;
+    double m_inverse_step_x;
+    double m_inverse_step_y;
+    size_t m_resolution;
+    std::vector<double> m_vertex_values;
+};
+
+}  // namespace mmlens
+
+#endif  // MM_LENS_DISTORTION_GUESS_GRID_H
@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Control of the vectorised (SIMD) lens distortion kernels.
+ */
+
+#ifndef MM_LENS_DISTORTION_SIMD_H
+#define MM_LENS_DISTORTION_SIMD_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "_symbol_export.h"
+
+namespace mmlens {
+
+// The instruction set width used to evaluate the 3DE lens
+// distortion models, when processing many points at once.
+enum class SimdLevel : uint8_t {
+    // Evaluate one point at a time with the LDPK functions.
+    kScalar = 0,
+
+    // Evaluate 2 points at once (128-bit; SSE2 or NEON).
+    kVector128 = 1,
+
+    // Evaluate 4 points at once (256-bit; AVX2).
+    kVector256 = 2,
+};
+
+// The widest SIMD level supported by the running CPU.
+MMLENS_API_EXPORT
+SimdLevel detect_simd_level();
+
+// Set the SIMD level used for lens distortion. Values wider than
+// 'detect_simd_level()' are clamped. Defaults to
+// 'detect_simd_level()'.
+//
+// 'SimdLevel::kScalar' disables the SIMD kernels, which is useful to
+// compare results with the LDPK functions.
+MMLENS_API_EXPORT
+void set_simd_level(const SimdLevel value);
+
+MMLENS_API_EXPORT
+SimdLevel get_simd_level();
+
+// The number of points evaluated at once with 'value'.
+MMLENS_API_EXPORT
+size_t simd_level_width(const SimdLevel value);
+
+}  // namespace mmlens
+
+#endif  // MM_LENS_DISTORTION_SIMD_H
@@ -28,6 +28,7 @@
 #include <mmlens/_cxx.h>
 #include <mmlens/_cxxbridge.h>
 
+#include <cstddef>
 #include <memory>
 
 namespace mmlens {
@@ -42,6 +43,7 @@ public:
         , m_camera{3.0, 3.6, 2.4, 1.0, 0.0, 0.0}
         // TODO: Pre-compute this value.
         , m_film_back_radius_cm(1.0)
+        , m_use_inverse_guess_grid(false)
         , m_inputLensModel{} {};
 
     virtual std::unique_ptr<LensModel> cloneAsUniquePtr() const = 0;
@@ -87,6 +89,17 @@ public:
         setParameter(m_camera.lens_center_offset_y_cm, value);
     }
 
+    // Use an inverse guess grid (see 'InverseGuessGrid') for the
+    // initial guess of each point re-distorted by
+    // 'applyModelDistortBatch'. The grid is built for each call with
+    // enough points, so the results only depend on the points and
+    // values given to the call. Disabled by default, so the solver
+    // does not use it.
+    bool getUseInverseGuessGrid() const { return m_use_inverse_guess_grid; }
+    void setUseInverseGuessGrid(const bool value) {
+        m_use_inverse_guess_grid = value;
+    }
+
     std::shared_ptr<LensModel> getInputLensModel() const {
         return m_inputLensModel;
     }
@@ -108,6 +121,32 @@ public:
     virtual void applyModelDistort(const double x, const double y,
                                    double& out_x, double& out_y) = 0;
 
+    // Apply the lens model to 'count' points at once.
+    //
+    // 'x' and 'y' are contiguous arrays of 'count' values, in the
+    // same coordinate space as 'applyModelUndistort', and the
+    // results are written to 'out_x' and 'out_y' (also 'count'
+    // values long). The output arrays may be the same as the input
+    // arrays.
+    //
+    // Prefer these functions when many points are evaluated with
+    // the same lens, because the lens model chain is walked and the
+    // distortion is initialized only once for all points.
+    virtual void applyModelUndistortBatch(const double* x, const double* y,
+                                          const size_t count, double* out_x,
+                                          double* out_y) {
+        for (size_t i = 0; i < count; i++) {
+            applyModelUndistort(x[i], y[i], out_x[i], out_y[i]);
+        }
+    }
+    virtual void applyModelDistortBatch(const double* x, const double* y,
+                                        const size_t count, double* out_x,
+                                        double* out_y) {
+        for (size_t i = 0; i < count; i++) {
+            applyModelDistort(x[i], y[i], out_x[i], out_y[i]);
+        }
+    }
+
     virtual mmhash::HashValue hashValue() = 0;
 
 protected:
@@ -115,6 +154,7 @@ protected:
     LensModelState m_state;
     CameraParameters m_camera;
     double m_film_back_radius_cm;
+    bool m_use_inverse_guess_grid;
     std::shared_ptr<LensModel> m_inputLensModel;
 
     template <typename T>
@@ -123,6 +123,13 @@ public:
     void applyModelDistort(const double x, const double y, double &out_x,
                            double &out_y) override;
 
+    void applyModelUndistortBatch(const double *x, const double *y,
+                                  const size_t count, double *out_x,
+                                  double *out_y) override;
+    void applyModelDistortBatch(const double *x, const double *y,
+                                const size_t count, double *out_x,
+                                double *out_y) override;
+
     mmhash::HashValue hashValue() override;
 
 private:
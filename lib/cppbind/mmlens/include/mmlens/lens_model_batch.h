@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Evaluate a LensModel on many points at once, using many threads.
+ */
+
+#ifndef MM_LENS_LENS_MODEL_BATCH_H
+#define MM_LENS_LENS_MODEL_BATCH_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "_symbol_export.h"
+#include "lens_model.h"
+
+namespace mmlens {
+
+// The fewest points evaluated by each thread. Below this, starting
+// a thread costs more than evaluating the points.
+const size_t kLensModelBatchMinPointsPerThread = 4096;
+
+// Apply the lens model to 'count' points, split into contiguous
+// ranges evaluated on up to 'num_threads' threads (0 means the
+// hardware thread count). Each range is evaluated with
+// 'applyModelUndistortBatch' or 'applyModelDistortBatch', so the
+// results are the same as a single batched call.
+//
+// The lens model (and the input lens models it is connected to)
+// must not be modified by any other thread while this function
+// runs.
+MMLENS_API_EXPORT
+void apply_model_undistort_batch_multithread(LensModel& lens_model,
+                                             const double* x, const double* y,
+                                             const size_t count, double* out_x,
+                                             double* out_y,
+                                             const int32_t num_threads);
+
+MMLENS_API_EXPORT
+void apply_model_distort_batch_multithread(LensModel& lens_model,
+                                           const double* x, const double* y,
+                                           const size_t count, double* out_x,
+                                           double* out_y,
+                                           const int32_t num_threads);
+
+}  // namespace mmlens
+
+#endif  // MM_LENS_LENS_MODEL_BATCH_H
@@ -25,7 +25,9 @@
 #include "_cxx.h"
 #include "_cxxbridge.h"
 #include "_types.h"
+#include "distortion_guess_grid.h"
 #include "distortion_layers.h"
+#include "distortion_simd.h"
 #include "lens_model.h"
 #include "lens_model_3de_anamorphic_deg_4_rotate_squeeze_xy.h"
 #include "lens_model_3de_anamorphic_deg_4_rotate_squeeze_xy_rescaled.h"
@@ -33,6 +35,7 @@
 #include "lens_model_3de_anamorphic_deg_6_rotate_squeeze_xy_rescaled.h"
 #include "lens_model_3de_classic.h"
 #include "lens_model_3de_radial_decentered_deg_4_cylindric.h"
+#include "lens_model_batch.h"
 #include "lens_model_passthrough.h"
 #include "lib.h"
 
@@ -1021,6 +1021,12 @@ MMLENS_API_EXPORT void mmlens$cxxbridge1$apply_f64_to_f32_3de_anamorphic_std_deg
 
 ::std::int32_t mmlens$cxxbridge1$initialize_global_thread_pool(::std::int32_t num_threads) noexcept;
 
+void mmlens$cxxbridge1$set_parallel_tile_size(::std::size_t tile_width, ::std::size_t tile_height) noexcept;
+
+::std::size_t mmlens$cxxbridge1$get_parallel_tile_width() noexcept;
+
+::std::size_t mmlens$cxxbridge1$get_parallel_tile_height() noexcept;
+
 void mmlens$cxxbridge1$apply_identity_to_f64_3de_classic_multithread(::mmlens::DistortionDirection direction, ::std::size_t image_width, ::std::size_t image_height, double *out_data_ptr, ::std::size_t out_data_size, ::std::size_t out_data_stride, ::mmlens::CameraParameters camera_parameters, double film_back_radius_cm, ::mmlens::Parameters3deClassic lens_parameters) noexcept;
 
 void mmlens$cxxbridge1$apply_identity_to_f32_3de_classic_multithread(::mmlens::DistortionDirection direction, ::std::size_t image_width, ::std::size_t image_height, float *out_data_ptr, ::std::size_t out_data_size, ::std::size_t out_data_stride, ::mmlens::CameraParameters camera_parameters, double film_back_radius_cm, ::mmlens::Parameters3deClassic lens_parameters) noexcept;
@@ -1484,6 +1490,18 @@ MMLENS_API_EXPORT ::std::int32_t initialize_global_thread_pool(::std::int32_t nu
   return mmlens$cxxbridge1$initialize_global_thread_pool(num_threads);
 }
 
+MMLENS_API_EXPORT void set_parallel_tile_size(::std::size_t tile_width, ::std::size_t tile_height) noexcept {
+  mmlens$cxxbridge1$set_parallel_tile_size(tile_width, tile_height);
+}
+
+MMLENS_API_EXPORT ::std::size_t get_parallel_tile_width() noexcept {
+  return mmlens$cxxbridge1$get_parallel_tile_width();
+}
+
+MMLENS_API_EXPORT ::std::size_t get_parallel_tile_height() noexcept {
+  return mmlens$cxxbridge1$get_parallel_tile_height();
+}
+
 MMLENS_API_EXPORT void apply_identity_to_f64_multithread(::mmlens::DistortionDirection direction, ::std::size_t image_width, ::std::size_t image_height, double *out_data_ptr, ::std::size_t out_data_size, ::std::size_t out_data_stride, ::mmlens::CameraParameters camera_parameters, double film_back_radius_cm, ::mmlens::Parameters3deClassic lens_parameters) noexcept {
   mmlens$cxxbridge1$apply_identity_to_f64_3de_classic_multithread(direction, image_width, image_height, out_data_ptr, out_data_size, out_data_stride, camera_parameters, film_back_radius_cm, lens_parameters);
 }
@@ -20,7 +20,10 @@
 
 use crate::distortion_layers::shim_create_distortion_layers_box;
 use crate::distortion_layers::ShimDistortionLayers;
+use crate::distortion_process::get_parallel_tile_height;
+use crate::distortion_process::get_parallel_tile_width;
 use crate::distortion_process::initialize_global_thread_pool;
+use crate::distortion_process::set_parallel_tile_size;
 use crate::lens_io::shim_read_lens_file;
 
 use crate::distortion_process::apply_f64_to_f32_3de_classic_multithread;
@@ -743,6 +746,10 @@ pub mod ffi {
     extern "Rust" {
         fn initialize_global_thread_pool(num_threads: i32) -> i32;
 
+        fn set_parallel_tile_size(tile_width: usize, tile_height: usize);
+        fn get_parallel_tile_width() -> usize;
+        fn get_parallel_tile_height() -> usize;
+
         //////////////////////////////////////////////////////////////////////
         // 3DE Classic
 
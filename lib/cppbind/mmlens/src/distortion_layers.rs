@@ -500,6 +500,69 @@ impl ShimDistortionLayers {
         }
     }
 
+    /// Construct the DistortionLayers from a parameter block that is
+    /// already in layer and frame order, as returned by
+    /// 'parameter_block()'.
+    ///
+    /// Returns None if the parts do not describe valid layers, or the
+    /// parameter block size does not match the layers.
+    pub fn from_parameter_block(
+        layer_count: LayerSize,
+        layer_lens_model_types: &SmallVec<[BindLensModelType; 4]>,
+        layer_frame_range: &SmallVec<[(FrameNumber, FrameNumber); 4]>,
+        camera_parameters: BindCameraParameters,
+        parameter_block: Vec<f64>,
+    ) -> Option<ShimDistortionLayers> {
+        if layer_lens_model_types.len() != layer_count as usize
+            || layer_frame_range.len() != layer_count as usize
+        {
+            return None;
+        }
+        for layer_num in 0..(layer_count as usize) {
+            if layer_lens_model_types[layer_num].parameters_size() == 0 {
+                return None;
+            }
+            let (start_frame, end_frame) = layer_frame_range[layer_num];
+            let is_static = start_frame == STATIC_FRAME_NUMBER
+                || end_frame == STATIC_FRAME_NUMBER;
+            if !is_static && start_frame > end_frame {
+                return None;
+            }
+        }
+
+        let (parameter_count, parameter_value_count) = total_parameter_count(
+            layer_count,
+            &layer_frame_range,
+            &layer_lens_model_types,
+        );
+        if parameter_value_count != parameter_block.len() {
+            return None;
+        }
+
+        let mut parameter_indices = Vec::with_capacity(parameter_count);
+        let mut index_start: usize = 0;
+        for layer_num in 0..layer_count {
+            let frame_count =
+                count_lens_layer_frame_count(layer_num, &layer_frame_range);
+            let lens_model_type = layer_lens_model_types[layer_num as usize];
+            let parameters_size = lens_model_type.parameters_size();
+            for _frame_index in 0..frame_count {
+                parameter_indices
+                    .push((index_start.try_into().unwrap(), parameters_size));
+                index_start += parameters_size as usize;
+            }
+        }
+
+        Some(ShimDistortionLayers {
+            layer_count,
+            layer_lens_model_types: layer_lens_model_types.clone(),
+            layer_frame_range: layer_frame_range.clone(),
+            camera_parameters,
+            parameter_indices,
+            parameter_block,
+        })
+    }
+
     pub fn is_static(&self) -> bool {
         for layer_num in 0..self.layer_count {
             let frame_count = count_lens_layer_frame_count(
@@ -597,6 +660,19 @@ impl ShimDistortionLayers {
         }
     }
 
+    /// The (start, end) frame range of the layer.
+    pub fn layer_frame_range(
+        &self,
+        layer_num: LayerIndex,
+    ) -> (FrameNumber, FrameNumber) {
+        self.layer_frame_range[layer_num as usize]
+    }
+
+    /// All parameter values, in layer and frame order.
+    pub fn parameter_block(&self) -> &[f64] {
+        &self.parameter_block
+    }
+
     impl_layer_lens_parameters_method!(
         layer_lens_parameters_3de_classic,
         BindLensModelType::TdeClassic,
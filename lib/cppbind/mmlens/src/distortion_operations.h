@@ -21,20 +21,35 @@
 
 #include <mmcore/mmdata.h>
 #include <mmlens/_cxxbridge.h>
+#include <mmlens/distortion_guess_grid.h>
+#include <mmlens/distortion_simd.h>
 #include <mmlens/lib.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <memory>
 #include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "distortion_simd_kernel.h"
 
 namespace mmlens {
 
 // Apply lens distortion to a single 2D coordinate.
+//
+// When re-distorting, 'guess_grid' (if not null) is used to look up
+// the initial guess for the iterative inverse distortion.
 template <DistortionDirection DIRECTION, class IN_TYPE, class OUT_TYPE,
           class LENS_TYPE>
 std::pair<OUT_TYPE, OUT_TYPE> apply_lens_distortion_once(
     const IN_TYPE in_x, const IN_TYPE in_y,
     const CameraParameters camera_parameters, const double film_back_radius_cm,
-    LENS_TYPE lens) {
+    const LENS_TYPE& lens, const InverseGuessGrid* guess_grid = nullptr) {
     auto out_x = static_cast<OUT_TYPE>(0);
     auto out_y = static_cast<OUT_TYPE>(0);
 
@@ -59,21 +74,14 @@ std::pair<OUT_TYPE, OUT_TYPE> apply_lens_distortion_once(
         // 2D coordinate, which is a lot slower than the undistortion
         // operation.
 
-        // TODO: Look up an initial value from a thread-safe
-        // structure that holds a grid of values at vertices which
-        // we can interpolate as an initial guess.
-        const auto use_guess = false;
-        auto guess_point_x = in_x;
-        auto guess_point_y = in_y;
-        const auto guess_point_unit =
-            mmdata::Vector2D(guess_point_x, guess_point_y);
-        const mmdata::Vector2D guess_point_dn = unit_to_diagonal_normalized(
-            camera_parameters, film_back_radius_cm, guess_point_unit);
-
         const auto in_point_unit = mmdata::Vector2D(in_x, in_y);
         const mmdata::Vector2D in_point_dn = unit_to_diagonal_normalized(
             camera_parameters, film_back_radius_cm, in_point_unit);
 
+        mmdata::Vector2D guess_point_dn;
+        const bool use_guess = (guess_grid != nullptr) &&
+                               guess_grid->lookup(in_point_dn, guess_point_dn);
+
         mmdata::Vector2D distorted_point_dn;
         if (use_guess) {
             // A guess can be used to reduce the number of
@@ -95,72 +103,235 @@ std::pair<OUT_TYPE, OUT_TYPE> apply_lens_distortion_once(
     return std::make_pair(out_x, out_y);
 }
 
-// Apply lens distortion to a pixel.
-template <DistortionDirection DIRECTION, size_t OUT_DATA_STRIDE, class IN_TYPE,
-          class OUT_TYPE, class LENS_TYPE>
-void apply_lens_distortion_to_pixel(const IN_TYPE in_x, const IN_TYPE in_y,
-                                    OUT_TYPE* out_pixel,
-                                    const CameraParameters camera_parameters,
-                                    const double film_back_radius_cm,
-                                    LENS_TYPE lens) {
-    // TODO: See if we can improve performance by calculating 2, 4 or
-    // 8 points at once? Try to use SIMD.
-    if (DIRECTION == DistortionDirection::kUndistort ||
-        DIRECTION == DistortionDirection::kRedistort) {
-        const auto out_xy =
-            apply_lens_distortion_once<DIRECTION, IN_TYPE, OUT_TYPE, LENS_TYPE>(
-                in_x, in_y, camera_parameters, film_back_radius_cm, lens);
+// Create the SIMD kernel of 'lens', if the current SIMD level
+// allows it.
+//
+// The kernel is checked against the (LDPK) 'lens' evaluation on a
+// grid of points, so a kernel that does not match the lens is never
+// used. Returns false if the kernel cannot be used.
+template <class LENS_TYPE>
+bool create_simd_lens_kernel(const CameraParameters camera_parameters,
+                             const double film_back_radius_cm,
+                             const LENS_TYPE& lens,
+                             SimdLensKernel& out_kernel) {
+    if (get_simd_level() == SimdLevel::kScalar) {
+        return false;
+    }
+    if (!lens.simd_kernel(out_kernel)) {
+        return false;
+    }
+    if (!simd_kernel_finalize(camera_parameters, film_back_radius_cm,
+                              out_kernel)) {
+        return false;
+    }
+
+    // Unit coordinates -0.25 to 1.25, covering the film back and
+    // some overscan.
+    const size_t resolution = 5;
+    const size_t count = resolution * resolution;
+    const double tolerance = 1e-9;
+    double in_x[count];
+    double in_y[count];
+    double out_x[count];
+    double out_y[count];
+    for (size_t i = 0; i < count; i++) {
+        in_x[i] = -0.25 + (1.5 * static_cast<double>(i % resolution) /
+                           static_cast<double>(resolution - 1));
+        in_y[i] = -0.25 + (1.5 * static_cast<double>(i / resolution) /
+                           static_cast<double>(resolution - 1));
+    }
+    simd_undistort_points(out_kernel, in_x, in_y, count, out_x, out_y);
+    for (size_t i = 0; i < count; i++) {
+        const auto check_xy =
+            apply_lens_distortion_once<DistortionDirection::kUndistort, double,
+                                       double, LENS_TYPE>(
+                in_x[i], in_y[i], camera_parameters, film_back_radius_cm,
+                lens);
+        // Written so that NaN values fail the test.
+        if (!(std::fabs(out_x[i] - check_xy.first) <= tolerance &&
+              std::fabs(out_y[i] - check_xy.second) <= tolerance)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Apply lens distortion to 'count' unit coordinates (0.0 to 1.0),
+// at most 'kSimdChunkSize'.
+//
+// The undistorted values are written to 'out_undistort_x/y' unless
+// DIRECTION is 'kRedistort', and the re-distorted values are
+// written to 'out_redistort_x/y' unless DIRECTION is 'kUndistort'.
+//
+// When 'simd_kernel' is not null, the points are evaluated with the
+// SIMD kernel, and points that the kernel fails to re-distort are
+// evaluated with 'lens'.
+template <DistortionDirection DIRECTION, class LENS_TYPE>
+void apply_lens_distortion_to_unit_points(
+    const double* in_x, const double* in_y, const size_t count,
+    const CameraParameters camera_parameters, const double film_back_radius_cm,
+    const LENS_TYPE& lens, const InverseGuessGrid* guess_grid,
+    const SimdLensKernel* simd_kernel, double* out_undistort_x,
+    double* out_undistort_y, double* out_redistort_x,
+    double* out_redistort_y) {
+    assert(count <= kSimdChunkSize);
+
+    if (DIRECTION != DistortionDirection::kRedistort) {
+        if (simd_kernel != nullptr) {
+            simd_undistort_points(*simd_kernel, in_x, in_y, count,
+                                  out_undistort_x, out_undistort_y);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                const auto out_xy =
+                    apply_lens_distortion_once<DistortionDirection::kUndistort,
+                                               double, double, LENS_TYPE>(
+                        in_x[i], in_y[i], camera_parameters,
+                        film_back_radius_cm, lens, guess_grid);
+                out_undistort_x[i] = out_xy.first;
+                out_undistort_y[i] = out_xy.second;
+            }
+        }
+    }
+
+    if (DIRECTION != DistortionDirection::kUndistort) {
+        if (simd_kernel != nullptr) {
+            double guess_x[kSimdChunkSize];
+            double guess_y[kSimdChunkSize];
+            uint8_t converged[kSimdChunkSize];
+            if (guess_grid != nullptr) {
+                const double nan_value =
+                    std::numeric_limits<double>::quiet_NaN();
+                for (size_t i = 0; i < count; i++) {
+                    const mmdata::Vector2D in_point_dn =
+                        unit_to_diagonal_normalized(
+                            camera_parameters, film_back_radius_cm,
+                            mmdata::Vector2D(in_x[i], in_y[i]));
+                    mmdata::Vector2D guess_point_dn;
+                    const bool use_guess =
+                        guess_grid->lookup(in_point_dn, guess_point_dn);
+                    guess_x[i] = use_guess ? guess_point_dn.x_ : nan_value;
+                    guess_y[i] = use_guess ? guess_point_dn.y_ : nan_value;
+                }
+            }
+            simd_redistort_points(
+                *simd_kernel, in_x, in_y,
+                (guess_grid != nullptr) ? guess_x : nullptr,
+                (guess_grid != nullptr) ? guess_y : nullptr, count,
+                out_redistort_x, out_redistort_y, converged);
+
+            for (size_t i = 0; i < count; i++) {
+                if (converged[i] == 0) {
+                    const auto out_xy = apply_lens_distortion_once<
+                        DistortionDirection::kRedistort, double, double,
+                        LENS_TYPE>(in_x[i], in_y[i], camera_parameters,
+                                   film_back_radius_cm, lens, guess_grid);
+                    out_redistort_x[i] = out_xy.first;
+                    out_redistort_y[i] = out_xy.second;
+                }
+            }
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                const auto out_xy =
+                    apply_lens_distortion_once<DistortionDirection::kRedistort,
+                                               double, double, LENS_TYPE>(
+                        in_x[i], in_y[i], camera_parameters,
+                        film_back_radius_cm, lens, guess_grid);
+                out_redistort_x[i] = out_xy.first;
+                out_redistort_y[i] = out_xy.second;
+            }
+        }
+    }
+    return;
+}
+
+// Apply lens distortion to 'count' 2D coordinates, stored in
+// separate X and Y arrays.
+//
+// The coordinates are in the -0.5 to 0.5 coordinate space used by
+// the LensModel classes. The in and out arrays may be the same
+// pointers.
+template <DistortionDirection DIRECTION, class LENS_TYPE>
+void apply_lens_distortion_to_span(
+    const double* in_x, const double* in_y, const size_t count,
+    const CameraParameters camera_parameters, const double film_back_radius_cm,
+    const LENS_TYPE& lens, const InverseGuessGrid* guess_grid, double* out_x,
+    double* out_y) {
+    // Building (and checking) the SIMD kernel has a small fixed
+    // cost, which is not worth it for a few points.
+    const size_t simd_min_count = 64;
+    SimdLensKernel simd_kernel;
+    const bool use_simd =
+        (count >= simd_min_count) &&
+        create_simd_lens_kernel<LENS_TYPE>(
+            camera_parameters, film_back_radius_cm, lens, simd_kernel);
+
+    double chunk_in_x[kSimdChunkSize];
+    double chunk_in_y[kSimdChunkSize];
+    double chunk_out_x[kSimdChunkSize];
+    double chunk_out_y[kSimdChunkSize];
+    for (size_t start = 0; start < count; start += kSimdChunkSize) {
+        const size_t chunk_count = std::min(kSimdChunkSize, count - start);
+
+        // The lens distortion operation expects values 0.0 to 1.0,
+        // but our inputs are -0.5 to 0.5, therefore we must convert.
+        for (size_t i = 0; i < chunk_count; i++) {
+            chunk_in_x[i] = in_x[start + i] + 0.5;
+            chunk_in_y[i] = in_y[start + i] + 0.5;
+        }
+
+        apply_lens_distortion_to_unit_points<DIRECTION, LENS_TYPE>(
+            chunk_in_x, chunk_in_y, chunk_count, camera_parameters,
+            film_back_radius_cm, lens, guess_grid,
+            use_simd ? &simd_kernel : nullptr, chunk_out_x, chunk_out_y,
+            chunk_out_x, chunk_out_y);
 
         // Convert back to -0.5 to 0.5 coordinate space.
-        OUT_TYPE out_x = static_cast<OUT_TYPE>(out_xy.first - 0.5);
-        OUT_TYPE out_y = static_cast<OUT_TYPE>(out_xy.second - 0.5);
-        if (std::is_same<OUT_TYPE, float>::value) {
-            // Converting to -0.5 to 0.5 coordinate space is not
-            // important if we are writing to a 'float' data type,
-            // since we can assume that f32 data will be the output
-            // and will not be processed further.
-            out_x = static_cast<OUT_TYPE>(out_xy.first);
-            out_y = static_cast<OUT_TYPE>(out_xy.second);
+        for (size_t i = 0; i < chunk_count; i++) {
+            out_x[start + i] = chunk_out_x[i] - 0.5;
+            out_y[start + i] = chunk_out_y[i] - 0.5;
         }
+    }
+    return;
+}
 
-        out_pixel[0] = out_x;
-        out_pixel[1] = out_y;
+// Write the lens distortion values of a single pixel.
+//
+// The undistorted values are used unless DIRECTION is 'kRedistort',
+// and the re-distorted values are used unless DIRECTION is
+// 'kUndistort'.
+template <DistortionDirection DIRECTION, size_t OUT_DATA_STRIDE,
+          class OUT_TYPE>
+void write_lens_distortion_pixel(const double undistort_x,
+                                 const double undistort_y,
+                                 const double redistort_x,
+                                 const double redistort_y,
+                                 OUT_TYPE* out_pixel) {
+    // Convert back to -0.5 to 0.5 coordinate space.
+    //
+    // Converting to -0.5 to 0.5 coordinate space is not important if
+    // we are writing to a 'float' data type, since we can assume that
+    // f32 data will be the output and will not be processed further.
+    const double offset = std::is_same<OUT_TYPE, float>::value ? 0.0 : 0.5;
+    if (DIRECTION == DistortionDirection::kUndistort) {
+        out_pixel[0] = static_cast<OUT_TYPE>(undistort_x - offset);
+        out_pixel[1] = static_cast<OUT_TYPE>(undistort_y - offset);
+    } else if (DIRECTION == DistortionDirection::kRedistort) {
+        out_pixel[0] = static_cast<OUT_TYPE>(redistort_x - offset);
+        out_pixel[1] = static_cast<OUT_TYPE>(redistort_y - offset);
     } else {
         // It is a logical error if trying to calculate both
         // undistortion and redistortion and trying to output to less
         // than 4 values.
         assert(OUT_DATA_STRIDE >= 4);
 
-        // Calculate both directions, and pack into the output data.
-        const auto out_undistort_xy =
-            apply_lens_distortion_once<DistortionDirection::kUndistort, IN_TYPE,
-                                       OUT_TYPE, LENS_TYPE>(
-                in_x, in_y, camera_parameters, film_back_radius_cm, lens);
-        const auto out_redistort_xy =
-            apply_lens_distortion_once<DistortionDirection::kRedistort, IN_TYPE,
-                                       OUT_TYPE, LENS_TYPE>(
-                in_x, in_y, camera_parameters, film_back_radius_cm, lens);
-
-        // Convert back to -0.5 to 0.5 coordinate space.
-        auto out_undistort_x =
-            static_cast<OUT_TYPE>(out_undistort_xy.first - 0.5);
-        auto out_undistort_y =
-            static_cast<OUT_TYPE>(out_undistort_xy.second - 0.5);
-        auto out_redistort_x =
-            static_cast<OUT_TYPE>(out_redistort_xy.first - 0.5);
-        auto out_redistort_y =
-            static_cast<OUT_TYPE>(out_redistort_xy.second - 0.5);
-        if (std::is_same<OUT_TYPE, float>::value) {
-            // Converting to -0.5 to 0.5 coordinate space is not
-            // important if we are writing to a 'float' data type,
-            // since we can assume that f32 data will be the output
-            // and will not be processed further.
-            out_undistort_x = static_cast<OUT_TYPE>(out_undistort_xy.first);
-            out_undistort_y = static_cast<OUT_TYPE>(out_undistort_xy.second);
-            out_redistort_x = static_cast<OUT_TYPE>(out_redistort_xy.first);
-            out_redistort_y = static_cast<OUT_TYPE>(out_redistort_xy.second);
-        }
-
+        const auto out_undistort_x =
+            static_cast<OUT_TYPE>(undistort_x - offset);
+        const auto out_undistort_y =
+            static_cast<OUT_TYPE>(undistort_y - offset);
+        const auto out_redistort_x =
+            static_cast<OUT_TYPE>(redistort_x - offset);
+        const auto out_redistort_y =
+            static_cast<OUT_TYPE>(redistort_y - offset);
         if (DIRECTION == DistortionDirection::kUndistortAndRedistort) {
             out_pixel[0] = out_undistort_x;
             out_pixel[1] = out_undistort_y;
@@ -185,13 +356,22 @@ void apply_lens_distortion_from_identity(
     const size_t end_image_width, const size_t end_image_height,
     OUT_TYPE* out_data_ptr, const size_t out_data_size,
     const CameraParameters camera_parameters, const double film_back_radius_cm,
-    LENS_TYPE lens) {
+    LENS_TYPE lens, const InverseGuessGrid* guess_grid = nullptr,
+    const SimdLensKernel* simd_kernel = nullptr) {
+    double in_x[kSimdChunkSize];
+    double in_y[kSimdChunkSize];
+    double undistort_x[kSimdChunkSize];
+    double undistort_y[kSimdChunkSize];
+    double redistort_x[kSimdChunkSize];
+    double redistort_y[kSimdChunkSize];
     for (auto row = start_image_height; row < end_image_height; row++) {
-        for (auto column = start_image_width; column < end_image_width;
-             column++) {
-            const size_t row_offset = row - start_image_height;
-            const size_t column_offset = column - start_image_width;
-            const size_t index = (row_offset * image_width) + column_offset;
+        const size_t row_offset = row - start_image_height;
+
+        // Each row is processed in chunks of columns.
+        for (auto chunk_start = start_image_width;
+             chunk_start < end_image_width; chunk_start += kSimdChunkSize) {
+            const size_t chunk_count =
+                std::min(kSimdChunkSize, end_image_width - chunk_start);
 
             // TODO: This assumes that the x/y coordinate matches up
             // with the display window coordinate. In reality the
@@ -204,19 +384,34 @@ void apply_lens_distortion_from_identity(
             // Natron lens distortion node output. (0.0, 0.0) origin
             // is bottom screen-left, and (1.0, 1.0) is the upper
             // screen-right.
-            const double in_x = static_cast<double>(column) /
-                                static_cast<double>(image_width - 1);
-            const double in_y = (static_cast<double>(row) /
-                                 static_cast<double>(image_height - 1) * -1.0) +
-                                1.0;
-
-            const size_t out_index = index * OUT_DATA_STRIDE;
-            OUT_TYPE* out_pixel = out_data_ptr + out_index;
-
-            apply_lens_distortion_to_pixel<DIRECTION, OUT_DATA_STRIDE, double,
-                                           OUT_TYPE, LENS_TYPE>(
-                in_x, in_y, out_pixel, camera_parameters, film_back_radius_cm,
-                lens);
+            const double row_y =
+                (static_cast<double>(row) /
+                 static_cast<double>(image_height - 1) * -1.0) +
+                1.0;
+            for (size_t i = 0; i < chunk_count; i++) {
+                const size_t column = chunk_start + i;
+                in_x[i] = static_cast<double>(column) /
+                          static_cast<double>(image_width - 1);
+                in_y[i] = row_y;
+            }
+
+            apply_lens_distortion_to_unit_points<DIRECTION, LENS_TYPE>(
+                in_x, in_y, chunk_count, camera_parameters,
+                film_back_radius_cm, lens, guess_grid, simd_kernel,
+                undistort_x, undistort_y, redistort_x, redistort_y);
+
+            for (size_t i = 0; i < chunk_count; i++) {
+                const size_t column_offset =
+                    (chunk_start + i) - start_image_width;
+                const size_t index = (row_offset * image_width) + column_offset;
+                const size_t out_index = index * OUT_DATA_STRIDE;
+                OUT_TYPE* out_pixel = out_data_ptr + out_index;
+
+                write_lens_distortion_pixel<DIRECTION, OUT_DATA_STRIDE,
+                                            OUT_TYPE>(
+                    undistort_x[i], undistort_y[i], redistort_x[i],
+                    redistort_y[i], out_pixel);
+            }
         }
     }
     return;
@@ -229,7 +424,9 @@ void apply_lens_distortion_from_identity_with_stride(
     const size_t end_image_width, const size_t end_image_height,
     OUT_TYPE* out_data_ptr, const size_t out_data_size,
     const size_t out_data_stride, const CameraParameters camera_parameters,
-    const double film_back_radius_cm, LENS_TYPE lens) {
+    const double film_back_radius_cm, LENS_TYPE lens,
+    const InverseGuessGrid* guess_grid = nullptr,
+    const SimdLensKernel* simd_kernel = nullptr) {
     if (out_data_stride == 2) {
         // The output buffer is expected to have 2D coordinates only.
         const size_t output_buffer_data_stride = 2;
@@ -238,7 +435,8 @@ void apply_lens_distortion_from_identity_with_stride(
             DIRECTION, output_buffer_data_stride, OUT_TYPE, LENS_TYPE>(
             image_width, image_height, start_image_width, start_image_height,
             end_image_width, end_image_height, out_data_ptr, out_data_size,
-            camera_parameters, film_back_radius_cm, lens);
+            camera_parameters, film_back_radius_cm, lens, guess_grid,
+            simd_kernel);
 
     } else if (out_data_stride == 4) {
         // The output buffer is expected to have 4 values; RGBA.
@@ -248,7 +446,8 @@ void apply_lens_distortion_from_identity_with_stride(
             DIRECTION, output_buffer_data_stride, OUT_TYPE, LENS_TYPE>(
             image_width, image_height, start_image_width, start_image_height,
             end_image_width, end_image_height, out_data_ptr, out_data_size,
-            camera_parameters, film_back_radius_cm, lens);
+            camera_parameters, film_back_radius_cm, lens, guess_grid,
+            simd_kernel);
     } else {
         std::cerr << "apply_lens_distortion_from_identity_with_stride: "
                   << "Invalid out data stride value: " << out_data_stride
@@ -282,31 +481,48 @@ void apply_lens_distortion_to_buffer(
 
     // Camera and lens parameters.
     const CameraParameters camera_parameters, const double film_back_radius_cm,
-    LENS_TYPE lens) {
-    for (size_t i = pixel_num_start; i < pixel_num_end; i++) {
-        const size_t in_index = i * IN_DATA_STRIDE;
-        assert(in_index < in_data_size);
-        const IN_TYPE* in_pixel = in_data_ptr + in_index;
+    LENS_TYPE lens, const InverseGuessGrid* guess_grid = nullptr,
+    const SimdLensKernel* simd_kernel = nullptr) {
+    double in_x[kSimdChunkSize];
+    double in_y[kSimdChunkSize];
+    double undistort_x[kSimdChunkSize];
+    double undistort_y[kSimdChunkSize];
+    double redistort_x[kSimdChunkSize];
+    double redistort_y[kSimdChunkSize];
+    for (size_t chunk_start = pixel_num_start; chunk_start < pixel_num_end;
+         chunk_start += kSimdChunkSize) {
+        const size_t chunk_count =
+            std::min(kSimdChunkSize, pixel_num_end - chunk_start);
+
+        // All the input values of the chunk are read before we write
+        // to the out_data_ptr, because in theory both in_data_ptr and
+        // out_data_ptr may point to the same memory, but we are
+        // interpreting the memory as different types.
+        for (size_t i = 0; i < chunk_count; i++) {
+            const size_t in_index = (chunk_start + i) * IN_DATA_STRIDE;
+            assert(in_index < in_data_size);
+            const IN_TYPE* in_pixel = in_data_ptr + in_index;
+
+            // The lens distortion operation expects values 0.0 to
+            // 1.0, but our inputs are -0.5 to 0.5, therefore we must
+            // convert.
+            in_x[i] = static_cast<double>(in_pixel[0]) + 0.5;
+            in_y[i] = static_cast<double>(in_pixel[1]) + 0.5;
+        }
 
-        // The lens distortion operation expects values 0.0 to 1.0,
-        // but our inputs are -0.5 to 0.5, therefore we must convert.
-        const auto in_x = static_cast<double>(in_pixel[0]) + 0.5;
-        const auto in_y = static_cast<double>(in_pixel[1]) + 0.5;
-
-        // The '{}' scope is used to ensure that the in_x/in_y values
-        // are read first before we write to the out_data_ptr, because
-        // in theory both in_data_ptr and out_data_ptr may point to
-        // the same memory, but we are interpreting the memory as
-        // different types.
-        {
-            const size_t out_index = i * OUT_DATA_STRIDE;
+        apply_lens_distortion_to_unit_points<DIRECTION, LENS_TYPE>(
+            in_x, in_y, chunk_count, camera_parameters, film_back_radius_cm,
+            lens, guess_grid, simd_kernel, undistort_x, undistort_y,
+            redistort_x, redistort_y);
+
+        for (size_t i = 0; i < chunk_count; i++) {
+            const size_t out_index = (chunk_start + i) * OUT_DATA_STRIDE;
             assert(out_index < out_data_size);
             OUT_TYPE* out_pixel = out_data_ptr + out_index;
 
-            apply_lens_distortion_to_pixel<DIRECTION, OUT_DATA_STRIDE, double,
-                                           OUT_TYPE, LENS_TYPE>(
-                in_x, in_y, out_pixel, camera_parameters, film_back_radius_cm,
-                lens);
+            write_lens_distortion_pixel<DIRECTION, OUT_DATA_STRIDE, OUT_TYPE>(
+                undistort_x[i], undistort_y[i], redistort_x[i], redistort_y[i],
+                out_pixel);
         }
     }
     return;
@@ -328,7 +544,8 @@ void apply_lens_distortion_from_buffer_with_stride(
 
     // Camera and Lens parameters
     const CameraParameters camera_parameters, const double film_back_radius_cm,
-    LENS_TYPE lens) {
+    LENS_TYPE lens, const InverseGuessGrid* guess_grid = nullptr,
+    const SimdLensKernel* simd_kernel = nullptr) {
     if ((in_data_stride == 2) && (out_data_stride == 2)) {
         // The input buffer will be 2D.
         const size_t input_buffer_data_stride = 2;
@@ -341,7 +558,7 @@ void apply_lens_distortion_from_buffer_with_stride(
                                         OUT_TYPE, LENS_TYPE>(
             data_chunk_start, data_chunk_end, in_data_ptr, in_data_size,
             out_data_ptr, out_data_size, camera_parameters, film_back_radius_cm,
-            lens);
+            lens, guess_grid, simd_kernel);
     } else if ((in_data_stride == 2) && (out_data_stride == 4)) {
         // The input buffer will be 2D.
         const size_t input_buffer_data_stride = 2;
@@ -354,7 +571,7 @@ void apply_lens_distortion_from_buffer_with_stride(
                                         OUT_TYPE, LENS_TYPE>(
             data_chunk_start, data_chunk_end, in_data_ptr, in_data_size,
             out_data_ptr, out_data_size, camera_parameters, film_back_radius_cm,
-            lens);
+            lens, guess_grid, simd_kernel);
     } else {
         std::cerr << "apply_lens_distortion_from_buffer_with_stride: "
                   << "Invalid in or out data stride value: "
@@ -365,4 +582,70 @@ void apply_lens_distortion_from_buffer_with_stride(
     return;
 }
 
+// Build an inverse guess grid for 'lens', covering the unit
+// coordinates -0.5 to 1.5 (the film back, with a lot of overscan).
+//
+// Each vertex is computed without a guess, and is only kept if
+// undistorting it again gives back the original point; vertices
+// that did not converge are stored as NaN, and are never used.
+template <class LENS_TYPE>
+std::shared_ptr<const InverseGuessGrid> build_inverse_guess_grid(
+    const CameraParameters camera_parameters, const double film_back_radius_cm,
+    const LENS_TYPE& lens) {
+    const size_t resolution = kInverseGuessGridResolution;
+    const double tolerance = 1e-6;
+    const double nan_value = std::numeric_limits<double>::quiet_NaN();
+
+    const mmdata::Vector2D min_dn = unit_to_diagonal_normalized(
+        camera_parameters, film_back_radius_cm, mmdata::Vector2D(-0.5, -0.5));
+    const mmdata::Vector2D max_dn = unit_to_diagonal_normalized(
+        camera_parameters, film_back_radius_cm, mmdata::Vector2D(1.5, 1.5));
+    const double step_x = (max_dn.x_ - min_dn.x_) / resolution;
+    const double step_y = (max_dn.y_ - min_dn.y_) / resolution;
+
+    std::vector<double> vertex_values((resolution + 1) * (resolution + 1) * 2);
+    for (size_t row = 0; row <= resolution; row++) {
+        for (size_t column = 0; column <= resolution; column++) {
+            const mmdata::Vector2D point_dn(min_dn.x_ + (column * step_x),
+                                            min_dn.y_ + (row * step_y));
+            const mmdata::Vector2D value_dn = lens.eval_inv(point_dn);
+            const mmdata::Vector2D check_dn = lens.eval(value_dn);
+
+            const bool valid =
+                std::isfinite(value_dn.x_) && std::isfinite(value_dn.y_) &&
+                (std::fabs(check_dn.x_ - point_dn.x_) < tolerance) &&
+                (std::fabs(check_dn.y_ - point_dn.y_) < tolerance);
+
+            const size_t index = ((row * (resolution + 1)) + column) * 2;
+            vertex_values[index + 0] = valid ? value_dn.x_ : nan_value;
+            vertex_values[index + 1] = valid ? value_dn.y_ : nan_value;
+        }
+    }
+
+    return std::shared_ptr<const InverseGuessGrid>(
+        new InverseGuessGrid(min_dn.x_, min_dn.y_, step_x, step_y, resolution,
+                             std::move(vertex_values)));
+}
+
+// Build an inverse guess grid for re-distorting 'point_count'
+// points with 'lens', if the cost of building the grid is repaid by
+// the points that use it.
+//
+// The grid is only used for the points of a single call, so the
+// results only depend on the points and values given to the call.
+//
+// Returns null when no grid should be used.
+template <class LENS_TYPE>
+std::shared_ptr<const InverseGuessGrid> get_inverse_guess_grid(
+    const size_t point_count, const CameraParameters camera_parameters,
+    const double film_back_radius_cm, const LENS_TYPE& lens) {
+    const size_t vertex_count = (kInverseGuessGridResolution + 1) *
+                                (kInverseGuessGridResolution + 1);
+    if (point_count < vertex_count) {
+        return nullptr;
+    }
+    return build_inverse_guess_grid<LENS_TYPE>(camera_parameters,
+                                               film_back_radius_cm, lens);
+}
+
 }  // namespace mmlens
@@ -20,8 +20,12 @@
  */
 
 #include <mmcore/mmdata.h>
+#include <mmlens/distortion_guess_grid.h>
+
+#include <memory>
 
 #include "distortion_operations.h"
+#include "distortion_simd_kernel.h"
 #include "distortion_structs.h"
 
 namespace mmlens {
@@ -47,6 +51,22 @@ void apply_identity_impl(const DistortionDirection direction,
     auto distortion = create_distortion<DistortionType>(lens_parameters);
     distortion.initialize_parameters(camera_parameters);
 
+    std::shared_ptr<const InverseGuessGrid> guess_grid;
+    if (direction != DistortionDirection::kUndistort) {
+        const size_t point_count =
+            (image_dimensions.end_width - image_dimensions.start_width) *
+            (image_dimensions.end_height - image_dimensions.start_height);
+        guess_grid = get_inverse_guess_grid<DistortionType>(
+            point_count, camera_parameters, film_back_radius_cm, distortion);
+    }
+
+    // The SIMD kernel is null when the lens cannot be evaluated with
+    // SIMD instructions.
+    SimdLensKernel simd_kernel;
+    const bool use_simd = create_simd_lens_kernel<DistortionType>(
+        camera_parameters, film_back_radius_cm, distortion, simd_kernel);
+    const SimdLensKernel* simd_kernel_ptr = use_simd ? &simd_kernel : nullptr;
+
     if (direction == DistortionDirection::kUndistort) {
         apply_lens_distortion_from_identity_with_stride<
             DistortionDirection::kUndistort, OutType, DistortionType>(
@@ -54,7 +74,7 @@ void apply_identity_impl(const DistortionDirection direction,
             image_dimensions.start_width, image_dimensions.start_height,
             image_dimensions.end_width, image_dimensions.end_height,
             out_data_ptr, out_data_size, out_data_stride, camera_parameters,
-            film_back_radius_cm, distortion);
+            film_back_radius_cm, distortion, guess_grid.get(), simd_kernel_ptr);
     } else if (direction == DistortionDirection::kRedistort) {
         apply_lens_distortion_from_identity_with_stride<
             DistortionDirection::kRedistort, OutType, DistortionType>(
@@ -62,7 +82,7 @@ void apply_identity_impl(const DistortionDirection direction,
             image_dimensions.start_width, image_dimensions.start_height,
             image_dimensions.end_width, image_dimensions.end_height,
             out_data_ptr, out_data_size, out_data_stride, camera_parameters,
-            film_back_radius_cm, distortion);
+            film_back_radius_cm, distortion, guess_grid.get(), simd_kernel_ptr);
     } else if (direction == DistortionDirection::kUndistortAndRedistort) {
         apply_lens_distortion_from_identity_with_stride<
             DistortionDirection::kUndistortAndRedistort, OutType,
@@ -71,7 +91,7 @@ void apply_identity_impl(const DistortionDirection direction,
             image_dimensions.start_width, image_dimensions.start_height,
             image_dimensions.end_width, image_dimensions.end_height,
             out_data_ptr, out_data_size, out_data_stride, camera_parameters,
-            film_back_radius_cm, distortion);
+            film_back_radius_cm, distortion, guess_grid.get(), simd_kernel_ptr);
     }
 }
 
@@ -100,19 +120,35 @@ void apply_buffer_impl(const DistortionDirection direction,
     auto distortion = create_distortion<DistortionType>(lens_parameters);
     distortion.initialize_parameters(camera_parameters);
 
+    std::shared_ptr<const InverseGuessGrid> guess_grid;
+    if (direction != DistortionDirection::kUndistort) {
+        const size_t point_count = data_chunk_end - data_chunk_start;
+        guess_grid = get_inverse_guess_grid<DistortionType>(
+            point_count, camera_parameters, film_back_radius_cm, distortion);
+    }
+
+    // The SIMD kernel is null when the lens cannot be evaluated with
+    // SIMD instructions.
+    SimdLensKernel simd_kernel;
+    const bool use_simd = create_simd_lens_kernel<DistortionType>(
+        camera_parameters, film_back_radius_cm, distortion, simd_kernel);
+    const SimdLensKernel* simd_kernel_ptr = use_simd ? &simd_kernel : nullptr;
+
     if (direction == DistortionDirection::kUndistort) {
         apply_lens_distortion_from_buffer_with_stride<
             DistortionDirection::kUndistort, InType, OutType, DistortionType>(
             data_chunk_start, data_chunk_end, in_data_ptr, in_data_size,
             in_data_stride, out_data_ptr, out_data_size, out_data_stride,
-            camera_parameters, film_back_radius_cm, distortion);
+            camera_parameters, film_back_radius_cm, distortion,
+            guess_grid.get(), simd_kernel_ptr);
 
     } else if (direction == DistortionDirection::kRedistort) {
         apply_lens_distortion_from_buffer_with_stride<
             DistortionDirection::kRedistort, InType, OutType, DistortionType>(
             data_chunk_start, data_chunk_end, in_data_ptr, in_data_size,
             in_data_stride, out_data_ptr, out_data_size, out_data_stride,
-            camera_parameters, film_back_radius_cm, distortion);
+            camera_parameters, film_back_radius_cm, distortion,
+            guess_grid.get(), simd_kernel_ptr);
 
     } else if (direction == DistortionDirection::kUndistortAndRedistort) {
         apply_lens_distortion_from_buffer_with_stride<
@@ -120,7 +156,8 @@ void apply_buffer_impl(const DistortionDirection direction,
             DistortionType>(data_chunk_start, data_chunk_end, in_data_ptr,
                             in_data_size, in_data_stride, out_data_ptr,
                             out_data_size, out_data_stride, camera_parameters,
-                            film_back_radius_cm, distortion);
+                            film_back_radius_cm, distortion,
+                            guess_grid.get(), simd_kernel_ptr);
     }
 }
 
@@ -19,6 +19,7 @@
 //
 
 use rayon::prelude::*;
+use std::sync::atomic::{AtomicUsize, Ordering};
 
 use crate::cxxbridge::ffi::CameraParameters as BindCameraParameters;
 use crate::cxxbridge::ffi::DistortionDirection as BindDistortionDirection;
@@ -81,13 +82,138 @@ pub fn initialize_global_thread_pool(num_threads: i32) -> i32 {
     }
 }
 
+// The smallest and largest size (in pixels) of a square tile chosen
+// automatically.
+//
+// Tiles smaller than this spend more time in per-task setup (such as
+// creating the lens distortion kernel) than computing pixels. Tiles
+// larger than this stop the work from being spread evenly across
+// threads.
+const MIN_AUTOMATIC_TILE_SIZE: usize = 16;
+const MAX_AUTOMATIC_TILE_SIZE: usize = 512;
+
+// The number of tasks to aim for, per-thread.
+//
+// The cost per-pixel is not the same across the image; re-distortion
+// needs more iterations near the edges of the image than the centre.
+// Creating more tasks than threads lets a thread that finishes early
+// take another task, rather than waiting for the slowest thread.
+const TASKS_PER_THREAD: usize = 8;
+
+// The tile size set by the user. Zero means the tile size is
+// calculated automatically, from the image size and thread count.
+static PARALLEL_TILE_WIDTH: AtomicUsize = AtomicUsize::new(0);
+static PARALLEL_TILE_HEIGHT: AtomicUsize = AtomicUsize::new(0);
+
+/// Set the size (in pixels) of the tiles processed by each parallel
+/// task in the 'apply_*_multithread' functions.
+///
+/// Use zero for either value to calculate the tile size
+/// automatically (the default).
+pub fn set_parallel_tile_size(tile_width: usize, tile_height: usize) {
+    PARALLEL_TILE_WIDTH.store(tile_width, Ordering::Relaxed);
+    PARALLEL_TILE_HEIGHT.store(tile_height, Ordering::Relaxed);
+}
+
+pub fn get_parallel_tile_width() -> usize {
+    PARALLEL_TILE_WIDTH.load(Ordering::Relaxed)
+}
+
+pub fn get_parallel_tile_height() -> usize {
+    PARALLEL_TILE_HEIGHT.load(Ordering::Relaxed)
+}
+
+/// The number of pixels in each parallel task, when the tile size is
+/// calculated automatically.
+fn automatic_tile_pixel_count(pixel_count: usize) -> usize {
+    let task_count =
+        std::cmp::max(1, rayon::current_num_threads() * TASKS_PER_THREAD);
+    let tile_pixel_count = pixel_count / task_count;
+    tile_pixel_count.clamp(
+        MIN_AUTOMATIC_TILE_SIZE * MIN_AUTOMATIC_TILE_SIZE,
+        MAX_AUTOMATIC_TILE_SIZE * MAX_AUTOMATIC_TILE_SIZE,
+    )
+}
+
+/// The width and height of the tiles used to split an image into
+/// parallel tasks.
+fn parallel_tile_size(
+    image_width: usize,
+    image_height: usize,
+) -> (usize, usize) {
+    let tile_width = get_parallel_tile_width();
+    let tile_height = get_parallel_tile_height();
+    let (tile_width, tile_height) = if tile_width > 0 && tile_height > 0 {
+        (tile_width, tile_height)
+    } else {
+        let tile_pixel_count =
+            automatic_tile_pixel_count(image_width * image_height);
+        let tile_size = (tile_pixel_count as f64).sqrt() as usize;
+        (tile_size, tile_size)
+    };
+    (
+        tile_width.clamp(1, std::cmp::max(1, image_width)),
+        tile_height.clamp(1, std::cmp::max(1, image_height)),
+    )
+}
+
+/// The number of pixels processed by each parallel task, for
+/// buffers with no 2D image layout.
+fn parallel_span_pixel_count(pixel_count: usize) -> usize {
+    let tile_width = get_parallel_tile_width();
+    let tile_height = get_parallel_tile_height();
+    let span_pixel_count = if tile_width > 0 && tile_height > 0 {
+        tile_width * tile_height
+    } else {
+        automatic_tile_pixel_count(pixel_count)
+    };
+    span_pixel_count.clamp(1, std::cmp::max(1, pixel_count))
+}
+
+/// A rectangular region of an image, processed by a single parallel
+/// task. The 'end' values are exclusive.
+#[derive(Debug, Copy, Clone)]
+struct ImageTile {
+    start_x: usize,
+    start_y: usize,
+    end_x: usize,
+    end_y: usize,
+}
+
+/// Split an image into tiles, in row-major order. The tiles on the
+/// right and bottom edges may be smaller than the given tile size.
+fn image_tiles(
+    image_width: usize,
+    image_height: usize,
+    tile_width: usize,
+    tile_height: usize,
+) -> Vec<ImageTile> {
+    let tile_count_x = (image_width + tile_width - 1) / tile_width;
+    let tile_count_y = (image_height + tile_height - 1) / tile_height;
+    let mut tiles = Vec::with_capacity(tile_count_x * tile_count_y);
+    for start_y in (0..image_height).step_by(tile_height) {
+        let end_y = std::cmp::min(start_y + tile_height, image_height);
+        for start_x in (0..image_width).step_by(tile_width) {
+            let end_x = std::cmp::min(start_x + tile_width, image_width);
+            tiles.push(ImageTile {
+                start_x,
+                start_y,
+                end_x,
+                end_y,
+            });
+        }
+    }
+    tiles
+}
+
 fn apply_identity_func<
     OutType: Copy + Send + Sync,
     LensParameter: Copy + Sized + Send + Sync,
 >(
     direction: BindDistortionDirection,
     image_dimensions: BindImageDimensions,
-    out_data: &mut [OutType],
+    out_data_ptr: *mut OutType,
+    out_data_size: usize,
     out_data_stride: usize,
     camera_parameters: BindCameraParameters,
     film_back_radius_cm: f64,
@@ -107,9 +233,6 @@ fn apply_identity_func<
         LensParameter,
     ),
 ) {
-    let out_data_ptr = out_data.as_mut_ptr();
-    let out_data_size = out_data.len();
-
     // SAFETY: This is a C++ function needing to be called as
     // 'unsafe'. We hope/assume that our C++ code stays within the
     // memory bounds given.
@@ -155,110 +278,50 @@ fn apply_identity_multithread<
         LensParameter,
     ),
 ) {
-    // SAFETY: Reconstructs the original slice from the
-    // pointer/size. We assume the values given are good.
-    let out_data =
-        unsafe { std::slice::from_raw_parts_mut(out_data_ptr, out_data_size) };
-    let out_data_ptr_num = out_data_ptr as usize;
-
-    // Number of scanlines to process at once.
-    let parallel_scanlines: usize = 1;
-
-    let chunk_size = std::cmp::min(
-        out_data_size,
-        image_width * num_channels * parallel_scanlines,
-    );
-    let remainder_count = out_data_size % chunk_size;
-    out_data
-        .par_chunks_exact_mut(chunk_size)
-        .for_each(|out_data_chunk| {
-            // Without this workaround we might need to use
-            // 'rayon::iter::split()', but that seemed slightly less
-            // performant and a little complicated.
-            let out_data_chunk_ptr = out_data_chunk.as_ptr();
-            let image_height_offset = (out_data_chunk_ptr as usize
-                - out_data_ptr_num)
-                / (core::mem::size_of::<OutType>() * chunk_size);
-
-            let start_image_width = 0;
-            let start_image_height = image_height_offset * parallel_scanlines;
-            let end_image_width = image_width;
-            let end_image_height = start_image_height + parallel_scanlines;
-
-            let image_dimensions = BindImageDimensions {
-                width: image_width,
-                height: image_height,
-                start_width: start_image_width,
-                start_height: start_image_height,
-                end_width: end_image_width,
-                end_height: end_image_height,
-            };
-
-            apply_identity_func(
-                direction,
-                image_dimensions,
-                out_data_chunk,
-                num_channels, // out_data_stride
-                camera_parameters,
-                film_back_radius_cm,
-                lens_parameters,
-                func,
-            );
-        });
+    let (tile_width, tile_height) =
+        parallel_tile_size(image_width, image_height);
+    let tiles = image_tiles(image_width, image_height, tile_width, tile_height);
 
-    // Process the remaining elements
-    if remainder_count > 0 {
-        let remainder_rows = remainder_count / image_width;
+    // Raw pointers cannot be shared between threads, so the address
+    // is shared instead. Each tile writes to a different set of
+    // pixels, so no two tasks write to the same memory.
+    let out_data_ptr_num = out_data_ptr as usize;
 
-        let start_image_width = 0;
-        let start_image_height = image_height - remainder_rows;
-        let end_image_width = image_width;
-        let end_image_height = image_height;
+    tiles.par_iter().for_each(|tile| {
+        // The C++ function indexes the output from the first pixel
+        // of the tile, with rows the full image width apart.
+        let out_data_offset =
+            ((tile.start_y * image_width) + tile.start_x) * num_channels;
+        if out_data_offset >= out_data_size {
+            return;
+        }
+        let tile_out_data_ptr =
+            (out_data_ptr_num as *mut OutType).wrapping_add(out_data_offset);
+        let tile_out_data_size = out_data_size - out_data_offset;
 
         let image_dimensions = BindImageDimensions {
             width: image_width,
             height: image_height,
-            start_width: start_image_width,
-            start_height: start_image_height,
-            end_width: end_image_width,
-            end_height: end_image_height,
+            start_width: tile.start_x,
+            start_height: tile.start_y,
+            end_width: tile.end_x,
+            end_height: tile.end_y,
         };
 
         apply_identity_func(
             direction,
             image_dimensions,
-            out_data,
-            num_channels,
+            tile_out_data_ptr,
+            tile_out_data_size,
+            num_channels, // out_data_stride
             camera_parameters,
             film_back_radius_cm,
             lens_parameters,
             func,
         );
-    }
+    });
 }
 
-// "Most" CPUs have a cache line of 64 bytes.
-const CPU_CACHE_LINE_NUM_BYTES: usize = 64;
-
-// Number of pixels per CPU cache line.
-const CPU_CACHE_LINE_PIXEL_COUNT: usize =
-    CPU_CACHE_LINE_NUM_BYTES / std::mem::size_of::<f64>();
-
-// Each parallel task will work on 64 cache lines in a single "task".
-//
-// This means each task will use 4KB (64 * 64 bytes = 4096 bytes),
-// which is about 1/8th of the "average" CPU's L1 cache size (32KB
-// per-CPU core).
-//
-// We probably shouldn't use all of the CPU cache. The operating
-// system is running other software on those cores. If we max-out the
-// L1 cache then the CPU will be forced to flush our all our data when
-// another process wants to run.
-//
-// TODO: Do tests to confirm if 64 is a reasonable number of cache
-// lines to use for maximum performance.
-const NUM_CACHE_LINES_PER_TASK: usize = 64;
-
 fn apply_buffer_func<
     InType: Copy + Send + Sync,
     OutType: Copy + Send + Sync,
@@ -375,34 +438,19 @@ fn apply_buffer_multithread<
         unsafe { std::slice::from_raw_parts(in_data_ptr, in_data_size) };
     let out_data =
         unsafe { std::slice::from_raw_parts_mut(out_data_ptr, out_data_size) };
-    let out_data_ptr_num = out_data_ptr as usize;
 
-    let reasonable_chunk_size = (CPU_CACHE_LINE_PIXEL_COUNT / out_data_stride)
-        * NUM_CACHE_LINES_PER_TASK;
-    let chunk_size = if reasonable_chunk_size > out_data_size {
-        out_data_size
-    } else {
-        reasonable_chunk_size
-    };
-    let remainder_count = out_data_size % chunk_size;
-
-    out_data
-        .par_chunks_exact_mut(chunk_size)
-        .for_each(|out_data_chunk| {
-            // This hack is extremely important to calculating the
-            // correct sub-window into the buffer data given only the
-            // new and original pointer. This feels kind of dirty.
-            // Without this workaround we might need to use
-            // 'rayon::iter::split()', but that seemed slightly less
-            // performant and a little complicated.
-            let out_data_chunk_ptr = out_data_chunk.as_mut_ptr();
-            let data_chunk_offset = (out_data_chunk_ptr as usize
-                - out_data_ptr_num)
-                / (core::mem::size_of::<OutType>() * chunk_size);
-
-            let chunk_pixel_count = chunk_size / out_data_stride;
-            let pixel_num_start = data_chunk_offset * chunk_pixel_count;
-            let pixel_num_end = pixel_num_start + chunk_pixel_count;
+    // Buffers have no 2D image layout, so each parallel task is a
+    // span of consecutive pixels, with the same pixel count as a
+    // tile.
+    let pixel_count = out_data_size / out_data_stride;
+    let span_pixel_count = parallel_span_pixel_count(pixel_count);
+    let chunk_size = span_pixel_count * out_data_stride;
+
+    out_data.par_chunks_mut(chunk_size).enumerate().for_each(
+        |(chunk_index, out_data_chunk)| {
+            let pixel_num_start = chunk_index * span_pixel_count;
+            let pixel_num_end =
+                pixel_num_start + (out_data_chunk.len() / out_data_stride);
 
             apply_buffer_func(
                 direction,
@@ -417,29 +465,8 @@ fn apply_buffer_multithread<
                 lens_parameters,
                 func,
             );
-        });
-
-    // Process the remaining elements
-    if remainder_count > 0 {
-        let pixel_num_start =
-            (out_data_size - remainder_count) / out_data_stride;
-        let pixel_num_end = out_data_size / out_data_stride;
-        let out_data_start = pixel_num_start * out_data_stride;
-        let out_data_chunk = &mut out_data[out_data_start..];
-        apply_buffer_func(
-            direction,
-            pixel_num_start,
-            pixel_num_end,
-            in_data,
-            in_data_stride,
-            out_data_chunk,
-            out_data_stride,
-            camera_parameters,
-            film_back_radius_cm,
-            lens_parameters,
-            func,
-        );
-    }
+        },
+    );
 }
 
 // This macro is used to reduce code-repetition of calling various
@@ -0,0 +1,224 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include <mmlens/distortion_simd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+#include "distortion_simd_kernel.h"
+
+#define MM_LENS_SIMD_LANES_NAMESPACE simd_lanes_default
+#include "distortion_simd_lanes.h"
+
+namespace mmlens {
+
+namespace {
+
+// The current SIMD level, or -1 if it has not been detected yet.
+std::atomic<int> g_simd_level(-1);
+
+bool detect_avx2() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool has_os_xsave = (info[2] & (1 << 27)) != 0;
+    const bool has_avx = (info[2] & (1 << 28)) != 0;
+    if (!has_os_xsave || !has_avx) {
+        return false;
+    }
+    // The operating system must save the YMM registers.
+    if ((_xgetbv(0) & 0x6) != 0x6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#else
+    return false;
+#endif
+}
+
+bool invert_matrix(const double* matrix, double* out_matrix) {
+    const double determinant =
+        (matrix[0] * matrix[3]) - (matrix[1] * matrix[2]);
+    if (!std::isfinite(determinant) || (determinant == 0.0)) {
+        return false;
+    }
+    const double inverse_determinant = 1.0 / determinant;
+    out_matrix[0] = matrix[3] * inverse_determinant;
+    out_matrix[1] = -matrix[1] * inverse_determinant;
+    out_matrix[2] = -matrix[2] * inverse_determinant;
+    out_matrix[3] = matrix[0] * inverse_determinant;
+    return true;
+}
+
+}  // namespace
+
+SimdLevel detect_simd_level() {
+    if (detect_avx2() && simd_avx2_compiled()) {
+        return SimdLevel::kVector256;
+    }
+#if defined(__x86_64__) || defined(_M_X64) || defined(__aarch64__) || \
+    defined(_M_ARM64)
+    // SSE2 and NEON are always available on 64-bit x86 and ARM.
+    return SimdLevel::kVector128;
+#else
+    return SimdLevel::kScalar;
+#endif
+}
+
+void set_simd_level(const SimdLevel value) {
+    const int level = std::min(static_cast<int>(value),
+                               static_cast<int>(detect_simd_level()));
+    g_simd_level.store(level);
+}
+
+SimdLevel get_simd_level() {
+    int level = g_simd_level.load();
+    if (level < 0) {
+        level = static_cast<int>(detect_simd_level());
+        g_simd_level.store(level);
+    }
+    return static_cast<SimdLevel>(level);
+}
+
+size_t simd_level_width(const SimdLevel value) {
+    if (value == SimdLevel::kVector256) {
+        return 4;
+    } else if (value == SimdLevel::kVector128) {
+        return 2;
+    }
+    return 1;
+}
+
+void simd_kernel_reset(const SimdPolynomial polynomial,
+                       SimdLensKernel& out_kernel) {
+    out_kernel.polynomial = polynomial;
+    for (size_t i = 0; i < 2; i++) {
+        out_kernel.unit_to_dn_scale[i] = 1.0;
+        out_kernel.unit_to_dn_offset[i] = 0.0;
+        out_kernel.dn_to_unit_scale[i] = 1.0;
+        out_kernel.dn_to_unit_offset[i] = 0.0;
+    }
+    const double identity[4] = {1.0, 0.0, 0.0, 1.0};
+    for (size_t i = 0; i < 4; i++) {
+        out_kernel.pre_matrix[i] = identity[i];
+        out_kernel.post_matrix[i] = identity[i];
+        out_kernel.pre_matrix_inverse[i] = identity[i];
+        out_kernel.post_matrix_inverse[i] = identity[i];
+    }
+    for (size_t i = 0; i < kSimdCoefficientCount; i++) {
+        out_kernel.coefficients_x[i] = 0.0;
+        out_kernel.coefficients_y[i] = 0.0;
+    }
+}
+
+bool simd_kernel_finalize(const CameraParameters camera_parameters,
+                          const double film_back_radius_cm,
+                          SimdLensKernel& kernel) {
+    const double w_fb_cm = camera_parameters.film_back_width_cm;
+    const double h_fb_cm = camera_parameters.film_back_height_cm;
+    const double x_lco_cm = camera_parameters.lens_center_offset_x_cm;
+    const double y_lco_cm = camera_parameters.lens_center_offset_y_cm;
+    if ((w_fb_cm == 0.0) || (h_fb_cm == 0.0) || (film_back_radius_cm == 0.0)) {
+        return false;
+    }
+
+    // Matches 'unit_to_diagonal_normalized()' and
+    // 'diagonal_normalized_to_unit()'.
+    kernel.unit_to_dn_scale[0] = w_fb_cm / film_back_radius_cm;
+    kernel.unit_to_dn_scale[1] = h_fb_cm / film_back_radius_cm;
+    kernel.unit_to_dn_offset[0] =
+        ((-0.5 * w_fb_cm) - x_lco_cm) / film_back_radius_cm;
+    kernel.unit_to_dn_offset[1] =
+        ((-0.5 * h_fb_cm) - y_lco_cm) / film_back_radius_cm;
+    kernel.dn_to_unit_scale[0] = film_back_radius_cm / w_fb_cm;
+    kernel.dn_to_unit_scale[1] = film_back_radius_cm / h_fb_cm;
+    kernel.dn_to_unit_offset[0] = 0.5 + (x_lco_cm / w_fb_cm);
+    kernel.dn_to_unit_offset[1] = 0.5 + (y_lco_cm / h_fb_cm);
+
+    if (!invert_matrix(kernel.pre_matrix, kernel.pre_matrix_inverse)) {
+        return false;
+    }
+    if (!invert_matrix(kernel.post_matrix, kernel.post_matrix_inverse)) {
+        return false;
+    }
+    for (size_t i = 0; i < kSimdCoefficientCount; i++) {
+        if (!std::isfinite(kernel.coefficients_x[i]) ||
+            !std::isfinite(kernel.coefficients_y[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void simd_undistort_points(const SimdLensKernel& kernel, const double* in_x,
+                           const double* in_y, const size_t count,
+                           double* out_x, double* out_y) {
+    const SimdLevel level = get_simd_level();
+    if (level == SimdLevel::kVector256) {
+        simd_undistort_points_avx2(kernel, in_x, in_y, count, out_x, out_y);
+    } else if (level == SimdLevel::kVector128) {
+        simd_lanes_default::simd_undistort_points_width<2>(
+            kernel, in_x, in_y, count, out_x, out_y);
+    } else {
+        simd_lanes_default::simd_undistort_points_width<1>(
+            kernel, in_x, in_y, count, out_x, out_y);
+    }
+}
+
+void simd_redistort_points(const SimdLensKernel& kernel, const double* in_x,
+                           const double* in_y, const double* guess_x,
+                           const double* guess_y, const size_t count,
+                           double* out_x, double* out_y,
+                           uint8_t* out_converged) {
+    const SimdLevel level = get_simd_level();
+    if (level == SimdLevel::kVector256) {
+        simd_redistort_points_avx2(kernel, in_x, in_y, guess_x, guess_y, count,
+                                   out_x, out_y, out_converged);
+    } else if (level == SimdLevel::kVector128) {
+        simd_lanes_default::simd_redistort_points_width<2>(
+            kernel, in_x, in_y, guess_x, guess_y, count, out_x, out_y,
+            out_converged);
+    } else {
+        simd_lanes_default::simd_redistort_points_width<1>(
+            kernel, in_x, in_y, guess_x, guess_y, count, out_x, out_y,
+            out_converged);
+    }
+}
+
+}  // namespace mmlens
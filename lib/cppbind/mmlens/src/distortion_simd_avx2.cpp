@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+// This file is compiled with AVX2 instructions enabled (see
+// 'lib/mmsolverlibs/src/CMakeLists.txt').
+
+#include <cstddef>
+#include <cstdint>
+
+#include "distortion_simd_kernel.h"
+
+#define MM_LENS_SIMD_LANES_NAMESPACE simd_lanes_avx2
+#include "distortion_simd_lanes.h"
+
+namespace mmlens {
+
+bool simd_avx2_compiled() {
+#if defined(__AVX2__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+void simd_undistort_points_avx2(const SimdLensKernel& kernel,
+                                const double* in_x, const double* in_y,
+                                const size_t count, double* out_x,
+                                double* out_y) {
+    simd_lanes_avx2::simd_undistort_points_width<4>(kernel, in_x, in_y, count,
+                                                    out_x, out_y);
+}
+
+void simd_redistort_points_avx2(const SimdLensKernel& kernel,
+                                const double* in_x, const double* in_y,
+                                const double* guess_x, const double* guess_y,
+                                const size_t count, double* out_x,
+                                double* out_y, uint8_t* out_converged) {
+    simd_lanes_avx2::simd_redistort_points_width<4>(
+        kernel, in_x, in_y, guess_x, guess_y, count, out_x, out_y,
+        out_converged);
+}
+
+}  // namespace mmlens
@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Vectorised (SIMD) evaluation of the 3DE lens distortion models.
+ *
+ * The 3DE models supported here are all made of a 2x2 matrix (lens
+ * rotation, squeeze, pixel aspect and cylindric bending), a
+ * polynomial, and another 2x2 matrix. A 'SimdLensKernel' stores
+ * those terms as plain arrays so that many points can be evaluated
+ * with the same instructions, without calling into LDPK per point.
+ *
+ * Kernels are built from a Distortion class (see
+ * 'Distortion::simd_kernel()') and are checked against the LDPK
+ * evaluation before use (see 'create_simd_lens_kernel()').
+ */
+
+#ifndef MM_LENS_DISTORTION_SIMD_KERNEL_H
+#define MM_LENS_DISTORTION_SIMD_KERNEL_H
+
+#include <mmlens/_cxxbridge.h>
+#include <mmlens/distortion_simd.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mmlens {
+
+// The number of points processed (on the stack) at once by the
+// batched lens distortion functions.
+const size_t kSimdChunkSize = 256;
+
+// The number of polynomial coefficients for each axis.
+const size_t kSimdCoefficientCount = 9;
+
+// The maximum number of Newton iterations used to re-distort points.
+// Points that have not converged are re-distorted with LDPK.
+const int kSimdRedistortMaxIterations = 20;
+
+// Re-distorted points have converged when the undistorted value is
+// within this distance (diagonally normalized) of the input point.
+const double kSimdRedistortTolerance = 1e-12;
+
+enum class SimdPolynomial : uint8_t {
+    // Each axis is multiplied by a polynomial of 'X = x^2' and
+    // 'Y = y^2' (3DE Classic and Anamorphic models). The
+    // coefficients are ordered; X, Y, X^2, XY, Y^2, X^3, X^2Y, XY^2,
+    // Y^3.
+    kEven = 0,
+
+    // The 3DE Radial Decentered model. The first 6 X coefficients
+    // are; degree 2 distortion, degree 2 U, degree 2 V, degree 4
+    // distortion, degree 4 U and degree 4 V.
+    kRadialDecentered = 1,
+};
+
+// Undistorting a unit coordinate (0.0 to 1.0) is:
+//
+//   dn = unit * unit_to_dn_scale + unit_to_dn_offset
+//   undistorted_dn = post_matrix * polynomial(pre_matrix * dn)
+//   out = undistorted_dn * dn_to_unit_scale + dn_to_unit_offset
+//
+// Matrices are 2x2, stored in row-major order.
+struct SimdLensKernel {
+    SimdPolynomial polynomial;
+
+    double unit_to_dn_scale[2];
+    double unit_to_dn_offset[2];
+    double dn_to_unit_scale[2];
+    double dn_to_unit_offset[2];
+
+    double pre_matrix[4];
+    double post_matrix[4];
+    double pre_matrix_inverse[4];
+    double post_matrix_inverse[4];
+
+    double coefficients_x[kSimdCoefficientCount];
+    double coefficients_y[kSimdCoefficientCount];
+};
+
+// Reset 'out_kernel' to an identity transform, with all polynomial
+// coefficients set to zero.
+void simd_kernel_reset(const SimdPolynomial polynomial,
+                       SimdLensKernel& out_kernel);
+
+// Compute the matrix inverses and the unit coordinate conversions of
+// 'kernel'.
+//
+// Returns false if the kernel cannot be used, for example when a
+// matrix cannot be inverted.
+bool simd_kernel_finalize(const CameraParameters camera_parameters,
+                          const double film_back_radius_cm,
+                          SimdLensKernel& kernel);
+
+// Undistort 'count' unit coordinates with the current SIMD level.
+//
+// The in and out arrays may be the same pointers.
+void simd_undistort_points(const SimdLensKernel& kernel, const double* in_x,
+                           const double* in_y, const size_t count,
+                           double* out_x, double* out_y);
+
+// Re-distort 'count' unit coordinates with the current SIMD level.
+//
+// 'guess_x' and 'guess_y' are optional (may be null) initial guesses
+// in diagonally normalized coordinates, NaN values are ignored.
+//
+// 'out_converged' is set to 0 for each point that did not converge,
+// those points must be re-distorted another way. The in and out
+// arrays may be the same pointers.
+void simd_redistort_points(const SimdLensKernel& kernel, const double* in_x,
+                           const double* in_y, const double* guess_x,
+                           const double* guess_y, const size_t count,
+                           double* out_x, double* out_y,
+                           uint8_t* out_converged);
+
+// The 256-bit (4 points at once) kernels, compiled separately with
+// AVX2 instructions enabled. Only call these when the CPU supports
+// AVX2.
+bool simd_avx2_compiled();
+void simd_undistort_points_avx2(const SimdLensKernel& kernel,
+                                const double* in_x, const double* in_y,
+                                const size_t count, double* out_x,
+                                double* out_y);
+void simd_redistort_points_avx2(const SimdLensKernel& kernel,
+                                const double* in_x, const double* in_y,
+                                const double* guess_x, const double* guess_y,
+                                const size_t count, double* out_x,
+                                double* out_y, uint8_t* out_converged);
+
+}  // namespace mmlens
+
+#endif  // MM_LENS_DISTORTION_SIMD_KERNEL_H
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Fixed-width lens distortion kernels, evaluating 'WIDTH' points at
+ * once.
+ *
+ * Each lane loop has a fixed trip count and no dependencies between
+ * lanes, so the compiler can map the lanes onto vector registers of
+ * the instruction set the including file is compiled for.
+ *
+ * IMPORTANT: This file is compiled with different instruction sets
+ * (see 'distortion_simd_avx2.cpp'), so the including file must
+ * define 'MM_LENS_SIMD_LANES_NAMESPACE' to a name unique to its
+ * instruction set. Everything here is declared in that namespace,
+ * with internal linkage (unnamed namespace), and no inline functions
+ * with external linkage (such as 'std::isfinite') are called. If the
+ * linker could merge the same function from both files, an AVX2
+ * instantiation could run on CPUs without AVX2.
+ */
+
+#ifndef MM_LENS_DISTORTION_SIMD_LANES_H
+#define MM_LENS_DISTORTION_SIMD_LANES_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "distortion_simd_kernel.h"
+
+#ifndef MM_LENS_SIMD_LANES_NAMESPACE
+#error "MM_LENS_SIMD_LANES_NAMESPACE must be defined."
+#endif
+
+namespace mmlens {
+namespace MM_LENS_SIMD_LANES_NAMESPACE {
+namespace {
+
+inline bool simd_is_finite(const double value) {
+    // NaN and infinity give NaN, which is not equal to zero.
+    return (value - value) == 0.0;
+}
+
+inline double simd_abs(const double value) {
+    return (value < 0.0) ? -value : value;
+}
+
+inline void simd_matrix_multiply(const double* matrix, const double x,
+                                 const double y, double& out_x,
+                                 double& out_y) {
+    out_x = (matrix[0] * x) + (matrix[1] * y);
+    out_y = (matrix[2] * x) + (matrix[3] * y);
+}
+
+// Evaluate the (undistorting) polynomial of 'kernel' at x and y.
+inline void simd_polynomial(const SimdLensKernel& kernel, const double x,
+                            const double y, double& out_x, double& out_y) {
+    const double* cx = kernel.coefficients_x;
+    const double* cy = kernel.coefficients_y;
+    const double xx = x * x;
+    const double yy = y * y;
+    if (kernel.polynomial == SimdPolynomial::kEven) {
+        const double xy = xx * yy;
+        const double px = 1.0 + (xx * (cx[0] + (xx * (cx[2] + (xx * cx[5]))))) +
+                          (yy * (cx[1] + (yy * (cx[4] + (yy * cx[8]))))) +
+                          (xy * (cx[3] + (xx * cx[6]) + (yy * cx[7])));
+        const double py = 1.0 + (xx * (cy[0] + (xx * (cy[2] + (xx * cy[5]))))) +
+                          (yy * (cy[1] + (yy * (cy[4] + (yy * cy[8]))))) +
+                          (xy * (cy[3] + (xx * cy[6]) + (yy * cy[7])));
+        out_x = x * px;
+        out_y = y * py;
+    } else {
+        const double r2 = xx + yy;
+        const double q = 1.0 + (r2 * (cx[0] + (r2 * cx[3])));
+        const double u = cx[1] + (cx[4] * r2);
+        const double v = cx[2] + (cx[5] * r2);
+        const double xy2 = 2.0 * x * y;
+        out_x = (x * q) + ((r2 + (2.0 * xx)) * u) + (xy2 * v);
+        out_y = (y * q) + ((r2 + (2.0 * yy)) * v) + (xy2 * u);
+    }
+}
+
+// Evaluate the polynomial of 'kernel' at x and y, with the partial
+// derivatives (Jacobian matrix, row-major).
+inline void simd_polynomial_with_jacobian(const SimdLensKernel& kernel,
+                                          const double x, const double y,
+                                          double& out_x, double& out_y,
+                                          double* out_jacobian) {
+    const double* cx = kernel.coefficients_x;
+    const double* cy = kernel.coefficients_y;
+    const double xx = x * x;
+    const double yy = y * y;
+    if (kernel.polynomial == SimdPolynomial::kEven) {
+        const double xy = xx * yy;
+        const double px = 1.0 + (xx * (cx[0] + (xx * (cx[2] + (xx * cx[5]))))) +
+                          (yy * (cx[1] + (yy * (cx[4] + (yy * cx[8]))))) +
+                          (xy * (cx[3] + (xx * cx[6]) + (yy * cx[7])));
+        const double py = 1.0 + (xx * (cy[0] + (xx * (cy[2] + (xx * cy[5]))))) +
+                          (yy * (cy[1] + (yy * (cy[4] + (yy * cy[8]))))) +
+                          (xy * (cy[3] + (xx * cy[6]) + (yy * cy[7])));
+
+        // Derivatives of the polynomials with respect to 'X = x^2'
+        // and 'Y = y^2'.
+        const double dpx_dxx = cx[0] + (2.0 * cx[2] * xx) + (cx[3] * yy) +
+                               (3.0 * cx[5] * xx * xx) + (2.0 * cx[6] * xy) +
+                               (cx[7] * yy * yy);
+        const double dpx_dyy = cx[1] + (cx[3] * xx) + (2.0 * cx[4] * yy) +
+                               (cx[6] * xx * xx) + (2.0 * cx[7] * xy) +
+                               (3.0 * cx[8] * yy * yy);
+        const double dpy_dxx = cy[0] + (2.0 * cy[2] * xx) + (cy[3] * yy) +
+                               (3.0 * cy[5] * xx * xx) + (2.0 * cy[6] * xy) +
+                               (cy[7] * yy * yy);
+        const double dpy_dyy = cy[1] + (cy[3] * xx) + (2.0 * cy[4] * yy) +
+                               (cy[6] * xx * xx) + (2.0 * cy[7] * xy) +
+                               (3.0 * cy[8] * yy * yy);
+
+        const double xy2 = 2.0 * x * y;
+        out_x = x * px;
+        out_y = y * py;
+        out_jacobian[0] = px + (2.0 * xx * dpx_dxx);
+        out_jacobian[1] = xy2 * dpx_dyy;
+        out_jacobian[2] = xy2 * dpy_dxx;
+        out_jacobian[3] = py + (2.0 * yy * dpy_dyy);
+    } else {
+        const double r2 = xx + yy;
+        const double q = 1.0 + (r2 * (cx[0] + (r2 * cx[3])));
+        const double u = cx[1] + (cx[4] * r2);
+        const double v = cx[2] + (cx[5] * r2);
+        const double xy2 = 2.0 * x * y;
+        const double rx = r2 + (2.0 * xx);
+        const double ry = r2 + (2.0 * yy);
+        out_x = (x * q) + (rx * u) + (xy2 * v);
+        out_y = (y * q) + (ry * v) + (xy2 * u);
+
+        // 'dq' is the derivative of 'q' with respect to x, divided
+        // by x (and the same for y).
+        const double dq = 2.0 * (cx[0] + (2.0 * cx[3] * r2));
+        const double xy_dq = x * y * dq;
+        out_jacobian[0] = q + (xx * dq) + (6.0 * x * u) +
+                          (2.0 * x * cx[4] * rx) + (2.0 * y * v) +
+                          (4.0 * xx * y * cx[5]);
+        out_jacobian[1] = xy_dq + (2.0 * y * u) + (2.0 * y * cx[4] * rx) +
+                          (2.0 * x * v) + (4.0 * x * yy * cx[5]);
+        out_jacobian[2] = xy_dq + (2.0 * x * v) + (2.0 * x * cx[5] * ry) +
+                          (2.0 * y * u) + (4.0 * xx * y * cx[4]);
+        out_jacobian[3] = q + (yy * dq) + (6.0 * y * v) +
+                          (2.0 * y * cx[5] * ry) + (2.0 * x * u) +
+                          (4.0 * x * yy * cx[4]);
+    }
+}
+
+template <size_t WIDTH>
+inline void simd_undistort_lanes(const SimdLensKernel& kernel,
+                                 const double* in_x, const double* in_y,
+                                 double* out_x, double* out_y) {
+    double lane_x[WIDTH];
+    double lane_y[WIDTH];
+    for (size_t l = 0; l < WIDTH; l++) {
+        const double dn_x = (in_x[l] * kernel.unit_to_dn_scale[0]) +
+                            kernel.unit_to_dn_offset[0];
+        const double dn_y = (in_y[l] * kernel.unit_to_dn_scale[1]) +
+                            kernel.unit_to_dn_offset[1];
+
+        double a_x = 0.0;
+        double a_y = 0.0;
+        double b_x = 0.0;
+        double b_y = 0.0;
+        simd_matrix_multiply(kernel.pre_matrix, dn_x, dn_y, a_x, a_y);
+        simd_polynomial(kernel, a_x, a_y, b_x, b_y);
+        simd_matrix_multiply(kernel.post_matrix, b_x, b_y, a_x, a_y);
+
+        lane_x[l] = (a_x * kernel.dn_to_unit_scale[0]) +
+                    kernel.dn_to_unit_offset[0];
+        lane_y[l] = (a_y * kernel.dn_to_unit_scale[1]) +
+                    kernel.dn_to_unit_offset[1];
+    }
+
+    // All inputs are read before writing, because the in and out
+    // arrays may be the same.
+    for (size_t l = 0; l < WIDTH; l++) {
+        out_x[l] = lane_x[l];
+        out_y[l] = lane_y[l];
+    }
+}
+
+template <size_t WIDTH>
+inline void simd_redistort_lanes(const SimdLensKernel& kernel,
+                                 const double* in_x, const double* in_y,
+                                 const double* guess_x, const double* guess_y,
+                                 double* out_x, double* out_y,
+                                 uint8_t* out_converged) {
+    // Target value of the polynomial, and the current estimate of
+    // the polynomial input.
+    double target_x[WIDTH];
+    double target_y[WIDTH];
+    double lane_x[WIDTH];
+    double lane_y[WIDTH];
+    bool done[WIDTH];
+    for (size_t l = 0; l < WIDTH; l++) {
+        const double dn_x = (in_x[l] * kernel.unit_to_dn_scale[0]) +
+                            kernel.unit_to_dn_offset[0];
+        const double dn_y = (in_y[l] * kernel.unit_to_dn_scale[1]) +
+                            kernel.unit_to_dn_offset[1];
+        simd_matrix_multiply(kernel.post_matrix_inverse, dn_x, dn_y,
+                             target_x[l], target_y[l]);
+
+        lane_x[l] = target_x[l];
+        lane_y[l] = target_y[l];
+        if (guess_x != nullptr && guess_y != nullptr) {
+            const double gx = guess_x[l];
+            const double gy = guess_y[l];
+            if (simd_is_finite(gx) && simd_is_finite(gy)) {
+                simd_matrix_multiply(kernel.pre_matrix, gx, gy, lane_x[l],
+                                     lane_y[l]);
+            }
+        }
+        done[l] = false;
+    }
+
+    // Newton's method, per-lane. Lanes that have converged are left
+    // unchanged while the remaining lanes iterate.
+    for (int i = 0; i < kSimdRedistortMaxIterations; i++) {
+        bool all_done = true;
+        for (size_t l = 0; l < WIDTH; l++) {
+            double f_x = 0.0;
+            double f_y = 0.0;
+            double jacobian[4];
+            simd_polynomial_with_jacobian(kernel, lane_x[l], lane_y[l], f_x,
+                                          f_y, jacobian);
+            const double residual_x = f_x - target_x[l];
+            const double residual_y = f_y - target_y[l];
+            const bool converged =
+                (simd_abs(residual_x) <= kSimdRedistortTolerance) &&
+                (simd_abs(residual_y) <= kSimdRedistortTolerance);
+            done[l] = done[l] || converged;
+
+            const double determinant =
+                (jacobian[0] * jacobian[3]) - (jacobian[1] * jacobian[2]);
+            const double step_x =
+                ((jacobian[3] * residual_x) - (jacobian[1] * residual_y)) /
+                determinant;
+            const double step_y =
+                ((jacobian[0] * residual_y) - (jacobian[2] * residual_x)) /
+                determinant;
+            lane_x[l] = done[l] ? lane_x[l] : (lane_x[l] - step_x);
+            lane_y[l] = done[l] ? lane_y[l] : (lane_y[l] - step_y);
+            all_done = all_done && done[l];
+        }
+        if (all_done) {
+            break;
+        }
+    }
+
+    for (size_t l = 0; l < WIDTH; l++) {
+        double dn_x = 0.0;
+        double dn_y = 0.0;
+        simd_matrix_multiply(kernel.pre_matrix_inverse, lane_x[l], lane_y[l],
+                             dn_x, dn_y);
+        out_x[l] =
+            (dn_x * kernel.dn_to_unit_scale[0]) + kernel.dn_to_unit_offset[0];
+        out_y[l] =
+            (dn_y * kernel.dn_to_unit_scale[1]) + kernel.dn_to_unit_offset[1];
+        out_converged[l] = static_cast<uint8_t>(
+            done[l] && simd_is_finite(out_x[l]) && simd_is_finite(out_y[l]));
+    }
+}
+
+template <size_t WIDTH>
+void simd_undistort_points_width(const SimdLensKernel& kernel,
+                                 const double* in_x, const double* in_y,
+                                 const size_t count, double* out_x,
+                                 double* out_y) {
+    size_t i = 0;
+    for (; (i + WIDTH) <= count; i += WIDTH) {
+        simd_undistort_lanes<WIDTH>(kernel, in_x + i, in_y + i, out_x + i,
+                                    out_y + i);
+    }
+    for (; i < count; i++) {
+        simd_undistort_lanes<1>(kernel, in_x + i, in_y + i, out_x + i,
+                                out_y + i);
+    }
+}
+
+template <size_t WIDTH>
+void simd_redistort_points_width(const SimdLensKernel& kernel,
+                                 const double* in_x, const double* in_y,
+                                 const double* guess_x, const double* guess_y,
+                                 const size_t count, double* out_x,
+                                 double* out_y, uint8_t* out_converged) {
+    const bool has_guess = (guess_x != nullptr) && (guess_y != nullptr);
+    size_t i = 0;
+    for (; (i + WIDTH) <= count; i += WIDTH) {
+        simd_redistort_lanes<WIDTH>(
+            kernel, in_x + i, in_y + i, has_guess ? guess_x + i : nullptr,
+            has_guess ? guess_y + i : nullptr, out_x + i, out_y + i,
+            out_converged + i);
+    }
+    for (; i < count; i++) {
+        simd_redistort_lanes<1>(
+            kernel, in_x + i, in_y + i, has_guess ? guess_x + i : nullptr,
+            has_guess ? guess_y + i : nullptr, out_x + i, out_y + i,
+            out_converged + i);
+    }
+}
+
+}  // namespace
+}  // namespace MM_LENS_SIMD_LANES_NAMESPACE
+}  // namespace mmlens
+
+#endif  // MM_LENS_DISTORTION_SIMD_LANES_H
@@ -76,8 +76,58 @@
 #include <mmcore/mmdata.h>
 #include <mmcore/mmhash.h>
 
+#include "distortion_simd_kernel.h"
+
 namespace mmlens {
 
+// Store the linear function 'eval' as a 2x2 matrix (row-major), by
+// evaluating it on the basis vectors.
+template <class FUNCTION>
+inline void simd_kernel_matrix(const FUNCTION& eval, double* out_matrix) {
+    ldpk::vec2d column_x = eval(ldpk::vec2d(1.0, 0.0));
+    ldpk::vec2d column_y = eval(ldpk::vec2d(0.0, 1.0));
+    out_matrix[0] = column_x[0];
+    out_matrix[1] = column_y[0];
+    out_matrix[2] = column_x[1];
+    out_matrix[3] = column_y[1];
+}
+
+// Set the polynomial of 'out_kernel' from the LDPK
+// 'generic_anamorphic_distortion' coefficients (Cx02, Cy02, Cx22,
+// Cy22, ...), of degree 4 or 6.
+//
+// The LDPK polynomial is written with 'r^2' and 'cos(2 * phi)'
+// terms, which are expanded into powers of 'X = x^2' and 'Y = y^2';
+// for example 'r^4 * cos(4 * phi) = X^2 - 6XY + Y^2'.
+inline void simd_kernel_anamorphic_coefficients(const double* parameters,
+                                                const int degree,
+                                                SimdLensKernel& out_kernel) {
+    for (size_t axis = 0; axis < 2; axis++) {
+        double* out = (axis == 0) ? out_kernel.coefficients_x
+                                  : out_kernel.coefficients_y;
+        const double c02 = parameters[0 + axis];
+        const double c22 = parameters[2 + axis];
+        const double c04 = parameters[4 + axis];
+        const double c24 = parameters[6 + axis];
+        const double c44 = parameters[8 + axis];
+        out[0] = c02 + c22;
+        out[1] = c02 - c22;
+        out[2] = c04 + c24 + c44;
+        out[3] = (2.0 * c04) - (6.0 * c44);
+        out[4] = c04 - c24 + c44;
+        if (degree >= 6) {
+            const double c06 = parameters[10 + axis];
+            const double c26 = parameters[12 + axis];
+            const double c46 = parameters[14 + axis];
+            const double c66 = parameters[16 + axis];
+            out[5] = c06 + c26 + c46 + c66;
+            out[6] = (3.0 * c06) + c26 - (5.0 * c46) - (15.0 * c66);
+            out[7] = (3.0 * c06) - c26 - (5.0 * c46) + (15.0 * c66);
+            out[8] = c06 - c26 + c46 - c66;
+        }
+    }
+}
+
 class Distortion {
 public:
     // Set parameter
@@ -102,14 +152,26 @@ public:
     virtual mmdata::Vector2D eval_inv(
         const mmdata::Vector2D in_point_dn,
         const mmdata::Vector2D in_initial_point_dn) const = 0;
+
+    // Describe the (undistort) evaluation as a vectorised kernel,
+    // see 'distortion_simd_kernel.h'. Call this after
+    // 'initialize_parameters'.
+    //
+    // Returns false if the distortion has no SIMD kernel.
+    virtual bool simd_kernel(SimdLensKernel& out_kernel) const {
+        return false;
+    }
 };
 
 // Matches LDPK 'tde4_ldp_classic_ld_model' implementation.
 class Distortion3deClassic : public Distortion {
 public:
-    Distortion3deClassic() {}
+    Distortion3deClassic() : m_parameters{0.0, 1.0, 0.0, 0.0, 0.0} {}
 
     void set_parameter(const int index, const double value) override {
+        if (index < 5) {
+            m_parameters[index] = value;
+        }
         m_distortion.set_coeff(index, value);
     }
 
@@ -141,17 +203,48 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        const double distortion = m_parameters[0];
+        const double squeeze = m_parameters[1];
+        const double curvature_x = m_parameters[2];
+        const double curvature_y = m_parameters[3];
+        const double quartic = m_parameters[4];
+        if (squeeze == 0.0) {
+            return false;
+        }
+
+        simd_kernel_reset(SimdPolynomial::kEven, out_kernel);
+        double* cx = out_kernel.coefficients_x;
+        double* cy = out_kernel.coefficients_y;
+        cx[0] = distortion / squeeze;
+        cx[1] = (distortion + curvature_x) / squeeze;
+        cx[2] = quartic / squeeze;
+        cx[3] = (2.0 * quartic) / squeeze;
+        cx[4] = quartic / squeeze;
+        cy[0] = distortion + curvature_y;
+        cy[1] = distortion;
+        cy[2] = quartic;
+        cy[3] = 2.0 * quartic;
+        cy[4] = quartic;
+        return true;
+    }
+
 private:
     ldpk::classic_ld_model_distortion<ldpk::vec2d, ldpk::mat2d> m_distortion;
+
+    // Distortion, anamorphic squeeze, curvature X, curvature Y and
+    // quartic distortion.
+    double m_parameters[5];
 };
 
 // Matches LDPK 'tde4_ldp_radial_standard_degree_4' implementation.
 class Distortion3deRadialStdDeg4 : public Distortion {
 public:
-    Distortion3deRadialStdDeg4() {}
+    Distortion3deRadialStdDeg4() : m_parameters{0.0, 0.0, 0.0, 0.0, 0.0, 0.0} {}
 
     void set_parameter(const int index, const double value) override {
         if (index < 6) {
+            m_parameters[index] = value;
             m_radial.set_coeff(index, value);
         } else if (index == 6) {
             m_cylindric.set_phi(value);
@@ -192,18 +285,34 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        simd_kernel_reset(SimdPolynomial::kRadialDecentered, out_kernel);
+        for (size_t i = 0; i < 6; i++) {
+            out_kernel.coefficients_x[i] = m_parameters[i];
+        }
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) { return m_cylindric.eval(p); },
+            out_kernel.post_matrix);
+        return true;
+    }
+
 private:
     ldpk::radial_decentered_distortion<ldpk::vec2d, ldpk::mat2d> m_radial;
     ldpk::cylindric_extender_2<ldpk::vec2d, ldpk::mat2d> m_cylindric;
+
+    // Degree 2 distortion, U and V, then degree 4 distortion, U and
+    // V.
+    double m_parameters[6];
 };
 
 // Matches LDPK 'tde4_ldp_anamorphic_standard_degree_4' implementation.
 class Distortion3deAnamorphicStdDeg4 : public Distortion {
 public:
-    Distortion3deAnamorphicStdDeg4() {}
+    Distortion3deAnamorphicStdDeg4() : m_parameters() {}
 
     void set_parameter(const int index, const double value) override {
         if (index < 10) {
+            m_parameters[index] = value;
             m_anamorphic.set_coeff(index, value);
         } else if (index == 10) {
             m_rotation.set_phi(value / 180.0 * M_PI);
@@ -260,6 +369,22 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        simd_kernel_reset(SimdPolynomial::kEven, out_kernel);
+        simd_kernel_anamorphic_coefficients(m_parameters, 4, out_kernel);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_pixel_aspect_and_rotation.eval_inv(p);
+            },
+            out_kernel.pre_matrix);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_rotation_squeeze_xy_pixel_aspect.eval(p);
+            },
+            out_kernel.post_matrix);
+        return true;
+    }
+
 private:
     // Anamorphic distortion of degree 4.
     ldpk::generic_anamorphic_distortion<ldpk::vec2d, ldpk::mat2d, 4>
@@ -275,15 +400,20 @@ private:
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d>
         m_rotation_squeeze_xy_pixel_aspect;
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d> m_pixel_aspect_and_rotation;
+
+    // The anamorphic distortion coefficients; Cx02, Cy02, Cx22,
+    // Cy22, etc.
+    double m_parameters[10];
 };
 
 // Matches LDPK 'tde4_ldp_anamorphic_rescaled_degree_4' implementation.
 class Distortion3deAnamorphicStdDeg4Rescaled : public Distortion {
 public:
-    Distortion3deAnamorphicStdDeg4Rescaled() {}
+    Distortion3deAnamorphicStdDeg4Rescaled() : m_parameters() {}
 
     void set_parameter(const int index, const double value) override {
         if (index < 10) {
+            m_parameters[index] = value;
             m_anamorphic.set_coeff(index, value);
         } else if (index == 10) {
             m_rotation.set_phi(value / 180.0 * M_PI);
@@ -345,6 +475,22 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        simd_kernel_reset(SimdPolynomial::kEven, out_kernel);
+        simd_kernel_anamorphic_coefficients(m_parameters, 4, out_kernel);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_pixel_aspect_rescale_and_rotation.eval_inv(p);
+            },
+            out_kernel.pre_matrix);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_rotation_squeeze_xy_rescale_pixel_aspect.eval(p);
+            },
+            out_kernel.post_matrix);
+        return true;
+    }
+
 private:
     // Anamorphic distortion of degree 4.
     ldpk::generic_anamorphic_distortion<ldpk::vec2d, ldpk::mat2d, 4>
@@ -362,15 +508,20 @@ private:
         m_rotation_squeeze_xy_rescale_pixel_aspect;
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d>
         m_pixel_aspect_rescale_and_rotation;
+
+    // The anamorphic distortion coefficients; Cx02, Cy02, Cx22,
+    // Cy22, etc.
+    double m_parameters[10];
 };
 
 // Matches LDPK 'tde4_ldp_anamorphic_standard_degree_6' implementation.
 class Distortion3deAnamorphicStdDeg6 : public Distortion {
 public:
-    Distortion3deAnamorphicStdDeg6() {}
+    Distortion3deAnamorphicStdDeg6() : m_parameters() {}
 
     void set_parameter(const int index, const double value) override {
         if (index < 18) {
+            m_parameters[index] = value;
             m_anamorphic.set_coeff(index, value);
         } else if (index == 18) {
             m_rotation.set_phi(value / 180.0 * M_PI);
@@ -427,6 +578,22 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        simd_kernel_reset(SimdPolynomial::kEven, out_kernel);
+        simd_kernel_anamorphic_coefficients(m_parameters, 6, out_kernel);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_pixel_aspect_and_rotation.eval_inv(p);
+            },
+            out_kernel.pre_matrix);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_rotation_squeeze_xy_pixel_aspect.eval(p);
+            },
+            out_kernel.post_matrix);
+        return true;
+    }
+
 private:
     // Anamorphic distortion of degree 6.
     ldpk::generic_anamorphic_distortion<ldpk::vec2d, ldpk::mat2d, 6>
@@ -442,15 +609,20 @@ private:
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d>
         m_rotation_squeeze_xy_pixel_aspect;
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d> m_pixel_aspect_and_rotation;
+
+    // The anamorphic distortion coefficients; Cx02, Cy02, Cx22,
+    // Cy22, etc.
+    double m_parameters[18];
 };
 
 // Matches LDPK 'tde4_ldp_anamorphic_rescaled_degree_6' implementation.
 class Distortion3deAnamorphicStdDeg6Rescaled : public Distortion {
 public:
-    Distortion3deAnamorphicStdDeg6Rescaled() {}
+    Distortion3deAnamorphicStdDeg6Rescaled() : m_parameters() {}
 
     void set_parameter(const int index, const double value) override {
         if (index < 18) {
+            m_parameters[index] = value;
             m_anamorphic.set_coeff(index, value);
         } else if (index == 18) {
             m_rotation.set_phi(value / 180.0 * M_PI);
@@ -522,6 +694,22 @@ public:
         return mmdata::Vector2D(out_point_dn[0], out_point_dn[1]);
     }
 
+    bool simd_kernel(SimdLensKernel& out_kernel) const override {
+        simd_kernel_reset(SimdPolynomial::kEven, out_kernel);
+        simd_kernel_anamorphic_coefficients(m_parameters, 6, out_kernel);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_pixel_aspect_rescale_and_rotation.eval_inv(p);
+            },
+            out_kernel.pre_matrix);
+        simd_kernel_matrix(
+            [this](const ldpk::vec2d& p) {
+                return m_rotation_squeeze_xy_rescale_pixel_aspect.eval(p);
+            },
+            out_kernel.post_matrix);
+        return true;
+    }
+
 private:
     // Anamorphic distortion of degree 6
     ldpk::generic_anamorphic_distortion<ldpk::vec2d, ldpk::mat2d, 6>
@@ -539,6 +727,10 @@ private:
         m_rotation_squeeze_xy_rescale_pixel_aspect;
     ldpk::linear_extender<ldpk::vec2d, ldpk::mat2d>
         m_pixel_aspect_rescale_and_rotation;
+
+    // The anamorphic distortion coefficients; Cx02, Cy02, Cx22,
+    // Cy22, etc.
+    double m_parameters[18];
 };
 
 }  // namespace mmlens
@@ -0,0 +1,415 @@
+//
+// Copyright (C) 2024 David Cattermole.
+//
+// This file is part of mmSolver.
+//
+// mmSolver is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// mmSolver is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+// ====================================================================
+//
+
+//! Binary cache of parsed lens files.
+//!
+//! Parsing a lens file with many animated frames is slow, so the
+//! parsed ShimDistortionLayers may be written to a binary cache
+//! file, and the cache file is read instead of parsing the lens
+//! file, until the lens file is changed.
+//!
+//! The cache is disabled by default, and is only used when the
+//! MMSOLVER_LENS_CACHE_DIR environment variable is set to the
+//! directory of the cache files. The lens file is always read and
+//! hashed to validate the cache file, so a cached load only saves
+//! the time spent parsing the lens file.
+//!
+//! The cache file (little-endian) has a versioned header, followed
+//! by the per-layer lens model type and frame range, and then all
+//! the parameter values, in layer and frame order (the same order
+//! as in memory, so reading the values is a single copy). The
+//! parameter values start on an 8-byte boundary.
+//!
+//! The cache file is only valid for the source lens file with the
+//! same path, size and content hash as stored in the header; the
+//! modification time is not used, because it is not always changed
+//! when a file is copied or restored.
+//!
+//! The total size of the cache files is limited; after a cache file
+//! is written, the oldest cache files are removed until the cache
+//! directory is within the limit.
+
+use crate::cxxbridge::ffi::CameraParameters as BindCameraParameters;
+use crate::cxxbridge::ffi::LensModelType as BindLensModelType;
+use crate::data::FrameNumber;
+use crate::data::LayerSize;
+use crate::distortion_layers::ShimDistortionLayers;
+use anyhow::Result;
+use rustc_hash::FxHasher;
+use smallvec::SmallVec;
+use std::convert::TryInto;
+use std::ffi::OsStr;
+use std::hash::Hash;
+use std::hash::Hasher;
+use std::io::Write;
+use std::path::Path;
+use std::path::PathBuf;
+use std::time::SystemTime;
+use std::time::UNIX_EPOCH;
+
+const LENS_CACHE_MAGIC: &[u8; 8] = b"MMLENSC\0";
+const LENS_CACHE_VERSION: u32 = 2;
+const LENS_CACHE_FILE_EXTENSION: &str = "mmlenscache";
+
+/// The directory the cache files are read from and written to. The
+/// cache is disabled when this is not set (or empty).
+const LENS_CACHE_DIR_ENV_VAR: &str = "MMSOLVER_LENS_CACHE_DIR";
+
+/// Overrides the maximum total size of the cache files, in
+/// megabytes.
+const LENS_CACHE_MAX_SIZE_MB_ENV_VAR: &str = "MMSOLVER_LENS_CACHE_MAX_SIZE_MB";
+const LENS_CACHE_MAX_SIZE_MB_DEFAULT: u64 = 256;
+
+// magic + version + layer count + source size + source content hash
+// + camera parameters.
+const HEADER_BYTE_SIZE: usize = 8 + 4 + 4 + 8 + 8 + (6 * 8);
+// lens model type + padding + start frame + end frame.
+const LAYER_BYTE_SIZE: usize = 1 + 3 + 2 + 2;
+
+/// Identifies a source lens file and its content.
+#[derive(Debug, Clone, PartialEq)]
+pub struct LensCacheKey {
+    cache_dir_path: PathBuf,
+    source_file_path: PathBuf,
+    size: u64,
+    content_hash: u64,
+}
+
+fn lens_cache_dir_path() -> Option<PathBuf> {
+    match std::env::var_os(LENS_CACHE_DIR_ENV_VAR) {
+        Some(dir_path) if !dir_path.is_empty() => Some(PathBuf::from(dir_path)),
+        _ => None,
+    }
+}
+
+fn lens_cache_max_byte_count() -> u64 {
+    let size_mb = std::env::var(LENS_CACHE_MAX_SIZE_MB_ENV_VAR)
+        .ok()
+        .and_then(|value| value.trim().parse::<u64>().ok())
+        .unwrap_or(LENS_CACHE_MAX_SIZE_MB_DEFAULT);
+    size_mb.saturating_mul(1024 * 1024)
+}
+
+/// The key used to read and write the cache file of the lens file
+/// 'file_path', with the (already read) 'contents' of the lens file.
+///
+/// Returns None when the cache is disabled.
+pub fn lens_cache_key(
+    file_path: &str,
+    contents: &[u8],
+) -> Option<LensCacheKey> {
+    let cache_dir_path = lens_cache_dir_path()?;
+    let mut s = FxHasher::default();
+    s.write(contents);
+    Some(LensCacheKey {
+        cache_dir_path,
+        source_file_path: absolute_file_path(file_path),
+        size: contents.len() as u64,
+        content_hash: s.finish(),
+    })
+}
+
+/// The cache file path is named with the hash of the (absolute)
+/// source file path, so all cache files can live in one directory.
+fn lens_cache_file_path(key: &LensCacheKey) -> PathBuf {
+    let mut s = FxHasher::default();
+    key.source_file_path.hash(&mut s);
+    let file_name =
+        format!("{:016x}.{}", s.finish(), LENS_CACHE_FILE_EXTENSION);
+    key.cache_dir_path.join(file_name)
+}
+
+fn absolute_file_path(file_path: &str) -> PathBuf {
+    match std::fs::canonicalize(file_path) {
+        Ok(path) => path,
+        Err(_) => PathBuf::from(file_path),
+    }
+}
+
+struct ByteReader<'a> {
+    bytes: &'a [u8],
+    offset: usize,
+}
+
+impl<'a> ByteReader<'a> {
+    fn new(bytes: &'a [u8]) -> ByteReader<'a> {
+        ByteReader { bytes, offset: 0 }
+    }
+
+    fn read_bytes(&mut self, count: usize) -> Option<&'a [u8]> {
+        let end = self.offset.checked_add(count)?;
+        let values = self.bytes.get(self.offset..end)?;
+        self.offset = end;
+        Some(values)
+    }
+
+    fn read_u8(&mut self) -> Option<u8> {
+        Some(self.read_bytes(1)?[0])
+    }
+
+    fn read_u16(&mut self) -> Option<u16> {
+        let values = self.read_bytes(2)?;
+        Some(u16::from_le_bytes([values[0], values[1]]))
+    }
+
+    fn read_u32(&mut self) -> Option<u32> {
+        let mut values = [0; 4];
+        values.copy_from_slice(self.read_bytes(4)?);
+        Some(u32::from_le_bytes(values))
+    }
+
+    fn read_u64(&mut self) -> Option<u64> {
+        let mut values = [0; 8];
+        values.copy_from_slice(self.read_bytes(8)?);
+        Some(u64::from_le_bytes(values))
+    }
+
+    fn read_f64(&mut self) -> Option<f64> {
+        Some(f64::from_bits(self.read_u64()?))
+    }
+}
+
+fn parse_lens_cache_bytes(
+    bytes: &[u8],
+    key: &LensCacheKey,
+) -> Option<ShimDistortionLayers> {
+    let mut reader = ByteReader::new(bytes);
+    if reader.read_bytes(LENS_CACHE_MAGIC.len())? != LENS_CACHE_MAGIC {
+        return None;
+    }
+    if reader.read_u32()? != LENS_CACHE_VERSION {
+        return None;
+    }
+    let layer_count = reader.read_u32()?;
+    if layer_count > LayerSize::MAX as u32 {
+        return None;
+    }
+    let layer_count = layer_count as LayerSize;
+
+    let size = reader.read_u64()?;
+    let content_hash = reader.read_u64()?;
+    if (size != key.size) || (content_hash != key.content_hash) {
+        return None;
+    }
+
+    let camera_parameters = BindCameraParameters {
+        focal_length_cm: reader.read_f64()?,
+        film_back_width_cm: reader.read_f64()?,
+        film_back_height_cm: reader.read_f64()?,
+        pixel_aspect: reader.read_f64()?,
+        lens_center_offset_x_cm: reader.read_f64()?,
+        lens_center_offset_y_cm: reader.read_f64()?,
+    };
+
+    let mut layer_lens_model_types = SmallVec::<[BindLensModelType; 4]>::new();
+    let mut layer_frame_range =
+        SmallVec::<[(FrameNumber, FrameNumber); 4]>::new();
+    for _layer_num in 0..layer_count {
+        let lens_model_type = BindLensModelType {
+            repr: reader.read_u8()?,
+        };
+        let _padding = reader.read_bytes(3)?;
+        let start_frame: FrameNumber = reader.read_u16()?;
+        let end_frame: FrameNumber = reader.read_u16()?;
+        layer_lens_model_types.push(lens_model_type);
+        layer_frame_range.push((start_frame, end_frame));
+    }
+
+    let value_count = reader.read_u64()? as usize;
+    let value_bytes = reader.read_bytes(value_count.checked_mul(8)?)?;
+    let parameter_block: Vec<f64> = value_bytes
+        .chunks_exact(8)
+        .map(|x| f64::from_le_bytes(x.try_into().unwrap()))
+        .collect();
+
+    // The source file path is stored to detect (unlikely) cache file
+    // name collisions.
+    let path_byte_count = reader.read_u64()? as usize;
+    let path_bytes = reader.read_bytes(path_byte_count)?;
+    let path_string = key.source_file_path.to_string_lossy();
+    if path_bytes != path_string.as_bytes() {
+        return None;
+    }
+
+    ShimDistortionLayers::from_parameter_block(
+        layer_count,
+        &layer_lens_model_types,
+        &layer_frame_range,
+        camera_parameters,
+        parameter_block,
+    )
+}
+
+fn lens_cache_bytes(
+    distortion_layers: &ShimDistortionLayers,
+    key: &LensCacheKey,
+) -> Vec<u8> {
+    let layer_count = distortion_layers.layer_count();
+    let parameter_block = distortion_layers.parameter_block();
+    let path_string = key.source_file_path.to_string_lossy();
+    let path_bytes = path_string.as_bytes();
+
+    let byte_count = HEADER_BYTE_SIZE
+        + (LAYER_BYTE_SIZE * layer_count as usize)
+        + 8
+        + (parameter_block.len() * 8)
+        + 8
+        + path_bytes.len();
+    let mut bytes: Vec<u8> = Vec::with_capacity(byte_count);
+
+    bytes.extend_from_slice(LENS_CACHE_MAGIC);
+    bytes.extend_from_slice(&LENS_CACHE_VERSION.to_le_bytes());
+    bytes.extend_from_slice(&(layer_count as u32).to_le_bytes());
+    bytes.extend_from_slice(&key.size.to_le_bytes());
+    bytes.extend_from_slice(&key.content_hash.to_le_bytes());
+
+    let camera_parameters = distortion_layers.camera_parameters();
+    for value in [
+        camera_parameters.focal_length_cm,
+        camera_parameters.film_back_width_cm,
+        camera_parameters.film_back_height_cm,
+        camera_parameters.pixel_aspect,
+        camera_parameters.lens_center_offset_x_cm,
+        camera_parameters.lens_center_offset_y_cm,
+    ] {
+        bytes.extend_from_slice(&value.to_le_bytes());
+    }
+
+    for layer_num in 0..layer_count {
+        let lens_model_type =
+            distortion_layers.layer_lens_model_type(layer_num);
+        let (start_frame, end_frame) =
+            distortion_layers.layer_frame_range(layer_num);
+        bytes.push(lens_model_type.repr);
+        bytes.extend_from_slice(&[0_u8; 3]);
+        bytes.extend_from_slice(&start_frame.to_le_bytes());
+        bytes.extend_from_slice(&end_frame.to_le_bytes());
+    }
+
+    bytes.extend_from_slice(&(parameter_block.len() as u64).to_le_bytes());
+    for value in parameter_block {
+        bytes.extend_from_slice(&value.to_le_bytes());
+    }
+
+    bytes.extend_from_slice(&(path_bytes.len() as u64).to_le_bytes());
+    bytes.extend_from_slice(path_bytes);
+
+    bytes
+}
+
+/// Remove the oldest cache files until the total size of the cache
+/// files in 'cache_dir_path' is at most 'max_byte_count'. The cache
+/// file 'keep_file_path' (that was just written) is never removed.
+fn remove_old_lens_cache_files(
+    cache_dir_path: &Path,
+    keep_file_path: &Path,
+    max_byte_count: u64,
+) -> Result<()> {
+    let mut total_byte_count: u64 = 0;
+    let mut old_files = Vec::<(SystemTime, u64, PathBuf)>::new();
+    for entry in std::fs::read_dir(cache_dir_path)? {
+        let entry = match entry {
+            Ok(value) => value,
+            Err(_) => continue,
+        };
+        let path = entry.path();
+        if path.extension() != Some(OsStr::new(LENS_CACHE_FILE_EXTENSION)) {
+            continue;
+        }
+        let metadata = match entry.metadata() {
+            Ok(value) => value,
+            Err(_) => continue,
+        };
+        let byte_count = metadata.len();
+        total_byte_count = total_byte_count.saturating_add(byte_count);
+        if path != keep_file_path {
+            let modified = metadata.modified().unwrap_or(UNIX_EPOCH);
+            old_files.push((modified, byte_count, path));
+        }
+    }
+    if total_byte_count <= max_byte_count {
+        return Ok(());
+    }
+
+    old_files.sort_by(|a, b| a.0.cmp(&b.0));
+    for (_modified, byte_count, path) in old_files {
+        if total_byte_count <= max_byte_count {
+            break;
+        }
+        // Another process may have removed the file already.
+        if std::fs::remove_file(&path).is_ok() {
+            total_byte_count = total_byte_count.saturating_sub(byte_count);
+        }
+    }
+    Ok(())
+}
+
+/// Read the cached DistortionLayers for the lens file, if the cache
+/// file exists and is still valid for the lens file.
+pub fn read_lens_cache_file(
+    key: &LensCacheKey,
+) -> Option<ShimDistortionLayers> {
+    let cache_file_path = lens_cache_file_path(key);
+    let bytes = std::fs::read(cache_file_path).ok()?;
+    parse_lens_cache_bytes(&bytes, key)
+}
+
+/// Write the DistortionLayers parsed from the lens file to the cache
+/// file, and then remove old cache files to keep the cache within
+/// the size limit. Cache files larger than the limit are not
+/// written.
+///
+/// The file is written to a temporary file name first and then
+/// renamed, so a reader never sees a partially written cache file.
+pub fn write_lens_cache_file(
+    key: &LensCacheKey,
+    distortion_layers: &ShimDistortionLayers,
+) -> Result<()> {
+    let bytes = lens_cache_bytes(distortion_layers, key);
+    let max_byte_count = lens_cache_max_byte_count();
+    if (bytes.len() as u64) > max_byte_count {
+        return Ok(());
+    }
+
+    let cache_file_path = lens_cache_file_path(key);
+    let cache_dir_path = &key.cache_dir_path;
+    std::fs::create_dir_all(cache_dir_path)?;
+
+    let temp_file_name = format!(
+        "{}.{}.tmp",
+        cache_file_path.to_string_lossy(),
+        std::process::id()
+    );
+    let temp_file_path = PathBuf::from(temp_file_name);
+    {
+        let mut file = std::fs::File::create(&temp_file_path)?;
+        file.write_all(&bytes)?;
+    }
+    if let Err(err) = std::fs::rename(&temp_file_path, &cache_file_path) {
+        let _ = std::fs::remove_file(&temp_file_path);
+        return Err(err.into());
+    }
+
+    remove_old_lens_cache_files(
+        cache_dir_path,
+        &cache_file_path,
+        max_byte_count,
+    )
+}
@@ -31,6 +31,9 @@ use crate::cxxbridge::ffi::LensModelType as BindLensModelType;
 use crate::data::FrameNumber;
 use crate::data::LayerSize;
 use crate::distortion_layers::ShimDistortionLayers;
+use crate::lens_cache::lens_cache_key;
+use crate::lens_cache::read_lens_cache_file;
+use crate::lens_cache::write_lens_cache_file;
 use smallvec::SmallVec;
 
 use anyhow::Result;
@@ -1186,9 +1189,8 @@ fn parse_nuke_file_lines(
     )))
 }
 
-fn read_nuke_file_lines(file_path: &str) -> Vec<String> {
-    std::fs::read_to_string(file_path)
-        .expect("Could not open file.")
+fn nuke_file_lines(contents: &str) -> Vec<String> {
+    contents
         .lines()
         .filter_map(|x| {
             let x = x.trim();
@@ -1203,6 +1205,25 @@ fn read_nuke_file_lines(file_path: &str) -> Vec<String> {
 }
 
 pub fn shim_read_lens_file(file_path: &str) -> Box<ShimDistortionLayers> {
-    let lines = read_nuke_file_lines(file_path);
-    parse_nuke_file_lines(lines).expect("should get distortion layers")
+    let contents =
+        std::fs::read_to_string(file_path).expect("Could not open file.");
+    let cache_key = lens_cache_key(file_path, contents.as_bytes());
+    if let Some(key) = &cache_key {
+        if let Some(distortion_layers) = read_lens_cache_file(key) {
+            return Box::new(distortion_layers);
+        }
+    }
+
+    let lines = nuke_file_lines(&contents);
+    let distortion_layers =
+        parse_nuke_file_lines(lines).expect("should get distortion layers");
+
+    // The cache is only an optimization; when it cannot be written
+    // (for example a read-only directory) the lens file is parsed
+    // again next time.
+    if let Some(key) = &cache_key {
+        let _ = write_lens_cache_file(key, &distortion_layers);
+    }
+
+    distortion_layers
 }
@@ -34,18 +34,29 @@ namespace mmlens {
 
 void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelUndistort(
     const double xd, const double yd, double &xu, double &yu) {
+    applyModelUndistortBatch(&xd, &yd, 1, &xu, &yu);
+}
+
+void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelUndistortBatch(
+    const double *xd, const double *yd, const size_t count, double *xu,
+    double *yu) {
     if (m_state != LensModelState::kClean) {
         m_film_back_radius_cm =
             mmlens::compute_diagonal_normalized_camera_factor(m_camera);
         m_state = LensModelState::kClean;
     }
 
-    // Apply the 'previous' lens model in the chain.
+    // Apply the 'previous' lens model in the chain, to all the
+    // points at once. The results are written to the output
+    // arrays, which are then used (in-place) as the input for this
+    // lens model.
     std::shared_ptr<LensModel> inputLensModel = LensModel::getInputLensModel();
-    double xdd = xd;
-    double ydd = yd;
+    const double *xdd = xd;
+    const double *ydd = yd;
     if (inputLensModel != nullptr) {
-        inputLensModel->applyModelUndistort(xdd, ydd, xdd, ydd);
+        inputLensModel->applyModelUndistortBatch(xd, yd, count, xu, yu);
+        xdd = xu;
+        ydd = yu;
     }
 
     auto distortion = Distortion3deAnamorphicStdDeg4();
@@ -64,33 +75,40 @@ void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelUndistort(
     distortion.set_parameter(12, m_lens.squeeze_y);
     distortion.initialize_parameters(m_camera);
 
-    // 'undistort' expects values 0.0 to 1.0, but our inputs are -0.5
-    // to 0.5, therefore we must convert.
+    // The distortion is initialized once and re-used for every
+    // point in the batch.
     const auto direction = DistortionDirection::kUndistort;
-    auto out_xy = apply_lens_distortion_once<direction, double, double,
-                                             Distortion3deAnamorphicStdDeg4>(
-        xdd + 0.5, ydd + 0.5, m_camera, m_film_back_radius_cm, distortion);
-
-    // Convert back to -0.5 to 0.5 coordinate space.
-    xu = out_xy.first - 0.5;
-    yu = out_xy.second - 0.5;
+    apply_lens_distortion_to_span<direction, Distortion3deAnamorphicStdDeg4>(
+        xdd, ydd, count, m_camera, m_film_back_radius_cm, distortion,
+        /*guess_grid=*/nullptr, xu, yu);
     return;
 }
 
 void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelDistort(
     const double xd, const double yd, double &xu, double &yu) {
+    applyModelDistortBatch(&xd, &yd, 1, &xu, &yu);
+}
+
+void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelDistortBatch(
+    const double *xd, const double *yd, const size_t count, double *xu,
+    double *yu) {
     if (m_state != LensModelState::kClean) {
         m_film_back_radius_cm =
             mmlens::compute_diagonal_normalized_camera_factor(m_camera);
         m_state = LensModelState::kClean;
     }
 
-    // Apply the 'previous' lens model in the chain.
+    // Apply the 'previous' lens model in the chain, to all the
+    // points at once. The results are written to the output
+    // arrays, which are then used (in-place) as the input for this
+    // lens model.
     std::shared_ptr<LensModel> inputLensModel = LensModel::getInputLensModel();
-    double xdd = xd;
-    double ydd = yd;
+    const double *xdd = xd;
+    const double *ydd = yd;
     if (inputLensModel != nullptr) {
-        inputLensModel->applyModelDistort(xdd, ydd, xdd, ydd);
+        inputLensModel->applyModelDistortBatch(xd, yd, count, xu, yu);
+        xdd = xu;
+        ydd = yu;
     }
 
     auto distortion = Distortion3deAnamorphicStdDeg4();
@@ -109,16 +127,21 @@ void LensModel3deAnamorphicDeg4RotateSqueezeXY::applyModelDistort(
     distortion.set_parameter(12, m_lens.squeeze_y);
     distortion.initialize_parameters(m_camera);
 
-    // 'undistort' expects values 0.0 to 1.0, but our inputs are -0.5
-    // to 0.5, therefore we must convert.
-    const auto direction = DistortionDirection::kRedistort;
-    auto out_xy = apply_lens_distortion_once<direction, double, double,
-                                             Distortion3deAnamorphicStdDeg4>(
-        xdd + 0.5, ydd + 0.5, m_camera, m_film_back_radius_cm, distortion);
+    // Re-distortion is iterative; when enabled, a grid built for
+    // this batch of points is used to look up the initial guess of
+    // each point.
+    std::shared_ptr<const InverseGuessGrid> guess_grid;
+    if (m_use_inverse_guess_grid) {
+        guess_grid = get_inverse_guess_grid<Distortion3deAnamorphicStdDeg4>(
+            count, m_camera, m_film_back_radius_cm, distortion);
+    }
 
-    // Convert back to -0.5 to 0.5 coordinate space.
-    xu = out_xy.first - 0.5;
-    yu = out_xy.second - 0.5;
+    // The distortion is initialized once and re-used for every
+    // point in the batch.
+    const auto direction = DistortionDirection::kRedistort;
+    apply_lens_distortion_to_span<direction, Distortion3deAnamorphicStdDeg4>(
+        xdd, ydd, count, m_camera, m_film_back_radius_cm, distortion,
+        guess_grid.get(), xu, yu);
     return;
 }
 
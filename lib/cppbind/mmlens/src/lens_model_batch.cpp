@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include <mmlens/lens_model_batch.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace mmlens {
+
+namespace {
+
+using LensModelBatchFunc = void (LensModel::*)(const double*, const double*,
+                                               const size_t, double*,
+                                               double*);
+
+void apply_model_batch_multithread(LensModel& lens_model,
+                                   LensModelBatchFunc batch_func,
+                                   const double* x, const double* y,
+                                   const size_t count, double* out_x,
+                                   double* out_y, const int32_t num_threads) {
+    if (count == 0) {
+        return;
+    }
+
+    // Evaluate the first point on this thread. This updates the
+    // cached values of every lens model in the chain (when
+    // 'LensModelState::kDirty'), so the threads below only read from
+    // the lens models.
+    (lens_model.*batch_func)(x, y, 1, out_x, out_y);
+    const size_t remaining_count = count - 1;
+    if (remaining_count == 0) {
+        return;
+    }
+
+    size_t thread_count = static_cast<size_t>(std::max(0, num_threads));
+    if (thread_count == 0) {
+        thread_count = static_cast<size_t>(std::thread::hardware_concurrency());
+    }
+    const size_t max_thread_count = std::max<size_t>(
+        1, remaining_count / kLensModelBatchMinPointsPerThread);
+    thread_count =
+        std::max<size_t>(1, std::min(thread_count, max_thread_count));
+
+    // The points are split into contiguous ranges, so each thread
+    // reads and writes its own part of the arrays.
+    const size_t points_per_thread =
+        (remaining_count + thread_count - 1) / thread_count;
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t t = 1; t < thread_count; t++) {
+        const size_t start = 1 + (t * points_per_thread);
+        if (start >= count) {
+            break;
+        }
+        const size_t range_count = std::min(points_per_thread, count - start);
+        threads.emplace_back([&lens_model, batch_func, x, y, out_x, out_y,
+                              start, range_count]() {
+            (lens_model.*batch_func)(x + start, y + start, range_count,
+                                     out_x + start, out_y + start);
+        });
+    }
+
+    // The first range is evaluated on this thread.
+    const size_t first_range_count =
+        std::min(points_per_thread, remaining_count);
+    (lens_model.*batch_func)(x + 1, y + 1, first_range_count, out_x + 1,
+                             out_y + 1);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace
+
+void apply_model_undistort_batch_multithread(LensModel& lens_model,
+                                             const double* x, const double* y,
+                                             const size_t count, double* out_x,
+                                             double* out_y,
+                                             const int32_t num_threads) {
+    apply_model_batch_multithread(lens_model,
+                                  &LensModel::applyModelUndistortBatch, x, y,
+                                  count, out_x, out_y, num_threads);
+}
+
+void apply_model_distort_batch_multithread(LensModel& lens_model,
+                                           const double* x, const double* y,
+                                           const size_t count, double* out_x,
+                                           double* out_y,
+                                           const int32_t num_threads) {
+    apply_model_batch_multithread(lens_model,
+                                  &LensModel::applyModelDistortBatch, x, y,
+                                  count, out_x, out_y, num_threads);
+}
+
+}  // namespace mmlens
@@ -22,37 +22,51 @@
 
 #include <mmlens/lens_model_passthrough.h>
 
+#include <algorithm>
+
 namespace mmlens {
 
 void LensModelPassthrough::applyModelUndistort(const double xd, const double yd,
                                                double &xu, double &yu) {
+    applyModelUndistortBatch(&xd, &yd, 1, &xu, &yu);
+}
+
+void LensModelPassthrough::applyModelUndistortBatch(const double *xd,
+                                                    const double *yd,
+                                                    const size_t count,
+                                                    double *xu, double *yu) {
     // Apply the 'previous' lens model in the chain.
     std::shared_ptr<LensModel> inputLensModel = LensModel::getInputLensModel();
-    double xdd = xd;
-    double ydd = yd;
     if (inputLensModel != nullptr) {
-        inputLensModel->applyModelUndistort(xdd, ydd, xdd, ydd);
+        inputLensModel->applyModelUndistortBatch(xd, yd, count, xu, yu);
+        return;
     }
 
     // Do nothing. This LensModel is a pass-through only.
-    xu = xdd;
-    yu = ydd;
+    std::copy(xd, xd + count, xu);
+    std::copy(yd, yd + count, yu);
     return;
 }
 
 void LensModelPassthrough::applyModelDistort(const double xd, const double yd,
                                              double &xu, double &yu) {
+    applyModelDistortBatch(&xd, &yd, 1, &xu, &yu);
+}
+
+void LensModelPassthrough::applyModelDistortBatch(const double *xd,
+                                                  const double *yd,
+                                                  const size_t count,
+                                                  double *xu, double *yu) {
     // Apply the 'previous' lens model in the chain.
     std::shared_ptr<LensModel> inputLensModel = LensModel::getInputLensModel();
-    double xdd = xd;
-    double ydd = yd;
     if (inputLensModel != nullptr) {
-        inputLensModel->applyModelDistort(xdd, ydd, xdd, ydd);
+        inputLensModel->applyModelDistortBatch(xd, yd, count, xu, yu);
+        return;
     }
 
     // Do nothing. This LensModel is a pass-through only.
-    xu = xdd;
-    yu = ydd;
+    std::copy(xd, xd + count, xu);
+    std::copy(yd, yd + count, yu);
     return;
 }
 
@@ -24,6 +24,7 @@ mod data;
 mod distortion_layers;
 mod distortion_process;
 mod hash_float;
+mod lens_cache;
 mod lens_io;
 mod lens_parameters;
 mod option_lens_parameters;
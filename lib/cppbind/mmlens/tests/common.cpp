@@ -19,9 +19,12 @@
  *
  */
 
+#include "common.h"
+
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 std::string join_path(const char* arg1, const char* arg2) {
     std::stringstream stream;
@@ -29,3 +32,21 @@ std::string join_path(const char* arg1, const char* arg2) {
     stream << arg2;
     return stream.str();
 }
+
+void generate_points_ndc(const size_t width, const size_t height,
+                         std::vector<double>& out_x_vec,
+                         std::vector<double>& out_y_vec) {
+    const size_t count = width * height;
+    out_x_vec.resize(count);
+    out_y_vec.resize(count);
+    for (size_t row = 0; row < height; row++) {
+        for (size_t column = 0; column < width; column++) {
+            const size_t index = (row * width) + column;
+            // -0.5 to 0.5 in X and Y.
+            out_x_vec[index] = -0.5 + (static_cast<double>(column) /
+                                       static_cast<double>(width - 1));
+            out_y_vec[index] = -0.5 + (static_cast<double>(row) /
+                                       static_cast<double>(height - 1));
+        }
+    }
+}
@@ -22,12 +22,42 @@
 #include <mmlens/mmlens.h>
 
 #include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <vector>
 
 std::string join_path(const char* arg1, const char* arg2);
 
+// Generate a 'width' by 'height' grid of points, in Normalized
+// Device Coordinates (-0.5 to 0.5), with X and Y in separate
+// buffers.
+void generate_points_ndc(const size_t width, const size_t height,
+                         std::vector<double>& out_x_vec,
+                         std::vector<double>& out_y_vec);
+
+// Count the values that differ between the two buffers.
+//
+// Re-distortion is iterative, and may start from a different initial
+// guess depending on how the points are evaluated (see
+// 'InverseGuessGrid'), so values are only expected to match within
+// the convergence tolerance of the iterative inverse distortion.
+template <typename T>
+size_t count_mismatches(const std::vector<T>& data_a,
+                        const std::vector<T>& data_b) {
+    const double tolerance = 1e-6;
+    size_t count = 0;
+    for (size_t i = 0; i < data_a.size(); i++) {
+        const double difference = static_cast<double>(data_a[i]) -
+                                  static_cast<double>(data_b[i]);
+        if (std::fabs(difference) > tolerance) {
+            count++;
+        }
+    }
+    return count;
+}
+
 const int kCoordinateSystemImage = 0;
 const int kCoordinateSystemNDC = 1;
 
@@ -34,11 +34,16 @@
 #include "test_both_3de_anamorphic_std_deg4_rescaled.h"
 #include "test_both_3de_classic.h"
 #include "test_both_3de_radial_std_deg4.h"
+#include "test_guess_grid_3de_classic.h"
 #include "test_lens_file_load.h"
+#include "test_model_batch_3de_classic.h"
 #include "test_once_3de_anamorphic_std_deg4.h"
 #include "test_once_3de_anamorphic_std_deg4_rescaled.h"
 #include "test_once_3de_classic.h"
 #include "test_once_3de_radial_std_deg4.h"
+#include "test_simd_3de.h"
+#include "test_span_3de_classic.h"
+#include "test_tile_3de_classic.h"
 
 void print_help(const char* exec_file) {
     std::cout
@@ -162,6 +167,63 @@ int main(int argc, char* argv[]) {
                                                    verbosity);
     }
 
+    // Evaluate all coordinates with a single (batched) call, and
+    // compare with evaluating each coordinate once.
+    for (const auto& test_size : test_image_sizes) {
+        size_t image_width = test_size.first;
+        size_t image_height = test_size.second;
+        const int result =
+            test_span_3de_classic(image_width, image_height, verbosity);
+        if (result != 0) {
+            return result;
+        }
+    }
+
+    // Evaluate a lens model on many threads, and compare with
+    // evaluating each coordinate once. The larger size has about as
+    // many points as a dense mesh deformed by the mmLensDeformer node.
+    {
+        auto batch_test_image_sizes = test_image_sizes;
+        batch_test_image_sizes.push_back(std::make_pair(400, 250));
+        for (const auto& test_size : batch_test_image_sizes) {
+            size_t image_width = test_size.first;
+            size_t image_height = test_size.second;
+            const int result = test_model_batch_3de_classic(
+                image_width, image_height, verbosity);
+            if (result != 0) {
+                return result;
+            }
+        }
+    }
+
+    // Compare the SIMD lens distortion kernels with the scalar
+    // (LDPK) evaluation.
+    for (const auto& test_size : test_image_sizes) {
+        size_t image_width = test_size.first;
+        size_t image_height = test_size.second;
+        const int result = test_simd_3de(image_width, image_height, verbosity);
+        if (result != 0) {
+            return result;
+        }
+    }
+
+    // Compare the multithreaded functions using different parallel
+    // tile sizes with the single threaded functions. The larger image
+    // size is used to benchmark each tile size.
+    {
+        auto tile_test_image_sizes = test_image_sizes;
+        tile_test_image_sizes.push_back(std::make_pair(960, 540));
+        for (const auto& test_size : tile_test_image_sizes) {
+            size_t image_width = test_size.first;
+            size_t image_height = test_size.second;
+            const int result =
+                test_tile_3de_classic(image_width, image_height, verbosity);
+            if (result != 0) {
+                return result;
+            }
+        }
+    }
+
     // Calculates both undistortion and redistortion in the same loop.
     for (const auto& test_size : test_image_sizes) {
         size_t image_width = test_size.first;
@@ -204,6 +266,15 @@ int main(int argc, char* argv[]) {
                                                    multithread, verbosity);
     }
 
+    // Compare re-distortion speed with and without the inverse
+    // guess grid.
+    {
+        const int result = test_guess_grid_3de_classic(512, 512, verbosity);
+        if (result != 0) {
+            return result;
+        }
+    }
+
     // Load Lens files.
     test_lens_file_load(dir_path, "test_file_3de_classic_1.nk");
     test_lens_file_load(dir_path, "test_file_3de_radial_std_deg4_1.nk");
@@ -220,5 +291,21 @@ int main(int argc, char* argv[]) {
     test_lens_file_load(dir_path, "test_file_3de_anamorphic_std_deg4_3.nk");
     test_lens_file_load(dir_path,
                         "test_file_3de_anamorphic_std_deg4_rescaled_3.nk");
+
+    // Lens file binary cache.
+    {
+        const int result =
+            test_lens_file_cache(dir_path, "test_file_3de_classic_3.nk");
+        if (result != 0) {
+            return result;
+        }
+    }
+    {
+        const int result = test_lens_file_cache(
+            dir_path, "test_file_3de_anamorphic_std_deg4_rescaled_3.nk");
+        if (result != 0) {
+            return result;
+        }
+    }
     return 0;
 }
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_guess_grid_3de_classic.h"
+
+#include <mmlens/mmlens.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "common.h"
+
+// Re-distort all points with the lens, returning the time taken in
+// seconds.
+static double redistort_points(mmlens::LensModel3deClassic& lens,
+                               const std::vector<double>& in_x_vec,
+                               const std::vector<double>& in_y_vec,
+                               std::vector<double>& out_x_vec,
+                               std::vector<double>& out_y_vec) {
+    const auto start = std::chrono::high_resolution_clock::now();
+    lens.applyModelDistortBatch(&in_x_vec[0], &in_y_vec[0], in_x_vec.size(),
+                                &out_x_vec[0], &out_y_vec[0]);
+    const auto end = std::chrono::high_resolution_clock::now();
+    const std::chrono::duration<double> duration = end - start;
+    return duration.count();
+}
+
+// Benchmark re-distortion with and without the inverse guess grid,
+// and check both give the same result.
+int test_guess_grid_3de_classic(const size_t width, const size_t height,
+                                const int verbosity) {
+    const auto test_name = "test_guess_grid_3de_classic";
+    std::cout << test_name << ": width=" << width << " height=" << height
+              << " verbosity=" << verbosity << std::endl;
+
+    const size_t count = width * height;
+    std::vector<double> in_x_vec;
+    std::vector<double> in_y_vec;
+    generate_points_ndc(width, height, in_x_vec, in_y_vec);
+
+    auto lens = mmlens::LensModel3deClassic();
+    lens.setFocalLength(3.5);
+    lens.setFilmBackWidth(3.6);
+    lens.setFilmBackHeight(2.4);
+    lens.setDistortion(0.1);
+    lens.setQuarticDistortion(0.1);
+
+    std::vector<double> off_x_vec(count);
+    std::vector<double> off_y_vec(count);
+    std::vector<double> on_x_vec(count);
+    std::vector<double> on_y_vec(count);
+    std::vector<double> again_x_vec(count);
+    std::vector<double> again_y_vec(count);
+
+    const double off_seconds =
+        redistort_points(lens, in_x_vec, in_y_vec, off_x_vec, off_y_vec);
+
+    // Each call builds its own grid.
+    lens.setUseInverseGuessGrid(true);
+    const double on_seconds =
+        redistort_points(lens, in_x_vec, in_y_vec, on_x_vec, on_y_vec);
+    redistort_points(lens, in_x_vec, in_y_vec, again_x_vec, again_y_vec);
+
+    // The results only depend on the points given to the call, so
+    // calling again gives exactly the same results.
+    if ((on_x_vec != again_x_vec) || (on_y_vec != again_y_vec)) {
+        std::cerr << test_name << ": FAILED; results differ between calls."
+                  << std::endl;
+        return 1;
+    }
+
+    // A small batch does not repay the cost of building a grid, so
+    // no grid is used, and the results are exactly the same as
+    // without a grid.
+    const size_t small_count = 16;
+    std::vector<double> small_x_vec(small_count);
+    std::vector<double> small_y_vec(small_count);
+    lens.applyModelDistortBatch(&in_x_vec[0], &in_y_vec[0], small_count,
+                                &small_x_vec[0], &small_y_vec[0]);
+    if (!std::equal(small_x_vec.begin(), small_x_vec.end(),
+                    off_x_vec.begin()) ||
+        !std::equal(small_y_vec.begin(), small_y_vec.end(),
+                    off_y_vec.begin())) {
+        std::cerr << test_name << ": FAILED; small batch used a grid."
+                  << std::endl;
+        return 1;
+    }
+
+    double max_difference = 0.0;
+    for (size_t i = 0; i < count; i++) {
+        max_difference =
+            std::max(max_difference, std::fabs(off_x_vec[i] - on_x_vec[i]));
+        max_difference =
+            std::max(max_difference, std::fabs(off_y_vec[i] - on_y_vec[i]));
+    }
+
+    const double off_throughput = static_cast<double>(count) / off_seconds;
+    const double on_throughput = static_cast<double>(count) / on_seconds;
+    std::cout << test_name << ": grid off: " << off_seconds << " seconds ("
+              << off_throughput << " points/second)\n"
+              << test_name << ": grid on (with build): " << on_seconds
+              << " seconds ("
+              << on_throughput << " points/second)\n"
+              << test_name << ": speed up: " << (off_seconds / on_seconds)
+              << "x max difference: " << max_difference << std::endl;
+
+    // The results are only expected to match within the convergence
+    // tolerance of the iterative inverse distortion.
+    const double tolerance = 1e-6;
+    if (max_difference > tolerance) {
+        std::cerr << test_name << ": FAILED; results differ by "
+                  << max_difference << '.' << std::endl;
+        return 1;
+    }
+    return 0;
+}
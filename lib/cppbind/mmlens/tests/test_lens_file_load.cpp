@@ -24,6 +24,7 @@
 #include <mmlens/mmlens.h>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 
@@ -128,3 +129,62 @@ int test_lens_file_load(const char* dir_path, const char* file_name) {
 
     return 0;
 }
+
+// The first read of a lens file writes the binary cache file, the
+// second read comes from the cache file; both must give the same
+// distortion layers.
+int test_lens_file_cache(const char* dir_path, const char* file_name) {
+    const auto test_name = "test_lens_file_cache";
+    std::cout << "Running... " << test_name << std::endl;
+
+    std::string file_path_string = join_path(dir_path, file_name);
+    rust::Str file_path = file_path_string.c_str();
+
+    std::chrono::duration<float> first_duration;
+    mmlens::DistortionLayers first_layers;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        first_layers = mmlens::read_lens_file(file_path);
+        auto end = std::chrono::high_resolution_clock::now();
+        first_duration = end - start;
+    }
+
+    std::chrono::duration<float> second_duration;
+    mmlens::DistortionLayers second_layers;
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        second_layers = mmlens::read_lens_file(file_path);
+        auto end = std::chrono::high_resolution_clock::now();
+        second_duration = end - start;
+    }
+
+    std::cout << test_name << " " << file_name
+              << ": first read=" << first_duration.count() << "s"
+              << " second read=" << second_duration.count() << "s"
+              << std::endl;
+
+    const rust::String first_string = first_layers.as_string();
+    const rust::String second_string = second_layers.as_string();
+    if (first_string != second_string) {
+        std::cerr << test_name << ": ERROR: " << file_name
+                  << " cached distortion layers do not match." << std::endl;
+        return 1;
+    }
+
+    mmlens::FrameNumber start_frame = 0;
+    mmlens::FrameNumber end_frame = 0;
+    first_layers.frame_range(start_frame, end_frame);
+    for (auto frame = start_frame; frame <= end_frame; frame++) {
+        if (first_layers.frame_hash(frame) != second_layers.frame_hash(frame)) {
+            std::cerr << test_name << ": ERROR: " << file_name
+                      << " cached frame hash does not match, frame="
+                      << frame << std::endl;
+            return 1;
+        }
+        if (frame == end_frame) {
+            break;
+        }
+    }
+
+    return 0;
+}
@@ -22,3 +22,5 @@
 #pragma once
 
 int test_lens_file_load(const char* dir_path, const char* file_name);
+
+int test_lens_file_cache(const char* dir_path, const char* file_name);
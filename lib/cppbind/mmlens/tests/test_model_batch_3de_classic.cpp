@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_model_batch_3de_classic.h"
+
+#include <mmlens/mmlens.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "common.h"
+
+// Evaluates a chain of two lens models on many threads (as used by
+// the mmLensDeformer node), and checks the result matches evaluating
+// each point once. The time taken by each method is printed, so this
+// test doubles as a benchmark.
+int test_model_batch_3de_classic(const size_t width, const size_t height,
+                                 const int verbosity) {
+    const auto test_name = "test_model_batch_3de_classic";
+    std::cout << test_name << ": width=" << width << " height=" << height
+              << " verbosity=" << verbosity << std::endl;
+
+    const size_t count = width * height;
+    std::vector<double> in_x_vec;
+    std::vector<double> in_y_vec;
+    generate_points_ndc(width, height, in_x_vec, in_y_vec);
+
+    auto input_lens =
+        std::make_shared<mmlens::LensModel3deRadialDecenteredDeg4Cylindric>();
+    input_lens->setDegree2Distortion(0.05);
+    input_lens->setDegree4Distortion(0.01);
+    input_lens->setCylindricBending(0.01);
+
+    auto lens = mmlens::LensModel3deClassic();
+    lens.setFocalLength(3.5);
+    lens.setFilmBackWidth(3.6);
+    lens.setFilmBackHeight(2.4);
+    lens.setDistortion(0.1);
+    lens.setQuarticDistortion(0.1);
+    lens.setInputLensModel(input_lens);
+
+    std::vector<double> once_x_vec(count);
+    std::vector<double> once_y_vec(count);
+    std::vector<double> batch_x_vec(count);
+    std::vector<double> batch_y_vec(count);
+
+    // 0 == the hardware thread count.
+    const int32_t num_threads = 0;
+
+    size_t mismatches = 0;
+    for (int direction = kDirectionUndistort; direction <= kDirectionRedistort;
+         direction++) {
+        std::chrono::duration<float> once_duration;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            for (size_t i = 0; i < count; i++) {
+                if (direction == kDirectionUndistort) {
+                    lens.applyModelUndistort(in_x_vec[i], in_y_vec[i],
+                                             once_x_vec[i], once_y_vec[i]);
+                } else {
+                    lens.applyModelDistort(in_x_vec[i], in_y_vec[i],
+                                           once_x_vec[i], once_y_vec[i]);
+                }
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            once_duration = end - start;
+        }
+
+        // Dirty the lens, so the multithreaded function must update
+        // the lens state before it starts threads.
+        lens.setFocalLength(3.6);
+        lens.setFocalLength(3.5);
+
+        std::chrono::duration<float> batch_duration;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            if (direction == kDirectionUndistort) {
+                mmlens::apply_model_undistort_batch_multithread(
+                    lens, &in_x_vec[0], &in_y_vec[0], count, &batch_x_vec[0],
+                    &batch_y_vec[0], num_threads);
+            } else {
+                mmlens::apply_model_distort_batch_multithread(
+                    lens, &in_x_vec[0], &in_y_vec[0], count, &batch_x_vec[0],
+                    &batch_y_vec[0], num_threads);
+            }
+            auto end = std::chrono::high_resolution_clock::now();
+            batch_duration = end - start;
+        }
+
+        const size_t direction_mismatches =
+            count_mismatches(once_x_vec, batch_x_vec) +
+            count_mismatches(once_y_vec, batch_y_vec);
+        mismatches += direction_mismatches;
+
+        const auto direction_name =
+            (direction == kDirectionUndistort) ? "undistort" : "redistort";
+        std::cout << test_name << ": " << direction_name << std::fixed
+                  << std::setprecision(6)
+                  << " per-point=" << once_duration.count() << "s"
+                  << " batch-multithread=" << batch_duration.count() << "s"
+                  << " mismatches=" << direction_mismatches << std::endl;
+    }
+
+    if (mismatches > 0) {
+        std::cerr << test_name << ": FAILED; " << mismatches
+                  << " values do not match." << std::endl;
+        return 1;
+    }
+    return 0;
+}
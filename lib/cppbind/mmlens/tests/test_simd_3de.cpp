@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_simd_3de.h"
+
+#include <mmlens/mmlens.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "common.h"
+
+namespace {
+
+// Undistort and re-distort an identity ST-map with 'lens_parameters'
+// using 'simd_level', returning 4 values per pixel.
+template <typename LENS_TYPE>
+std::vector<double> compute_identity(const size_t width, const size_t height,
+                                     const mmlens::SimdLevel simd_level,
+                                     const mmlens::CameraParameters camera,
+                                     const LENS_TYPE& lens_parameters) {
+    const size_t out_data_stride = 4;
+    std::vector<double> out_data_vec(width * height * out_data_stride);
+    const double film_back_radius_cm =
+        mmlens::compute_diagonal_normalized_camera_factor(camera);
+
+    mmlens::set_simd_level(simd_level);
+    const auto image_dimensions =
+        mmlens::ImageDimensions{width, height, 0, 0, width, height};
+    mmlens::apply_identity_to_f64(
+        mmlens::DistortionDirection::kUndistortAndRedistort, image_dimensions,
+        &out_data_vec[0], out_data_vec.size(), out_data_stride, camera,
+        film_back_radius_cm, lens_parameters);
+    return out_data_vec;
+}
+
+// Count the values that differ between the scalar (LDPK) and SIMD
+// evaluation of 'lens_parameters'.
+//
+// Re-distortion is iterative and each implementation stops at a
+// slightly different value, so values are only expected to match
+// within the convergence tolerance.
+template <typename LENS_TYPE>
+size_t count_simd_mismatches(const char* test_name, const size_t width,
+                             const size_t height,
+                             const mmlens::CameraParameters camera,
+                             const LENS_TYPE& lens_parameters,
+                             const int verbosity) {
+    const double tolerance = 1e-6;
+    const std::vector<double> scalar_data_vec = compute_identity<LENS_TYPE>(
+        width, height, mmlens::SimdLevel::kScalar, camera, lens_parameters);
+    const std::vector<double> simd_data_vec = compute_identity<LENS_TYPE>(
+        width, height, mmlens::detect_simd_level(), camera, lens_parameters);
+
+    size_t count = 0;
+    for (size_t i = 0; i < scalar_data_vec.size(); i++) {
+        // Written so that NaN values are counted.
+        if (!(std::fabs(scalar_data_vec[i] - simd_data_vec[i]) <= tolerance)) {
+            count++;
+        }
+    }
+    if (verbosity >= 2) {
+        const auto print_compare = " == ";
+        print_data_2d_compare<double, double>(
+            test_name, print_compare, width, height, 4, 4, &scalar_data_vec[0],
+            &simd_data_vec[0]);
+    }
+    return count;
+}
+
+}  // namespace
+
+// Evaluates each 3DE lens model with the SIMD kernels and the scalar
+// (LDPK) functions, and checks the results match.
+int test_simd_3de(const size_t width, const size_t height,
+                  const int verbosity) {
+    const auto test_name = "test_simd_3de";
+    std::cout << test_name << ": width=" << width << " height=" << height
+              << " simd_level="
+              << static_cast<int>(mmlens::detect_simd_level())
+              << " verbosity=" << verbosity << std::endl;
+
+    // A lens center offset and non-square pixels are used to check
+    // the coordinate conversions of the kernels.
+    const double focal_length_cm = 3.5;
+    const double film_back_width_cm = 3.6;
+    const double film_back_height_cm = 2.4;
+    const double pixel_aspect = 1.2;
+    const double lens_center_offset_x_cm = 0.01;
+    const double lens_center_offset_y_cm = -0.02;
+    const mmlens::CameraParameters camera{
+        focal_length_cm, film_back_width_cm,      film_back_height_cm,
+        pixel_aspect,    lens_center_offset_x_cm, lens_center_offset_y_cm};
+
+    auto classic = mmlens::Parameters3deClassic();
+    classic.distortion = 0.1;
+    classic.anamorphic_squeeze = 1.1;
+    classic.curvature_x = 0.02;
+    classic.curvature_y = -0.03;
+    classic.quartic_distortion = 0.05;
+
+    auto radial = mmlens::Parameters3deRadialStdDeg4();
+    radial.degree2_distortion = 0.05;
+    radial.degree2_u = 0.01;
+    radial.degree2_v = -0.01;
+    radial.degree4_distortion = 0.02;
+    radial.degree4_u = 0.005;
+    radial.degree4_v = -0.003;
+    radial.cylindric_direction = 15.0;
+    radial.cylindric_bending = 0.01;
+
+    auto anamorphic_deg4 = mmlens::Parameters3deAnamorphicStdDeg4();
+    anamorphic_deg4.degree2_cx02 = 0.05;
+    anamorphic_deg4.degree2_cy02 = 0.04;
+    anamorphic_deg4.degree2_cx22 = 0.01;
+    anamorphic_deg4.degree2_cy22 = -0.01;
+    anamorphic_deg4.degree4_cx04 = 0.01;
+    anamorphic_deg4.degree4_cy04 = 0.005;
+    anamorphic_deg4.degree4_cx24 = -0.002;
+    anamorphic_deg4.degree4_cy24 = 0.003;
+    anamorphic_deg4.degree4_cx44 = 0.001;
+    anamorphic_deg4.degree4_cy44 = -0.001;
+    anamorphic_deg4.lens_rotation = 2.0;
+    anamorphic_deg4.squeeze_x = 1.0;
+    anamorphic_deg4.squeeze_y = 0.98;
+
+    auto anamorphic_deg4_rescaled =
+        mmlens::Parameters3deAnamorphicStdDeg4Rescaled();
+    anamorphic_deg4_rescaled.degree2_cx02 = anamorphic_deg4.degree2_cx02;
+    anamorphic_deg4_rescaled.degree2_cy02 = anamorphic_deg4.degree2_cy02;
+    anamorphic_deg4_rescaled.degree2_cx22 = anamorphic_deg4.degree2_cx22;
+    anamorphic_deg4_rescaled.degree2_cy22 = anamorphic_deg4.degree2_cy22;
+    anamorphic_deg4_rescaled.degree4_cx04 = anamorphic_deg4.degree4_cx04;
+    anamorphic_deg4_rescaled.degree4_cy04 = anamorphic_deg4.degree4_cy04;
+    anamorphic_deg4_rescaled.degree4_cx24 = anamorphic_deg4.degree4_cx24;
+    anamorphic_deg4_rescaled.degree4_cy24 = anamorphic_deg4.degree4_cy24;
+    anamorphic_deg4_rescaled.degree4_cx44 = anamorphic_deg4.degree4_cx44;
+    anamorphic_deg4_rescaled.degree4_cy44 = anamorphic_deg4.degree4_cy44;
+    anamorphic_deg4_rescaled.lens_rotation = anamorphic_deg4.lens_rotation;
+    anamorphic_deg4_rescaled.squeeze_x = anamorphic_deg4.squeeze_x;
+    anamorphic_deg4_rescaled.squeeze_y = anamorphic_deg4.squeeze_y;
+    anamorphic_deg4_rescaled.rescale = 1.05;
+
+    auto anamorphic_deg6 = mmlens::Parameters3deAnamorphicStdDeg6();
+    anamorphic_deg6.degree2_cx02 = anamorphic_deg4.degree2_cx02;
+    anamorphic_deg6.degree2_cy02 = anamorphic_deg4.degree2_cy02;
+    anamorphic_deg6.degree2_cx22 = anamorphic_deg4.degree2_cx22;
+    anamorphic_deg6.degree2_cy22 = anamorphic_deg4.degree2_cy22;
+    anamorphic_deg6.degree4_cx04 = anamorphic_deg4.degree4_cx04;
+    anamorphic_deg6.degree4_cy04 = anamorphic_deg4.degree4_cy04;
+    anamorphic_deg6.degree4_cx24 = anamorphic_deg4.degree4_cx24;
+    anamorphic_deg6.degree4_cy24 = anamorphic_deg4.degree4_cy24;
+    anamorphic_deg6.degree4_cx44 = anamorphic_deg4.degree4_cx44;
+    anamorphic_deg6.degree4_cy44 = anamorphic_deg4.degree4_cy44;
+    anamorphic_deg6.degree6_cx06 = 0.002;
+    anamorphic_deg6.degree6_cy06 = -0.001;
+    anamorphic_deg6.degree6_cx26 = 0.001;
+    anamorphic_deg6.degree6_cy26 = 0.001;
+    anamorphic_deg6.degree6_cx46 = -0.0005;
+    anamorphic_deg6.degree6_cy46 = 0.0005;
+    anamorphic_deg6.degree6_cx66 = 0.0002;
+    anamorphic_deg6.degree6_cy66 = -0.0002;
+    anamorphic_deg6.lens_rotation = anamorphic_deg4.lens_rotation;
+    anamorphic_deg6.squeeze_x = anamorphic_deg4.squeeze_x;
+    anamorphic_deg6.squeeze_y = anamorphic_deg4.squeeze_y;
+
+    const mmlens::SimdLevel original_simd_level = mmlens::get_simd_level();
+
+    size_t mismatches = 0;
+    mismatches += count_simd_mismatches<mmlens::Parameters3deClassic>(
+        test_name, width, height, camera, classic, verbosity);
+    mismatches += count_simd_mismatches<mmlens::Parameters3deRadialStdDeg4>(
+        test_name, width, height, camera, radial, verbosity);
+    mismatches += count_simd_mismatches<mmlens::Parameters3deAnamorphicStdDeg4>(
+        test_name, width, height, camera, anamorphic_deg4, verbosity);
+    mismatches += count_simd_mismatches<
+        mmlens::Parameters3deAnamorphicStdDeg4Rescaled>(
+        test_name, width, height, camera, anamorphic_deg4_rescaled, verbosity);
+    mismatches += count_simd_mismatches<mmlens::Parameters3deAnamorphicStdDeg6>(
+        test_name, width, height, camera, anamorphic_deg6, verbosity);
+
+    mmlens::set_simd_level(original_simd_level);
+
+    if (mismatches > 0) {
+        std::cerr << test_name << ": FAILED; " << mismatches
+                  << " values do not match." << std::endl;
+        return 1;
+    }
+    return 0;
+}
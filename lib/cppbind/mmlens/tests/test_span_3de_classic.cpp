@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_span_3de_classic.h"
+
+#include <mmlens/mmlens.h>
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "common.h"
+
+// Evaluates a chain of two lens models with the batched (span)
+// functions, and checks the result matches evaluating each point
+// once.
+int test_span_3de_classic(const size_t width, const size_t height,
+                          const int verbosity) {
+    const auto test_name = "test_span_3de_classic";
+    std::cout << test_name << ": width=" << width << " height=" << height
+              << " verbosity=" << verbosity << std::endl;
+
+    const size_t count = width * height;
+    std::vector<double> in_x_vec;
+    std::vector<double> in_y_vec;
+    generate_points_ndc(width, height, in_x_vec, in_y_vec);
+
+    auto input_lens =
+        std::make_shared<mmlens::LensModel3deRadialDecenteredDeg4Cylindric>();
+    input_lens->setDegree2Distortion(0.05);
+    input_lens->setDegree4Distortion(0.01);
+    input_lens->setCylindricBending(0.01);
+
+    auto lens = mmlens::LensModel3deClassic();
+    lens.setFocalLength(3.5);
+    lens.setFilmBackWidth(3.6);
+    lens.setFilmBackHeight(2.4);
+    lens.setDistortion(0.1);
+    lens.setQuarticDistortion(0.1);
+    lens.setInputLensModel(input_lens);
+
+    std::vector<double> once_x_vec(count);
+    std::vector<double> once_y_vec(count);
+    std::vector<double> span_x_vec(count);
+    std::vector<double> span_y_vec(count);
+
+    size_t mismatches = 0;
+    for (int direction = kDirectionUndistort; direction <= kDirectionRedistort;
+         direction++) {
+        for (size_t i = 0; i < count; i++) {
+            if (direction == kDirectionUndistort) {
+                lens.applyModelUndistort(in_x_vec[i], in_y_vec[i],
+                                         once_x_vec[i], once_y_vec[i]);
+            } else {
+                lens.applyModelDistort(in_x_vec[i], in_y_vec[i], once_x_vec[i],
+                                       once_y_vec[i]);
+            }
+        }
+
+        // The output buffers are also the input buffers, to test
+        // in-place evaluation.
+        span_x_vec = in_x_vec;
+        span_y_vec = in_y_vec;
+        if (direction == kDirectionUndistort) {
+            lens.applyModelUndistortBatch(&span_x_vec[0], &span_y_vec[0],
+                                          count, &span_x_vec[0],
+                                          &span_y_vec[0]);
+        } else {
+            lens.applyModelDistortBatch(&span_x_vec[0], &span_y_vec[0], count,
+                                        &span_x_vec[0], &span_y_vec[0]);
+        }
+
+        mismatches += count_mismatches(once_x_vec, span_x_vec);
+        mismatches += count_mismatches(once_y_vec, span_y_vec);
+        if (verbosity >= 2) {
+            std::vector<double> once_data_vec(count * 2);
+            std::vector<double> span_data_vec(count * 2);
+            for (size_t i = 0; i < count; i++) {
+                once_data_vec[(i * 2) + 0] = once_x_vec[i];
+                once_data_vec[(i * 2) + 1] = once_y_vec[i];
+                span_data_vec[(i * 2) + 0] = span_x_vec[i];
+                span_data_vec[(i * 2) + 1] = span_y_vec[i];
+            }
+            const auto print_compare = " == ";
+            print_data_2d_compare<double, double>(
+                test_name, print_compare, width, height, 2, 2,
+                &once_data_vec[0], &span_data_vec[0]);
+        }
+    }
+
+    if (mismatches > 0) {
+        std::cerr << test_name << ": FAILED; " << mismatches
+                  << " values do not match." << std::endl;
+        return 1;
+    }
+    return 0;
+}
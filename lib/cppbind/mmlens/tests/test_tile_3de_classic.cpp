@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ */
+
+#include "test_tile_3de_classic.h"
+
+#include <mmlens/mmlens.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "common.h"
+
+// Evaluates the multithreaded functions with a range of parallel tile
+// sizes, and checks the result matches the single threaded
+// functions. The time taken for each tile size is printed, so this
+// test doubles as a benchmark.
+int test_tile_3de_classic(const size_t width, const size_t height,
+                          const int verbosity) {
+    const auto test_name = "test_tile_3de_classic";
+    std::cout << test_name << ": width=" << width << " height=" << height
+              << " verbosity=" << verbosity << std::endl;
+
+    const double focal_length_cm = 3.5;
+    const double film_back_width_cm = 3.6;
+    const double film_back_height_cm = 2.4;
+    const double pixel_aspect = 1.0;
+    const double lens_center_offset_x_cm = 0.0;
+    const double lens_center_offset_y_cm = 0.0;
+    const mmlens::CameraParameters camera_parameters{
+        focal_length_cm, film_back_width_cm,      film_back_height_cm,
+        pixel_aspect,    lens_center_offset_x_cm, lens_center_offset_y_cm};
+    const double film_back_radius_cm =
+        mmlens::compute_diagonal_normalized_camera_factor(camera_parameters);
+
+    auto lens = mmlens::Parameters3deClassic();
+    lens.distortion = 0.1;
+    lens.anamorphic_squeeze = 1.0;
+    lens.curvature_x = 0.0;
+    lens.curvature_y = 0.0;
+    lens.quartic_distortion = 0.1;
+
+    const size_t pixel_count = width * height;
+    const size_t in_data_stride = 2;
+    const size_t out_data_stride = 4;
+    const size_t in_data_size = pixel_count * in_data_stride;
+    const size_t out_data_size = pixel_count * out_data_stride;
+
+    // The single threaded result, used as the reference.
+    std::vector<double> reference_in_data_vec(in_data_size);
+    std::vector<float> reference_out_data_vec(out_data_size);
+    {
+        auto image_dimensions =
+            mmlens::ImageDimensions{width, height, 0, 0, width, height};
+        mmlens::apply_identity_to_f64(
+            mmlens::DistortionDirection::kUndistort, image_dimensions,
+            &reference_in_data_vec[0], in_data_size, in_data_stride,
+            camera_parameters, film_back_radius_cm, lens);
+        mmlens::apply_f64_to_f32(
+            mmlens::DistortionDirection::kRedistort, 0, pixel_count,
+            &reference_in_data_vec[0], in_data_size, in_data_stride,
+            &reference_out_data_vec[0], out_data_size, out_data_stride,
+            camera_parameters, film_back_radius_cm, lens);
+    }
+
+    // Tile sizes to test; (0, 0) is the automatic tile size, and
+    // (width, 1) is a single scanline per-task.
+    std::vector<std::pair<size_t, size_t>> tile_sizes;
+    tile_sizes.push_back(std::make_pair(0, 0));
+    tile_sizes.push_back(std::make_pair(width, 1));
+    tile_sizes.push_back(std::make_pair(16, 16));
+    tile_sizes.push_back(std::make_pair(64, 64));
+    tile_sizes.push_back(std::make_pair(256, 256));
+    tile_sizes.push_back(std::make_pair(width, height));
+
+    std::vector<double> in_data_vec(in_data_size);
+    std::vector<float> out_data_vec(out_data_size);
+    size_t mismatches = 0;
+    for (const auto& tile_size : tile_sizes) {
+        mmlens::set_parallel_tile_size(tile_size.first, tile_size.second);
+
+        std::chrono::duration<float> undistort_duration;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            mmlens::apply_identity_to_f64_multithread(
+                mmlens::DistortionDirection::kUndistort, width, height,
+                &in_data_vec[0], in_data_size, in_data_stride,
+                camera_parameters, film_back_radius_cm, lens);
+            auto end = std::chrono::high_resolution_clock::now();
+            undistort_duration = end - start;
+        }
+
+        std::chrono::duration<float> redistort_duration;
+        {
+            auto start = std::chrono::high_resolution_clock::now();
+            mmlens::apply_f64_to_f32_multithread(
+                mmlens::DistortionDirection::kRedistort, &in_data_vec[0],
+                in_data_size, in_data_stride, &out_data_vec[0],
+                out_data_size, out_data_stride, camera_parameters,
+                film_back_radius_cm, lens);
+            auto end = std::chrono::high_resolution_clock::now();
+            redistort_duration = end - start;
+        }
+
+        const size_t tile_mismatches =
+            count_mismatches(reference_in_data_vec, in_data_vec) +
+            count_mismatches(reference_out_data_vec, out_data_vec);
+        mismatches += tile_mismatches;
+
+        std::cout << test_name << ": tile=" << tile_size.first << 'x'
+                  << tile_size.second << std::fixed << std::setprecision(6)
+                  << " undistort=" << undistort_duration.count() << "s"
+                  << " redistort=" << redistort_duration.count() << "s"
+                  << " mismatches=" << tile_mismatches << std::endl;
+
+        if (verbosity >= 2) {
+            const auto print_compare = " == ";
+            print_data_2d_compare<double, double>(
+                test_name, print_compare, width, height, in_data_stride,
+                in_data_stride, &reference_in_data_vec[0], &in_data_vec[0]);
+        }
+    }
+
+    // Restore the default; the automatic tile size.
+    mmlens::set_parallel_tile_size(0, 0);
+
+    if (mismatches > 0) {
+        std::cerr << test_name << ": FAILED; " << mismatches
+                  << " values do not match." << std::endl;
+        return 1;
+    }
+    return 0;
+}
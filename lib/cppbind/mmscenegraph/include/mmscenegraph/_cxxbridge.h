@@ -877,6 +877,7 @@ enum class AttrType : ::std::uint8_t {
   kAnimDense = 0,
   kStatic = 1,
   kNone = 2,
+  kAnimRle = 3,
   kUnknown = 255,
 };
 #endif // CXXBRIDGE1_ENUM_mmscenegraph$AttrType
@@ -1101,10 +1102,14 @@ struct ShimAttrDataBlock final : public ::rust::Opaque {
   MMSCENEGRAPH_API_EXPORT void clear() noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_static() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_anim_dense() const noexcept;
+  MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_anim_rle() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_static(double value) noexcept;
   MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_anim_dense(::rust::Vec<double> values, ::std::uint32_t frame_start) noexcept;
+  MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_anim_rle(::rust::Slice<const ::std::uint32_t> run_frames, ::rust::Slice<const double> run_values, ::std::uint32_t frame_start, ::std::uint32_t frame_end) noexcept;
   MMSCENEGRAPH_API_EXPORT double get_attr_value(::mmscenegraph::AttrId attr_id, ::std::uint32_t frame) const noexcept;
   MMSCENEGRAPH_API_EXPORT bool set_attr_value(::mmscenegraph::AttrId attr_id, ::std::uint32_t frame, double value) noexcept;
+  MMSCENEGRAPH_API_EXPORT bool get_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<double> out_values) const noexcept;
+  MMSCENEGRAPH_API_EXPORT bool set_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<const double> values, ::rust::Slice<::std::uint8_t> out_changed) noexcept;
   ~ShimAttrDataBlock() = delete;
 
 private:
@@ -1149,7 +1154,9 @@ struct ShimFlatScene final : public ::rust::Opaque {
   MMSCENEGRAPH_API_EXPORT ::rust::Slice<const double> points() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_markers() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_points() const noexcept;
+  MMSCENEGRAPH_API_EXPORT void set_frame_parallel_grain_size(::std::size_t value) noexcept;
   MMSCENEGRAPH_API_EXPORT void evaluate(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list) noexcept;
+  MMSCENEGRAPH_API_EXPORT void evaluate_dirty(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list, ::rust::Slice<const ::mmscenegraph::AttrId> dirty_attr_list, ::rust::Slice<const ::std::uint32_t> dirty_frame_list) noexcept;
   ~ShimFlatScene() = delete;
 
 private:
@@ -1187,12 +1194,16 @@ private:
 
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimAttrDataBlock> shim_create_attr_data_block_box() noexcept;
 
+MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimAttrDataBlock> shim_clone_attr_data_block_box(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb) noexcept;
+
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimSceneGraph> shim_create_scene_graph_box() noexcept;
 
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_bake_scene_graph(const ::rust::Box<::mmscenegraph::ShimSceneGraph> &sg, const ::rust::Box<::mmscenegraph::ShimEvaluationObjects> &eval_objects) noexcept;
 
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_create_flat_scene_box() noexcept;
 
+MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_clone_flat_scene_box(const ::rust::Box<::mmscenegraph::ShimFlatScene> &flat_scene) noexcept;
+
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimEvaluationObjects> shim_create_evaluation_objects_box() noexcept;
 
 MMSCENEGRAPH_API_EXPORT bool shim_fit_line_to_points_type2(::rust::Slice<const double> x, ::rust::Slice<const double> y, double &out_point_x, double &out_point_y, double &out_dir_x, double &out_dir_y) noexcept;
@@ -22,8 +22,10 @@
 #ifndef MM_SOLVER_MM_SCENE_GRAPH_ATTR_DATA_BLOCK_H
 #define MM_SOLVER_MM_SCENE_GRAPH_ATTR_DATA_BLOCK_H
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "_cxx.h"
 #include "_cxxbridge.h"
@@ -37,6 +39,15 @@ public:
     MMSCENEGRAPH_API_EXPORT
     AttrDataBlock() noexcept;
 
+    MMSCENEGRAPH_API_EXPORT
+    explicit AttrDataBlock(
+        rust::Box<ShimAttrDataBlock> attr_data_block) noexcept;
+
+    // Create a deep copy of the attribute data, for example to be
+    // evaluated on another thread.
+    MMSCENEGRAPH_API_EXPORT
+    AttrDataBlock clone() const noexcept;
+
     MMSCENEGRAPH_API_EXPORT
     rust::Box<ShimAttrDataBlock> get_inner() noexcept;
 
@@ -52,6 +63,9 @@ public:
     MMSCENEGRAPH_API_EXPORT
     size_t num_attr_anim_dense() noexcept;
 
+    MMSCENEGRAPH_API_EXPORT
+    size_t num_attr_anim_rle() noexcept;
+
     MMSCENEGRAPH_API_EXPORT
     AttrId create_attr_static(Real value) noexcept;
 
@@ -59,12 +73,45 @@ public:
     AttrId create_attr_anim_dense(rust::Vec<Real> values,
                                   FrameValue frame_start) noexcept;
 
+    // Create an animated attribute from runs of constant values;
+    // each run starts at a frame and holds its value until the next
+    // run. The first run must start at 'frame_start'.
+    MMSCENEGRAPH_API_EXPORT
+    AttrId create_attr_anim_rle(const std::vector<FrameValue> &run_frames,
+                                const std::vector<Real> &run_values,
+                                FrameValue frame_start,
+                                FrameValue frame_end) noexcept;
+
     MMSCENEGRAPH_API_EXPORT
     Real get_attr_value(AttrId attr_id, FrameValue frame) const noexcept;
 
     MMSCENEGRAPH_API_EXPORT
     bool set_attr_value(AttrId attr_id, FrameValue frame, Real value) noexcept;
 
+    // Get the values of many attributes, in one call. 'attr_ids' and
+    // 'frames' are pairs; 'out_values' is resized to match.
+    //
+    // Returns false, without getting any values, if 'attr_ids' and
+    // 'frames' have different lengths.
+    MMSCENEGRAPH_API_EXPORT
+    bool get_attr_values(const std::vector<AttrId> &attr_ids,
+                         const std::vector<FrameValue> &frames,
+                         std::vector<Real> &out_values) const noexcept;
+
+    // Set the values of many attributes, in one call. 'attr_ids',
+    // 'frames' and 'values' are pairs; 'out_changed' is resized to
+    // match and set to 1 for each value that was different to the
+    // previous value.
+    //
+    // Returns false, without setting any values, if any value is not
+    // finite, or 'attr_ids', 'frames' and 'values' have different
+    // lengths.
+    MMSCENEGRAPH_API_EXPORT
+    bool set_attr_values(const std::vector<AttrId> &attr_ids,
+                         const std::vector<FrameValue> &frames,
+                         const std::vector<Real> &values,
+                         std::vector<uint8_t> &out_changed) noexcept;
+
 private:
     rust::Box<ShimAttrDataBlock> inner_;
 };
@@ -41,6 +41,12 @@ public:
     MMSCENEGRAPH_API_EXPORT
     explicit FlatScene(rust::Box<ShimFlatScene> flat_scene) noexcept;
 
+    // Create a deep copy of the flat scene, including the last
+    // evaluated values, for example to be evaluated on another
+    // thread.
+    MMSCENEGRAPH_API_EXPORT
+    FlatScene clone() const noexcept;
+
     MMSCENEGRAPH_API_EXPORT
     rust::Slice<const Real> markers() const noexcept;
 
@@ -53,10 +59,28 @@ public:
     MMSCENEGRAPH_API_EXPORT
     size_t num_points() const noexcept;
 
+    // The number of frames evaluated by each thread, or zero to
+    // evaluate all frames on the calling thread. Flat scenes
+    // evaluated from a worker thread should use zero, so the thread
+    // pool is not nested inside the worker threads.
+    MMSCENEGRAPH_API_EXPORT
+    void set_frame_parallel_grain_size(size_t value) noexcept;
+
     MMSCENEGRAPH_API_EXPORT
     void evaluate(AttrDataBlock &attrDataBlock,
                   std::vector<FrameValue> &frames) noexcept;
 
+    // Evaluate only the values affected by the attributes changed
+    // since the last evaluation, re-using all other values.
+    //
+    // Each attribute in 'dirtyAttrs' was changed at the same index
+    // frame in 'dirtyFrames' (ignored for static attributes).
+    MMSCENEGRAPH_API_EXPORT
+    void evaluate_dirty(AttrDataBlock &attrDataBlock,
+                        std::vector<FrameValue> &frames,
+                        const std::vector<AttrId> &dirtyAttrs,
+                        const std::vector<FrameValue> &dirtyFrames) noexcept;
+
 private:
     rust::Box<ShimFlatScene> inner_;
 };
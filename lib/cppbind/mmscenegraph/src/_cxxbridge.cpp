@@ -905,6 +905,7 @@ enum class AttrType : ::std::uint8_t {
   kAnimDense = 0,
   kStatic = 1,
   kNone = 2,
+  kAnimRle = 3,
   kUnknown = 255,
 };
 #endif // CXXBRIDGE1_ENUM_mmscenegraph$AttrType
@@ -1129,10 +1130,14 @@ struct ShimAttrDataBlock final : public ::rust::Opaque {
   MMSCENEGRAPH_API_EXPORT void clear() noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_static() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_anim_dense() const noexcept;
+  MMSCENEGRAPH_API_EXPORT ::std::size_t num_attr_anim_rle() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_static(double value) noexcept;
   MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_anim_dense(::rust::Vec<double> values, ::std::uint32_t frame_start) noexcept;
+  MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId create_attr_anim_rle(::rust::Slice<const ::std::uint32_t> run_frames, ::rust::Slice<const double> run_values, ::std::uint32_t frame_start, ::std::uint32_t frame_end) noexcept;
   MMSCENEGRAPH_API_EXPORT double get_attr_value(::mmscenegraph::AttrId attr_id, ::std::uint32_t frame) const noexcept;
   MMSCENEGRAPH_API_EXPORT bool set_attr_value(::mmscenegraph::AttrId attr_id, ::std::uint32_t frame, double value) noexcept;
+  MMSCENEGRAPH_API_EXPORT bool get_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<double> out_values) const noexcept;
+  MMSCENEGRAPH_API_EXPORT bool set_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<const double> values, ::rust::Slice<::std::uint8_t> out_changed) noexcept;
   ~ShimAttrDataBlock() = delete;
 
 private:
@@ -1177,7 +1182,9 @@ struct ShimFlatScene final : public ::rust::Opaque {
   MMSCENEGRAPH_API_EXPORT ::rust::Slice<const double> points() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_markers() const noexcept;
   MMSCENEGRAPH_API_EXPORT ::std::size_t num_points() const noexcept;
+  MMSCENEGRAPH_API_EXPORT void set_frame_parallel_grain_size(::std::size_t value) noexcept;
   MMSCENEGRAPH_API_EXPORT void evaluate(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list) noexcept;
+  MMSCENEGRAPH_API_EXPORT void evaluate_dirty(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list, ::rust::Slice<const ::mmscenegraph::AttrId> dirty_attr_list, ::rust::Slice<const ::std::uint32_t> dirty_frame_list) noexcept;
   ~ShimFlatScene() = delete;
 
 private:
@@ -1255,15 +1262,25 @@ void mmscenegraph$cxxbridge1$ShimAttrDataBlock$clear(::mmscenegraph::ShimAttrDat
 
 ::std::size_t mmscenegraph$cxxbridge1$ShimAttrDataBlock$num_attr_anim_dense(const ::mmscenegraph::ShimAttrDataBlock &self) noexcept;
 
+::std::size_t mmscenegraph$cxxbridge1$ShimAttrDataBlock$num_attr_anim_rle(const ::mmscenegraph::ShimAttrDataBlock &self) noexcept;
+
 ::mmscenegraph::AttrId mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_static(::mmscenegraph::ShimAttrDataBlock &self, double value) noexcept;
 
 ::mmscenegraph::AttrId mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_anim_dense(::mmscenegraph::ShimAttrDataBlock &self, ::rust::Vec<double> *values, ::std::uint32_t frame_start) noexcept;
 
+::mmscenegraph::AttrId mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_anim_rle(::mmscenegraph::ShimAttrDataBlock &self, ::rust::Slice<const ::std::uint32_t> run_frames, ::rust::Slice<const double> run_values, ::std::uint32_t frame_start, ::std::uint32_t frame_end) noexcept;
+
 double mmscenegraph$cxxbridge1$ShimAttrDataBlock$get_attr_value(const ::mmscenegraph::ShimAttrDataBlock &self, ::mmscenegraph::AttrId attr_id, ::std::uint32_t frame) noexcept;
 
 bool mmscenegraph$cxxbridge1$ShimAttrDataBlock$set_attr_value(::mmscenegraph::ShimAttrDataBlock &self, ::mmscenegraph::AttrId attr_id, ::std::uint32_t frame, double value) noexcept;
 
+bool mmscenegraph$cxxbridge1$ShimAttrDataBlock$get_attr_values(const ::mmscenegraph::ShimAttrDataBlock &self, ::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<double> out_values) noexcept;
+
+bool mmscenegraph$cxxbridge1$ShimAttrDataBlock$set_attr_values(::mmscenegraph::ShimAttrDataBlock &self, ::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<const double> values, ::rust::Slice<::std::uint8_t> out_changed) noexcept;
+
 ::mmscenegraph::ShimAttrDataBlock *mmscenegraph$cxxbridge1$shim_create_attr_data_block_box() noexcept;
+
+::mmscenegraph::ShimAttrDataBlock *mmscenegraph$cxxbridge1$shim_clone_attr_data_block_box(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb) noexcept;
 ::std::size_t mmscenegraph$cxxbridge1$ShimSceneGraph$operator$sizeof() noexcept;
 ::std::size_t mmscenegraph$cxxbridge1$ShimSceneGraph$operator$alignof() noexcept;
 
@@ -1303,11 +1320,17 @@ bool mmscenegraph$cxxbridge1$ShimSceneGraph$set_node_parent(::mmscenegraph::Shim
 
 ::std::size_t mmscenegraph$cxxbridge1$ShimFlatScene$num_points(const ::mmscenegraph::ShimFlatScene &self) noexcept;
 
+void mmscenegraph$cxxbridge1$ShimFlatScene$set_frame_parallel_grain_size(::mmscenegraph::ShimFlatScene &self, ::std::size_t value) noexcept;
+
 void mmscenegraph$cxxbridge1$ShimFlatScene$evaluate(::mmscenegraph::ShimFlatScene &self, const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list) noexcept;
 
+void mmscenegraph$cxxbridge1$ShimFlatScene$evaluate_dirty(::mmscenegraph::ShimFlatScene &self, const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list, ::rust::Slice<const ::mmscenegraph::AttrId> dirty_attr_list, ::rust::Slice<const ::std::uint32_t> dirty_frame_list) noexcept;
+
 ::mmscenegraph::ShimFlatScene *mmscenegraph$cxxbridge1$shim_bake_scene_graph(const ::rust::Box<::mmscenegraph::ShimSceneGraph> &sg, const ::rust::Box<::mmscenegraph::ShimEvaluationObjects> &eval_objects) noexcept;
 
 ::mmscenegraph::ShimFlatScene *mmscenegraph$cxxbridge1$shim_create_flat_scene_box() noexcept;
+
+::mmscenegraph::ShimFlatScene *mmscenegraph$cxxbridge1$shim_clone_flat_scene_box(const ::rust::Box<::mmscenegraph::ShimFlatScene> &flat_scene) noexcept;
 ::std::size_t mmscenegraph$cxxbridge1$ShimEvaluationObjects$operator$sizeof() noexcept;
 ::std::size_t mmscenegraph$cxxbridge1$ShimEvaluationObjects$operator$alignof() noexcept;
 
@@ -1594,6 +1617,10 @@ MMSCENEGRAPH_API_EXPORT ::std::size_t ShimAttrDataBlock::num_attr_anim_dense() c
   return mmscenegraph$cxxbridge1$ShimAttrDataBlock$num_attr_anim_dense(*this);
 }
 
+MMSCENEGRAPH_API_EXPORT ::std::size_t ShimAttrDataBlock::num_attr_anim_rle() const noexcept {
+  return mmscenegraph$cxxbridge1$ShimAttrDataBlock$num_attr_anim_rle(*this);
+}
+
 MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId ShimAttrDataBlock::create_attr_static(double value) noexcept {
   return mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_static(*this, value);
 }
@@ -1603,6 +1630,10 @@ MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId ShimAttrDataBlock::create_attr_an
   return mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_anim_dense(*this, &values$.value, frame_start);
 }
 
+MMSCENEGRAPH_API_EXPORT ::mmscenegraph::AttrId ShimAttrDataBlock::create_attr_anim_rle(::rust::Slice<const ::std::uint32_t> run_frames, ::rust::Slice<const double> run_values, ::std::uint32_t frame_start, ::std::uint32_t frame_end) noexcept {
+  return mmscenegraph$cxxbridge1$ShimAttrDataBlock$create_attr_anim_rle(*this, run_frames, run_values, frame_start, frame_end);
+}
+
 MMSCENEGRAPH_API_EXPORT double ShimAttrDataBlock::get_attr_value(::mmscenegraph::AttrId attr_id, ::std::uint32_t frame) const noexcept {
   return mmscenegraph$cxxbridge1$ShimAttrDataBlock$get_attr_value(*this, attr_id, frame);
 }
@@ -1611,10 +1642,22 @@ MMSCENEGRAPH_API_EXPORT bool ShimAttrDataBlock::set_attr_value(::mmscenegraph::A
   return mmscenegraph$cxxbridge1$ShimAttrDataBlock$set_attr_value(*this, attr_id, frame, value);
 }
 
+MMSCENEGRAPH_API_EXPORT bool ShimAttrDataBlock::get_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<double> out_values) const noexcept {
+  return mmscenegraph$cxxbridge1$ShimAttrDataBlock$get_attr_values(*this, attr_ids, frames, out_values);
+}
+
+MMSCENEGRAPH_API_EXPORT bool ShimAttrDataBlock::set_attr_values(::rust::Slice<const ::mmscenegraph::AttrId> attr_ids, ::rust::Slice<const ::std::uint32_t> frames, ::rust::Slice<const double> values, ::rust::Slice<::std::uint8_t> out_changed) noexcept {
+  return mmscenegraph$cxxbridge1$ShimAttrDataBlock$set_attr_values(*this, attr_ids, frames, values, out_changed);
+}
+
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimAttrDataBlock> shim_create_attr_data_block_box() noexcept {
   return ::rust::Box<::mmscenegraph::ShimAttrDataBlock>::from_raw(mmscenegraph$cxxbridge1$shim_create_attr_data_block_box());
 }
 
+MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimAttrDataBlock> shim_clone_attr_data_block_box(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb) noexcept {
+  return ::rust::Box<::mmscenegraph::ShimAttrDataBlock>::from_raw(mmscenegraph$cxxbridge1$shim_clone_attr_data_block_box(attrdb));
+}
+
 ::std::size_t ShimSceneGraph::layout::size() noexcept {
   return mmscenegraph$cxxbridge1$ShimSceneGraph$operator$sizeof();
 }
@@ -1699,10 +1742,18 @@ MMSCENEGRAPH_API_EXPORT ::std::size_t ShimFlatScene::num_points() const noexcept
   return mmscenegraph$cxxbridge1$ShimFlatScene$num_points(*this);
 }
 
+MMSCENEGRAPH_API_EXPORT void ShimFlatScene::set_frame_parallel_grain_size(::std::size_t value) noexcept {
+  mmscenegraph$cxxbridge1$ShimFlatScene$set_frame_parallel_grain_size(*this, value);
+}
+
 MMSCENEGRAPH_API_EXPORT void ShimFlatScene::evaluate(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list) noexcept {
   mmscenegraph$cxxbridge1$ShimFlatScene$evaluate(*this, attrdb, frame_list);
 }
 
+MMSCENEGRAPH_API_EXPORT void ShimFlatScene::evaluate_dirty(const ::rust::Box<::mmscenegraph::ShimAttrDataBlock> &attrdb, ::rust::Slice<const ::std::uint32_t> frame_list, ::rust::Slice<const ::mmscenegraph::AttrId> dirty_attr_list, ::rust::Slice<const ::std::uint32_t> dirty_frame_list) noexcept {
+  mmscenegraph$cxxbridge1$ShimFlatScene$evaluate_dirty(*this, attrdb, frame_list, dirty_attr_list, dirty_frame_list);
+}
+
 MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_bake_scene_graph(const ::rust::Box<::mmscenegraph::ShimSceneGraph> &sg, const ::rust::Box<::mmscenegraph::ShimEvaluationObjects> &eval_objects) noexcept {
   return ::rust::Box<::mmscenegraph::ShimFlatScene>::from_raw(mmscenegraph$cxxbridge1$shim_bake_scene_graph(sg, eval_objects));
 }
@@ -1711,6 +1762,10 @@ MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_create_f
   return ::rust::Box<::mmscenegraph::ShimFlatScene>::from_raw(mmscenegraph$cxxbridge1$shim_create_flat_scene_box());
 }
 
+MMSCENEGRAPH_API_EXPORT ::rust::Box<::mmscenegraph::ShimFlatScene> shim_clone_flat_scene_box(const ::rust::Box<::mmscenegraph::ShimFlatScene> &flat_scene) noexcept {
+  return ::rust::Box<::mmscenegraph::ShimFlatScene>::from_raw(mmscenegraph$cxxbridge1$shim_clone_flat_scene_box(flat_scene));
+}
+
 ::std::size_t ShimEvaluationObjects::layout::size() noexcept {
   return mmscenegraph$cxxbridge1$ShimEvaluationObjects$operator$sizeof();
 }
@@ -31,6 +31,7 @@ pub fn bind_to_core_attr_id(value: BindAttrId) -> CoreAttrId {
     match value.attr_type {
         BindAttrType::Static => CoreAttrId::Static(value.index),
         BindAttrType::AnimDense => CoreAttrId::AnimDense(value.index),
+        BindAttrType::AnimRle => CoreAttrId::AnimRle(value.index),
         BindAttrType::None => CoreAttrId::None,
         _ => CoreAttrId::None,
     }
@@ -46,6 +47,10 @@ pub fn core_to_bind_attr_id(value: CoreAttrId) -> BindAttrId {
             attr_type: BindAttrType::AnimDense,
             index,
         },
+        CoreAttrId::AnimRle(index) => BindAttrId {
+            attr_type: BindAttrType::AnimRle,
+            index,
+        },
         _ => BindAttrId {
             attr_type: BindAttrType::None,
             index: 0,
@@ -23,12 +23,21 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 namespace mmscenegraph {
 
 AttrDataBlock::AttrDataBlock() noexcept
     : inner_(shim_create_attr_data_block_box()) {}
 
+AttrDataBlock::AttrDataBlock(
+    rust::Box<ShimAttrDataBlock> attr_data_block) noexcept
+    : inner_(std::move(attr_data_block)) {}
+
+AttrDataBlock AttrDataBlock::clone() const noexcept {
+    return AttrDataBlock(shim_clone_attr_data_block_box(inner_));
+}
+
 rust::Box<ShimAttrDataBlock> AttrDataBlock::get_inner() noexcept {
     return std::move(inner_);
 }
@@ -48,6 +57,10 @@ size_t AttrDataBlock::num_attr_anim_dense() noexcept {
     return inner_->num_attr_anim_dense();
 }
 
+size_t AttrDataBlock::num_attr_anim_rle() noexcept {
+    return inner_->num_attr_anim_rle();
+}
+
 AttrId AttrDataBlock::create_attr_static(Real value) noexcept {
     return inner_->create_attr_static(value);
 }
@@ -57,6 +70,18 @@ AttrId AttrDataBlock::create_attr_anim_dense(rust::Vec<Real> values,
     return inner_->create_attr_anim_dense(values, frame_start);
 }
 
+AttrId AttrDataBlock::create_attr_anim_rle(
+    const std::vector<FrameValue> &run_frames,
+    const std::vector<Real> &run_values, FrameValue frame_start,
+    FrameValue frame_end) noexcept {
+    rust::Slice<const FrameValue> run_frames_slice{run_frames.data(),
+                                                   run_frames.size()};
+    rust::Slice<const Real> run_values_slice{run_values.data(),
+                                             run_values.size()};
+    return inner_->create_attr_anim_rle(run_frames_slice, run_values_slice,
+                                        frame_start, frame_end);
+}
+
 Real AttrDataBlock::get_attr_value(AttrId attr_id,
                                    FrameValue frame) const noexcept {
     return inner_->get_attr_value(attr_id, frame);
@@ -67,4 +92,28 @@ bool AttrDataBlock::set_attr_value(AttrId attr_id, FrameValue frame,
     return inner_->set_attr_value(attr_id, frame, value);
 }
 
+bool AttrDataBlock::get_attr_values(
+    const std::vector<AttrId> &attr_ids, const std::vector<FrameValue> &frames,
+    std::vector<Real> &out_values) const noexcept {
+    out_values.resize(attr_ids.size());
+    rust::Slice<const AttrId> attr_ids_slice{attr_ids.data(), attr_ids.size()};
+    rust::Slice<const FrameValue> frames_slice{frames.data(), frames.size()};
+    rust::Slice<Real> values_slice{out_values.data(), out_values.size()};
+    return inner_->get_attr_values(attr_ids_slice, frames_slice,
+                                   values_slice);
+}
+
+bool AttrDataBlock::set_attr_values(
+    const std::vector<AttrId> &attr_ids, const std::vector<FrameValue> &frames,
+    const std::vector<Real> &values,
+    std::vector<uint8_t> &out_changed) noexcept {
+    out_changed.resize(attr_ids.size());
+    rust::Slice<const AttrId> attr_ids_slice{attr_ids.data(), attr_ids.size()};
+    rust::Slice<const FrameValue> frames_slice{frames.data(), frames.size()};
+    rust::Slice<const Real> values_slice{values.data(), values.size()};
+    rust::Slice<uint8_t> changed_slice{out_changed.data(), out_changed.size()};
+    return inner_->set_attr_values(attr_ids_slice, frames_slice, values_slice,
+                                   changed_slice);
+}
+
 }  // namespace mmscenegraph
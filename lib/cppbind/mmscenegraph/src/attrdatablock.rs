@@ -22,18 +22,23 @@ use crate::attr::bind_to_core_attr_id;
 use crate::attr::core_to_bind_attr_id;
 use crate::cxxbridge::ffi::AttrId as BindAttrId;
 use mmscenegraph_rust::attr::datablock::AttrDataBlock as CoreAttrDataBlock;
+use mmscenegraph_rust::attr::AttrId as CoreAttrId;
 use mmscenegraph_rust::constant::FrameValue as CoreFrameValue;
 use mmscenegraph_rust::constant::Real as CoreReal;
 
 #[derive(Debug, Clone)]
 pub struct ShimAttrDataBlock {
     inner: CoreAttrDataBlock,
+
+    // Scratch list of converted attribute ids, re-used between calls.
+    attr_ids: Vec<CoreAttrId>,
 }
 
 impl ShimAttrDataBlock {
     fn new() -> Self {
         Self {
             inner: CoreAttrDataBlock::new(),
+            attr_ids: Vec::new(),
         }
     }
 
@@ -53,6 +58,10 @@ impl ShimAttrDataBlock {
         self.inner.num_attr_anim_dense()
     }
 
+    pub fn num_attr_anim_rle(&self) -> usize {
+        self.inner.num_attr_anim_rle()
+    }
+
     pub fn create_attr_static(&mut self, value: CoreReal) -> BindAttrId {
         let attr_id = self.inner.create_attr_static(value);
         core_to_bind_attr_id(attr_id)
@@ -67,6 +76,22 @@ impl ShimAttrDataBlock {
         core_to_bind_attr_id(attr_id)
     }
 
+    pub fn create_attr_anim_rle(
+        &mut self,
+        run_frames: &[CoreFrameValue],
+        run_values: &[CoreReal],
+        frame_start: CoreFrameValue,
+        frame_end: CoreFrameValue,
+    ) -> BindAttrId {
+        let attr_id = self.inner.create_attr_anim_rle(
+            run_frames,
+            run_values,
+            frame_start,
+            frame_end,
+        );
+        core_to_bind_attr_id(attr_id)
+    }
+
     pub fn get_attr_value(
         &self,
         attr_id: BindAttrId,
@@ -85,8 +110,57 @@ impl ShimAttrDataBlock {
         let attr_id = bind_to_core_attr_id(attr_id);
         self.inner.set_attr_value(attr_id, frame, value)
     }
+
+    /// Returns false, without getting any values, if the slices do
+    /// not all have the same length; a panic must not unwind into
+    /// C++.
+    pub fn get_attr_values(
+        &self,
+        attr_ids: &[BindAttrId],
+        frames: &[CoreFrameValue],
+        out_values: &mut [CoreReal],
+    ) -> bool {
+        if (attr_ids.len() != frames.len())
+            || (attr_ids.len() != out_values.len())
+        {
+            return false;
+        }
+        for ((attr_id, frame), out_value) in
+            attr_ids.iter().zip(frames).zip(out_values.iter_mut())
+        {
+            let attr_id = bind_to_core_attr_id(*attr_id);
+            *out_value = self.inner.get_attr_value(attr_id, *frame);
+        }
+        true
+    }
+
+    pub fn set_attr_values(
+        &mut self,
+        attr_ids: &[BindAttrId],
+        frames: &[CoreFrameValue],
+        values: &[CoreReal],
+        out_changed: &mut [u8],
+    ) -> bool {
+        if (attr_ids.len() != frames.len())
+            || (attr_ids.len() != values.len())
+            || (attr_ids.len() != out_changed.len())
+        {
+            return false;
+        }
+        self.attr_ids.clear();
+        self.attr_ids
+            .extend(attr_ids.iter().map(|x| bind_to_core_attr_id(*x)));
+        self.inner
+            .set_attr_values(&self.attr_ids, frames, values, out_changed)
+    }
 }
 
 pub fn shim_create_attr_data_block_box() -> Box<ShimAttrDataBlock> {
     Box::new(ShimAttrDataBlock::new())
 }
+
+pub fn shim_clone_attr_data_block_box(
+    attrdb: &Box<ShimAttrDataBlock>,
+) -> Box<ShimAttrDataBlock> {
+    Box::new(attrdb.as_ref().clone())
+}
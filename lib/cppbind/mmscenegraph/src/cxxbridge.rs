@@ -18,6 +18,7 @@
 // ====================================================================
 //
 
+use crate::attrdatablock::shim_clone_attr_data_block_box;
 use crate::attrdatablock::shim_create_attr_data_block_box;
 use crate::attrdatablock::ShimAttrDataBlock;
 use crate::curve_detect_pops::shim_detect_curve_pops;
@@ -25,6 +26,7 @@ use crate::curve_detect_pops::shim_filter_curve_pops;
 use crate::evaluationobjects::shim_create_evaluation_objects_box;
 use crate::evaluationobjects::ShimEvaluationObjects;
 use crate::fit_plane::shim_fit_plane_to_points;
+use crate::flatscene::shim_clone_flat_scene_box;
 use crate::flatscene::shim_create_flat_scene_box;
 use crate::flatscene::ShimFlatScene;
 use crate::line::shim_fit_line_to_points_type2;
@@ -99,6 +101,9 @@ pub mod ffi {
         #[cxx_name = "kNone"]
         None = 2,
 
+        #[cxx_name = "kAnimRle"]
+        AnimRle = 3,
+
         #[cxx_name = "kUnknown"]
         Unknown = 255,
     }
@@ -270,6 +275,7 @@ pub mod ffi {
 
         fn num_attr_static(&self) -> usize;
         fn num_attr_anim_dense(&self) -> usize;
+        fn num_attr_anim_rle(&self) -> usize;
 
         fn create_attr_static(&mut self, value: f64) -> AttrId;
         fn create_attr_anim_dense(
@@ -277,6 +283,13 @@ pub mod ffi {
             values: Vec<f64>,
             frame_start: u32,
         ) -> AttrId;
+        fn create_attr_anim_rle(
+            &mut self,
+            run_frames: &[u32],
+            run_values: &[f64],
+            frame_start: u32,
+            frame_end: u32,
+        ) -> AttrId;
 
         fn get_attr_value(&self, attr_id: AttrId, frame: u32) -> f64;
         fn set_attr_value(
@@ -285,8 +298,24 @@ pub mod ffi {
             frame: u32,
             value: f64,
         ) -> bool;
+        fn get_attr_values(
+            &self,
+            attr_ids: &[AttrId],
+            frames: &[u32],
+            out_values: &mut [f64],
+        ) -> bool;
+        fn set_attr_values(
+            &mut self,
+            attr_ids: &[AttrId],
+            frames: &[u32],
+            values: &[f64],
+            out_changed: &mut [u8],
+        ) -> bool;
 
         fn shim_create_attr_data_block_box() -> Box<ShimAttrDataBlock>;
+        fn shim_clone_attr_data_block_box(
+            attrdb: &Box<ShimAttrDataBlock>,
+        ) -> Box<ShimAttrDataBlock>;
     }
 
     extern "Rust" {
@@ -358,11 +387,20 @@ pub mod ffi {
         fn num_markers(&self) -> usize;
         fn num_points(&self) -> usize;
 
+        fn set_frame_parallel_grain_size(&mut self, value: usize);
+
         fn evaluate(
             &mut self,
             attrdb: &Box<ShimAttrDataBlock>,
             frame_list: &[u32],
         );
+        fn evaluate_dirty(
+            &mut self,
+            attrdb: &Box<ShimAttrDataBlock>,
+            frame_list: &[u32],
+            dirty_attr_list: &[AttrId],
+            dirty_frame_list: &[u32],
+        );
 
         fn shim_bake_scene_graph(
             sg: &Box<ShimSceneGraph>,
@@ -370,6 +408,9 @@ pub mod ffi {
         ) -> Box<ShimFlatScene>;
 
         fn shim_create_flat_scene_box() -> Box<ShimFlatScene>;
+        fn shim_clone_flat_scene_box(
+            flat_scene: &Box<ShimFlatScene>,
+        ) -> Box<ShimFlatScene>;
     }
 
     extern "Rust" {
@@ -31,6 +31,10 @@ FlatScene::FlatScene() noexcept : inner_(shim_create_flat_scene_box()) {}
 FlatScene::FlatScene(rust::Box<ShimFlatScene> flat_scene) noexcept
     : inner_(std::move(flat_scene)) {}
 
+FlatScene FlatScene::clone() const noexcept {
+    return FlatScene(shim_clone_flat_scene_box(inner_));
+}
+
 rust::Slice<const Real> FlatScene::markers() const noexcept {
     return inner_->markers();
 }
@@ -43,6 +47,10 @@ size_t FlatScene::num_markers() const noexcept { return inner_->num_markers(); }
 
 size_t FlatScene::num_points() const noexcept { return inner_->num_points(); }
 
+void FlatScene::set_frame_parallel_grain_size(size_t value) noexcept {
+    inner_->set_frame_parallel_grain_size(value);
+}
+
 void FlatScene::evaluate(AttrDataBlock &attrDataBlock,
                          std::vector<FrameValue> &frames) noexcept {
     auto attrDataBlock_inner = attrDataBlock.get_inner();
@@ -52,4 +60,20 @@ void FlatScene::evaluate(AttrDataBlock &attrDataBlock,
     attrDataBlock.set_inner(attrDataBlock_inner);
 }
 
+void FlatScene::evaluate_dirty(
+    AttrDataBlock &attrDataBlock, std::vector<FrameValue> &frames,
+    const std::vector<AttrId> &dirtyAttrs,
+    const std::vector<FrameValue> &dirtyFrames) noexcept {
+    auto attrDataBlock_inner = attrDataBlock.get_inner();
+    rust::Slice<const FrameValue> frames_slice{frames.data(), frames.size()};
+    rust::Slice<const AttrId> dirty_attrs_slice{dirtyAttrs.data(),
+                                                dirtyAttrs.size()};
+    rust::Slice<const FrameValue> dirty_frames_slice{dirtyFrames.data(),
+                                                     dirtyFrames.size()};
+    inner_->evaluate_dirty(attrDataBlock_inner, frames_slice,
+                           dirty_attrs_slice, dirty_frames_slice);
+
+    attrDataBlock.set_inner(attrDataBlock_inner);
+}
+
 }  // namespace mmscenegraph
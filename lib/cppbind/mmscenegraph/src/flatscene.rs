@@ -18,19 +18,25 @@
 // ====================================================================
 //
 
+use crate::attr::bind_to_core_attr_id;
 use crate::attrdatablock::ShimAttrDataBlock;
+use crate::cxxbridge::ffi::AttrId as BindAttrId;
+use mmscenegraph_rust::attr::AttrId as CoreAttrId;
 use mmscenegraph_rust::constant::FrameValue as CoreFrameValue;
 use mmscenegraph_rust::constant::Real as CoreReal;
 use mmscenegraph_rust::scene::flat::FlatScene as CoreFlatScene;
 
+#[derive(Clone)]
 pub struct ShimFlatScene {
     inner: CoreFlatScene,
+    dirty_attr_list: Vec<CoreAttrId>,
 }
 
 impl ShimFlatScene {
     pub fn new(core_flat_scene: CoreFlatScene) -> Self {
         Self {
             inner: core_flat_scene,
+            dirty_attr_list: Vec::new(),
         }
     }
 
@@ -54,6 +60,10 @@ impl ShimFlatScene {
         self.inner.num_points()
     }
 
+    pub fn set_frame_parallel_grain_size(&mut self, value: usize) {
+        self.inner.set_frame_parallel_grain_size(value)
+    }
+
     pub fn evaluate(
         &mut self,
         attrdb: &ShimAttrDataBlock,
@@ -61,6 +71,24 @@ impl ShimFlatScene {
     ) {
         self.inner.evaluate(attrdb.get_inner(), frame_list)
     }
+
+    pub fn evaluate_dirty(
+        &mut self,
+        attrdb: &ShimAttrDataBlock,
+        frame_list: &[CoreFrameValue],
+        dirty_attr_list: &[BindAttrId],
+        dirty_frame_list: &[CoreFrameValue],
+    ) {
+        self.dirty_attr_list.clear();
+        self.dirty_attr_list
+            .extend(dirty_attr_list.iter().map(|x| bind_to_core_attr_id(*x)));
+        self.inner.evaluate_dirty(
+            attrdb.get_inner(),
+            frame_list,
+            &self.dirty_attr_list,
+            dirty_frame_list,
+        )
+    }
 }
 
 pub fn shim_create_flat_scene_box() -> Box<ShimFlatScene> {
@@ -96,3 +124,9 @@ pub fn shim_create_flat_scene_box() -> Box<ShimFlatScene> {
     );
     Box::new(ShimFlatScene::new(core_flat_scene))
 }
+
+pub fn shim_clone_flat_scene_box(
+    flat_scene: &Box<ShimFlatScene>,
+) -> Box<ShimFlatScene> {
+    Box::new(flat_scene.as_ref().clone())
+}
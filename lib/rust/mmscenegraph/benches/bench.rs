@@ -19,7 +19,9 @@
 //
 
 use criterion::measurement::WallTime;
-use criterion::{black_box, criterion_group, criterion_main, Criterion};
+use criterion::{
+    black_box, criterion_group, criterion_main, BenchmarkId, Criterion,
+};
 
 use rand::distributions::Uniform;
 use rand::thread_rng;
@@ -703,6 +705,108 @@ fn bench_construct_and_evaluate_scene_graph(c: &mut Criterion) {
     });
 }
 
+fn bench_evaluate_flat_scene_multi_camera(c: &mut Criterion) {
+    const MAX_MIN_TRANSLATE_VALUE: Real = 100.0;
+    const MAX_MIN_ROTATE_VALUE: Real = 180.0;
+    const MAX_MIN_MARKER_VALUE: Real = 0.5;
+    const MARKER_COUNT: usize = 400;
+
+    let mut rng = thread_rng();
+    let translate_side =
+        Uniform::new(-MAX_MIN_TRANSLATE_VALUE, MAX_MIN_TRANSLATE_VALUE);
+    let rotate_side = Uniform::new(-MAX_MIN_ROTATE_VALUE, MAX_MIN_ROTATE_VALUE);
+    let marker_side = Uniform::new(-MAX_MIN_MARKER_VALUE, MAX_MIN_MARKER_VALUE);
+
+    let mut frame_list = Vec::new();
+    for frame in 1001..1121 {
+        frame_list.push(frame);
+    }
+
+    let mut group = c.benchmark_group("evaluate_flat_scene_multi_camera");
+    for camera_count in [1, 4, 16].iter() {
+        let mut sg = SceneGraph::new();
+        let mut attrdb = AttrDataBlock::new();
+        let mut eval_objects = EvaluationObjects::new();
+
+        let rotate_order = RotateOrder::ZXY;
+        let mut cameras = Vec::new();
+        for _ in 0..*camera_count {
+            let tx = rng.sample(translate_side);
+            let ty = rng.sample(translate_side);
+            let tz = rng.sample(translate_side);
+            let rx = rng.sample(rotate_side);
+            let ry = rng.sample(rotate_side);
+            let rz = rng.sample(rotate_side);
+            let cam = create_static_camera(
+                &mut sg,
+                &mut attrdb,
+                (tx, ty, tz),
+                (rx, ry, rz),
+                (1.0, 1.0, 1.0),
+                (36.0, 24.0),
+                35.0,
+                (0.0, 0.0),
+                1.0,
+                10000.0,
+                1.0,
+                rotate_order,
+                FilmFit::Horizontal,
+                2048,
+                2048,
+            );
+            eval_objects.add_camera(cam);
+            cameras.push(cam);
+        }
+
+        // Markers are interleaved across the cameras, so consecutive
+        // markers never share a camera.
+        for i in 0..MARKER_COUNT {
+            let tx = rng.sample(translate_side);
+            let ty = rng.sample(translate_side);
+            let tz = rng.sample(translate_side);
+            let bnd = create_static_bundle(
+                &mut sg,
+                &mut attrdb,
+                (tx, ty, tz),
+                (0.0, 0.0, 0.0),
+                (1.0, 1.0, 1.0),
+                rotate_order,
+            );
+
+            let mkr_tx = rng.sample(marker_side);
+            let mkr_ty = rng.sample(marker_side);
+            let mkr = create_static_marker(
+                &mut sg,
+                &mut attrdb,
+                (mkr_tx, mkr_ty),
+                1.0,
+            );
+
+            let cam = cameras[i % cameras.len()];
+            sg.link_marker_to_camera(mkr.get_id(), cam.get_id());
+            sg.link_marker_to_bundle(mkr.get_id(), bnd.get_id());
+
+            eval_objects.add_marker(mkr);
+            eval_objects.add_bundle(bnd);
+        }
+
+        let mut flat_scene = bake_scene_graph(&sg, &eval_objects);
+
+        group.bench_with_input(
+            BenchmarkId::from_parameter(camera_count),
+            camera_count,
+            |b, _| {
+                b.iter(|| {
+                    flat_scene.evaluate(&attrdb, &frame_list);
+                    black_box(flat_scene.points());
+                    black_box(flat_scene.markers());
+                })
+            },
+        );
+    }
+    group.finish();
+}
+
 // fn bench_compute_dag_matrices_deep(c: &mut Criterion) {
 //     let mut group = c.benchmark_group("dag::compute_matrices (deep graph)");
 //     for size in [1, 2, 10, 20, 100, 200, 1000, 2000].iter() {
@@ -937,6 +1041,7 @@ criterion_group!(
         bench_construct_scene_graph_hierarchy_transforms,
         bench_construct_scene_graph_depth_transforms,
         bench_construct_and_evaluate_scene_graph,
+        bench_evaluate_flat_scene_multi_camera,
         // bench_compute_dag_matrices,
         // bench_compute_dag_matrices_deep,
         // bench_compute_dag_matrices_wide
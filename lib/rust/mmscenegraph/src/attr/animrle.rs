@@ -0,0 +1,287 @@
+//
+// Copyright (C) 2024 David Cattermole.
+//
+// This file is part of mmSolver.
+//
+// mmSolver is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// mmSolver is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+// ====================================================================
+//
+
+use crate::constant::FrameValue;
+use crate::constant::Real;
+
+/// An animated attribute stored as runs of constant values, for
+/// values that are constant or piecewise-constant (stepped) across
+/// many frames.
+///
+/// Each run starts at a frame and holds its value until the next
+/// run starts. Frames outside of the attribute's frame range are
+/// clamped to the first or last frame, so frames before the first run
+/// use the first value, and frames after the last run use the last
+/// value, when getting or setting a value. Getting a value is
+/// O(1) for a single run and O(log n) for n runs.
+///
+/// Setting a value that differs from its run splits the run. When
+/// the number of runs grows large (for example when the attribute is
+/// solved per-frame) the attribute is converted to dense values, so
+/// setting values stays O(1).
+#[derive(Debug, Clone)]
+pub struct AnimRleAttr {
+    pub frame_start: FrameValue,
+    pub frame_end: FrameValue,
+    run_frames: Vec<FrameValue>,
+    run_values: Vec<Real>,
+    dense_values: Vec<Real>,
+}
+
+impl AnimRleAttr {
+    pub fn new() -> Self {
+        Self {
+            frame_start: 0,
+            frame_end: 0,
+            run_frames: Vec::<FrameValue>::new(),
+            run_values: Vec::<Real>::new(),
+            dense_values: Vec::<Real>::new(),
+        }
+    }
+
+    /// Set the runs of the attribute; 'run_frames' must start at
+    /// 'frame_start', be sorted in ascending order with no
+    /// duplicates, and have the same length as 'run_values'.
+    ///
+    /// Neighbouring runs with the same value are merged.
+    pub fn set_runs(
+        &mut self,
+        run_frames: &[FrameValue],
+        run_values: &[Real],
+        frame_start: FrameValue,
+        frame_end: FrameValue,
+    ) {
+        assert!(run_frames.len() == run_values.len());
+        assert!(run_frames.len() > 0);
+        assert!(frame_start <= frame_end);
+        assert!(run_frames[0] == frame_start);
+        self.frame_start = frame_start;
+        self.frame_end = frame_end;
+        self.run_frames.clear();
+        self.run_values.clear();
+        self.dense_values.clear();
+        for (i, (frame, value)) in (0..).zip(run_frames.iter().zip(run_values))
+        {
+            assert!(i == 0 || *frame > run_frames[i - 1]);
+            assert!(*frame <= frame_end);
+            if self.run_values.last() != Some(value) {
+                self.run_frames.push(*frame);
+                self.run_values.push(*value);
+            }
+        }
+    }
+
+    /// Set the runs from dense per-frame values, starting at
+    /// 'frame_start'.
+    pub fn set_values(&mut self, values: &[Real], frame_start: FrameValue) {
+        assert!(values.len() > 0);
+        let frame_end = frame_start + (values.len() as FrameValue) - 1;
+        let run_frames: Vec<FrameValue> = (frame_start..=frame_end).collect();
+        self.set_runs(&run_frames, values, frame_start, frame_end);
+    }
+
+    pub fn num_runs(&self) -> usize {
+        self.run_frames.len()
+    }
+
+    pub fn is_dense(&self) -> bool {
+        !self.dense_values.is_empty()
+    }
+
+    /// Clamp 'frame' into the attribute's frame range.
+    #[inline]
+    fn clamp_frame(&self, frame: FrameValue) -> FrameValue {
+        frame.clamp(self.frame_start, self.frame_end)
+    }
+
+    /// The index of the run containing 'frame'.
+    #[inline]
+    fn run_index(&self, frame: FrameValue) -> usize {
+        if self.run_frames.len() == 1 {
+            return 0;
+        }
+        // The number of runs starting at, or before, the frame.
+        let count = self.run_frames.partition_point(|x| *x <= frame);
+        if count == 0 {
+            0
+        } else {
+            count - 1
+        }
+    }
+
+    pub fn get_value(&self, frame: FrameValue) -> Real {
+        if self.is_dense() {
+            let f = (self.clamp_frame(frame) - self.frame_start) as usize;
+            return self.dense_values[f];
+        }
+        self.run_values[self.run_index(frame)]
+    }
+
+    pub fn set_value(&mut self, frame: FrameValue, value: Real) {
+        let frame = self.clamp_frame(frame);
+        if self.is_dense() {
+            let f = (frame - self.frame_start) as usize;
+            self.dense_values[f] = value;
+            return;
+        }
+
+        let index = self.run_index(frame);
+        if self.run_values[index] == value {
+            return;
+        }
+
+        // The frame range covered by the run, within the attribute's
+        // frame range.
+        let run_start = self.run_frames[index];
+        let run_end = match self.run_frames.get(index + 1) {
+            Some(next_frame) => *next_frame - 1,
+            None => self.frame_end,
+        };
+        if run_start == run_end {
+            self.run_values[index] = value;
+            return;
+        }
+
+        // Splitting a run inserts values in the middle of the lists,
+        // so change to dense values once many runs exist.
+        let num_frames = (self.frame_end - self.frame_start + 1) as usize;
+        if (self.run_frames.len() + 2) * 4 > num_frames {
+            self.convert_to_dense();
+            self.set_value(frame, value);
+            return;
+        }
+
+        let old_value = self.run_values[index];
+        let mut insert_index = index + 1;
+        if frame == run_start {
+            self.run_values[index] = value;
+        } else {
+            self.run_frames.insert(insert_index, frame);
+            self.run_values.insert(insert_index, value);
+            insert_index += 1;
+        }
+        if frame < run_end {
+            self.run_frames.insert(insert_index, frame + 1);
+            self.run_values.insert(insert_index, old_value);
+        }
+    }
+
+    fn convert_to_dense(&mut self) {
+        let mut dense_values = Vec::<Real>::new();
+        dense_values.reserve((self.frame_end - self.frame_start + 1) as usize);
+        for frame in self.frame_start..=self.frame_end {
+            dense_values.push(self.run_values[self.run_index(frame)]);
+        }
+        self.dense_values = dense_values;
+        self.run_frames.clear();
+        self.run_values.clear();
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn assert_values(attr: &AnimRleAttr, expected: &[Real]) {
+        for (i, value) in (0..).zip(expected) {
+            let frame = attr.frame_start + i as FrameValue;
+            assert_eq!(attr.get_value(frame), *value);
+        }
+    }
+
+    #[test]
+    fn test_constant_values() {
+        let mut attr = AnimRleAttr::new();
+        attr.set_values(&vec![35.0; 1000], 1001);
+        assert_eq!(attr.num_runs(), 1);
+        assert_eq!(attr.get_value(1001), 35.0);
+        assert_eq!(attr.get_value(2000), 35.0);
+    }
+
+    #[test]
+    fn test_stepped_values() {
+        let values = [1.0, 1.0, 2.0, 2.0, 2.0, 3.0, 1.0, 1.0];
+        let mut attr = AnimRleAttr::new();
+        attr.set_values(&values, 1001);
+        assert_eq!(attr.num_runs(), 4);
+        assert_values(&attr, &values);
+
+        let mut attr = AnimRleAttr::new();
+        attr.set_runs(
+            &[1001, 1003, 1006, 1007],
+            &[1.0, 2.0, 3.0, 1.0],
+            1001,
+            1008,
+        );
+        assert_values(&attr, &values);
+    }
+
+    #[test]
+    fn test_set_value() {
+        let mut values = vec![1.0; 40];
+        let mut attr = AnimRleAttr::new();
+        attr.set_values(&values, 1);
+
+        // Middle, start and end of runs.
+        for (frame, value) in [(10, 2.0), (1, 3.0), (40, 4.0), (11, 5.0)] {
+            attr.set_value(frame, value);
+            values[(frame - 1) as usize] = value;
+            assert_values(&attr, &values);
+        }
+        assert!(!attr.is_dense());
+
+        // Many different values become dense.
+        for frame in 1..=40 {
+            let value = frame as Real * 0.5;
+            attr.set_value(frame, value);
+            values[(frame - 1) as usize] = value;
+        }
+        assert!(attr.is_dense());
+        assert_values(&attr, &values);
+    }
+
+    #[test]
+    fn test_out_of_range_frames() {
+        let values = [1.0, 2.0, 2.0, 3.0];
+        let mut attr = AnimRleAttr::new();
+        attr.set_values(&values, 1001);
+        assert_eq!(attr.get_value(0), 1.0);
+        assert_eq!(attr.get_value(1000), 1.0);
+        assert_eq!(attr.get_value(1005), 3.0);
+        assert_eq!(attr.get_value(FrameValue::MAX), 3.0);
+
+        // Setting a value outside of the frame range sets the first
+        // or last frame.
+        attr.set_value(1000, 4.0);
+        attr.set_value(1010, 5.0);
+        assert_values(&attr, &[4.0, 2.0, 2.0, 5.0]);
+
+        // The same is true for dense values.
+        for frame in 1001..=1004 {
+            attr.set_value(frame, frame as Real);
+        }
+        assert!(attr.is_dense());
+        assert_eq!(attr.get_value(0), 1001.0);
+        assert_eq!(attr.get_value(FrameValue::MAX), 1004.0);
+        attr.set_value(0, 6.0);
+        attr.set_value(FrameValue::MAX, 7.0);
+        assert_values(&attr, &[6.0, 1002.0, 1003.0, 7.0]);
+    }
+}
@@ -19,6 +19,7 @@
 //
 
 use crate::attr::animdense::AnimDenseAttr;
+use crate::attr::animrle::AnimRleAttr;
 use crate::attr::staticattr::StaticAttr;
 use crate::attr::AttrId;
 use crate::constant::AttrIndex;
@@ -29,6 +30,7 @@ use crate::constant::Real;
 pub struct AttrDataBlock {
     pub static_attrs: Vec<StaticAttr>,
     pub anim_dense_attrs: Vec<AnimDenseAttr>,
+    pub anim_rle_attrs: Vec<AnimRleAttr>,
 }
 
 impl AttrDataBlock {
@@ -36,12 +38,14 @@ impl AttrDataBlock {
         AttrDataBlock {
             static_attrs: Vec::<StaticAttr>::new(),
             anim_dense_attrs: Vec::<AnimDenseAttr>::new(),
+            anim_rle_attrs: Vec::<AnimRleAttr>::new(),
         }
     }
 
     pub fn clear(&mut self) {
         self.static_attrs.clear();
         self.anim_dense_attrs.clear();
+        self.anim_rle_attrs.clear();
     }
 
     pub fn num_attr_static(&self) -> usize {
@@ -52,6 +56,10 @@ impl AttrDataBlock {
         self.anim_dense_attrs.len()
     }
 
+    pub fn num_attr_anim_rle(&self) -> usize {
+        self.anim_rle_attrs.len()
+    }
+
     pub fn create_attr_static(&mut self, value: Real) -> AttrId {
         let mut attr = StaticAttr::new();
         attr.set_value(value);
@@ -73,12 +81,32 @@ impl AttrDataBlock {
         AttrId::AnimDense(index)
     }
 
+    /// Create an animated attribute from runs of constant values,
+    /// between 'frame_start' and 'frame_end' (inclusive). See
+    /// 'AnimRleAttr::set_runs'.
+    pub fn create_attr_anim_rle(
+        &mut self,
+        run_frames: &[FrameValue],
+        run_values: &[Real],
+        frame_start: FrameValue,
+        frame_end: FrameValue,
+    ) -> AttrId {
+        let mut attr = AnimRleAttr::new();
+        attr.set_runs(run_frames, run_values, frame_start, frame_end);
+        let index = self.anim_rle_attrs.len() as AttrIndex;
+        self.anim_rle_attrs.push(attr);
+        AttrId::AnimRle(index)
+    }
+
     pub fn get_attr_value(&self, attr_id: AttrId, frame: FrameValue) -> Real {
         match attr_id {
             AttrId::Static(index) => self.static_attrs[index].get_value(),
             AttrId::AnimDense(index) => {
                 self.anim_dense_attrs[index].get_value(frame)
             }
+            AttrId::AnimRle(index) => {
+                self.anim_rle_attrs[index].get_value(frame)
+            }
             AttrId::None => 0.0,
         }
     }
@@ -102,11 +130,89 @@ impl AttrDataBlock {
                 AttrId::AnimDense(index) => {
                     self.anim_dense_attrs[index].set_value(frame, value)
                 }
+                AttrId::AnimRle(index) => {
+                    self.anim_rle_attrs[index].set_value(frame, value)
+                }
                 AttrId::None => (),
             }
             true
         }
     }
+
+    /// Get the value of many attributes at once; 'attr_ids', 'frames'
+    /// and 'out_values' are pairs, with the same length.
+    pub fn get_attr_values(
+        &self,
+        attr_ids: &[AttrId],
+        frames: &[FrameValue],
+        out_values: &mut [Real],
+    ) {
+        assert!(attr_ids.len() == frames.len());
+        assert!(attr_ids.len() == out_values.len());
+        for ((attr_id, frame), out_value) in
+            attr_ids.iter().zip(frames).zip(out_values.iter_mut())
+        {
+            *out_value = self.get_attr_value(*attr_id, *frame);
+        }
+    }
+
+    /// Set the value of many attributes at once; 'attr_ids', 'frames',
+    /// 'values' and 'out_changed' are pairs, with the same length.
+    ///
+    /// 'out_changed' is set to 1 for each value that is different to
+    /// the existing attribute value, otherwise 0.
+    ///
+    /// If any value is not finite, no values are set and false is
+    /// returned.
+    pub fn set_attr_values(
+        &mut self,
+        attr_ids: &[AttrId],
+        frames: &[FrameValue],
+        values: &[Real],
+        out_changed: &mut [u8],
+    ) -> bool {
+        assert!(attr_ids.len() == frames.len());
+        assert!(attr_ids.len() == values.len());
+        assert!(attr_ids.len() == out_changed.len());
+        if !values.iter().all(|value| value.is_finite()) {
+            return false;
+        }
+
+        for (((attr_id, frame), value), out_changed) in attr_ids
+            .iter()
+            .zip(frames)
+            .zip(values)
+            .zip(out_changed.iter_mut())
+        {
+            let frame = *frame;
+            let value = *value;
+            let changed = match *attr_id {
+                AttrId::Static(index) => {
+                    let attr = &mut self.static_attrs[index];
+                    let changed = attr.get_value() != value;
+                    attr.set_value(value);
+                    changed
+                }
+                AttrId::AnimDense(index) => {
+                    let attr = &mut self.anim_dense_attrs[index];
+                    let changed = attr.get_value(frame) != value;
+                    attr.set_value(frame, value);
+                    changed
+                }
+                AttrId::AnimRle(index) => {
+                    let attr = &mut self.anim_rle_attrs[index];
+                    let changed = attr.get_value(frame) != value;
+                    if changed {
+                        attr.set_value(frame, value);
+                    }
+                    changed
+                }
+                AttrId::None => false,
+            };
+            *out_changed = changed as u8;
+        }
+        true
+    }
 }
 
 #[cfg(test)]
@@ -140,4 +246,55 @@ mod tests {
             _ => assert!(false),
         }
     }
+
+    #[test]
+    fn test_create_anim_rle_attr() {
+        let mut attrdb = AttrDataBlock::new();
+        let run_frames = [1001, 1010];
+        let run_values = [35.0, 50.0];
+        let attr_id =
+            attrdb.create_attr_anim_rle(&run_frames, &run_values, 1001, 1020);
+        println!("attr_id: {:?}", attr_id);
+        match attr_id {
+            AttrId::AnimRle(x) => assert_eq!(x, 0),
+            _ => assert!(false),
+        }
+        assert_eq!(attrdb.get_attr_value(attr_id, 1009), 35.0);
+        assert_eq!(attrdb.get_attr_value(attr_id, 1010), 50.0);
+        assert_eq!(attrdb.get_attr_value(attr_id, 1020), 50.0);
+    }
+
+    #[test]
+    fn test_set_get_attr_values() {
+        let mut attrdb = AttrDataBlock::new();
+        let attr_static = attrdb.create_attr_static(1.0);
+        let attr_dense =
+            attrdb.create_attr_anim_dense(vec![1.0, 2.0, 3.0], 1001);
+        let attr_ids = [attr_static, attr_dense, attr_dense, AttrId::None];
+        let frames = [0, 1001, 1002, 0];
+
+        let mut changed = [0; 4];
+        let ok = attrdb.set_attr_values(
+            &attr_ids,
+            &frames,
+            &[5.0, 1.0, 7.0, 9.0],
+            &mut changed,
+        );
+        assert!(ok);
+        assert_eq!(changed, [1, 0, 1, 0]);
+
+        let mut values = [0.0; 4];
+        attrdb.get_attr_values(&attr_ids, &frames, &mut values);
+        assert_eq!(values, [5.0, 1.0, 7.0, 0.0]);
+
+        // Non-finite values are not set.
+        let ok = attrdb.set_attr_values(
+            &attr_ids,
+            &frames,
+            &[6.0, Real::NAN, 8.0, 9.0],
+            &mut changed,
+        );
+        assert!(!ok);
+        assert_eq!(attrdb.get_attr_value(attr_static, 0), 5.0);
+    }
 }
@@ -19,6 +19,7 @@
 //
 
 pub mod animdense;
+pub mod animrle;
 pub mod datablock;
 pub mod staticattr;
 
@@ -27,6 +28,7 @@ use crate::constant::AttrIndex;
 #[derive(Debug, Copy, Clone, Hash, Eq, PartialEq, Ord, PartialOrd)]
 pub enum AttrId {
     AnimDense(AttrIndex),
+    AnimRle(AttrIndex),
     Static(AttrIndex),
     None,
 }
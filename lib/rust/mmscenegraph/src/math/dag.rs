@@ -18,6 +18,8 @@
 // ====================================================================
 //
 
+use rayon::prelude::*;
+
 use crate::attr::datablock::AttrDataBlock;
 use crate::attr::AttrId;
 use crate::attr::AttrTransformIds;
@@ -326,6 +328,104 @@ pub fn compute_world_matrices_with_attrs(
     }
 }
 
+/// The default number of frames evaluated by each task of
+/// 'compute_world_matrices_with_attrs_frame_parallel'.
+pub const DEFAULT_FRAME_PARALLEL_GRAIN_SIZE: usize = 64;
+
+/// Same as 'compute_world_matrices_with_attrs', but frames are
+/// evaluated in parallel.
+///
+/// A world matrix only depends on its parent at the same frame, so
+/// the frames are split into chunks of 'grain_size' frames, and each
+/// chunk evaluates all transforms on one thread. When 'grain_size'
+/// is zero, or there are not more frames than 'grain_size', the
+/// serial function is used.
+///
+/// 'scratch_matrix_list' stores the matrices ordered by frame, before
+/// they are copied into 'out_matrix_list' in the same order as the
+/// serial function; it may be re-used between calls to avoid
+/// allocations. The results are identical to the serial function.
+pub fn compute_world_matrices_with_attrs_frame_parallel(
+    attr_data_block: &AttrDataBlock,
+    tfm_attr_list: &Vec<AttrTransformIds>,
+    rotate_order_list: &Vec<RotateOrder>,
+    transform_parents: &Vec<Option<usize>>,
+    frame_list: &[FrameValue],
+    grain_size: usize,
+    scratch_matrix_list: &mut Vec<Matrix44>,
+    out_matrix_list: &mut Vec<Matrix44>,
+) {
+    let transform_num = transform_parents.len();
+    let num_frames = frame_list.len();
+    if grain_size == 0 || num_frames <= grain_size || transform_num == 0 {
+        compute_world_matrices_with_attrs(
+            attr_data_block,
+            tfm_attr_list,
+            rotate_order_list,
+            transform_parents,
+            frame_list,
+            out_matrix_list,
+        );
+        return;
+    }
+    assert!(tfm_attr_list.len() == transform_num);
+    assert!(rotate_order_list.len() == transform_num);
+
+    // Evaluate chunks of frames, with all transforms of a frame
+    // stored next to each other.
+    scratch_matrix_list.clear();
+    scratch_matrix_list
+        .resize(transform_num * num_frames, Matrix44::identity());
+    scratch_matrix_list
+        .par_chunks_mut(transform_num * grain_size)
+        .zip(frame_list.par_chunks(grain_size))
+        .for_each(|(chunk_matrix_list, chunk_frame_list)| {
+            for (f, frame) in (0..).zip(chunk_frame_list) {
+                let frame = *frame;
+                let frame_start = f * transform_num;
+                for i in 0..transform_num {
+                    let tfm_attrs = &tfm_attr_list[i];
+                    let local_matrix = compute_matrix_with_attrs(
+                        attr_data_block,
+                        tfm_attrs.tx,
+                        tfm_attrs.ty,
+                        tfm_attrs.tz,
+                        tfm_attrs.rx,
+                        tfm_attrs.ry,
+                        tfm_attrs.rz,
+                        tfm_attrs.sx,
+                        tfm_attrs.sy,
+                        tfm_attrs.sz,
+                        rotate_order_list[i],
+                        frame,
+                    );
+                    let world_matrix = match transform_parents[i] {
+                        Some(parent_index) => {
+                            assert!(parent_index < i);
+                            chunk_matrix_list[frame_start + parent_index]
+                                * local_matrix
+                        }
+                        None => local_matrix,
+                    };
+                    chunk_matrix_list[frame_start + i] = world_matrix;
+                }
+            }
+        });
+
+    // Re-order the matrices per-transform, then per-frame.
+    let scratch_matrix_list: &Vec<Matrix44> = scratch_matrix_list;
+    out_matrix_list.clear();
+    out_matrix_list.resize(transform_num * num_frames, Matrix44::identity());
+    out_matrix_list
+        .par_chunks_mut(num_frames)
+        .enumerate()
+        .for_each(|(i, tfm_matrix_list)| {
+            for (f, matrix) in tfm_matrix_list.iter_mut().enumerate() {
+                *matrix = scratch_matrix_list[(f * transform_num) + i];
+            }
+        });
+}
+
 pub fn compute_world_matrices(
     attr_data_block: &AttrDataBlock,
     transforms: &Vec<Box<dyn NodeCanTransform3D>>,
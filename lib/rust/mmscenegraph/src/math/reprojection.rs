@@ -20,6 +20,7 @@
 
 use crate::constant::Matrix14;
 use crate::constant::Matrix44;
+use crate::constant::Real;
 
 // TODO: Re-write this function to take just a 4x4 matrix, and 3 float
 // values. This will reduce the amount of required data, and allow us
@@ -61,3 +62,186 @@ pub fn reproject_as_normalised_coord(
         reproject(camera_projection_matrix, camera_transform_matrix, point);
     Matrix14::new(screen_point.x * 0.5, screen_point.y * 0.5, 0.0, 1.0)
 }
+
+/// Compute the matrix that converts world-space points into the
+/// camera's screen-space, so it can be re-used for many points.
+///
+/// The result is the same as the matrix computed inside 'reproject'.
+#[inline]
+pub fn compute_camera_world_projection_matrix(
+    camera_projection_matrix: Matrix44,
+    camera_transform_matrix: Matrix44,
+) -> Matrix44 {
+    let camera_projection_matrix_inv =
+        match camera_projection_matrix.try_inverse() {
+            Some(x) => x,
+            None => Matrix44::new_scaling(1.0),
+        };
+    camera_transform_matrix * camera_projection_matrix_inv
+}
+
+/// Same as 'reproject_as_normalised_coord', with a matrix computed by
+/// 'compute_camera_world_projection_matrix'.
+#[inline]
+pub fn reproject_as_normalised_coord_with_world_projection_matrix(
+    camera_world_proj_matrix: Matrix44,
+    point: Matrix44,
+) -> Matrix14 {
+    let screen_point = camera_world_proj_matrix * point;
+    let w = *screen_point.index((3, 3));
+    Matrix14::new(
+        (screen_point.index((0, 3)) / w) * 0.5,
+        (screen_point.index((1, 3)) / w) * 0.5,
+        0.0,
+        1.0,
+    )
+}
+
+/// Re-project many points into one camera, with the camera matrix
+/// computed by 'compute_camera_world_projection_matrix'.
+///
+/// Points are given as structure-of-arrays world-space positions (the
+/// translation of a bundle's world matrix), which are assumed to have
+/// a homogeneous 'w' of 1.0. The normalised screen-space coordinates
+/// are written to 'out_x' and 'out_y', matching
+/// 'reproject_as_normalised_coord_with_world_projection_matrix'.
+///
+/// AVX2 (with FMA) is used to project 4 points at once when the CPU
+/// supports it, otherwise a scalar loop is used.
+pub fn reproject_as_normalised_coord_batch(
+    camera_world_proj_matrix: &Matrix44,
+    point_x: &[Real],
+    point_y: &[Real],
+    point_z: &[Real],
+    out_x: &mut [Real],
+    out_y: &mut [Real],
+) {
+    let count = point_x.len();
+    assert!(point_y.len() == count);
+    assert!(point_z.len() == count);
+    assert!(out_x.len() == count);
+    assert!(out_y.len() == count);
+
+    #[cfg(target_arch = "x86_64")]
+    {
+        if is_x86_feature_detected!("avx2") && is_x86_feature_detected!("fma") {
+            // SAFETY: The CPU features are checked above, and the
+            // lengths of all slices are checked to be equal.
+            unsafe {
+                reproject_as_normalised_coord_batch_avx2(
+                    camera_world_proj_matrix,
+                    point_x,
+                    point_y,
+                    point_z,
+                    out_x,
+                    out_y,
+                );
+            }
+            return;
+        }
+    }
+
+    reproject_as_normalised_coord_batch_scalar(
+        camera_world_proj_matrix,
+        0,
+        point_x,
+        point_y,
+        point_z,
+        out_x,
+        out_y,
+    );
+}
+
+/// Scalar re-projection of the points from 'start' to the end of the
+/// slices.
+#[inline]
+fn reproject_as_normalised_coord_batch_scalar(
+    m: &Matrix44,
+    start: usize,
+    point_x: &[Real],
+    point_y: &[Real],
+    point_z: &[Real],
+    out_x: &mut [Real],
+    out_y: &mut [Real],
+) {
+    for i in start..point_x.len() {
+        let x = point_x[i];
+        let y = point_y[i];
+        let z = point_z[i];
+        let sx = m[(0, 0)] * x + m[(0, 1)] * y + m[(0, 2)] * z + m[(0, 3)];
+        let sy = m[(1, 0)] * x + m[(1, 1)] * y + m[(1, 2)] * z + m[(1, 3)];
+        let sw = m[(3, 0)] * x + m[(3, 1)] * y + m[(3, 2)] * z + m[(3, 3)];
+        out_x[i] = (sx / sw) * 0.5;
+        out_y[i] = (sy / sw) * 0.5;
+    }
+}
+
+#[cfg(target_arch = "x86_64")]
+#[target_feature(enable = "avx2,fma")]
+unsafe fn reproject_as_normalised_coord_batch_avx2(
+    m: &Matrix44,
+    point_x: &[Real],
+    point_y: &[Real],
+    point_z: &[Real],
+    out_x: &mut [Real],
+    out_y: &mut [Real],
+) {
+    use std::arch::x86_64::*;
+
+    const LANES: usize = 4;
+    let count = point_x.len();
+    let count_vectorised = count - (count % LANES);
+
+    let m00 = _mm256_set1_pd(m[(0, 0)]);
+    let m01 = _mm256_set1_pd(m[(0, 1)]);
+    let m02 = _mm256_set1_pd(m[(0, 2)]);
+    let m03 = _mm256_set1_pd(m[(0, 3)]);
+    let m10 = _mm256_set1_pd(m[(1, 0)]);
+    let m11 = _mm256_set1_pd(m[(1, 1)]);
+    let m12 = _mm256_set1_pd(m[(1, 2)]);
+    let m13 = _mm256_set1_pd(m[(1, 3)]);
+    let m30 = _mm256_set1_pd(m[(3, 0)]);
+    let m31 = _mm256_set1_pd(m[(3, 1)]);
+    let m32 = _mm256_set1_pd(m[(3, 2)]);
+    let m33 = _mm256_set1_pd(m[(3, 3)]);
+    let half = _mm256_set1_pd(0.5);
+
+    let mut i = 0;
+    while i < count_vectorised {
+        let x = _mm256_loadu_pd(point_x.as_ptr().add(i));
+        let y = _mm256_loadu_pd(point_y.as_ptr().add(i));
+        let z = _mm256_loadu_pd(point_z.as_ptr().add(i));
+
+        let sx = _mm256_fmadd_pd(
+            m00,
+            x,
+            _mm256_fmadd_pd(m01, y, _mm256_fmadd_pd(m02, z, m03)),
+        );
+        let sy = _mm256_fmadd_pd(
+            m10,
+            x,
+            _mm256_fmadd_pd(m11, y, _mm256_fmadd_pd(m12, z, m13)),
+        );
+        let sw = _mm256_fmadd_pd(
+            m30,
+            x,
+            _mm256_fmadd_pd(m31, y, _mm256_fmadd_pd(m32, z, m33)),
+        );
+
+        let rx = _mm256_mul_pd(_mm256_div_pd(sx, sw), half);
+        let ry = _mm256_mul_pd(_mm256_div_pd(sy, sw), half);
+        _mm256_storeu_pd(out_x.as_mut_ptr().add(i), rx);
+        _mm256_storeu_pd(out_y.as_mut_ptr().add(i), ry);
+        i += LANES;
+    }
+
+    reproject_as_normalised_coord_batch_scalar(
+        m,
+        count_vectorised,
+        point_x,
+        point_y,
+        point_z,
+        out_x,
+        out_y,
+    );
+}
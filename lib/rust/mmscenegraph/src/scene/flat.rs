@@ -19,25 +19,43 @@
 //
 
 use petgraph::graph::NodeIndex as PGNodeIndex;
+use rustc_hash::FxHashMap;
 
 use crate::attr::datablock::AttrDataBlock;
 use crate::attr::AttrCameraIds;
+use crate::attr::AttrId;
 use crate::attr::AttrMarkerIds;
 use crate::attr::AttrTransformIds;
 use crate::constant::FrameValue;
 use crate::constant::Matrix44;
 use crate::constant::Real;
 use crate::math::camera::FilmFit;
+use crate::math::dag::compute_matrix_with_attrs;
 use crate::math::dag::compute_projection_matrix_with_attrs;
-use crate::math::dag::compute_world_matrices_with_attrs;
-use crate::math::reprojection::reproject_as_normalised_coord;
+use crate::math::dag::compute_world_matrices_with_attrs_frame_parallel;
+use crate::math::dag::DEFAULT_FRAME_PARALLEL_GRAIN_SIZE;
+use crate::math::reprojection::compute_camera_world_projection_matrix;
+use crate::math::reprojection::reproject_as_normalised_coord_batch;
+use crate::math::reprojection::reproject_as_normalised_coord_with_world_projection_matrix;
 use crate::math::rotate::euler::RotateOrder;
 use crate::node::NodeId;
 
 const NUM_VALUES_PER_POINT: usize = 2;
 const NUM_VALUES_PER_MARKER: usize = 2;
 
+/// The value in a flat scene that is computed from an attribute.
+#[derive(Debug, Copy, Clone, Eq, PartialEq)]
+enum AttrDependency {
+    // Index into the transform lists.
+    Transform(usize),
+    // Index into the camera lists.
+    Camera(usize),
+    // Index into the marker lists.
+    Marker(usize),
+}
+
 /// flattened scene data with an un-editable hierarchy.
+#[derive(Clone)]
 pub struct FlatScene {
     // The node ids for bundles and cameras. These can be used to look
     // up and filter data.
@@ -68,6 +86,171 @@ pub struct FlatScene {
     out_cam_world_matrix_list: Vec<Matrix44>,
     out_marker_list: Vec<Real>,
     out_point_list: Vec<Real>,
+
+    // The number of frames of world matrices evaluated by each
+    // thread, or zero to evaluate all frames on one thread.
+    frame_parallel_grain_size: usize,
+    tfm_world_matrix_scratch_list: Vec<Matrix44>,
+
+    // Per-camera values, at each frame, shared by all the markers of
+    // the camera.
+    cam_world_proj_matrix_list: Vec<Matrix44>,
+    cam_marker_scale_list: Vec<(Real, Real)>,
+
+    // Scratch buffers for re-projecting all the bundles viewed by a
+    // camera at once, as structure-of-arrays.
+    batch_point_x_list: Vec<Real>,
+    batch_point_y_list: Vec<Real>,
+    batch_point_z_list: Vec<Real>,
+    batch_out_x_list: Vec<Real>,
+    batch_out_y_list: Vec<Real>,
+
+    // Look-ups used to find the values affected by an attribute,
+    // computed once because the hierarchy cannot change.
+    tfm_children_indices: Vec<Vec<usize>>,
+    cam_mkr_indices: Vec<Vec<usize>>,
+    bnd_mkr_indices: Vec<Vec<usize>>,
+    attr_dependencies: FxHashMap<AttrId, Vec<AttrDependency>>,
+
+    // The frames used for the last evaluation, and the index of each
+    // frame.
+    evaluated_frame_list: Vec<FrameValue>,
+    evaluated_frame_indices: FxHashMap<FrameValue, usize>,
+
+    // The transforms, cameras and markers to be re-evaluated, at each
+    // frame; 'index * num_frames + frame_index'.
+    dirty_tfm_flags: Vec<bool>,
+    dirty_tfm_list: Vec<usize>,
+    dirty_cam_flags: Vec<bool>,
+    dirty_cam_list: Vec<usize>,
+    dirty_mkr_flags: Vec<bool>,
+    dirty_mkr_list: Vec<usize>,
+}
+
+fn mark_dirty(index: usize, flags: &mut Vec<bool>, list: &mut Vec<usize>) {
+    if !flags[index] {
+        flags[index] = true;
+        list.push(index);
+    }
+}
+
+fn clear_dirty(flags: &mut Vec<bool>, list: &mut Vec<usize>) {
+    for index in list.iter() {
+        flags[*index] = false;
+    }
+    list.clear();
+}
+
+/// Compute the values shared by all markers of a camera at one
+/// frame; the world-to-screen matrix and the film-fit scale for
+/// marker positions.
+fn compute_camera_at_frame(
+    attrdb: &AttrDataBlock,
+    cam_attrs: &AttrCameraIds,
+    cam_film_fit: FilmFit,
+    cam_render_res: (i32, i32),
+    cam_tfm_matrix: Matrix44,
+    frame: FrameValue,
+) -> (Matrix44, (Real, Real)) {
+    let (cam_render_width, cam_render_height) = cam_render_res;
+    let cam_proj_matrix = compute_projection_matrix_with_attrs(
+        &attrdb,
+        cam_attrs.sensor_width,
+        cam_attrs.sensor_height,
+        cam_attrs.focal_length,
+        cam_attrs.lens_offset_x,
+        cam_attrs.lens_offset_y,
+        cam_attrs.near_clip_plane,
+        cam_attrs.far_clip_plane,
+        cam_attrs.camera_scale,
+        cam_film_fit,
+        cam_render_width,
+        cam_render_height,
+        frame,
+    );
+    // println!("Camera Transform Matrix: {}", cam_tfm_matrix);
+    // println!("Camera Projection Matrix: {}", cam_proj_matrix);
+    let cam_world_proj_matrix =
+        compute_camera_world_projection_matrix(cam_tfm_matrix, cam_proj_matrix);
+
+    // Scale the Marker Y for deviation calculation.
+    let cam_sensor_x = attrdb.get_attr_value(cam_attrs.sensor_width, frame);
+    let cam_sensor_y = attrdb.get_attr_value(cam_attrs.sensor_height, frame);
+    let sensor_aspect = cam_sensor_x / cam_sensor_y;
+    let render_x = cam_render_width as Real;
+    let render_y = cam_render_height as Real;
+    let render_aspect = render_x / render_y;
+
+    let mut scale_x = 1.0;
+    let mut scale_y = 1.0;
+    scale_xy_with_film_fit(
+        cam_film_fit,
+        sensor_aspect,
+        render_aspect,
+        &mut scale_x,
+        &mut scale_y,
+    );
+
+    (cam_world_proj_matrix, (scale_x, scale_y))
+}
+
+/// Compute the reprojected bundle point and the (film-fit scaled)
+/// marker position, for one marker at one frame.
+#[inline]
+fn compute_point_and_marker(
+    attrdb: &AttrDataBlock,
+    mkr_attrs: &AttrMarkerIds,
+    cam_world_proj_matrix: Matrix44,
+    cam_marker_scale: (Real, Real),
+    bnd_matrix: Matrix44,
+    frame: FrameValue,
+) -> ([Real; NUM_VALUES_PER_POINT], [Real; NUM_VALUES_PER_MARKER]) {
+    let reproj_mat = reproject_as_normalised_coord_with_world_projection_matrix(
+        cam_world_proj_matrix,
+        bnd_matrix,
+    );
+
+    let marker = compute_marker(attrdb, mkr_attrs, cam_marker_scale, frame);
+
+    // TODO: Compute the dot product of the camera
+    // forward vector and the direction to the bundle.
+
+    ([reproj_mat[0], reproj_mat[1]], marker)
+}
+
+/// Compute the (film-fit scaled) marker position at one frame.
+#[inline]
+fn compute_marker(
+    attrdb: &AttrDataBlock,
+    mkr_attrs: &AttrMarkerIds,
+    cam_marker_scale: (Real, Real),
+    frame: FrameValue,
+) -> [Real; NUM_VALUES_PER_MARKER] {
+    let (scale_x, scale_y) = cam_marker_scale;
+    let mkr_tx = attrdb.get_attr_value(mkr_attrs.tx, frame) * scale_x;
+    let mkr_ty = attrdb.get_attr_value(mkr_attrs.ty, frame) * scale_y;
+
+    // // TODO: Use marker weight?
+    // let mkr_weight = attr_data_block.get_attr_value(mkr_attr.weight, frame);
+
+    [mkr_tx, mkr_ty]
+}
+
+/// Write the values of a marker at a frame into the output lists.
+#[inline]
+fn write_point_and_marker(
+    mkr_index_at_frame: usize,
+    point: [Real; NUM_VALUES_PER_POINT],
+    marker: [Real; NUM_VALUES_PER_MARKER],
+    out_point_list: &mut [Real],
+    out_marker_list: &mut [Real],
+) {
+    let point_start = mkr_index_at_frame * NUM_VALUES_PER_POINT;
+    let marker_start = mkr_index_at_frame * NUM_VALUES_PER_MARKER;
+    out_point_list[point_start..point_start + NUM_VALUES_PER_POINT]
+        .copy_from_slice(&point);
+    out_marker_list[marker_start..marker_start + NUM_VALUES_PER_MARKER]
+        .copy_from_slice(&marker);
 }
 
 fn scale_xy_with_film_fit(
@@ -116,6 +299,59 @@ impl FlatScene {
         tfm_node_indices: Vec<PGNodeIndex>,
         tfm_node_parent_indices: Vec<Option<usize>>,
     ) -> Self {
+        let num_transforms = tfm_node_ids.len();
+        let mut tfm_children_indices = vec![Vec::new(); num_transforms];
+        for (i, parent_index) in (0..).zip(tfm_node_parent_indices.iter()) {
+            if let Some(parent_index) = parent_index {
+                tfm_children_indices[*parent_index].push(i);
+            }
+        }
+
+        let mut cam_mkr_indices = vec![Vec::new(); cam_ids.len()];
+        for (mkr_index, cam_index) in (0..).zip(mkr_cam_indices.iter()) {
+            cam_mkr_indices[*cam_index].push(mkr_index);
+        }
+        let mut bnd_mkr_indices = vec![Vec::new(); bnd_ids.len()];
+        for (mkr_index, bnd_index) in (0..).zip(mkr_bnd_indices.iter()) {
+            bnd_mkr_indices[*bnd_index].push(mkr_index);
+        }
+
+        let mut attr_dependencies: FxHashMap<AttrId, Vec<AttrDependency>> =
+            FxHashMap::default();
+        let mut add_dependency = |attr_id: AttrId, dep: AttrDependency| {
+            if attr_id != AttrId::None {
+                attr_dependencies.entry(attr_id).or_default().push(dep);
+            }
+        };
+        for (i, tfm_attrs) in (0..).zip(tfm_attr_list.iter()) {
+            let dep = AttrDependency::Transform(i);
+            add_dependency(tfm_attrs.tx, dep);
+            add_dependency(tfm_attrs.ty, dep);
+            add_dependency(tfm_attrs.tz, dep);
+            add_dependency(tfm_attrs.rx, dep);
+            add_dependency(tfm_attrs.ry, dep);
+            add_dependency(tfm_attrs.rz, dep);
+            add_dependency(tfm_attrs.sx, dep);
+            add_dependency(tfm_attrs.sy, dep);
+            add_dependency(tfm_attrs.sz, dep);
+        }
+        for (i, cam_attrs) in (0..).zip(cam_attr_list.iter()) {
+            let dep = AttrDependency::Camera(i);
+            add_dependency(cam_attrs.sensor_width, dep);
+            add_dependency(cam_attrs.sensor_height, dep);
+            add_dependency(cam_attrs.focal_length, dep);
+            add_dependency(cam_attrs.lens_offset_x, dep);
+            add_dependency(cam_attrs.lens_offset_y, dep);
+            add_dependency(cam_attrs.near_clip_plane, dep);
+            add_dependency(cam_attrs.far_clip_plane, dep);
+            add_dependency(cam_attrs.camera_scale, dep);
+        }
+        for (i, mkr_attrs) in (0..).zip(mkr_attr_list.iter()) {
+            let dep = AttrDependency::Marker(i);
+            add_dependency(mkr_attrs.tx, dep);
+            add_dependency(mkr_attrs.ty, dep);
+        }
+
         Self {
             bnd_ids,
             cam_ids,
@@ -140,6 +376,33 @@ impl FlatScene {
             out_cam_world_matrix_list: Vec::new(),
             out_marker_list: Vec::new(),
             out_point_list: Vec::new(),
+
+            frame_parallel_grain_size: DEFAULT_FRAME_PARALLEL_GRAIN_SIZE,
+            tfm_world_matrix_scratch_list: Vec::new(),
+
+            cam_world_proj_matrix_list: Vec::new(),
+            cam_marker_scale_list: Vec::new(),
+
+            batch_point_x_list: Vec::new(),
+            batch_point_y_list: Vec::new(),
+            batch_point_z_list: Vec::new(),
+            batch_out_x_list: Vec::new(),
+            batch_out_y_list: Vec::new(),
+
+            tfm_children_indices,
+            cam_mkr_indices,
+            bnd_mkr_indices,
+            attr_dependencies,
+
+            evaluated_frame_list: Vec::new(),
+            evaluated_frame_indices: FxHashMap::default(),
+
+            dirty_tfm_flags: Vec::new(),
+            dirty_tfm_list: Vec::new(),
+            dirty_cam_flags: Vec::new(),
+            dirty_cam_list: Vec::new(),
+            dirty_mkr_flags: Vec::new(),
+            dirty_mkr_list: Vec::new(),
         }
     }
 
@@ -151,6 +414,16 @@ impl FlatScene {
         &self.out_point_list[..]
     }
 
+    pub fn frame_parallel_grain_size(&self) -> usize {
+        self.frame_parallel_grain_size
+    }
+
+    /// Set the number of frames of world matrices evaluated by each
+    /// thread. Zero evaluates all frames on the calling thread.
+    pub fn set_frame_parallel_grain_size(&mut self, value: usize) {
+        self.frame_parallel_grain_size = value;
+    }
+
     pub fn num_markers(&self) -> usize {
         let len = self.out_marker_list.len();
         if len > 0 {
@@ -192,21 +465,31 @@ impl FlatScene {
 
         let num_total_bundles = num_bundles * num_frames;
         let num_total_cameras = num_cameras * num_frames;
-        let _num_total_transforms = num_transforms * num_frames;
+        let num_total_markers = num_markers * num_frames;
 
-        self.out_bnd_world_matrix_list = Vec::with_capacity(num_total_bundles);
-        self.out_cam_world_matrix_list = Vec::with_capacity(num_total_cameras);
+        // The output lists are re-used between evaluations, so memory
+        // is only allocated when the scene or frames grow.
         self.out_bnd_world_matrix_list
             .resize(num_total_bundles, Matrix44::identity());
         self.out_cam_world_matrix_list
             .resize(num_total_cameras, Matrix44::identity());
+        self.cam_world_proj_matrix_list
+            .resize(num_total_cameras, Matrix44::identity());
+        self.cam_marker_scale_list
+            .resize(num_total_cameras, (1.0, 1.0));
+        self.out_marker_list
+            .resize(num_total_markers * NUM_VALUES_PER_MARKER, 0.0);
+        self.out_point_list
+            .resize(num_total_markers * NUM_VALUES_PER_POINT, 0.0);
 
-        compute_world_matrices_with_attrs(
+        compute_world_matrices_with_attrs_frame_parallel(
             &attrdb,
             &self.tfm_attr_list,
             &self.rotate_order_list,
             &self.tfm_node_parent_indices,
             frame_list,
+            self.frame_parallel_grain_size,
+            &mut self.tfm_world_matrix_scratch_list,
             &mut self.out_tfm_world_matrix_list,
         );
         // println!(
@@ -253,108 +536,312 @@ impl FlatScene {
         // );
 
         assert!(self.out_cam_world_matrix_list.len() == num_total_cameras);
-        self.out_marker_list.clear();
-        self.out_point_list.clear();
-        self.out_marker_list
-            .reserve(num_markers * NUM_VALUES_PER_MARKER * num_frames);
-        self.out_point_list
-            .reserve(num_markers * NUM_VALUES_PER_POINT * num_frames);
-
-        let cam_attrs_iter = (0..).zip(
-            self.cam_attr_list.iter().zip(
-                self.cam_film_fit_list
-                    .iter()
-                    .zip(self.cam_render_res_list.iter()),
-            ),
-        );
 
-        for (
-            i,
-            (cam_attrs, (cam_film_fit, (cam_render_width, cam_render_height))),
-        ) in cam_attrs_iter
-        {
-            let attr_cam_sensor_x = cam_attrs.sensor_width;
-            let attr_cam_sensor_y = cam_attrs.sensor_height;
-            let attr_cam_focal_length = cam_attrs.focal_length;
-            let attr_cam_lens_offset_x = cam_attrs.lens_offset_x;
-            let attr_cam_lens_offset_y = cam_attrs.lens_offset_y;
-            let attr_cam_near_clip_plane = cam_attrs.near_clip_plane;
-            let attr_cam_far_clip_plane = cam_attrs.far_clip_plane;
-            let attr_cam_camera_scale = cam_attrs.camera_scale;
-
-            let mkr_attrs_iter = (0..).zip(self.mkr_attr_list.iter());
-            for (mkr_index, mkr_attrs) in mkr_attrs_iter {
-                let cam_index = self.mkr_cam_indices[mkr_index];
-                if cam_index != i {
-                    continue;
-                }
-                let bnd_index = self.mkr_bnd_indices[mkr_index];
+        // Compute the camera values once per-frame, then re-project
+        // all the bundles viewed by the camera together. Values are
+        // stored per-marker, then per-frame.
+        for cam_index in 0..num_cameras {
+            let cam_attrs = &self.cam_attr_list[cam_index];
+            let cam_film_fit = self.cam_film_fit_list[cam_index];
+            let cam_render_res = self.cam_render_res_list[cam_index];
+            let mkr_indices = &self.cam_mkr_indices[cam_index];
+            let num_cam_markers = mkr_indices.len();
+            if num_cam_markers == 0 {
+                continue;
+            }
+            self.batch_point_x_list.resize(num_cam_markers, 0.0);
+            self.batch_point_y_list.resize(num_cam_markers, 0.0);
+            self.batch_point_z_list.resize(num_cam_markers, 0.0);
+            self.batch_out_x_list.resize(num_cam_markers, 0.0);
+            self.batch_out_y_list.resize(num_cam_markers, 0.0);
+
+            for (f, frame) in (0..).zip(frame_list) {
+                let frame = *frame;
+                let cam_index_at_frame = (cam_index * num_frames) + f;
+                let (cam_world_proj_matrix, cam_marker_scale) =
+                    compute_camera_at_frame(
+                        attrdb,
+                        cam_attrs,
+                        cam_film_fit,
+                        cam_render_res,
+                        self.out_cam_world_matrix_list[cam_index_at_frame],
+                        frame,
+                    );
+                self.cam_world_proj_matrix_list[cam_index_at_frame] =
+                    cam_world_proj_matrix;
+                self.cam_marker_scale_list[cam_index_at_frame] =
+                    cam_marker_scale;
 
-                for (f, frame) in (0..).zip(frame_list) {
-                    let frame = *frame;
-                    let cam_index_at_frame = (cam_index * num_frames) + f;
+                for (k, mkr_index) in (0..).zip(mkr_indices) {
+                    let bnd_index = self.mkr_bnd_indices[*mkr_index];
                     let bnd_index_at_frame = (bnd_index * num_frames) + f;
                     let bnd_matrix =
-                        self.out_bnd_world_matrix_list[bnd_index_at_frame];
-                    let cam_tfm_matrix =
-                        self.out_cam_world_matrix_list[cam_index_at_frame];
-                    let cam_proj_matrix = compute_projection_matrix_with_attrs(
-                        &attrdb,
-                        attr_cam_sensor_x,
-                        attr_cam_sensor_y,
-                        attr_cam_focal_length,
-                        attr_cam_lens_offset_x,
-                        attr_cam_lens_offset_y,
-                        attr_cam_near_clip_plane,
-                        attr_cam_far_clip_plane,
-                        attr_cam_camera_scale,
-                        *cam_film_fit,
-                        *cam_render_width,
-                        *cam_render_height,
-                        frame,
-                    );
-                    // println!("Camera Transform Matrix: {}", cam_tfm_matrix);
-                    // println!("Camera Projection Matrix: {}", cam_proj_matrix);
+                        &self.out_bnd_world_matrix_list[bnd_index_at_frame];
+                    self.batch_point_x_list[k] = bnd_matrix[(0, 3)];
+                    self.batch_point_y_list[k] = bnd_matrix[(1, 3)];
+                    self.batch_point_z_list[k] = bnd_matrix[(2, 3)];
+                }
 
-                    let reproj_mat = reproject_as_normalised_coord(
-                        cam_tfm_matrix,
-                        cam_proj_matrix,
-                        bnd_matrix,
+                reproject_as_normalised_coord_batch(
+                    &cam_world_proj_matrix,
+                    &self.batch_point_x_list,
+                    &self.batch_point_y_list,
+                    &self.batch_point_z_list,
+                    &mut self.batch_out_x_list,
+                    &mut self.batch_out_y_list,
+                );
+
+                for (k, mkr_index) in (0..).zip(mkr_indices) {
+                    let mkr_index = *mkr_index;
+                    let point =
+                        [self.batch_out_x_list[k], self.batch_out_y_list[k]];
+                    let marker = compute_marker(
+                        attrdb,
+                        &self.mkr_attr_list[mkr_index],
+                        cam_marker_scale,
+                        frame,
                     );
-                    self.out_point_list.push(reproj_mat[0]);
-                    self.out_point_list.push(reproj_mat[1]);
-
-                    // Scale the Marker Y for deviation calculation.
-                    let cam_sensor_x =
-                        attrdb.get_attr_value(attr_cam_sensor_x, frame);
-                    let cam_sensor_y =
-                        attrdb.get_attr_value(attr_cam_sensor_y, frame);
-                    let sensor_aspect = cam_sensor_x / cam_sensor_y;
-                    let render_x = *cam_render_width as Real;
-                    let render_y = *cam_render_height as Real;
-                    let render_aspect = render_x / render_y;
-
-                    let mut mkr_tx = attrdb.get_attr_value(mkr_attrs.tx, frame);
-                    let mut mkr_ty = attrdb.get_attr_value(mkr_attrs.ty, frame);
-                    scale_xy_with_film_fit(
-                        *cam_film_fit,
-                        sensor_aspect,
-                        render_aspect,
-                        &mut mkr_tx,
-                        &mut mkr_ty,
+                    write_point_and_marker(
+                        (mkr_index * num_frames) + f,
+                        point,
+                        marker,
+                        &mut self.out_point_list,
+                        &mut self.out_marker_list,
                     );
+                }
+            }
+        }
+
+        self.set_evaluated_frames(frame_list);
+    }
+
+    /// Remember the frames evaluated, so that later evaluations can
+    /// re-use the values.
+    fn set_evaluated_frames(&mut self, frame_list: &[FrameValue]) {
+        if self.evaluated_frame_list != frame_list {
+            self.evaluated_frame_list.clear();
+            self.evaluated_frame_list.extend_from_slice(frame_list);
+            self.evaluated_frame_indices.clear();
+            for (f, frame) in (0..).zip(frame_list) {
+                self.evaluated_frame_indices.insert(*frame, f);
+            }
+        }
+
+        let num_frames = frame_list.len();
+        let num_transforms = self.tfm_node_ids.len();
+        let num_cameras = self.cam_ids.len();
+        let num_markers = self.mkr_ids.len();
+        clear_dirty(&mut self.dirty_tfm_flags, &mut self.dirty_tfm_list);
+        clear_dirty(&mut self.dirty_cam_flags, &mut self.dirty_cam_list);
+        clear_dirty(&mut self.dirty_mkr_flags, &mut self.dirty_mkr_list);
+        self.dirty_tfm_flags
+            .resize(num_transforms * num_frames, false);
+        self.dirty_cam_flags.resize(num_cameras * num_frames, false);
+        self.dirty_mkr_flags.resize(num_markers * num_frames, false);
+    }
+
+    /// Evaluate only the values affected by changed attributes,
+    /// re-using the values computed by the previous evaluation.
+    ///
+    /// 'dirty_attr_list' and 'dirty_frame_list' are pairs; each
+    /// attribute has changed at the frame. Static attributes change
+    /// all frames, so the frame is ignored. Changed transforms are
+    /// re-computed along with their children, and only the markers
+    /// that view changed transforms, cameras or markers are
+    /// re-projected.
+    ///
+    /// The attribute values must only have changed by the dirty
+    /// attributes since the last evaluation. When 'frame_list' is
+    /// different to the previous evaluation, everything is evaluated.
+    pub fn evaluate_dirty(
+        &mut self,
+        attrdb: &AttrDataBlock,
+        frame_list: &[FrameValue],
+        dirty_attr_list: &[AttrId],
+        dirty_frame_list: &[FrameValue],
+    ) {
+        assert!(dirty_attr_list.len() == dirty_frame_list.len());
+        if self.evaluated_frame_list.is_empty()
+            || self.evaluated_frame_list != frame_list
+        {
+            self.evaluate(attrdb, frame_list);
+            return;
+        }
+        let num_frames = frame_list.len();
+
+        // Find the transforms, cameras and markers changed directly
+        // by the attributes.
+        for (attr_id, frame) in dirty_attr_list.iter().zip(dirty_frame_list) {
+            let dependencies = match self.attr_dependencies.get(attr_id) {
+                Some(value) => value,
+                None => continue,
+            };
+            let (frame_start, frame_end) = match attr_id {
+                AttrId::Static(_) => (0, num_frames),
+                AttrId::AnimDense(_) | AttrId::AnimRle(_) => {
+                    match self.evaluated_frame_indices.get(frame) {
+                        Some(f) => (*f, *f + 1),
+                        None => continue,
+                    }
+                }
+                AttrId::None => continue,
+            };
+
+            for dependency in dependencies {
+                let (index, flags, list) = match dependency {
+                    AttrDependency::Transform(index) => (
+                        *index,
+                        &mut self.dirty_tfm_flags,
+                        &mut self.dirty_tfm_list,
+                    ),
+                    AttrDependency::Camera(index) => (
+                        *index,
+                        &mut self.dirty_cam_flags,
+                        &mut self.dirty_cam_list,
+                    ),
+                    AttrDependency::Marker(index) => (
+                        *index,
+                        &mut self.dirty_mkr_flags,
+                        &mut self.dirty_mkr_list,
+                    ),
+                };
+                for f in frame_start..frame_end {
+                    mark_dirty((index * num_frames) + f, flags, list);
+                }
+            }
+        }
 
-                    self.out_marker_list.push(mkr_tx);
-                    self.out_marker_list.push(mkr_ty);
+        // Children of changed transforms are changed too.
+        let mut k = 0;
+        while k < self.dirty_tfm_list.len() {
+            let tfm_index_at_frame = self.dirty_tfm_list[k];
+            let tfm_index = tfm_index_at_frame / num_frames;
+            let f = tfm_index_at_frame % num_frames;
+            for child_index in &self.tfm_children_indices[tfm_index] {
+                mark_dirty(
+                    (child_index * num_frames) + f,
+                    &mut self.dirty_tfm_flags,
+                    &mut self.dirty_tfm_list,
+                );
+            }
+            k += 1;
+        }
 
-                    // // TODO: Use marker weight?
-                    // let mkr_weight = attr_data_block.get_attr_value(mkr_attr.weight, frame);
+        // Parents always have a lower index than their children, so
+        // sorting computes parent world matrices first.
+        self.dirty_tfm_list.sort_unstable();
+        for tfm_index_at_frame in self.dirty_tfm_list.iter() {
+            let tfm_index_at_frame = *tfm_index_at_frame;
+            let i = tfm_index_at_frame / num_frames;
+            let f = tfm_index_at_frame % num_frames;
+            let tfm_attrs = &self.tfm_attr_list[i];
+            let local_matrix = compute_matrix_with_attrs(
+                attrdb,
+                tfm_attrs.tx,
+                tfm_attrs.ty,
+                tfm_attrs.tz,
+                tfm_attrs.rx,
+                tfm_attrs.ry,
+                tfm_attrs.rz,
+                tfm_attrs.sx,
+                tfm_attrs.sy,
+                tfm_attrs.sz,
+                self.rotate_order_list[i],
+                frame_list[f],
+            );
+            let world_matrix = match self.tfm_node_parent_indices[i] {
+                Some(parent_index) => {
+                    let parent_index_at_frame = (parent_index * num_frames) + f;
+                    self.out_tfm_world_matrix_list[parent_index_at_frame]
+                        * local_matrix
+                }
+                None => local_matrix,
+            };
+            self.out_tfm_world_matrix_list[tfm_index_at_frame] = world_matrix;
 
-                    // TODO: Compute the dot product of the camera
-                    // forward vector and the direction to the bundle.
+            match self.tfm_node_ids[i] {
+                NodeId::Camera(index) => {
+                    let index_at_frame = (index as usize * num_frames) + f;
+                    self.out_cam_world_matrix_list[index_at_frame] =
+                        world_matrix;
+                    mark_dirty(
+                        index_at_frame,
+                        &mut self.dirty_cam_flags,
+                        &mut self.dirty_cam_list,
+                    );
+                }
+                NodeId::Bundle(index) => {
+                    let index = index as usize;
+                    self.out_bnd_world_matrix_list[(index * num_frames) + f] =
+                        world_matrix;
+                    for mkr_index in &self.bnd_mkr_indices[index] {
+                        mark_dirty(
+                            (mkr_index * num_frames) + f,
+                            &mut self.dirty_mkr_flags,
+                            &mut self.dirty_mkr_list,
+                        );
+                    }
                 }
+                _ => (),
+            };
+        }
+
+        // Re-compute the changed cameras, which changes all markers
+        // of the camera.
+        for cam_index_at_frame in self.dirty_cam_list.iter() {
+            let cam_index_at_frame = *cam_index_at_frame;
+            let cam_index = cam_index_at_frame / num_frames;
+            let f = cam_index_at_frame % num_frames;
+            let (cam_world_proj_matrix, cam_marker_scale) =
+                compute_camera_at_frame(
+                    attrdb,
+                    &self.cam_attr_list[cam_index],
+                    self.cam_film_fit_list[cam_index],
+                    self.cam_render_res_list[cam_index],
+                    self.out_cam_world_matrix_list[cam_index_at_frame],
+                    frame_list[f],
+                );
+            self.cam_world_proj_matrix_list[cam_index_at_frame] =
+                cam_world_proj_matrix;
+            self.cam_marker_scale_list[cam_index_at_frame] = cam_marker_scale;
+            for mkr_index in &self.cam_mkr_indices[cam_index] {
+                mark_dirty(
+                    (mkr_index * num_frames) + f,
+                    &mut self.dirty_mkr_flags,
+                    &mut self.dirty_mkr_list,
+                );
             }
         }
+
+        // Re-project the changed markers.
+        for mkr_index_at_frame in self.dirty_mkr_list.iter() {
+            let mkr_index_at_frame = *mkr_index_at_frame;
+            let mkr_index = mkr_index_at_frame / num_frames;
+            let f = mkr_index_at_frame % num_frames;
+            let cam_index_at_frame =
+                (self.mkr_cam_indices[mkr_index] * num_frames) + f;
+            let bnd_index_at_frame =
+                (self.mkr_bnd_indices[mkr_index] * num_frames) + f;
+            let (point, marker) = compute_point_and_marker(
+                attrdb,
+                &self.mkr_attr_list[mkr_index],
+                self.cam_world_proj_matrix_list[cam_index_at_frame],
+                self.cam_marker_scale_list[cam_index_at_frame],
+                self.out_bnd_world_matrix_list[bnd_index_at_frame],
+                frame_list[f],
+            );
+            write_point_and_marker(
+                mkr_index_at_frame,
+                point,
+                marker,
+                &mut self.out_point_list,
+                &mut self.out_marker_list,
+            );
+        }
+
+        clear_dirty(&mut self.dirty_tfm_flags, &mut self.dirty_tfm_list);
+        clear_dirty(&mut self.dirty_cam_flags, &mut self.dirty_cam_list);
+        clear_dirty(&mut self.dirty_mkr_flags, &mut self.dirty_mkr_list);
     }
 }
 
@@ -0,0 +1,121 @@
+//
+// Copyright (C) 2020, 2021 David Cattermole.
+//
+// This file is part of mmSolver.
+//
+// mmSolver is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// mmSolver is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+// ====================================================================
+//
+
+use mmscenegraph_rust::attr::datablock::AttrDataBlock;
+use mmscenegraph_rust::attr::AttrTransformIds;
+use mmscenegraph_rust::constant::FrameValue;
+use mmscenegraph_rust::constant::Real;
+use mmscenegraph_rust::math::dag::compute_world_matrices_with_attrs;
+use mmscenegraph_rust::math::dag::compute_world_matrices_with_attrs_frame_parallel;
+use mmscenegraph_rust::math::rotate::euler::RotateOrder;
+
+fn create_anim_values(
+    num_frames: usize,
+    offset: Real,
+    scale: Real,
+) -> Vec<Real> {
+    (0..num_frames)
+        .map(|f| offset + ((f as Real) * 0.1).sin() * scale)
+        .collect()
+}
+
+#[test]
+fn frame_parallel_matches_serial() {
+    let num_frames = 300;
+    let start_frame: FrameValue = 1001;
+    let frame_list: Vec<FrameValue> = (0..num_frames)
+        .map(|f| start_frame + f as FrameValue)
+        .collect();
+
+    // A deep chain of animated transforms, with a static transform
+    // branching from the middle of the chain.
+    let mut attrdb = AttrDataBlock::new();
+    let mut tfm_attr_list = Vec::new();
+    let mut rotate_order_list = Vec::new();
+    let mut transform_parents = Vec::new();
+    for i in 0..8 {
+        let offset = i as Real;
+        let tfm_attrs = AttrTransformIds {
+            tx: attrdb.create_attr_anim_dense(
+                create_anim_values(num_frames, offset, 1.0),
+                start_frame,
+            ),
+            ty: attrdb.create_attr_static(0.5),
+            tz: attrdb.create_attr_anim_dense(
+                create_anim_values(num_frames, -offset, 2.0),
+                start_frame,
+            ),
+            rx: attrdb.create_attr_static(5.0),
+            ry: attrdb.create_attr_anim_dense(
+                create_anim_values(num_frames, offset * 10.0, 45.0),
+                start_frame,
+            ),
+            rz: attrdb.create_attr_static(-5.0),
+            sx: attrdb.create_attr_static(1.0),
+            sy: attrdb.create_attr_static(1.0),
+            sz: attrdb.create_attr_static(1.0),
+        };
+        tfm_attr_list.push(tfm_attrs);
+        rotate_order_list.push(RotateOrder::ZXY);
+        transform_parents.push(if i == 0 { None } else { Some(i - 1) });
+    }
+    tfm_attr_list.push(AttrTransformIds {
+        tx: attrdb.create_attr_static(1.0),
+        ty: attrdb.create_attr_static(2.0),
+        tz: attrdb.create_attr_static(3.0),
+        rx: attrdb.create_attr_static(10.0),
+        ry: attrdb.create_attr_static(20.0),
+        rz: attrdb.create_attr_static(30.0),
+        sx: attrdb.create_attr_static(2.0),
+        sy: attrdb.create_attr_static(2.0),
+        sz: attrdb.create_attr_static(2.0),
+    });
+    rotate_order_list.push(RotateOrder::XYZ);
+    transform_parents.push(Some(3));
+
+    let mut serial_matrix_list = Vec::new();
+    compute_world_matrices_with_attrs(
+        &attrdb,
+        &tfm_attr_list,
+        &rotate_order_list,
+        &transform_parents,
+        &frame_list,
+        &mut serial_matrix_list,
+    );
+    assert_eq!(serial_matrix_list.len(), tfm_attr_list.len() * num_frames);
+
+    // Grain sizes that divide the frames evenly, unevenly, and are
+    // larger than the number of frames (using the serial function).
+    let mut scratch_matrix_list = Vec::new();
+    for grain_size in [0, 1, 7, 64, 1000] {
+        let mut parallel_matrix_list = Vec::new();
+        compute_world_matrices_with_attrs_frame_parallel(
+            &attrdb,
+            &tfm_attr_list,
+            &rotate_order_list,
+            &transform_parents,
+            &frame_list,
+            grain_size,
+            &mut scratch_matrix_list,
+            &mut parallel_matrix_list,
+        );
+        assert_eq!(parallel_matrix_list, serial_matrix_list);
+    }
+}
@@ -0,0 +1,205 @@
+//
+// Copyright (C) 2020, 2021 David Cattermole.
+//
+// This file is part of mmSolver.
+//
+// mmSolver is free software: you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// mmSolver is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+// ====================================================================
+//
+
+use approx::assert_relative_eq;
+
+use mmscenegraph_rust::attr::datablock::AttrDataBlock;
+use mmscenegraph_rust::attr::AttrId;
+use mmscenegraph_rust::constant::FrameValue;
+use mmscenegraph_rust::math::camera::FilmFit;
+use mmscenegraph_rust::math::rotate::euler::RotateOrder;
+use mmscenegraph_rust::node::traits::NodeCanRotate3D;
+use mmscenegraph_rust::node::traits::NodeCanTranslate2D;
+use mmscenegraph_rust::node::traits::NodeCanTranslate3D;
+use mmscenegraph_rust::node::traits::NodeCanViewScene;
+use mmscenegraph_rust::node::traits::NodeHasId;
+use mmscenegraph_rust::node::NodeId;
+use mmscenegraph_rust::scene::bake::bake_scene_graph;
+use mmscenegraph_rust::scene::evaluationobjects::EvaluationObjects;
+use mmscenegraph_rust::scene::flat::FlatScene;
+use mmscenegraph_rust::scene::graph::SceneGraph;
+use mmscenegraph_rust::scene::helper::create_static_bundle;
+use mmscenegraph_rust::scene::helper::create_static_camera;
+use mmscenegraph_rust::scene::helper::create_static_marker;
+use mmscenegraph_rust::scene::helper::create_static_transform;
+
+fn assert_same_values(flat_scene_a: &FlatScene, flat_scene_b: &FlatScene) {
+    let points_a = flat_scene_a.points();
+    let points_b = flat_scene_b.points();
+    let markers_a = flat_scene_a.markers();
+    let markers_b = flat_scene_b.markers();
+    assert_eq!(points_a.len(), points_b.len());
+    assert_eq!(markers_a.len(), markers_b.len());
+    for (a, b) in points_a.iter().zip(points_b.iter()) {
+        assert_relative_eq!(*a, *b, epsilon = 1.0e-12);
+    }
+    for (a, b) in markers_a.iter().zip(markers_b.iter()) {
+        assert_relative_eq!(*a, *b, epsilon = 1.0e-12);
+    }
+}
+
+#[test]
+fn evaluate_dirty_scene() {
+    let mut sg = SceneGraph::new();
+    let mut attrdb = AttrDataBlock::new();
+
+    let frame_list: Vec<FrameValue> = vec![1001, 1002, 1003, 1004];
+    let rotate_order = RotateOrder::XYZ;
+
+    // A group with a static bundle and an animated bundle below it.
+    let group = create_static_transform(
+        &mut sg,
+        &mut attrdb,
+        (0.0, 1.0, 0.0),
+        (0.0, 15.0, 0.0),
+        (1.0, 1.0, 1.0),
+        rotate_order,
+    );
+    let bnd_0 = create_static_bundle(
+        &mut sg,
+        &mut attrdb,
+        (1.0, 0.0, 0.0),
+        (0.0, 0.0, 0.0),
+        (1.0, 1.0, 1.0),
+        rotate_order,
+    );
+    let bnd_1_tx = attrdb
+        .create_attr_anim_dense(vec![-1.0, -0.5, 0.0, 0.5], frame_list[0]);
+    let bnd_1 = sg.create_bundle_node(
+        (
+            bnd_1_tx,
+            attrdb.create_attr_static(0.5),
+            attrdb.create_attr_static(-1.0),
+        ),
+        (
+            attrdb.create_attr_static(0.0),
+            attrdb.create_attr_static(0.0),
+            attrdb.create_attr_static(0.0),
+        ),
+        (
+            attrdb.create_attr_static(1.0),
+            attrdb.create_attr_static(1.0),
+            attrdb.create_attr_static(1.0),
+        ),
+        rotate_order,
+    );
+    sg.set_node_parent(group.get_id(), NodeId::Root);
+    sg.set_node_parent(bnd_0.get_id(), group.get_id());
+    sg.set_node_parent(bnd_1.get_id(), group.get_id());
+
+    let cam_0 = create_static_camera(
+        &mut sg,
+        &mut attrdb,
+        (-9.0, 8.5, 15.0),
+        (-10.0, -38.0, 0.0),
+        (1.0, 1.0, 1.0),
+        (36.0, 24.0),
+        40.0,
+        (0.0, 0.0),
+        1.0,
+        10000.0,
+        1.0,
+        RotateOrder::ZXY,
+        FilmFit::Horizontal,
+        2048,
+        1556,
+    );
+    let cam_1 = create_static_camera(
+        &mut sg,
+        &mut attrdb,
+        (9.0, 8.5, 15.0),
+        (-10.0, 38.0, 0.0),
+        (1.0, 1.0, 1.0),
+        (36.0, 24.0),
+        35.0,
+        (0.0, 0.0),
+        1.0,
+        10000.0,
+        1.0,
+        RotateOrder::ZXY,
+        FilmFit::Fill,
+        1920,
+        1080,
+    );
+
+    // Markers are not grouped by camera.
+    let mkr_0 = create_static_marker(&mut sg, &mut attrdb, (-0.5, -0.5), 1.0);
+    let mkr_1 = create_static_marker(&mut sg, &mut attrdb, (0.5, -0.5), 1.0);
+    let mkr_2 = create_static_marker(&mut sg, &mut attrdb, (0.5, 0.5), 1.0);
+    let mkr_3 = create_static_marker(&mut sg, &mut attrdb, (-0.5, 0.5), 1.0);
+    sg.link_marker_to_camera(mkr_0.get_id(), cam_0.get_id());
+    sg.link_marker_to_camera(mkr_1.get_id(), cam_1.get_id());
+    sg.link_marker_to_camera(mkr_2.get_id(), cam_0.get_id());
+    sg.link_marker_to_camera(mkr_3.get_id(), cam_1.get_id());
+    sg.link_marker_to_bundle(mkr_0.get_id(), bnd_0.get_id());
+    sg.link_marker_to_bundle(mkr_1.get_id(), bnd_0.get_id());
+    sg.link_marker_to_bundle(mkr_2.get_id(), bnd_1.get_id());
+    sg.link_marker_to_bundle(mkr_3.get_id(), bnd_1.get_id());
+
+    let group_ry = group.get_attr_ry();
+    let bnd_0_tz = bnd_0.get_attr_tz();
+    let cam_1_focal = cam_1.get_attr_focal_length();
+    let mkr_2_tx = mkr_2.get_attr_tx();
+
+    let mut eval_objects = EvaluationObjects::new();
+    eval_objects.add_marker(mkr_0);
+    eval_objects.add_marker(mkr_1);
+    eval_objects.add_marker(mkr_2);
+    eval_objects.add_marker(mkr_3);
+    eval_objects.add_bundle(bnd_0);
+    eval_objects.add_bundle(bnd_1);
+    eval_objects.add_camera(cam_0);
+    eval_objects.add_camera(cam_1);
+
+    let mut flat_scene = bake_scene_graph(&sg, &eval_objects);
+    flat_scene.evaluate(&attrdb, &frame_list);
+    assert_eq!(flat_scene.num_points(), 4 * frame_list.len());
+
+    // Change attributes one at a time, evaluating only the dirty
+    // values, and compare with a full evaluation.
+    let changes: Vec<(AttrId, FrameValue, f64)> = vec![
+        (bnd_1_tx, 1003, 2.0),
+        (bnd_0_tz, 0, 0.25),
+        (group_ry, 0, 30.0),
+        (cam_1_focal, 0, 50.0),
+        (mkr_2_tx, 0, 0.1),
+        (bnd_1_tx, 1001, 0.0),
+    ];
+    for (attr_id, frame, value) in changes {
+        attrdb.set_attr_value(attr_id, frame, value);
+        flat_scene.evaluate_dirty(&attrdb, &frame_list, &[attr_id], &[frame]);
+
+        let mut flat_scene_full = bake_scene_graph(&sg, &eval_objects);
+        flat_scene_full.evaluate(&attrdb, &frame_list);
+        assert_same_values(&flat_scene, &flat_scene_full);
+    }
+
+    // Nothing has changed.
+    let flat_scene_before = flat_scene.clone();
+    flat_scene.evaluate_dirty(&attrdb, &frame_list, &[], &[]);
+    assert_same_values(&flat_scene, &flat_scene_before);
+
+    // A different frame list evaluates everything.
+    let frame_list_short: Vec<FrameValue> = vec![1002, 1003];
+    flat_scene.evaluate_dirty(&attrdb, &frame_list_short, &[], &[]);
+    let mut flat_scene_full = bake_scene_graph(&sg, &eval_objects);
+    flat_scene_full.evaluate(&attrdb, &frame_list_short);
+    assert_same_values(&flat_scene, &flat_scene_full);
+}
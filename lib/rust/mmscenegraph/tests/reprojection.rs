@@ -26,7 +26,9 @@ use nalgebra as na;
 use mmscenegraph_rust::constant::Real;
 use mmscenegraph_rust::math::camera::get_projection_matrix;
 use mmscenegraph_rust::math::camera::FilmFit;
+use mmscenegraph_rust::math::reprojection::compute_camera_world_projection_matrix;
 use mmscenegraph_rust::math::reprojection::reproject_as_normalised_coord;
+use mmscenegraph_rust::math::reprojection::reproject_as_normalised_coord_batch;
 use mmscenegraph_rust::math::rotate::euler::RotateOrder;
 use mmscenegraph_rust::math::transform::calculate_matrix;
 use mmscenegraph_rust::math::transform::multiply;
@@ -194,3 +196,67 @@ fn two_bundles_under_group() {
     assert_relative_eq!(screen_point_b.x, 0.2150060, epsilon = EPSILON);
     assert_relative_eq!(screen_point_b.y, -0.071858, epsilon = EPSILON);
 }
+
+#[test]
+fn batch_points_match_single_points() {
+    let roo_zxy = RotateOrder::ZXY;
+    let camera_transform =
+        Transform::from_txyz_rxyz(0.0, 5.0, 10.0, -10.0, 5.0, 2.0, roo_zxy);
+    let camera_transform_matrix = calculate_matrix(&camera_transform);
+    let camera_projection_matrix = get_projection_matrix(
+        35.0,
+        36.0 / 25.4,
+        24.0 / 25.4,
+        0.1,
+        -0.05,
+        2048.0,
+        1556.0,
+        FilmFit::Horizontal,
+        0.1,
+        10000.0,
+        1.0,
+    );
+    let camera_world_proj_matrix = compute_camera_world_projection_matrix(
+        camera_transform_matrix,
+        camera_projection_matrix,
+    );
+
+    // Odd counts test the points left over after the vector lanes.
+    for count in [0, 1, 3, 4, 7, 16, 101] {
+        let mut point_x = Vec::new();
+        let mut point_y = Vec::new();
+        let mut point_z = Vec::new();
+        for i in 0..count {
+            let i = i as Real;
+            point_x.push((i * 0.37) - 5.0);
+            point_y.push((i * -0.11) + 1.0);
+            point_z.push((i * -0.05) - 3.0);
+        }
+        let mut out_x = vec![0.0; count];
+        let mut out_y = vec![0.0; count];
+        reproject_as_normalised_coord_batch(
+            &camera_world_proj_matrix,
+            &point_x,
+            &point_y,
+            &point_z,
+            &mut out_x,
+            &mut out_y,
+        );
+
+        for i in 0..count {
+            let point = na::Matrix4::<Real>::new(
+                1.0, 0.0, 0.0, point_x[i], //
+                0.0, 1.0, 0.0, point_y[i], //
+                0.0, 0.0, 1.0, point_z[i], //
+                0.0, 0.0, 0.0, 1.0, //
+            );
+            let screen_point = reproject_as_normalised_coord(
+                camera_transform_matrix,
+                camera_projection_matrix,
+                point,
+            );
+            assert_relative_eq!(out_x[i], screen_point.x, epsilon = 1.0e-12);
+            assert_relative_eq!(out_y[i], screen_point.y, epsilon = 1.0e-12);
+        }
+    }
+}
@@ -145,12 +145,14 @@ SOLVER_TYPE_CMINPACK_LM = 1
 SOLVER_TYPE_CMINPACK_LMDIF = 1
 SOLVER_TYPE_CMINPACK_LMDER = 2
 SOLVER_TYPE_CERES = 3
+SOLVER_TYPE_CMINPACK_LMSTR = 4
 SOLVER_TYPE_DEFAULT = SOLVER_TYPE_CMINPACK_LMDER
 SOLVER_TYPE_LIST = [
     # levmar is not included in this list because it is deprecated.
     SOLVER_TYPE_CMINPACK_LMDIF,
     SOLVER_TYPE_CMINPACK_LMDER,
     SOLVER_TYPE_CERES,
+    SOLVER_TYPE_CMINPACK_LMSTR,
 ]
 
 
@@ -157,6 +157,7 @@ from mmSolver._api.constant import (
     SOLVER_TYPE_CMINPACK_LMDIF,
     SOLVER_TYPE_CMINPACK_LMDER,
     SOLVER_TYPE_CERES,
+    SOLVER_TYPE_CMINPACK_LMSTR,
     SOLVER_TYPE_DEFAULT,
     SOLVER_TYPE_LIST,
     SCENE_GRAPH_MODE_AUTO,
@@ -308,6 +309,7 @@ __all__ = [
     'SOLVER_TYPE_CMINPACK_LMDIF',
     'SOLVER_TYPE_CMINPACK_LMDER',
     'SOLVER_TYPE_CERES',
+    'SOLVER_TYPE_CMINPACK_LMSTR',
     'SOLVER_TYPE_DEFAULT',
     'SOLVER_TYPE_LIST',
     'SCENE_GRAPH_MODE_AUTO',
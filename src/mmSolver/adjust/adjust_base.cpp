@@ -26,12 +26,15 @@
 
 // STL
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
 #include <limits>
 #include <map>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Maya
@@ -58,10 +61,13 @@
 // MM Solver
 #include "adjust_cminpack_lmder.h"
 #include "adjust_cminpack_lmdif.h"
+#include "adjust_cminpack_lmstr.h"
 #include "adjust_measureErrors.h"
 #include "adjust_relationships.h"
 #include "adjust_results.h"
+#include "adjust_setParameters.h"
 #include "adjust_solveFunc.h"
+#include "adjust_sparseJacobian.h"
 #include "mmSolver/mayahelper/maya_attr.h"
 #include "mmSolver/mayahelper/maya_camera.h"
 #include "mmSolver/mayahelper/maya_lens_model_utils.h"
@@ -89,6 +95,10 @@ std::vector<SolverTypePair> getSolverTypes() {
     solverType.second = SOLVER_TYPE_CMINPACK_LM_DER_NAME;
     solverTypes.push_back(solverType);
 
+    solverType.first = SOLVER_TYPE_CMINPACK_LMSTR;
+    solverType.second = SOLVER_TYPE_CMINPACK_LM_STR_NAME;
+    solverTypes.push_back(solverType);
+
     return solverTypes;
 }
 
@@ -120,6 +130,7 @@ SolverTypePair getSolverTypeDefault() {
                 << "Value may be "
                 << "\"cminpack_lm\", "
                 << "\"cminpack_lmder\", "
+                << "\"cminpack_lmstr\", "
                 << "or \"ceres\"; "
                 << "; value=" << defaultSolver);
         }
@@ -723,8 +734,7 @@ MStatus solveFrames(
     const MGlobal::MMayaState &mayaSessionState, MDGModifier &out_dgmod,
     MAnimCurveChange &out_curveChange, MComputation &out_computation,
     //
-    std::vector<double> &out_jacobianList, IndexPairList &out_paramToAttrList,
-    IndexPairList &out_errorToMarkerList,
+    IndexPairList &out_paramToAttrList, IndexPairList &out_errorToMarkerList,
     std::vector<MPoint> &out_markerPosList,
     std::vector<double> &out_markerWeightList,
     std::vector<double> &out_errorList, std::vector<double> &out_paramList,
@@ -743,7 +753,6 @@ MStatus solveFrames(
     out_errorList.clear();
     out_paramList.clear();
     out_previousParamList.clear();
-    out_jacobianList.clear();
 
     int numberOfErrors = 0;
     int numberOfMarkerErrors = 0;
@@ -770,14 +779,13 @@ MStatus solveFrames(
     auto paramLowerBoundList = std::vector<double>();
     auto paramUpperBoundList = std::vector<double>();
     auto paramWeightList = std::vector<double>();
-    auto paramFrameList = BoolList2D();
     numberOfParameters = countUpNumberOfUnknownParameters(
         usedAttrList, frameList,
 
         // Outputs
         camStaticAttrList, camAnimAttrList, staticAttrList, animAttrList,
         paramLowerBoundList, paramUpperBoundList, paramWeightList,
-        out_paramToAttrList, paramFrameList, status);
+        out_paramToAttrList, status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
     assert(paramLowerBoundList.size() ==
            static_cast<size_t>(numberOfParameters));
@@ -788,7 +796,7 @@ MStatus solveFrames(
 
     // Expand the 'Marker to Attribute' relationship into errors and
     // parameter relationships.
-    auto errorToParamList = BoolList2D();
+    auto errorToParamList = ErrorToParamIndex();
     findErrorToParameterRelationship(usedMarkerList, usedAttrList, frameList,
 
                                      numberOfParameters, numberOfMarkerErrors,
@@ -888,7 +896,6 @@ MStatus solveFrames(
     out_paramList.resize((uint64_t)numberOfParameters, 0);
     out_previousParamList.resize((uint64_t)numberOfParameters, 0);
     out_errorList.resize((uint64_t)numberOfErrors, 0);
-    out_jacobianList.resize((uint64_t)numberOfParameters * numberOfErrors, 0);
 
     auto errorDistanceList = std::vector<double>();
     errorDistanceList.resize((uint64_t)numberOfMarkerErrors / ERRORS_PER_MARKER,
@@ -997,13 +1004,14 @@ MStatus solveFrames(
     }
 
 #if MMSOLVER_LENS_DISTORTION == 1
-    std::vector<std::shared_ptr<mmlens::LensModel>> markerFrameToLensModelList;
-    std::vector<std::shared_ptr<mmlens::LensModel>> attrFrameToLensModelList;
+    std::vector<int32_t> markerFrameToLensModelIndexList;
+    std::vector<int32_t> attrFrameToLensModelIndexList;
     std::vector<std::shared_ptr<mmlens::LensModel>> lensModelList;
 
     status = mmsolver::constructLensModelList(
         cameraList, usedMarkerList, usedAttrList, frameList,
-        markerFrameToLensModelList, attrFrameToLensModelList, lensModelList);
+        markerFrameToLensModelIndexList, attrFrameToLensModelIndexList,
+        lensModelList);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 #endif
 
@@ -1021,8 +1029,9 @@ MStatus solveFrames(
     userData.stiffAttrsList = stiffAttrsList;
 
 #if MMSOLVER_LENS_DISTORTION == 1
-    userData.markerFrameToLensModelList = markerFrameToLensModelList;
-    userData.attrFrameToLensModelList = attrFrameToLensModelList;
+    userData.markerFrameToLensModelIndexList =
+        markerFrameToLensModelIndexList;
+    userData.attrFrameToLensModelIndexList = attrFrameToLensModelIndexList;
     userData.lensModelList = lensModelList;
 #endif
 
@@ -1036,17 +1045,27 @@ MStatus solveFrames(
     userData.mmsgAttrIdList = std::move(mmsgAttrIdList);
 
     userData.paramToAttrList = out_paramToAttrList;
+    if (solverOptions.sceneGraphMode == SceneGraphMode::kMMSceneGraph) {
+        constructSceneGraphParameterList(userData);
+    }
     userData.errorToMarkerList = out_errorToMarkerList;
     userData.markerPosList = out_markerPosList;
     userData.markerWeightList = out_markerWeightList;
-    userData.paramFrameList = paramFrameList;
     userData.errorToParamList = errorToParamList;
 
     userData.paramList = out_paramList;
     userData.previousParamList = out_previousParamList;
     userData.errorList = out_errorList;
     userData.errorDistanceList = errorDistanceList;
-    userData.jacobianList = out_jacobianList;
+    constructSparseJacobianStructure(
+        numberOfParameters, numberOfErrors, numberOfMarkerErrors,
+        numberOfAttrStiffnessErrors, numberOfAttrSmoothnessErrors,
+        out_paramToAttrList, errorToParamList, stiffAttrsList, smoothAttrsList,
+        userData.jacobian);
+    MMSOLVER_MAYA_VRB("Jacobian non-zero entries: "
+                      << userData.jacobian.numberOfNonZeros() << " of "
+                      << (static_cast<uint64_t>(numberOfParameters) *
+                          numberOfErrors));
     userData.funcEvalNum = 0;  // number of function evaluations.
     userData.iterNum = 0;
     userData.jacIterNum = 0;
@@ -1075,6 +1094,12 @@ MStatus solveFrames(
 
     userData.logLevel = logLevel;
 
+    status = undistortMarkerPositions(&userData);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    if (userData.markerPositionsUndistorted) {
+        MMSOLVER_MAYA_VRB("Marker positions are undistorted before solving.");
+    }
+
     // Calculate initial errors.
     double initialErrorAvg = 0.0;
     double initialErrorMin = std::numeric_limits<double>::max();
@@ -1183,6 +1208,11 @@ MStatus solveFrames(
                                 numberOfErrors, out_paramList, out_errorList,
                                 paramWeightList, userData,
                                 out_cmdResult.solverResult);
+    } else if (solverOptions.solverType == SOLVER_TYPE_CMINPACK_LMSTR) {
+        solve_3d_cminpack_lmstr(solverOptions, numberOfParameters,
+                                numberOfErrors, out_paramList, out_errorList,
+                                paramWeightList, userData,
+                                out_cmdResult.solverResult);
     } else {
         MMSOLVER_MAYA_ERR(
             "Solver Type is invalid. solverType=" << solverOptions.solverType);
@@ -1288,6 +1318,578 @@ MStatus solveFrames(
     return status;
 }
 
+// A single frame of a per-frame solve.
+//
+// The frame is prepared, and the results are set in Maya, on the
+// main thread, but the frame may be solved on any thread.
+struct FrameSolveData {
+    int numberOfParameters;
+    int numberOfErrors;
+    bool solved;
+    bool errorIsBetter;
+    MStatus status;
+    // The step that failed when 'status' is not successful.
+    const char *failedStep;
+    mmsolver::debug::Timestamp solveEndTimestamp;
+
+    IndexPairList paramToAttrList;
+    std::vector<double> paramWeightList;
+    std::vector<double> paramList;
+    std::vector<double> previousParamList;
+    std::vector<double> errorList;
+
+    SolverData userData;
+    CommandResult cmdResult;
+
+    FrameSolveData()
+        : numberOfParameters(0)
+        , numberOfErrors(0)
+        , solved(false)
+        , errorIsBetter(true)
+        , status(MS::kSuccess)
+        , failedStep("")
+        , solveEndTimestamp(0) {}
+};
+
+// Can each frame of a per-frame solve be solved independently of
+// the other frames?
+//
+// When only animated attributes are solved each frame has its own
+// parameters, so the frames do not depend on each other. Static
+// attributes are shared by all frames, so each frame must start from
+// the previous frame's result. Only the MM Scene Graph can be
+// evaluated off the main thread, and lens, stiffness and smoothness
+// attributes are shared with (or read from) Maya.
+bool canSolveFramesIndependently(const SolverOptions &solverOptions,
+                                 const PrintStatOptions &printStats,
+                                 const MTimeArray &frameList,
+                                 const MarkerPtrList &usedMarkerList,
+                                 const AttrPtrList &usedAttrList,
+                                 const StiffAttrsPtrList &stiffAttrsList,
+                                 const SmoothAttrsPtrList &smoothAttrsList) {
+    if (solverOptions.sceneGraphMode != SceneGraphMode::kMMSceneGraph) {
+        return false;
+    }
+    if (printStats.doNotSolve || (frameList.length() < 2)) {
+        return false;
+    }
+    if (usedMarkerList.empty() || usedAttrList.empty()) {
+        return false;
+    }
+    if (!stiffAttrsList.empty() || !smoothAttrsList.empty()) {
+        return false;
+    }
+    for (const AttrPtr &attr : usedAttrList) {
+        if (attr->getObjectType() == ObjectType::kLens) {
+            return false;
+        }
+        if (!attr->isAnimated()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int calculateFrameThreadCount(const int frameCount,
+                              const SolverOptions &solverOptions) {
+    int threadCount = solverOptions.frameThreadCount;
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    threadCount = std::min(threadCount, frameCount);
+    return std::max(threadCount, 1);
+}
+
+// Solve a single frame prepared by 'solveFramesIndependently', using
+// the MM Scene Graph copy of 'worker'.
+//
+// The Maya API is only used when 'computation' is given, so this may
+// be called on any thread when 'computation' is null.
+void solveFrameWithWorker(FrameSolveData &frame, SceneGraphWorkerData &worker,
+                          MComputation *computation) {
+    SolverData &userData = frame.userData;
+    SolverResult &solverResult = frame.cmdResult.solverResult;
+    SolverOptions &solverOptions = *userData.solverOptions;
+    const int numberOfParameters = frame.numberOfParameters;
+    const int numberOfErrors = frame.numberOfErrors;
+    const int numberOfMarkerErrors = userData.numberOfMarkerErrors;
+
+    // Each frame only changes the attribute values of its own frame,
+    // so a single copy of the scene can solve many frames.
+    userData.mmsgAttrDataBlock = std::move(worker.attrDataBlock);
+    userData.mmsgFlatScene = std::move(worker.flatScene);
+    userData.computation = computation;
+    frame.status = undistortMarkerPositions(&userData);
+    if (frame.status != MS::kSuccess) {
+        frame.failedStep = "undistort marker positions";
+    }
+
+    SolverTimer &timer = userData.timer;
+    timer.startTimestamp = mmsolver::debug::get_timestamp();
+    timer.solveBenchTimer.start();
+    timer.solveBenchTicks.start();
+
+    double initialErrorAvg = 0.0;
+    double initialErrorMin = 0.0;
+    double initialErrorMax = 0.0;
+    if (solverOptions.acceptOnlyBetter) {
+        MStatus status;
+        std::vector<bool> frameIndexEnable(1, 1);
+        std::vector<bool> skipErrorMeasurements(numberOfErrors, 1);
+        measureErrors(numberOfErrors, numberOfMarkerErrors,
+                      userData.numberOfAttrStiffnessErrors,
+                      userData.numberOfAttrSmoothnessErrors, frameIndexEnable,
+                      skipErrorMeasurements, solverOptions.imageWidth,
+                      &frame.errorList[0], &userData, initialErrorAvg,
+                      initialErrorMax, initialErrorMin, status);
+        compute_error_stats(numberOfMarkerErrors, userData.errorDistanceList,
+                            initialErrorAvg, initialErrorMin,
+                            initialErrorMax);
+    }
+
+    solverResult.success = true;
+    solverResult.reason_number = 0;
+    solverResult.reason = "";
+    solverResult.iterations = 0;
+    solverResult.functionEvals = 0;
+    solverResult.jacobianEvals = 0;
+    solverResult.errorFinal = 0.0;
+    solverResult.errorAvg = initialErrorAvg;
+    solverResult.errorMin = initialErrorMin;
+    solverResult.errorMax = initialErrorMax;
+
+    if (solverOptions.solverType == SOLVER_TYPE_CMINPACK_LMDIF) {
+        solve_3d_cminpack_lmdif(solverOptions, numberOfParameters,
+                                numberOfErrors, frame.paramList,
+                                frame.errorList, frame.paramWeightList,
+                                userData, solverResult);
+    } else if (solverOptions.solverType == SOLVER_TYPE_CMINPACK_LMDER) {
+        solve_3d_cminpack_lmder(solverOptions, numberOfParameters,
+                                numberOfErrors, frame.paramList,
+                                frame.errorList, frame.paramWeightList,
+                                userData, solverResult);
+    } else if (solverOptions.solverType == SOLVER_TYPE_CMINPACK_LMSTR) {
+        solve_3d_cminpack_lmstr(solverOptions, numberOfParameters,
+                                numberOfErrors, frame.paramList,
+                                frame.errorList, frame.paramWeightList,
+                                userData, solverResult);
+    } else {
+        solverResult.success = false;
+        frame.status = MS::kFailure;
+        frame.failedStep = "solver type is invalid";
+    }
+
+    timer.solveBenchTimer.stop();
+    timer.solveBenchTicks.stop();
+    frame.solveEndTimestamp = mmsolver::debug::get_timestamp();
+
+    if (frame.status == MS::kSuccess) {
+        double errorAvg = 0;
+        double errorMin = 0;
+        double errorMax = 0;
+        compute_error_stats(numberOfMarkerErrors, userData.errorDistanceList,
+                            errorAvg, errorMin, errorMax);
+        solverResult.errorAvg = errorAvg;
+        solverResult.errorMin = errorMin;
+        solverResult.errorMax = errorMax;
+        if (solverOptions.acceptOnlyBetter) {
+            frame.errorIsBetter = errorAvg <= initialErrorAvg;
+        }
+    }
+
+    userData.computation = nullptr;
+    worker.attrDataBlock = std::move(userData.mmsgAttrDataBlock);
+    worker.flatScene = std::move(userData.mmsgFlatScene);
+    frame.solved = true;
+}
+
+// Solve each frame of 'frameList' as a separate problem, with
+// 'solverOptions.frameThreadCount' threads.
+//
+// The results are the same as calling 'solveFrames' for each frame,
+// but the MM Scene Graph and lens models are constructed once for
+// all frames, each thread evaluates its own copy of the scene, and
+// the solved values are set in Maya after all frames are solved.
+//
+// 'canSolveFramesIndependently' must be true.
+MStatus solveFramesIndependently(
+    CameraPtrList &cameraList, BundlePtrList &bundleList,
+    const MTimeArray &frameList, MarkerPtrList &usedMarkerList,
+    AttrPtrList &usedAttrList, const StiffAttrsPtrList &stiffAttrsList,
+    const SmoothAttrsPtrList &smoothAttrsList,
+    const BoolList2D &markerToAttrList, SolverOptions &solverOptions,
+    //
+    const MGlobal::MMayaState &mayaSessionState, MDGModifier &out_dgmod,
+    MAnimCurveChange &out_curveChange, MComputation &out_computation,
+    //
+    const LogLevel &logLevel, CommandResult &out_cmdResult) {
+    MStatus status = MS::kSuccess;
+    const bool verbose = logLevel >= LogLevel::kDebug;
+    const int frameCount = static_cast<int>(frameList.length());
+    const int threadCount =
+        calculateFrameThreadCount(frameCount, solverOptions);
+    MMSOLVER_MAYA_VRB("Solving " << frameCount << " frames with "
+                                 << threadCount << " threads.");
+
+    // Frames are already solved concurrently, so the Jacobian is
+    // calculated on the frame's thread.
+    SolverOptions frameSolverOptions = solverOptions;
+    if (threadCount > 1) {
+        frameSolverOptions.jacobianThreadCount = 1;
+    }
+
+    // Only print the details of each frame once all frames are
+    // solved, rather than mixing the output of many threads.
+    LogLevel frameLogLevel = logLevel;
+    if ((threadCount > 1) && (frameLogLevel > LogLevel::kInfo)) {
+        frameLogLevel = LogLevel::kInfo;
+    }
+
+    // Shared by all frames.
+    auto mmsgFrameList = std::vector<mmsg::FrameValue>();
+    auto mmsgSceneGraph = mmsg::SceneGraph();
+    auto mmsgAttrDataBlock = mmsg::AttrDataBlock();
+    auto mmsgFlatScene = mmsg::FlatScene();
+    auto mmsgCameraNodes = std::vector<mmsg::CameraNode>();
+    auto mmsgBundleNodes = std::vector<mmsg::BundleNode>();
+    auto mmsgMarkerNodes = std::vector<mmsg::MarkerNode>();
+    auto mmsgAttrIdList = std::vector<mmsg::AttrId>();
+    status = construct_scene_graph(
+        cameraList, usedMarkerList, bundleList, usedAttrList, frameList,
+        solverOptions.timeEvalMode, mmsgSceneGraph, mmsgAttrDataBlock,
+        mmsgFlatScene, mmsgFrameList, mmsgCameraNodes, mmsgBundleNodes,
+        mmsgMarkerNodes, mmsgAttrIdList);
+    if (status != MS::kSuccess) {
+        CHECK_MSTATUS(status);
+        MMSOLVER_MAYA_ERR("Maya DAG is invalid for use with MM Scene Graph, "
+                          << "please switch to Maya DAG and solve again.");
+        out_cmdResult.solverResult.success = false;
+        return status;
+    }
+
+#if MMSOLVER_LENS_DISTORTION == 1
+    std::vector<int32_t> markerFrameToLensModelIndexList;
+    std::vector<int32_t> attrFrameToLensModelIndexList;
+    std::vector<std::shared_ptr<mmlens::LensModel>> lensModelList;
+    status = mmsolver::constructLensModelList(
+        cameraList, usedMarkerList, usedAttrList, frameList,
+        markerFrameToLensModelIndexList, attrFrameToLensModelIndexList,
+        lensModelList);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
+#if MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
+    // Lens models compute cached values on first use; do that now,
+    // so the threads only read the lens models.
+    for (auto &lensModel : lensModelList) {
+        if (lensModel) {
+            double out_x = 0.0;
+            double out_y = 0.0;
+            lensModel->applyModelDistort(0.0, 0.0, out_x, out_y);
+        }
+    }
+#endif
+#endif
+
+    // Prepare each frame. This queries Maya, so it is done on the
+    // main thread, and stops at the first frame that cannot be
+    // solved, the same as solving one frame after another.
+    std::atomic<bool> cancelRequested(false);
+    std::vector<std::unique_ptr<FrameSolveData>> frameSolveList;
+    frameSolveList.reserve(frameCount);
+    bool prepareFailed = false;
+    for (int i = 0; i < frameCount; ++i) {
+        auto frame = std::unique_ptr<FrameSolveData>(new FrameSolveData());
+        frame->cmdResult.printStats = out_cmdResult.printStats;
+        SolverData &userData = frame->userData;
+        const MTimeArray frames(1, frameList[i]);
+
+        int numberOfMarkerErrors = 0;
+        int numberOfAttrStiffnessErrors = 0;
+        int numberOfAttrSmoothnessErrors = 0;
+        auto validMarkerList = MarkerPtrList();
+        auto errorToMarkerList = IndexPairList();
+        auto markerPosList = std::vector<MPoint>();
+        auto markerWeightList = std::vector<double>();
+        frame->numberOfErrors = countUpNumberOfErrors(
+            usedMarkerList, stiffAttrsList, smoothAttrsList, frames,
+            validMarkerList, markerPosList, markerWeightList,
+            errorToMarkerList, numberOfMarkerErrors,
+            numberOfAttrStiffnessErrors, numberOfAttrSmoothnessErrors, status);
+        CHECK_MSTATUS(status);
+
+        if (status == MS::kSuccess) {
+            auto camStaticAttrList = AttrPtrList();
+            auto camAnimAttrList = AttrPtrList();
+            auto staticAttrList = AttrPtrList();
+            auto animAttrList = AttrPtrList();
+            auto paramLowerBoundList = std::vector<double>();
+            auto paramUpperBoundList = std::vector<double>();
+            frame->numberOfParameters = countUpNumberOfUnknownParameters(
+                usedAttrList, frames, camStaticAttrList, camAnimAttrList,
+                staticAttrList, animAttrList, paramLowerBoundList,
+                paramUpperBoundList, frame->paramWeightList,
+                frame->paramToAttrList, status);
+            CHECK_MSTATUS(status);
+        }
+
+        const int numberOfParameters = frame->numberOfParameters;
+        const int numberOfErrors = frame->numberOfErrors;
+        auto errorToParamList = ErrorToParamIndex();
+        if (status == MS::kSuccess) {
+            findErrorToParameterRelationship(
+                usedMarkerList, usedAttrList, frames, numberOfParameters,
+                numberOfMarkerErrors, frame->paramToAttrList,
+                errorToMarkerList, markerToAttrList, errorToParamList,
+                status);
+            CHECK_MSTATUS(status);
+        }
+        if ((status == MS::kSuccess) &&
+            ((numberOfMarkerErrors == 0) ||
+             (numberOfParameters > numberOfErrors))) {
+            MMSOLVER_MAYA_ERR(
+                "Solver failure; cannot solve for more attributes "
+                << "(\"parameters\") than number of markers (\"errors\"). "
+                << "parameters=" << numberOfParameters << " "
+                << "errors=" << numberOfErrors);
+            status = MS::kFailure;
+        }
+
+        frame->paramList.resize(numberOfParameters, 0);
+        frame->previousParamList.resize(numberOfParameters, 0);
+        frame->errorList.resize(numberOfErrors, 0);
+        if (status == MS::kSuccess) {
+            const bool initial_ok = get_initial_parameters(
+                numberOfParameters, frame->previousParamList,
+                frame->paramToAttrList, usedAttrList, frames,
+                frame->cmdResult.solverResult);
+            if (!initial_ok) {
+                MMSOLVER_MAYA_ERR("Failed to get initial parameters.");
+                status = MS::kFailure;
+            }
+        }
+
+        if (status != MS::kSuccess) {
+            auto frameNumber = frameList[i].asUnits(MTime::uiUnit());
+            MMSOLVER_MAYA_ERR("Failed to solve frame "
+                              << frameNumber << ", stopping solve.");
+            out_cmdResult.solverResult.success = false;
+            prepareFailed = true;
+            break;
+        }
+        frame->paramList = frame->previousParamList;
+
+        userData.cameraList = cameraList;
+        userData.markerList = usedMarkerList;
+        userData.bundleList = bundleList;
+        userData.attrList = usedAttrList;
+        userData.frameList = frames;
+        userData.smoothAttrsList = smoothAttrsList;
+        userData.stiffAttrsList = stiffAttrsList;
+
+#if MMSOLVER_LENS_DISTORTION == 1
+        // The lens models of this frame only.
+        const size_t numberOfMarkers = usedMarkerList.size();
+        userData.markerFrameToLensModelIndexList.resize(numberOfMarkers);
+        for (size_t j = 0; j < numberOfMarkers; ++j) {
+            userData.markerFrameToLensModelIndexList[j] =
+                markerFrameToLensModelIndexList[(j * frameCount) + i];
+        }
+        userData.lensModelList = lensModelList;
+#endif
+
+        userData.mmsgFrameList.push_back(mmsgFrameList[i]);
+        userData.mmsgAttrIdList = mmsgAttrIdList;
+        userData.paramToAttrList = frame->paramToAttrList;
+        constructSceneGraphParameterList(userData);
+        userData.errorToMarkerList = errorToMarkerList;
+        userData.markerPosList = markerPosList;
+        userData.markerWeightList = markerWeightList;
+        userData.errorToParamList = errorToParamList;
+
+        userData.paramList.resize(numberOfParameters, 0);
+        userData.previousParamList.resize(numberOfParameters, 0);
+        userData.errorList.resize(numberOfErrors, 0);
+        userData.errorDistanceList.resize(
+            numberOfMarkerErrors / ERRORS_PER_MARKER, 0);
+        constructSparseJacobianStructure(
+            numberOfParameters, numberOfErrors, numberOfMarkerErrors,
+            numberOfAttrStiffnessErrors, numberOfAttrSmoothnessErrors,
+            frame->paramToAttrList, errorToParamList, stiffAttrsList,
+            smoothAttrsList, userData.jacobian);
+        userData.numberOfMarkerErrors = numberOfMarkerErrors;
+        userData.numberOfAttrStiffnessErrors = numberOfAttrStiffnessErrors;
+        userData.numberOfAttrSmoothnessErrors = numberOfAttrSmoothnessErrors;
+
+        userData.isJacobianCall = false;
+        userData.isNormalCall = true;
+        userData.isPrintCall = false;
+        userData.doCalcJacobian = false;
+
+        userData.solverOptions = &frameSolverOptions;
+        userData.dgmod = &out_dgmod;
+        userData.curveChange = &out_curveChange;
+        userData.computation = nullptr;
+        userData.cancelRequested = &cancelRequested;
+        userData.userInterrupted = false;
+        userData.mayaSessionState = mayaSessionState;
+        userData.logLevel = frameLogLevel;
+
+        frameSolveList.push_back(std::move(frame));
+    }
+    const int preparedFrameCount = static_cast<int>(frameSolveList.size());
+
+    // Each thread evaluates its own copy of the scene. The main
+    // thread uses the original.
+    std::vector<SceneGraphWorkerData> workerList(threadCount);
+    for (int t = 1; t < threadCount; ++t) {
+        workerList[t].attrDataBlock = mmsgAttrDataBlock.clone();
+        workerList[t].flatScene = mmsgFlatScene.clone();
+    }
+    workerList[0].attrDataBlock = std::move(mmsgAttrDataBlock);
+    workerList[0].flatScene = std::move(mmsgFlatScene);
+
+    // Frames are already evaluated concurrently, so each copy of the
+    // scene evaluates all its frames on the frame's thread.
+    if (threadCount > 1) {
+        for (int t = 0; t < threadCount; ++t) {
+            workerList[t].flatScene.set_frame_parallel_grain_size(0);
+        }
+    }
+
+    // Frames are given to the threads in order. Only the main thread
+    // may use the Maya API, so it reports progress and checks if the
+    // user wants to cancel the solve.
+    std::atomic<int> nextFrame(0);
+    std::atomic<int> solvedFrameCount(0);
+    auto solveFrameList = [&](const int workerIndex) {
+        SceneGraphWorkerData &worker = workerList[workerIndex];
+        const bool isMainThread = workerIndex == 0;
+        while (!cancelRequested) {
+            if (isMainThread) {
+                out_computation.setProgress(solvedFrameCount);
+                if (out_computation.isInterruptRequested()) {
+                    MMSOLVER_MAYA_WRN("User wants to cancel the evaluation!");
+                    cancelRequested = true;
+                    break;
+                }
+            }
+
+            const int i = nextFrame.fetch_add(1);
+            if (i >= preparedFrameCount) {
+                break;
+            }
+
+            FrameSolveData &frame = *frameSolveList[i];
+            MComputation *computation = nullptr;
+            if (isMainThread) {
+                computation = &out_computation;
+            }
+            solveFrameWithWorker(frame, worker, computation);
+            ++solvedFrameCount;
+
+            if (frame.userData.userInterrupted) {
+                cancelRequested = true;
+            }
+        }
+    };
+
+    std::vector<std::thread> threadList;
+    threadList.reserve(threadCount - 1);
+    for (int t = 1; t < threadCount; ++t) {
+        threadList.push_back(std::thread(solveFrameList, t));
+    }
+    solveFrameList(0);
+    for (std::thread &thread : threadList) {
+        thread.join();
+    }
+
+    // Set the solved values in Maya, in frame order.
+    for (int i = 0; i < preparedFrameCount; ++i) {
+        FrameSolveData &frame = *frameSolveList[i];
+        if (!frame.solved) {
+            // The solve was cancelled before the frame started, so
+            // the frame is left unchanged.
+            continue;
+        }
+
+        SolverData &userData = frame.userData;
+        const int numberOfParameters = frame.numberOfParameters;
+        const int numberOfMarkerErrors = userData.numberOfMarkerErrors;
+        CommandResult &frameCmdResult = frame.cmdResult;
+        if (frame.status != MS::kSuccess) {
+            auto frameNumber = userData.frameList[0].asUnits(MTime::uiUnit());
+            MMSOLVER_MAYA_ERR("Failed to solve frame "
+                              << frameNumber << ", " << frame.failedStep
+                              << "; status="
+                              << frame.status.errorString().asChar()
+                              << ", solverType=" << solverOptions.solverType);
+            out_cmdResult.add(frameCmdResult);
+            status = frame.status;
+            break;
+        }
+
+        logResultsErrorMetrics(numberOfMarkerErrors, userData.markerList,
+                               userData.frameList, userData.errorToMarkerList,
+                               userData.errorDistanceList,
+                               frameCmdResult.errorMetricsResult);
+        logResultsTimer(userData.timer, frameCmdResult.timerResult);
+        frameCmdResult.solverResult.user_interrupted =
+            userData.userInterrupted;
+
+        bool set_attrs_ok = false;
+        if (frame.errorIsBetter) {
+            set_attrs_ok = set_maya_attribute_values(
+                numberOfParameters, frame.paramToAttrList, usedAttrList,
+                frame.paramList, userData.frameList, out_dgmod,
+                out_curveChange);
+        } else {
+            set_attrs_ok = set_maya_attribute_values(
+                numberOfParameters, frame.paramToAttrList, usedAttrList,
+                frame.previousParamList, userData.frameList, out_dgmod,
+                out_curveChange);
+        }
+        if (!set_attrs_ok) {
+            MMSOLVER_MAYA_ERR("Failed to set solved parameters.");
+            frameCmdResult.solverResult.success = false;
+            out_cmdResult.add(frameCmdResult);
+            status = MS::kFailure;
+            break;
+        }
+
+        logResultsSolveValues(
+            numberOfParameters,
+            numberOfMarkerErrors + userData.numberOfAttrStiffnessErrors +
+                userData.numberOfAttrSmoothnessErrors,
+            frame.paramList, userData.errorList,
+            frameCmdResult.solveValuesResult);
+
+        // Report the time taken to solve the frame, not including the
+        // time waiting for other frames.
+        userData.timer.startTimestamp +=
+            mmsolver::debug::get_timestamp() - frame.solveEndTimestamp;
+        printSolveDetails(frameCmdResult.solverResult, userData,
+                          userData.timer, numberOfParameters,
+                          numberOfMarkerErrors,
+                          userData.numberOfAttrStiffnessErrors,
+                          userData.numberOfAttrSmoothnessErrors, logLevel,
+                          frame.paramList);
+
+        out_cmdResult.add(frameCmdResult);
+    }
+
+    // Frames that were not solved are left unchanged, so a cancelled
+    // solve is not a success.
+    if (cancelRequested) {
+        out_cmdResult.solverResult.success = false;
+        out_cmdResult.solverResult.user_interrupted = true;
+    }
+
+    if (prepareFailed && (status == MS::kSuccess)) {
+        status = MS::kFailure;
+    }
+    return status;
+}
+
 /*! Solve everything!
  *
  * This function is responsible for taking the given cameras, markers,
@@ -1411,7 +2013,6 @@ bool solve_v1(SolverOptions &solverOptions, CameraPtrList &cameraList,
     auto errorList = std::vector<double>();
     auto paramList = std::vector<double>();
     auto previousParamList = std::vector<double>();
-    auto jacobianList = std::vector<double>();
 
     MGlobal::MMayaState mayaSessionState = MGlobal::mayaState(&status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -1427,8 +2028,8 @@ bool solve_v1(SolverOptions &solverOptions, CameraPtrList &cameraList,
             //
             mayaSessionState, dgmod, curveChange, computation,
             //
-            jacobianList, paramToAttrList, errorToMarkerList, markerPosList,
-            markerWeightList, errorList, paramList, previousParamList,
+            paramToAttrList, errorToMarkerList, markerPosList, markerWeightList,
+            errorList, paramList, previousParamList,
             //
             logLevel, cmdResult);
     } else if (frameSolveMode == FrameSolveMode::kPerFrame) {
@@ -1452,33 +2053,49 @@ bool solve_v1(SolverOptions &solverOptions, CameraPtrList &cameraList,
             perFrameLogLevel = LogLevel::kInfo;
         }
 
-        for (auto i = 0; i < frameCount; ++i) {
-            computation.setProgress(i);
-
-            CommandResult perFrameCmdResult;
-            perFrameCmdResult.printStats = cmdResult.printStats;
-
-            auto frames = MTimeArray(1, frameList[i]);
-            status = solveFrames(
-                cameraList, bundleList, frames, usedMarkerList,
-                unusedMarkerList, usedAttrList, unusedAttrList, stiffAttrsList,
-                smoothAttrsList, markerToAttrList, solverOptions,
+        const bool independentFrames = canSolveFramesIndependently(
+            solverOptions, cmdResult.printStats, frameList, usedMarkerList,
+            usedAttrList, stiffAttrsList, smoothAttrsList);
+        if (independentFrames) {
+            status = solveFramesIndependently(
+                cameraList, bundleList, frameList, usedMarkerList,
+                usedAttrList, stiffAttrsList, smoothAttrsList,
+                markerToAttrList, solverOptions,
                 //
                 mayaSessionState, dgmod, curveChange, computation,
                 //
-                jacobianList, paramToAttrList, errorToMarkerList, markerPosList,
-                markerWeightList, errorList, paramList, previousParamList,
-                //
-                perFrameLogLevel, perFrameCmdResult);
-
-            // Combine results from each iteration.
-            cmdResult.add(perFrameCmdResult);
-
-            if (status != MS::kSuccess) {
-                auto frame = frameList[i].asUnits(MTime::uiUnit());
-                MMSOLVER_MAYA_ERR("Failed to solve frame "
-                                  << frame << ", stopping solve.");
-                break;
+                perFrameLogLevel, cmdResult);
+        } else {
+            for (auto i = 0; i < frameCount; ++i) {
+                computation.setProgress(i);
+
+                CommandResult perFrameCmdResult;
+                perFrameCmdResult.printStats = cmdResult.printStats;
+
+                auto frames = MTimeArray(1, frameList[i]);
+                status = solveFrames(
+                    cameraList, bundleList, frames, usedMarkerList,
+                    unusedMarkerList, usedAttrList, unusedAttrList,
+                    stiffAttrsList, smoothAttrsList, markerToAttrList,
+                    solverOptions,
+                    //
+                    mayaSessionState, dgmod, curveChange, computation,
+                    //
+                    paramToAttrList, errorToMarkerList, markerPosList,
+                    markerWeightList, errorList, paramList,
+                    previousParamList,
+                    //
+                    perFrameLogLevel, perFrameCmdResult);
+
+                // Combine results from each iteration.
+                cmdResult.add(perFrameCmdResult);
+
+                if (status != MS::kSuccess) {
+                    auto frame = frameList[i].asUnits(MTime::uiUnit());
+                    MMSOLVER_MAYA_ERR("Failed to solve frame "
+                                      << frame << ", stopping solve.");
+                    break;
+                }
             }
         }
 
@@ -1603,7 +2220,6 @@ bool solve_v2(SolverOptions &solverOptions, CameraPtrList &cameraList,
     auto errorList = std::vector<double>();
     auto paramList = std::vector<double>();
     auto previousParamList = std::vector<double>();
-    auto jacobianList = std::vector<double>();
 
     MGlobal::MMayaState mayaSessionState = MGlobal::mayaState(&status);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -1619,8 +2235,8 @@ bool solve_v2(SolverOptions &solverOptions, CameraPtrList &cameraList,
             //
             mayaSessionState, dgmod, curveChange, computation,
             //
-            jacobianList, paramToAttrList, errorToMarkerList, markerPosList,
-            markerWeightList, errorList, paramList, previousParamList,
+            paramToAttrList, errorToMarkerList, markerPosList, markerWeightList,
+            errorList, paramList, previousParamList,
             //
             logLevel, out_cmdResult);
     } else if (frameSolveMode == FrameSolveMode::kPerFrame) {
@@ -1644,33 +2260,49 @@ bool solve_v2(SolverOptions &solverOptions, CameraPtrList &cameraList,
             perFrameLogLevel = LogLevel::kInfo;
         }
 
-        for (auto i = 0; i < frameCount; ++i) {
-            computation.setProgress(i);
-
-            CommandResult perFrameCmdResult;
-            perFrameCmdResult.printStats = out_cmdResult.printStats;
-
-            auto frames = MTimeArray(1, frameList[i]);
-            status = solveFrames(
-                cameraList, bundleList, frames, usedMarkerList,
-                unusedMarkerList, usedAttrList, unusedAttrList, stiffAttrsList,
-                smoothAttrsList, markerToAttrList, solverOptions,
-                //
-                mayaSessionState, dgmod, curveChange, computation, jacobianList,
+        const bool independentFrames = canSolveFramesIndependently(
+            solverOptions, out_cmdResult.printStats, frameList, usedMarkerList,
+            usedAttrList, stiffAttrsList, smoothAttrsList);
+        if (independentFrames) {
+            status = solveFramesIndependently(
+                cameraList, bundleList, frameList, usedMarkerList,
+                usedAttrList, stiffAttrsList, smoothAttrsList,
+                markerToAttrList, solverOptions,
                 //
-                paramToAttrList, errorToMarkerList, markerPosList,
-                markerWeightList, errorList, paramList, previousParamList,
+                mayaSessionState, dgmod, curveChange, computation,
                 //
-                perFrameLogLevel, perFrameCmdResult);
-
-            // Combine results from each iteration.
-            out_cmdResult.add(perFrameCmdResult);
-
-            if (status != MS::kSuccess) {
-                auto frame = frameList[i].asUnits(MTime::uiUnit());
-                MMSOLVER_MAYA_ERR("Failed to solve frame "
-                                  << frame << ", stopping solve.");
-                break;
+                perFrameLogLevel, out_cmdResult);
+        } else {
+            for (auto i = 0; i < frameCount; ++i) {
+                computation.setProgress(i);
+
+                CommandResult perFrameCmdResult;
+                perFrameCmdResult.printStats = out_cmdResult.printStats;
+
+                auto frames = MTimeArray(1, frameList[i]);
+                status = solveFrames(
+                    cameraList, bundleList, frames, usedMarkerList,
+                    unusedMarkerList, usedAttrList, unusedAttrList,
+                    stiffAttrsList, smoothAttrsList, markerToAttrList,
+                    solverOptions,
+                    //
+                    mayaSessionState, dgmod, curveChange, computation,
+                    //
+                    paramToAttrList, errorToMarkerList, markerPosList,
+                    markerWeightList, errorList, paramList,
+                    previousParamList,
+                    //
+                    perFrameLogLevel, perFrameCmdResult);
+
+                // Combine results from each iteration.
+                out_cmdResult.add(perFrameCmdResult);
+
+                if (status != MS::kSuccess) {
+                    auto frame = frameList[i].asUnits(MTime::uiUnit());
+                    MMSOLVER_MAYA_ERR("Failed to solve frame "
+                                      << frame << ", stopping solve.");
+                    break;
+                }
             }
         }
 
@@ -20,7 +20,7 @@
  * Common functions and data to be used by CMinpack algorithms.
  */
 
-#ifdef USE_SOLVER_CMINPACK
+#ifdef MMSOLVER_USE_CMINPACK
 
 #include "adjust_cminpack_base.h"
 
@@ -54,4 +54,65 @@
 #include "mmSolver/utilities/debug_utils.h"
 #include "mmSolver/utilities/string_utils.h"
 
-#endif  // USE_SOLVER_CMINPACK
+void cminpack_prepare_solve(const SolverOptions &solverOptions,
+                            const int numberOfParameters,
+                            const int numberOfErrors, const int ldfjac,
+                            const size_t jacobianSize,
+                            CMinpackSolveData &out_solveData) {
+    out_solveData.ldfjac = ldfjac;
+    out_solveData.jacobianList.assign(jacobianSize, 0);
+    out_solveData.ipvtList.assign((unsigned long)numberOfParameters, 0);
+    out_solveData.qtfList.assign((unsigned long)numberOfParameters, 0);
+    out_solveData.wa1List.assign((unsigned long)numberOfParameters, 0);
+    out_solveData.wa2List.assign((unsigned long)numberOfParameters, 0);
+    out_solveData.wa3List.assign((unsigned long)numberOfParameters, 0);
+    out_solveData.wa4List.assign((unsigned long)numberOfErrors, 0);
+
+    out_solveData.ftol = solverOptions.eps1;
+    out_solveData.xtol = solverOptions.eps2;
+    out_solveData.gtol = solverOptions.eps3;
+
+    out_solveData.mode = 2;  // Off
+    if (solverOptions.autoParamScale == 1) {
+        out_solveData.mode = 1;  // On
+    }
+
+    // cminpack uses a 'tau' value of between 0.0 to 100.0;
+    out_solveData.factor = solverOptions.tau * 100.0;
+    out_solveData.nprint = 0;  // 0 == don't print anything.
+    out_solveData.calls = 0;
+    out_solveData.njev = 0;
+}
+
+void cminpack_set_solve_result(const int info,
+                               const CMinpackSolveData &solveData,
+                               const int numberOfErrors,
+                               const std::vector<double> &errorList,
+                               const SolverData &userData,
+                               SolverResult &out_solveResult) {
+    const double error_norm_value =
+        __cminpack_func__(enorm)(numberOfErrors, &errorList[0]);
+    const int ret = userData.iterNum;
+
+    int reason_number = info;
+    const std::string &reason = cminpackReasons[reason_number];
+    out_solveResult.success = ret > 0;
+    out_solveResult.reason_number = reason_number;
+    out_solveResult.reason = reason;
+    out_solveResult.iterations = solveData.calls;
+    out_solveResult.functionEvals = userData.iterNum;
+    out_solveResult.jacobianEvals = userData.jacIterNum;
+    out_solveResult.errorFinal = error_norm_value;
+}
+
+int cminpack_solve_func_info(const int solveFuncReturn) {
+    int info = -1;
+    if (solveFuncReturn == SOLVE_FUNC_SUCCESS) {
+        info = 0;
+    } else if (solveFuncReturn == SOLVE_FUNC_FAILURE) {
+        info = -1;
+    }
+    return info;
+}
+
+#endif  // MMSOLVER_USE_CMINPACK
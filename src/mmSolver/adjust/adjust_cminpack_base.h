@@ -82,4 +82,59 @@ const std::string cminpackReasons[9] = {
     "to machine precision.",
 };
 
+// The options and working memory given to the cminpack 'lmder' and
+// 'lmstr' functions.
+struct CMinpackSolveData {
+    // Leading dimension of the 'fjac' matrix.
+    int ldfjac;
+
+    // Tolerances to stop solving.
+    double ftol;
+    double xtol;
+    double gtol;
+
+    // Auto-parameter-scaling mode; 1 is on, 2 is off.
+    int mode;
+
+    // Tau factor (scale factor for initialTransform mu).
+    double factor;
+
+    // Should we print at each iteration? 0 == don't print anything.
+    int nprint;
+
+    // Number of function and Jacobian calls, set by the solve.
+    int calls;
+    int njev;
+
+    std::vector<double> jacobianList;
+    std::vector<int> ipvtList;
+    std::vector<double> qtfList;
+    std::vector<double> wa1List;
+    std::vector<double> wa2List;
+    std::vector<double> wa3List;
+    std::vector<double> wa4List;
+};
+
+// Set the options from the solver options, and allocate the working
+// memory. The 'fjac' matrix has 'jacobianSize' values with a leading
+// dimension of 'ldfjac'.
+void cminpack_prepare_solve(const SolverOptions &solverOptions,
+                            const int numberOfParameters,
+                            const int numberOfErrors, const int ldfjac,
+                            const size_t jacobianSize,
+                            CMinpackSolveData &out_solveData);
+
+// Fill the solve result from the cminpack termination reason
+// ('info') and the final errors.
+void cminpack_set_solve_result(const int info,
+                               const CMinpackSolveData &solveData,
+                               const int numberOfErrors,
+                               const std::vector<double> &errorList,
+                               const SolverData &userData,
+                               SolverResult &out_solveResult);
+
+// Convert the 'solveFunc' return value into the value returned to
+// cminpack; a negative value stops the solve.
+int cminpack_solve_func_info(const int solveFuncReturn);
+
 #endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_CMINPACK_BASE_H
@@ -29,6 +29,7 @@
 // STL
 #include <math.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <ctime>
@@ -68,48 +69,16 @@ bool solve_3d_cminpack_lmder(SolverOptions &solverOptions,
                              std::vector<double> &paramWeightList,
                              SolverData &userData, SolverResult &solveResult) {
     const int solverType = SOLVER_TYPE_CMINPACK_LMDER;
-    int ret = 0;
     int iterMax = solverOptions.iterMax;
     userData.solverType = solverType;
 
-    std::vector<double> jacobianList(1);
-    jacobianList.resize((unsigned long)numberOfParameters * numberOfErrors, 0);
-
-    std::vector<int> ipvtList(1);
-    ipvtList.resize((unsigned long)numberOfParameters, 0);
-
-    std::vector<double> qtfList(1);
-    qtfList.resize((unsigned long)numberOfParameters, 0);
-
-    std::vector<double> wa1List(1);
-    std::vector<double> wa2List(1);
-    std::vector<double> wa3List(1);
-    std::vector<double> wa4List(1);
-    wa1List.resize((unsigned long)numberOfParameters, 0);
-    wa2List.resize((unsigned long)numberOfParameters, 0);
-    wa3List.resize((unsigned long)numberOfParameters, 0);
-    wa4List.resize((unsigned long)numberOfErrors, 0);
-
-    int ldfjac = numberOfErrors;
-    if (numberOfParameters >= numberOfErrors) {
-        ldfjac = numberOfParameters;
-    }
-
-    double ftol = solverOptions.eps1;
-    double xtol = solverOptions.eps2;
-    double gtol = solverOptions.eps3;
-
-    int mode = 2;  // Off
-    if (solverOptions.autoParamScale == 1) {
-        mode = 1;  // On
-    }
-
-    // cminpack uses a 'tau' value of between 0.0 to 100.0;
-    double factor = solverOptions.tau * 100.0;
-    int nprint = 0;  // 0 == don't print anything.
-    int calls = 0;
-    int njev = 0;
-    double error_norm_value = 0.0;
+    // The Jacobian is an m by n matrix.
+    const int ldfjac = std::max(numberOfErrors, numberOfParameters);
+    const size_t jacobianSize = (size_t)numberOfParameters * numberOfErrors;
+    CMinpackSolveData solveData;
+    cminpack_prepare_solve(solverOptions, numberOfParameters, numberOfErrors,
+                           ldfjac, jacobianSize, solveData);
+
     int info = __cminpack_func__(lmder)(
         // Function to call
         solveFunc_cminpack_lmder,
@@ -135,13 +104,13 @@ bool solve_3d_cminpack_lmder(SolverOptions &solverOptions,
         // array. The upper n by n submatrix of fjac contains
         // an upper triangular matrix r with diagonal elements
         // of nonincreasing magnitude.
-        &jacobianList[0],
+        &solveData.jacobianList[0],
 
         // Longest Dimension of Jacobian Matrix
-        ldfjac,
+        solveData.ldfjac,
 
         // Tolerance to stop solving.
-        ftol, xtol, gtol,
+        solveData.ftol, solveData.xtol, solveData.gtol,
 
         // Iteration maximum
         iterMax,
@@ -150,20 +119,20 @@ bool solve_3d_cminpack_lmder(SolverOptions &solverOptions,
         &paramWeightList[0],
 
         // Auto-parameter-scaling mode
-        mode,
+        solveData.mode,
 
         // Tau factor (scale factor for initialTransform mu)
-        factor,
+        solveData.factor,
 
         // Should we print at each iteration?
-        nprint,
+        solveData.nprint,
 
         // 'nfev' is an integer output variable set to the
         // number of calls to 'fcn'.
-        &calls,
+        &solveData.calls,
 
         // Number of Jacobian calls.
-        &njev,
+        &solveData.njev,
 
         // 'ipvt' is an integer output array of length n. ipvt
         // defines a permutation matrix p such that jac*p =
@@ -172,27 +141,18 @@ bool solve_3d_cminpack_lmder(SolverOptions &solverOptions,
         // triangular with diagonal elements of non-increasing
         // magnitude. Column j of p is column ipvt(j) of the
         // identity matrix
-        &ipvtList[0],
+        &solveData.ipvtList[0],
 
         // 'qtf' is an output array of length n which contains
         // the first n elements of the vector `(q transpose) *
         // fvec`.
-        &qtfList[0],
+        &solveData.qtfList[0],
 
         // Working memory arrays
-        &wa1List[0], &wa2List[0], &wa3List[0], &wa4List[0]);
-    error_norm_value = __cminpack_func__(enorm)(numberOfErrors, &errorList[0]);
-    ret = userData.iterNum;
-
-    int reason_number = info;
-    const std::string &reason = cminpackReasons[reason_number];
-    solveResult.success = ret > 0;
-    solveResult.reason_number = reason_number;
-    solveResult.reason = reason;
-    solveResult.iterations = calls;
-    solveResult.functionEvals = userData.iterNum;
-    solveResult.jacobianEvals = userData.jacIterNum;
-    solveResult.errorFinal = error_norm_value;
+        &solveData.wa1List[0], &solveData.wa2List[0], &solveData.wa3List[0],
+        &solveData.wa4List[0]);
+    cminpack_set_solve_result(info, solveData, numberOfErrors, errorList,
+                              userData, solveResult);
     return true;
 }
 
@@ -233,14 +193,7 @@ int solveFunc_cminpack_lmder(void *data, int m, int n, const double *x,
     ud->doCalcJacobian = iflag == 2;
 
     int ret = solveFunc(n, m, x, fvec, fjac, data);
-
-    int info = -1;
-    if (ret == SOLVE_FUNC_SUCCESS) {
-        info = 0;
-    } else if (ret == SOLVE_FUNC_FAILURE) {
-        info = -1;
-    }
-    return info;
+    return cminpack_solve_func_info(ret);
 }
 
 #endif  // MMSOLVER_USE_CMINPACK
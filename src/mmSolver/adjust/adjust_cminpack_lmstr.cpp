@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Uses Non-Linear Least Squares algorithm to calculate attribute
+ * values based on 2D-to-3D error measurements through a pinhole
+ * camera.
+ *
+ * The 'lmstr' function only requests a single row of the Jacobian at
+ * a time, so the full (dense) Jacobian matrix is never stored. The
+ * Jacobian is computed once per solver iteration into the sparse
+ * Jacobian stored in 'SolverData', and the rows are read from it.
+ */
+
+#ifdef MMSOLVER_USE_CMINPACK
+
+#include "adjust_cminpack_lmstr.h"
+
+// STL
+#include <math.h>
+
+#include <cassert>
+#include <cmath>
+#include <ctime>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Maya
+#include <maya/MAnimCurveChange.h>
+#include <maya/MComputation.h>
+#include <maya/MFnAnimCurve.h>
+#include <maya/MMatrix.h>
+#include <maya/MObject.h>
+#include <maya/MPoint.h>
+#include <maya/MProfiler.h>
+#include <maya/MString.h>
+#include <maya/MStringArray.h>
+
+// CMinpack
+#include <cminpack.h>
+
+// MM Solver Libs
+#include <mmsolverlibs/debug.h>
+
+// MM Solver
+#include "adjust_cminpack_base.h"
+#include "adjust_solveFunc.h"
+#include "adjust_sparseJacobian.h"
+#include "mmSolver/mayahelper/maya_utils.h"
+#include "mmSolver/utilities/debug_utils.h"
+#include "mmSolver/utilities/string_utils.h"
+
+bool solve_3d_cminpack_lmstr(SolverOptions &solverOptions,
+                             int numberOfParameters, int numberOfErrors,
+                             std::vector<double> &paramList,
+                             std::vector<double> &errorList,
+                             std::vector<double> &paramWeightList,
+                             SolverData &userData, SolverResult &solveResult) {
+    const int solverType = SOLVER_TYPE_CMINPACK_LMSTR;
+    int iterMax = solverOptions.iterMax;
+    userData.solverType = solverType;
+
+    // 'lmstr' only needs an n by n matrix to store the upper
+    // triangular 'R' matrix; the m by n Jacobian is never allocated.
+    const int ldfjac = numberOfParameters;
+    const size_t jacobianSize = (size_t)numberOfParameters * numberOfParameters;
+    CMinpackSolveData solveData;
+    cminpack_prepare_solve(solverOptions, numberOfParameters, numberOfErrors,
+                           ldfjac, jacobianSize, solveData);
+
+    int info = __cminpack_func__(lmstr)(
+        // Function to call
+        solveFunc_cminpack_lmstr,
+
+        // Input user data.
+        (void *)&userData,
+
+        // Number of errors.
+        numberOfErrors,
+
+        // Number of parameters.
+        numberOfParameters,
+
+        // Parameters
+        &paramList[0],
+
+        // Errors
+        &errorList[0],
+
+        // 'fjac' is an output n by n array. The upper triangle of
+        // fjac contains an upper triangular matrix r such that
+        // 'p^T * (jac^T * jac) * p = r^T * r', where p is a
+        // permutation matrix and jac is the final calculated
+        // Jacobian.
+        &solveData.jacobianList[0],
+
+        // Leading Dimension of 'fjac' (at least n).
+        solveData.ldfjac,
+
+        // Tolerance to stop solving.
+        solveData.ftol, solveData.xtol, solveData.gtol,
+
+        // Iteration maximum
+        iterMax,
+
+        // Weight list (diagonal scaling)
+        &paramWeightList[0],
+
+        // Auto-parameter-scaling mode
+        solveData.mode,
+
+        // Tau factor (scale factor for initialTransform mu)
+        solveData.factor,
+
+        // Should we print at each iteration?
+        solveData.nprint,
+
+        // 'nfev' is an integer output variable set to the
+        // number of calls to 'fcn' with iflag = 1.
+        &solveData.calls,
+
+        // Number of Jacobian calls (with iflag = 2).
+        &solveData.njev,
+
+        // 'ipvt' is an integer output array of length n. ipvt
+        // defines a permutation matrix p such that jac*p =
+        // q*r, where jac is the final calculated Jacobian, q
+        // is orthogonal (not stored), and r is upper
+        // triangular. Column j of p is column ipvt(j) of the
+        // identity matrix
+        &solveData.ipvtList[0],
+
+        // 'qtf' is an output array of length n which contains
+        // the first n elements of the vector `(q transpose) *
+        // fvec`.
+        &solveData.qtfList[0],
+
+        // Working memory arrays
+        &solveData.wa1List[0], &solveData.wa2List[0], &solveData.wa3List[0],
+        &solveData.wa4List[0]);
+    cminpack_set_solve_result(info, solveData, numberOfErrors, errorList,
+                              userData, solveResult);
+    return true;
+}
+
+// Run the cminpack 'lmstr' solve function.
+//
+// 'data' is a pointer to a user data that was passed to 'lmstr'.
+//
+// 'm' is a positive integer input variable set to the number of
+// functions.
+//
+// 'n' is a positive integer input variable set to the number of
+// variables. n must not exceed m.
+//
+// 'x' is an array of length n, the current parameters.
+//
+// 'fvec' is an array of length m. When 'iflag' is 1, fvec must be
+// set to the functions evaluated at 'x'. Otherwise fvec contains
+// the functions evaluated at 'x' and must not be changed.
+//
+// 'fjrow' is an output array of length n. When 'iflag' is 'i + 1'
+// (with i >= 1) fjrow must be set to row 'i' of the Jacobian at 'x'.
+//
+// 'iflag' tells us what type of call this function is expected to
+// perform. 'lmstr' requests all rows of the Jacobian in order,
+// starting with iflag = 2 and without changing 'x', so the full
+// Jacobian is computed on the first row request and the following
+// rows are read from the sparse Jacobian.
+int solveFunc_cminpack_lmstr(void *data, int m, int n, const double *x,
+                             double *fvec, double *fjrow, int iflag) {
+    SolverData *ud = static_cast<SolverData *>(data);
+
+    if (iflag > 2) {
+        const int errorIndex = iflag - 2;
+        assert(errorIndex < m);
+        sparseJacobianGetRow(ud->jacobian, errorIndex, fjrow);
+        return 0;
+    }
+
+    ud->isPrintCall = iflag == 0;
+    ud->isNormalCall = iflag == 1;
+    ud->isJacobianCall = iflag == 2;
+    ud->doCalcJacobian = iflag == 2;
+
+    // The dense Jacobian is never needed, only the sparse Jacobian
+    // stored in the user data is filled.
+    double *jacobian = nullptr;
+    int ret = solveFunc(n, m, x, fvec, jacobian, data);
+    if ((ret == SOLVE_FUNC_SUCCESS) && (iflag == 2)) {
+        sparseJacobianGetRow(ud->jacobian, 0, fjrow);
+    }
+    return cminpack_solve_func_info(ret);
+}
+
+#endif  // MMSOLVER_USE_CMINPACK
@@ -24,6 +24,8 @@
 #define MM_SOLVER_CORE_BUNDLE_ADJUST_DATA_H
 
 // STL
+#include <atomic>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -48,9 +50,12 @@
 #include <mmlens/lens_model.h>
 
 #include "adjust_defines.h"
+#include "adjust_relationshipIndex.h"
+#include "adjust_sparseJacobian.h"
 #include "mmSolver/mayahelper/maya_attr.h"
 #include "mmSolver/mayahelper/maya_bundle.h"
 #include "mmSolver/mayahelper/maya_camera.h"
+#include "mmSolver/mayahelper/maya_lens_model_utils.h"
 #include "mmSolver/mayahelper/maya_marker.h"
 #include "mmSolver/utilities/debug_utils.h"
 
@@ -148,6 +153,23 @@ struct SolverOptions {
     double imageWidth;
     FrameSolveMode frameSolveMode;
 
+    // Number of threads used to calculate the Jacobian matrix, when
+    // the scene graph mode supports it. 0 means use all available
+    // hardware threads, 1 disables threading.
+    int jacobianThreadCount;
+
+    // Number of threads used to solve frames concurrently, when the
+    // frame solve mode is 'kPerFrame' and each frame can be solved
+    // independently. 0 means use all available hardware threads, 1
+    // solves the frames one after another.
+    int frameThreadCount;
+
+    // Measure errors against marker positions undistorted once
+    // before solving, instead of distorting the re-projected bundles
+    // on every evaluation. Only used when no lens distortion
+    // attributes are solved.
+    bool undistortMarkers;
+
     // Auto-adjust the input solve objects before solving?
     bool removeUnusedMarkers;
     bool removeUnusedAttributes;
@@ -176,6 +198,9 @@ struct SolverOptions {
         , acceptOnlyBetter(false)
         , imageWidth(1.0)
         , frameSolveMode(FrameSolveMode::kAllFrameAtOnce)
+        , jacobianThreadCount(JACOBIAN_THREAD_COUNT_DEFAULT_VALUE)
+        , frameThreadCount(FRAME_THREAD_COUNT_DEFAULT_VALUE)
+        , undistortMarkers(UNDISTORT_MARKERS_DEFAULT_VALUE)
         , removeUnusedMarkers(false)
         , removeUnusedAttributes(false)
         , solverSupportsAutoDiffForward(false)
@@ -184,6 +209,27 @@ struct SolverOptions {
         , solverSupportsRobustLoss(false) {}
 };
 
+// A copy of the MM Scene Graph evaluation data for a single thread,
+// so that Jacobian matrix columns can be computed concurrently.
+struct SceneGraphWorkerData {
+    mmscenegraph::AttrDataBlock attrDataBlock;
+    mmscenegraph::FlatScene flatScene;
+
+    // Attributes changed since 'flatScene' was last evaluated.
+    std::vector<mmscenegraph::AttrId> dirtyAttrList;
+    std::vector<mmscenegraph::FrameValue> dirtyFrameList;
+
+    // Scratch values, the same size as the lists in 'SolverData'.
+    std::vector<mmscenegraph::Real> paramValueList;
+    std::vector<uint8_t> paramChangedList;
+    std::vector<double> errorList;
+    std::vector<double> errorDistanceList;
+    std::vector<double> paramListA;
+    std::vector<double> paramListB;
+    std::vector<double> errorListA;
+    std::vector<double> errorListB;
+};
+
 // The user data given to the solve function.
 struct SolverData {
     // Solver Objects.
@@ -196,10 +242,21 @@ struct SolverData {
     StiffAttrsPtrList stiffAttrsList;
 
     // Lens Distortion
-    std::vector<std::shared_ptr<mmlens::LensModel>> markerFrameToLensModelList;
-    std::vector<std::shared_ptr<mmlens::LensModel>> attrFrameToLensModelList;
+    //
+    // The marker/frame and attribute/frame tables are indices into
+    // 'lensModelList', or LENS_MODEL_INDEX_NONE.
+    std::vector<int32_t> markerFrameToLensModelIndexList;
+    std::vector<int32_t> attrFrameToLensModelIndexList;
     std::vector<std::shared_ptr<mmlens::LensModel>> lensModelList;
 
+    // The marker positions with the lens distortion removed, as two
+    // values (X and Y) per marker error. When
+    // 'markerPositionsUndistorted' is true, errors are measured
+    // against these positions and the re-projected bundles are not
+    // distorted. See 'undistortMarkerPositions'.
+    bool markerPositionsUndistorted;
+    std::vector<double> undistortedMarkerPosList;
+
     // MM Scene Graph
     mmscenegraph::SceneGraph mmsgSceneGraph;
     mmscenegraph::AttrDataBlock mmsgAttrDataBlock;
@@ -209,20 +266,36 @@ struct SolverData {
     std::vector<mmscenegraph::BundleNode> mmsgBundleNodes;
     std::vector<mmscenegraph::MarkerNode> mmsgMarkerNodes;
     std::vector<mmscenegraph::AttrId> mmsgAttrIdList;
+    std::vector<SceneGraphWorkerData> mmsgWorkerList;
+
+    // The attributes (and frames) changed since 'mmsgFlatScene' was
+    // last evaluated, so that only the changed values are evaluated.
+    std::vector<mmscenegraph::AttrId> mmsgDirtyAttrList;
+    std::vector<mmscenegraph::FrameValue> mmsgDirtyFrameList;
+
+    // The parameters set on the MM Scene Graph attributes, with the
+    // attribute and frame of each parameter resolved once, so all
+    // values can be set with a single call. Lens attributes are
+    // listed separately, because they are set on the lens models.
+    std::vector<int> mmsgParamIndexList;
+    std::vector<mmscenegraph::AttrId> mmsgParamAttrIdList;
+    std::vector<mmscenegraph::FrameValue> mmsgParamFrameList;
+    std::vector<int> mmsgLensParamIndexList;
+    std::vector<mmscenegraph::Real> mmsgParamValueList;
+    std::vector<uint8_t> mmsgParamChangedList;
 
     // Relational mapping indexes.
     std::vector<std::pair<int, int>> paramToAttrList;
     std::vector<std::pair<int, int>> errorToMarkerList;
     std::vector<MPoint> markerPosList;
     std::vector<double> markerWeightList;
-    std::vector<std::vector<bool>> paramFrameList;
-    std::vector<std::vector<bool>> errorToParamList;
+    ErrorToParamIndex errorToParamList;
 
     // Internal Solver Data.
     std::vector<double> paramList;
     std::vector<double> errorList;
     std::vector<double> errorDistanceList;
-    std::vector<double> jacobianList;
+    SparseJacobian jacobian;
     std::vector<double> previousParamList;
     int funcEvalNum;
     int iterNum;
@@ -249,7 +322,12 @@ struct SolverData {
     MAnimCurveChange *curveChange;
 
     // Allow user to cancel the solve.
+    //
+    // 'computation' may only be used on the main thread. A solve
+    // running on another thread has no 'computation' and is cancelled
+    // by the main thread setting 'cancelRequested'.
     MComputation *computation;
+    const std::atomic<bool> *cancelRequested;
     bool userInterrupted;
 
     // Maya is running as an interactive or batch?
@@ -258,7 +336,8 @@ struct SolverData {
     LogLevel logLevel;
 
     SolverData()
-        : funcEvalNum(0)
+        : markerPositionsUndistorted(false)
+        , funcEvalNum(0)
         , iterNum(0)
         , jacIterNum(0)
         , solverType(SOLVER_TYPE_DEFAULT_VALUE)
@@ -274,6 +353,7 @@ struct SolverData {
         , dgmod(nullptr)
         , curveChange(nullptr)
         , computation(nullptr)
+        , cancelRequested(nullptr)
         , userInterrupted(false)
         , logLevel(LogLevel::kInfo){};
 };
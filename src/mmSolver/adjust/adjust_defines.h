@@ -52,6 +52,12 @@
 #define SOLVER_TYPE_CERES (3)
 #define SOLVER_TYPE_CERES_NAME "ceres"
 
+// LM solver, with a custom sparse jacobian given to the solver one
+// row at a time, using 'cminpack' library. Uses much less memory than
+// 'lmder' for problems with many errors.
+#define SOLVER_TYPE_CMINPACK_LMSTR (4)
+#define SOLVER_TYPE_CMINPACK_LM_STR_NAME "cminpack_lmstr"
+
 // The default solver to use, if all solvers are available.
 #define SOLVER_TYPE_DEFAULT_VALUE SOLVER_TYPE_CMINPACK_LMDER
 
@@ -83,6 +89,29 @@
 // The default value
 #define FRAME_SOLVE_MODE_DEFAULT_VALUE FRAME_SOLVE_MODE_ALL_FRAMES_AT_ONCE
 
+// How many threads are used to calculate the Jacobian matrix?
+//
+// Only the MM Scene Graph evaluation can be threaded; the Maya DAG is
+// always evaluated on the main thread. A value of 0 uses all hardware
+// threads, 1 disables threading. Threading is disabled by default.
+#define JACOBIAN_THREAD_COUNT_DEFAULT_VALUE (1)
+
+// How many threads are used to solve frames, when the frame solve
+// mode is per-frame?
+//
+// Frames are only solved concurrently with the MM Scene Graph, when
+// every solved attribute is animated (so each frame is an
+// independent problem). A value of 0 uses all hardware threads, 1
+// disables threading.
+#define FRAME_THREAD_COUNT_DEFAULT_VALUE (0)
+
+// Are the errors measured against undistorted marker positions?
+//
+// When enabled and no lens distortion attributes are solved, the
+// marker positions are undistorted once before solving, and
+// re-projected bundles are not distorted when measuring errors.
+#define UNDISTORT_MARKERS_DEFAULT_VALUE (false)
+
 // Print Statistics for mmSolver command.
 //
 // These are the possible values:
@@ -140,6 +169,25 @@
 #define CMINPACK_LMDER_SUPPORT_PARAMETER_BOUNDS_VALUE true
 #define CMINPACK_LMDER_SUPPORT_ROBUST_LOSS_VALUE false
 
+// CMinpack lmstr Solver default flag values
+//
+#define CMINPACK_LMSTR_ITERATIONS_DEFAULT_VALUE (100)
+#define CMINPACK_LMSTR_TAU_DEFAULT_VALUE (1.0)
+#define CMINPACK_LMSTR_EPSILON1_DEFAULT_VALUE (1E-6)  // ftol
+#define CMINPACK_LMSTR_EPSILON2_DEFAULT_VALUE (1E-6)  // xtol
+#define CMINPACK_LMSTR_EPSILON3_DEFAULT_VALUE (1E-6)  // gtol
+#define CMINPACK_LMSTR_DELTA_DEFAULT_VALUE (1E-04)
+// cminpack lmstr supports both forward '0=forward' and 'central' auto-diff'ing.
+#define CMINPACK_LMSTR_AUTO_DIFF_TYPE_DEFAULT_VALUE (AUTO_DIFF_TYPE_FORWARD)
+#define CMINPACK_LMSTR_AUTO_PARAM_SCALE_DEFAULT_VALUE \
+    (1)  // default is 'on=1 (mode=1)'
+#define CMINPACK_LMSTR_ROBUST_LOSS_TYPE_DEFAULT_VALUE (ROBUST_LOSS_TYPE_TRIVIAL)
+#define CMINPACK_LMSTR_ROBUST_LOSS_SCALE_DEFAULT_VALUE (1.0)
+#define CMINPACK_LMSTR_SUPPORT_AUTO_DIFF_FORWARD_VALUE true
+#define CMINPACK_LMSTR_SUPPORT_AUTO_DIFF_CENTRAL_VALUE true
+#define CMINPACK_LMSTR_SUPPORT_PARAMETER_BOUNDS_VALUE true
+#define CMINPACK_LMSTR_SUPPORT_ROBUST_LOSS_VALUE false
+
 // Levmar Solver default flag values
 //
 #define LEVMAR_ITERATIONS_DEFAULT_VALUE (100)
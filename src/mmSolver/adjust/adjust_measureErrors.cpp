@@ -115,6 +115,52 @@ inline double distance_2d(const double ax, const double ay, const double bx,
     return std::sqrt((dx * dx) + (dy * dy));
 }
 
+// Get the position of marker error 'i', in the same space as the
+// re-projected bundles of the Maya DAG mode.
+MStatus getMarkerPosition_mayaDag(const int i, const MarkerPtr &marker,
+                                  const CameraPtr &camera, const MTime &frame,
+                                  const int timeEvalMode, SolverData *ud,
+                                  double &out_mkr_x, double &out_mkr_y) {
+    MStatus status = MS::kSuccess;
+#if USE_MARKER_POSITION_CACHE == 1
+    MMSOLVER_CORE_UNUSED(marker);
+    const MPoint mkr_mpos = ud->markerPosList[i];
+    out_mkr_x = mkr_mpos.x;
+    out_mkr_y = mkr_mpos.y;
+#else
+    MMSOLVER_CORE_UNUSED(i);
+    MMSOLVER_CORE_UNUSED(ud);
+    bool applyOverscan = true;
+    status = marker->getPosXY(out_mkr_x, out_mkr_y, frame, timeEvalMode,
+                              applyOverscan);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+#endif
+
+    const short filmFit = camera->getFilmFitValue();
+    const double filmBackWidth =
+        camera->getFilmbackWidthValue(frame, timeEvalMode);
+    const double filmBackHeight =
+        camera->getFilmbackHeightValue(frame, timeEvalMode);
+    const int32_t renderWidth = camera->getRenderWidthValue();
+    const int32_t renderHeight = camera->getRenderHeightValue();
+
+    const double filmBackAspect = filmBackWidth / filmBackHeight;
+    const double renderAspect =
+        static_cast<double>(renderWidth) / static_cast<double>(renderHeight);
+
+    // The Marker position must be scaled slightly based on the
+    // Camera's FilmFit attribute, because the camera projection
+    // matrix already has the same scale factors embedded in the
+    // matrix.
+    //
+    // This is only needed for the 'Maya DAG' mode, because the
+    // 'MM SceneGraph' (Rust) code already accounts for this
+    // change.
+    applyFilmFitCorrectionScaleBackward(filmFit, filmBackAspect, renderAspect,
+                                        out_mkr_x, out_mkr_y);
+    return status;
+}
+
 void measureErrors_mayaDag(const int numberOfErrors,
                            const int numberOfMarkerErrors,
                            const int numberOfAttrStiffnessErrors,
@@ -147,7 +193,6 @@ void measureErrors_mayaDag(const int numberOfErrors,
 
     // Compute Marker Errors
     MMatrix cameraWorldProjectionMatrix;
-    MPoint mkr_mpos;
     MPoint bnd_mpos;
     int numberOfErrorsMeasured = 0;
     for (int i = 0; i < (numberOfMarkerErrors / ERRORS_PER_MARKER); ++i) {
@@ -187,39 +232,14 @@ void measureErrors_mayaDag(const int numberOfErrors,
 
         double mkr_x = 0.0;
         double mkr_y = 0.0;
-#if USE_MARKER_POSITION_CACHE == 1
-        mkr_mpos = ud->markerPosList[i];
-        mkr_x = mkr_mpos.x;
-        mkr_y = mkr_mpos.y;
-#else
-        bool applyOverscan = true;
-        status =
-            marker->getPosXY(mkr_x, mkr_y, frame, timeEvalMode, applyOverscan);
-        CHECK_MSTATUS(status);
-#endif
-
-        const short filmFit = camera->getFilmFitValue();
-        const double filmBackWidth =
-            camera->getFilmbackWidthValue(frame, timeEvalMode);
-        const double filmBackHeight =
-            camera->getFilmbackHeightValue(frame, timeEvalMode);
-        const int32_t renderWidth = camera->getRenderWidthValue();
-        const int32_t renderHeight = camera->getRenderHeightValue();
-
-        const double filmBackAspect = filmBackWidth / filmBackHeight;
-        const double renderAspect = static_cast<double>(renderWidth) /
-                                    static_cast<double>(renderHeight);
-
-        // The Marker position must be scaled slightly based on the
-        // Camera's FilmFit attribute, because the camera projection
-        // matrix already has the same scale factors embedded in the
-        // matrix.
-        //
-        // This is only needed for the 'Maya DAG' mode, because the
-        // 'MM SceneGraph' (Rust) code already accounts for this
-        // change.
-        applyFilmFitCorrectionScaleBackward(filmFit, filmBackAspect,
-                                            renderAspect, mkr_x, mkr_y);
+        if (ud->markerPositionsUndistorted) {
+            mkr_x = ud->undistortedMarkerPosList[i * 2];
+            mkr_y = ud->undistortedMarkerPosList[(i * 2) + 1];
+        } else {
+            status = getMarkerPosition_mayaDag(i, marker, camera, frame,
+                                               timeEvalMode, ud, mkr_x, mkr_y);
+            CHECK_MSTATUS(status);
+        }
 
         double mkr_weight = ud->markerWeightList[i];
         assert(mkr_weight >
@@ -241,9 +261,12 @@ void measureErrors_mayaDag(const int numberOfErrors,
         double point_y = bnd_mpos[1] * 0.5;
 
 #if MMSOLVER_LENS_DISTORTION == 1 && MMSOLVER_LENS_DISTORTION_MAYA_DAG == 1
-        auto markerFrameIndex = markerIndex + frameIndex;
-        auto lensModel = ud->markerFrameToLensModelList[markerFrameIndex];
-        if (lensModel) {
+        auto markerFrameIndex = (markerIndex * num_frames) + frameIndex;
+        auto lensModelIndex =
+            ud->markerFrameToLensModelIndexList[markerFrameIndex];
+        if (lensModelIndex != LENS_MODEL_INDEX_NONE &&
+            !ud->markerPositionsUndistorted) {
+            auto &lensModel = ud->lensModelList[lensModelIndex];
             double out_x = point_x;
             double out_y = point_y;
             lensModel->applyModelDistort(point_x, point_y, out_x, out_y);
@@ -396,32 +419,50 @@ void measureErrors_mmSceneGraph(const int numberOfErrors,
                                 const std::vector<bool> &frameIndexEnable,
                                 const std::vector<bool> &errorMeasurements,
                                 const double imageWidth, double *errors,
-                                SolverData *ud, double &error_avg,
-                                double &error_max, double &error_min,
-                                MStatus &status) {
+                                SolverData *ud,
+                                mmsg::AttrDataBlock &attrDataBlock,
+                                mmsg::FlatScene &flatScene,
+                                std::vector<mmsg::AttrId> &dirtyAttrList,
+                                std::vector<mmsg::FrameValue> &dirtyFrameList,
+                                std::vector<double> &out_errorList,
+                                std::vector<double> &out_errorDistanceList,
+                                double &error_avg, double &error_max,
+                                double &error_min, MStatus &status) {
     MMSOLVER_CORE_UNUSED(numberOfErrors);
     MMSOLVER_CORE_UNUSED(numberOfAttrStiffnessErrors);
     MMSOLVER_CORE_UNUSED(numberOfAttrSmoothnessErrors);
     MMSOLVER_CORE_UNUSED(status);
 
-    // Evaluate Scene.
-    ud->mmsgFlatScene.evaluate(ud->mmsgAttrDataBlock, ud->mmsgFrameList);
+    // Evaluate Scene, only re-computing the values affected by the
+    // attributes changed since the last evaluation.
+    flatScene.evaluate_dirty(attrDataBlock, ud->mmsgFrameList, dirtyAttrList,
+                             dirtyFrameList);
+    dirtyAttrList.clear();
+    dirtyFrameList.clear();
 
-    auto num_points = ud->mmsgFlatScene.num_points();
-    auto num_markers = ud->mmsgFlatScene.num_markers();
+    auto num_points = flatScene.num_points();
+    auto num_markers = flatScene.num_markers();
     auto num_frames = ud->mmsgFrameList.size();
     auto num_marker_lens_models = ud->lensModelList.size();
     MMSOLVER_CORE_UNUSED(num_points);
     MMSOLVER_CORE_UNUSED(num_markers);
     assert(num_points == num_markers);
 
-    auto out_point_list = ud->mmsgFlatScene.points();
-    auto out_marker_list = ud->mmsgFlatScene.markers();
+    auto out_point_list = flatScene.points();
+    auto out_marker_list = flatScene.markers();
     assert(out_marker_list.size() == out_point_list.size());
 
-    // Count Marker Errors
-    int numberOfErrorsMeasured = 0;
-    for (int i = 0; i < (numberOfMarkerErrors / ERRORS_PER_MARKER); ++i) {
+    // The marker errors to be measured, with the re-projected
+    // (undistorted) point of each.
+    const int numberOfMarkerErrorsTotal =
+        numberOfMarkerErrors / ERRORS_PER_MARKER;
+    std::vector<int> measureErrorIndexList;
+    std::vector<double> measurePointXList;
+    std::vector<double> measurePointYList;
+    measureErrorIndexList.reserve(numberOfMarkerErrorsTotal);
+    measurePointXList.reserve(numberOfMarkerErrorsTotal);
+    measurePointYList.reserve(numberOfMarkerErrorsTotal);
+    for (int i = 0; i < numberOfMarkerErrorsTotal; ++i) {
         IndexPair markerPair = ud->errorToMarkerList[i];
         int markerIndex = markerPair.first;
         int frameIndex = markerPair.second;
@@ -441,6 +482,82 @@ void measureErrors_mmSceneGraph(const int numberOfErrors,
             continue;
         }
 
+        auto mkrIndex_x = ((markerIndex * num_frames * 2) + (frameIndex * 2));
+        auto mkrIndex_y = mkrIndex_x + 1;
+        measureErrorIndexList.push_back(i);
+        measurePointXList.push_back(out_point_list[mkrIndex_x]);
+        measurePointYList.push_back(out_point_list[mkrIndex_y]);
+    }
+    const size_t numberOfMeasurements = measureErrorIndexList.size();
+
+#if MMSOLVER_LENS_DISTORTION == 1 && \
+    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
+    // Distort the re-projected points, passing each run of marker
+    // errors that share the same lens model through a single
+    // batched call, rather than one call per point.
+    //
+    // The markers are already undistorted when
+    // 'markerPositionsUndistorted' is true, so no lens distortion is
+    // applied at all.
+    if (!ud->markerPositionsUndistorted) {
+        std::vector<double> distortPointXList(numberOfMeasurements);
+        std::vector<double> distortPointYList(numberOfMeasurements);
+        size_t runStart = 0;
+        while (runStart < numberOfMeasurements) {
+            IndexPair markerPair =
+                ud->errorToMarkerList[measureErrorIndexList[runStart]];
+            auto markerFrameIndex =
+                (markerPair.first * num_frames) + markerPair.second;
+            auto lensModelIndex =
+                ud->markerFrameToLensModelIndexList[markerFrameIndex];
+
+            size_t runEnd = runStart + 1;
+            while (runEnd < numberOfMeasurements) {
+                IndexPair nextMarkerPair =
+                    ud->errorToMarkerList[measureErrorIndexList[runEnd]];
+                auto nextMarkerFrameIndex =
+                    (nextMarkerPair.first * num_frames) +
+                    nextMarkerPair.second;
+                if (ud->markerFrameToLensModelIndexList[nextMarkerFrameIndex] !=
+                    lensModelIndex) {
+                    break;
+                }
+                ++runEnd;
+            }
+
+            if (lensModelIndex != LENS_MODEL_INDEX_NONE) {
+                auto &lensModel = ud->lensModelList[lensModelIndex];
+                const size_t runCount = runEnd - runStart;
+                lensModel->applyModelDistortBatch(
+                    &measurePointXList[runStart], &measurePointYList[runStart],
+                    runCount, &distortPointXList[runStart],
+                    &distortPointYList[runStart]);
+
+                for (size_t j = runStart; j < runEnd; ++j) {
+                    // Applying the lens distortion model to large input
+                    // values, creates NaN undistorted points.
+                    if (std::isfinite(distortPointXList[j])) {
+                        measurePointXList[j] = distortPointXList[j];
+                    }
+                    if (std::isfinite(distortPointYList[j])) {
+                        measurePointYList[j] = distortPointYList[j];
+                    }
+                }
+            }
+
+            runStart = runEnd;
+        }
+    }
+#endif
+
+    // Count Marker Errors
+    int numberOfErrorsMeasured = 0;
+    for (size_t j = 0; j < numberOfMeasurements; ++j) {
+        const int i = measureErrorIndexList[j];
+        IndexPair markerPair = ud->errorToMarkerList[i];
+        int markerIndex = markerPair.first;
+        int frameIndex = markerPair.second;
+
         // Use pre-computed marker weight
         double mkr_weight = ud->markerWeightList[i];
         assert(mkr_weight >
@@ -455,28 +572,12 @@ void measureErrors_mmSceneGraph(const int numberOfErrors,
         auto mkrIndex_y = mkrIndex_x + 1;
         auto mkr_x = out_marker_list[mkrIndex_x];
         auto mkr_y = out_marker_list[mkrIndex_y];
-        auto point_x = out_point_list[mkrIndex_x];
-        auto point_y = out_point_list[mkrIndex_y];
-
-#if MMSOLVER_LENS_DISTORTION == 1 && \
-    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
-        auto markerFrameIndex = markerIndex + frameIndex;
-        auto lensModel = ud->markerFrameToLensModelList[markerFrameIndex];
-        if (lensModel) {
-            double out_x = point_x;
-            double out_y = point_y;
-            lensModel->applyModelDistort(point_x, point_y, out_x, out_y);
-
-            // Applying the lens distortion model to large input
-            // values, creates NaN undistorted points.
-            if (std::isfinite(out_x)) {
-                point_x = out_x;
-            }
-            if (std::isfinite(out_y)) {
-                point_y = out_y;
-            }
+        if (ud->markerPositionsUndistorted) {
+            mkr_x = ud->undistortedMarkerPosList[i * 2];
+            mkr_y = ud->undistortedMarkerPosList[(i * 2) + 1];
         }
-#endif
+        auto point_x = measurePointXList[j];
+        auto point_y = measurePointYList[j];
 
         auto dx = std::fabs(mkr_x - point_x);
         auto dy = std::fabs(mkr_y - point_y);
@@ -492,11 +593,11 @@ void measureErrors_mmSceneGraph(const int numberOfErrors,
 
         // 'ud->errorList' is the deviation shown to the user, it
         // should not have any loss functions or scaling applied to it.
-        ud->errorList[errorIndex_x] = dx_pixels * behind_camera_error_factor;
-        ud->errorList[errorIndex_y] = dy_pixels * behind_camera_error_factor;
+        out_errorList[errorIndex_x] = dx_pixels * behind_camera_error_factor;
+        out_errorList[errorIndex_y] = dy_pixels * behind_camera_error_factor;
 
         const double d = std::sqrt((dx * dx) + (dy * dy)) * imageWidth;
-        ud->errorDistanceList[i] = d;
+        out_errorDistanceList[i] = d;
         error_avg += d;
         if (d > error_max) {
             error_max = d;
@@ -545,7 +646,9 @@ void measureErrors(const int numberOfErrors, const int numberOfMarkerErrors,
         measureErrors_mmSceneGraph(
             numberOfErrors, numberOfMarkerErrors, numberOfAttrStiffnessErrors,
             numberOfAttrSmoothnessErrors, frameIndexEnable, errorMeasurements,
-            imageWidth, errors, ud, error_avg, error_max, error_min, status);
+            imageWidth, errors, ud, ud->mmsgAttrDataBlock, ud->mmsgFlatScene,
+            ud->mmsgDirtyAttrList, ud->mmsgDirtyFrameList, ud->errorList,
+            ud->errorDistanceList, error_avg, error_max, error_min, status);
     }
 
     // Changes the errors to be scaled by the loss function.
@@ -561,5 +664,159 @@ void measureErrors(const int numberOfErrors, const int numberOfMarkerErrors,
     return;
 }
 
+void measureErrors_mmSceneGraphWorker(
+    const int numberOfErrors, const int numberOfMarkerErrors,
+    const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors,
+    const std::vector<bool> &frameIndexEnable,
+    const std::vector<bool> &errorMeasurements, const double imageWidth,
+    double *errors, SolverData *ud, SceneGraphWorkerData &worker,
+    double &error_avg, double &error_max, double &error_min, MStatus &status) {
+    error_avg = 0.0;
+    error_max = -0.0;
+    error_min = std::numeric_limits<double>::max();
+
+    assert(ud->errorToMarkerList.size() > 0);
+    assert(ud->frameList.length() > 0);
+    assert(ud->solverOptions->sceneGraphMode == SceneGraphMode::kMMSceneGraph);
+
+    measureErrors_mmSceneGraph(
+        numberOfErrors, numberOfMarkerErrors, numberOfAttrStiffnessErrors,
+        numberOfAttrSmoothnessErrors, frameIndexEnable, errorMeasurements,
+        imageWidth, errors, ud, worker.attrDataBlock, worker.flatScene,
+        worker.dirtyAttrList, worker.dirtyFrameList, worker.errorList,
+        worker.errorDistanceList, error_avg, error_max, error_min, status);
+
+    if (ud->solverOptions->solverSupportsRobustLoss) {
+        applyLossFunctionToErrors(numberOfErrors, errors,
+                                  ud->solverOptions->robustLossType,
+                                  ud->solverOptions->robustLossScale);
+    }
+    assert(error_max >= error_min);
+    assert(error_min <= error_max);
+    return;
+}
+
 // Clean up #define
 #undef FORCE_TRIGGER_EVAL
+
+MStatus undistortMarkerPositions(SolverData *ud) {
+    MStatus status = MS::kSuccess;
+    ud->markerPositionsUndistorted = false;
+    ud->undistortedMarkerPosList.clear();
+    if (!ud->solverOptions->undistortMarkers) {
+        return status;
+    }
+
+    // Solving a lens attribute changes the lens distortion on each
+    // evaluation, so the marker positions cannot be undistorted
+    // before solving.
+    for (const AttrPtr &attr : ud->attrList) {
+        if (attr->getObjectType() == ObjectType::kLens) {
+            return status;
+        }
+    }
+
+    if (ud->lensModelList.empty()) {
+        return status;
+    }
+
+    const int numberOfMarkerErrorsTotal =
+        ud->numberOfMarkerErrors / ERRORS_PER_MARKER;
+    std::vector<double> markerXList(numberOfMarkerErrorsTotal, 0.0);
+    std::vector<double> markerYList(numberOfMarkerErrorsTotal, 0.0);
+
+    // Get the marker positions in the same space as the re-projected
+    // bundles of the scene graph mode.
+    const SceneGraphMode sceneGraphMode = ud->solverOptions->sceneGraphMode;
+    if (sceneGraphMode == SceneGraphMode::kMayaDag) {
+#if MMSOLVER_LENS_DISTORTION == 1 && MMSOLVER_LENS_DISTORTION_MAYA_DAG == 1
+        const int timeEvalMode = ud->solverOptions->timeEvalMode;
+        for (int i = 0; i < numberOfMarkerErrorsTotal; ++i) {
+            IndexPair markerPair = ud->errorToMarkerList[i];
+            MarkerPtr marker = ud->markerList[markerPair.first];
+            CameraPtr camera = marker->getCamera();
+            MTime frame = ud->frameList[markerPair.second];
+            status = getMarkerPosition_mayaDag(i, marker, camera, frame,
+                                               timeEvalMode, ud,
+                                               markerXList[i], markerYList[i]);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+        }
+#else
+        return status;
+#endif
+    } else if (sceneGraphMode == SceneGraphMode::kMMSceneGraph) {
+#if MMSOLVER_LENS_DISTORTION == 1 && \
+    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
+        ud->mmsgFlatScene.evaluate(ud->mmsgAttrDataBlock, ud->mmsgFrameList);
+        auto out_marker_list = ud->mmsgFlatScene.markers();
+        auto num_frames = ud->mmsgFrameList.size();
+        for (int i = 0; i < numberOfMarkerErrorsTotal; ++i) {
+            IndexPair markerPair = ud->errorToMarkerList[i];
+            auto mkrIndex_x = ((markerPair.first * num_frames * 2) +
+                               (markerPair.second * 2));
+            markerXList[i] = out_marker_list[mkrIndex_x];
+            markerYList[i] = out_marker_list[mkrIndex_x + 1];
+        }
+#else
+        return status;
+#endif
+    } else {
+        return status;
+    }
+
+    // Undistort each run of marker errors that share the same lens
+    // model with a single batched call.
+    const auto num_lens_frames = ud->frameList.length();
+    std::vector<double> undistortXList(markerXList);
+    std::vector<double> undistortYList(markerYList);
+    int runStart = 0;
+    while (runStart < numberOfMarkerErrorsTotal) {
+        IndexPair markerPair = ud->errorToMarkerList[runStart];
+        auto markerFrameIndex =
+            (markerPair.first * num_lens_frames) + markerPair.second;
+        auto lensModelIndex =
+            ud->markerFrameToLensModelIndexList[markerFrameIndex];
+
+        int runEnd = runStart + 1;
+        while (runEnd < numberOfMarkerErrorsTotal) {
+            IndexPair nextMarkerPair = ud->errorToMarkerList[runEnd];
+            auto nextMarkerFrameIndex =
+                (nextMarkerPair.first * num_lens_frames) +
+                nextMarkerPair.second;
+            if (ud->markerFrameToLensModelIndexList[nextMarkerFrameIndex] !=
+                lensModelIndex) {
+                break;
+            }
+            ++runEnd;
+        }
+
+        if (lensModelIndex != LENS_MODEL_INDEX_NONE) {
+            auto &lensModel = ud->lensModelList[lensModelIndex];
+            const size_t runCount = runEnd - runStart;
+            lensModel->applyModelUndistortBatch(
+                &markerXList[runStart], &markerYList[runStart], runCount,
+                &undistortXList[runStart], &undistortYList[runStart]);
+        }
+
+        runStart = runEnd;
+    }
+
+    ud->undistortedMarkerPosList.resize(numberOfMarkerErrorsTotal * 2);
+    for (int i = 0; i < numberOfMarkerErrorsTotal; ++i) {
+        // Applying the lens distortion model to large input values,
+        // creates NaN undistorted points.
+        double mkr_x = undistortXList[i];
+        double mkr_y = undistortYList[i];
+        if (!std::isfinite(mkr_x)) {
+            mkr_x = markerXList[i];
+        }
+        if (!std::isfinite(mkr_y)) {
+            mkr_y = markerYList[i];
+        }
+        ud->undistortedMarkerPosList[i * 2] = mkr_x;
+        ud->undistortedMarkerPosList[(i * 2) + 1] = mkr_y;
+    }
+    ud->markerPositionsUndistorted = true;
+    return status;
+}
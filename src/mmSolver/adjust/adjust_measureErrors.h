@@ -34,4 +34,25 @@ void measureErrors(const int numberOfErrors, const int numberOfMarkerErrors,
                    double &error_avg, double &error_max, double &error_min,
                    MStatus &status);
 
+// Measure the errors using the MM Scene Graph data owned by 'worker',
+// rather than 'ud'. 'ud' is only read, so this may be called from
+// many threads at once, as long as no lens attributes are solved.
+void measureErrors_mmSceneGraphWorker(
+    const int numberOfErrors, const int numberOfMarkerErrors,
+    const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors,
+    const std::vector<bool> &frameIndexEnable,
+    const std::vector<bool> &errorMeasurements, const double imageWidth,
+    double *errors, SolverData *ud, SceneGraphWorkerData &worker,
+    double &error_avg, double &error_max, double &error_min, MStatus &status);
+
+// Undistort the marker positions once, before solving, so errors
+// can be measured without any lens distortion calculations.
+//
+// Only used when 'SolverOptions::undistortMarkers' is enabled, a
+// lens model is used and no lens attributes are solved. Sets
+// 'SolverData::markerPositionsUndistorted' when the marker
+// positions are undistorted.
+MStatus undistortMarkerPositions(SolverData *ud);
+
 #endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_MEASURE_ERRORS_H
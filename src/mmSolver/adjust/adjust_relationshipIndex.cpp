@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Sparse index of the relationships between marker errors and
+ * parameters.
+ */
+
+#include "adjust_relationshipIndex.h"
+
+// STL
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+bool ErrorToParamIndex::affects(const int markerIndex,
+                                const int paramIndex) const {
+    assert(markerIndex >= 0);
+    assert(markerIndex < numberOfMarkers);
+    const auto begin = markerParamList.cbegin() + markerParamBegin(markerIndex);
+    const auto end = markerParamList.cbegin() + markerParamEnd(markerIndex);
+    return std::binary_search(begin, end, paramIndex);
+}
+
+void errorToParamIndexBegin(const int numberOfParameters,
+                            const int numberOfMarkersHint,
+                            ErrorToParamIndex &out_index) {
+    out_index.clear();
+    out_index.numberOfParameters = numberOfParameters;
+    out_index.markerOffsetList.reserve(numberOfMarkersHint + 1);
+    out_index.markerOffsetList.push_back(0);
+}
+
+void errorToParamIndexAddMarker(const std::vector<int> &paramList,
+                                ErrorToParamIndex &out_index) {
+    assert(std::is_sorted(paramList.cbegin(), paramList.cend()));
+    out_index.markerParamList.insert(out_index.markerParamList.end(),
+                                     paramList.cbegin(), paramList.cend());
+    out_index.markerOffsetList.push_back(
+        static_cast<int>(out_index.markerParamList.size()));
+    ++out_index.numberOfMarkers;
+}
+
+void errorToParamIndexEnd(ErrorToParamIndex &out_index) {
+    const int numberOfMarkers = out_index.numberOfMarkers;
+    const int numberOfParameters = out_index.numberOfParameters;
+    const int numberOfRelationships =
+        static_cast<int>(out_index.markerParamList.size());
+
+    // Count the number of markers for each parameter.
+    std::vector<int> &paramOffsetList = out_index.paramOffsetList;
+    paramOffsetList.assign(numberOfParameters + 1, 0);
+    for (int k = 0; k < numberOfRelationships; ++k) {
+        const int paramIndex = out_index.markerParamList[k];
+        assert(paramIndex >= 0);
+        assert(paramIndex < numberOfParameters);
+        paramOffsetList[paramIndex + 1] += 1;
+    }
+    for (int j = 0; j < numberOfParameters; ++j) {
+        paramOffsetList[j + 1] += paramOffsetList[j];
+    }
+
+    // Markers are visited in ascending order, so each parameter's
+    // markers end up sorted.
+    out_index.paramMarkerList.resize(numberOfRelationships, 0);
+    std::vector<int> paramFillList(paramOffsetList.begin(),
+                                   paramOffsetList.end() - 1);
+    for (int i = 0; i < numberOfMarkers; ++i) {
+        for (int k = out_index.markerParamBegin(i);
+             k < out_index.markerParamEnd(i); ++k) {
+            const int paramIndex = out_index.markerParamList[k];
+            out_index.paramMarkerList[paramFillList[paramIndex]] = i;
+            ++paramFillList[paramIndex];
+        }
+    }
+}
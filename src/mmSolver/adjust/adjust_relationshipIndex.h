@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Sparse index of the relationships between marker errors and
+ * parameters.
+ */
+
+#ifndef MM_SOLVER_CORE_BUNDLE_ADJUST_RELATIONSHIP_INDEX_H
+#define MM_SOLVER_CORE_BUNDLE_ADJUST_RELATIONSHIP_INDEX_H
+
+// STL
+#include <cstddef>
+#include <vector>
+
+// The relationship of each marker error (one marker on one frame,
+// an index into 'errorToMarkerList') to the parameters that can
+// affect it.
+//
+// Only the positive relationships are stored, in Compressed Sparse
+// Row (CSR) format, with a transposed copy so the marker errors
+// affected by a single parameter can be found without scanning all
+// markers. Memory and look-up costs scale with the number of real
+// relationships, not 'numberOfMarkers * numberOfParameters'.
+struct ErrorToParamIndex {
+    int numberOfMarkers;
+    int numberOfParameters;
+
+    // The parameters of marker 'i' are stored in the range
+    // 'markerOffsetList[i]' to 'markerOffsetList[i + 1]' (exclusive)
+    // of 'markerParamList', sorted in ascending order.
+    std::vector<int> markerOffsetList;
+    std::vector<int> markerParamList;
+
+    // The markers of parameter 'j' are stored in the range
+    // 'paramOffsetList[j]' to 'paramOffsetList[j + 1]' (exclusive)
+    // of 'paramMarkerList', sorted in ascending order.
+    std::vector<int> paramOffsetList;
+    std::vector<int> paramMarkerList;
+
+    ErrorToParamIndex() : numberOfMarkers(0), numberOfParameters(0) {}
+
+    size_t numberOfRelationships() const { return markerParamList.size(); }
+
+    int markerParamBegin(const int markerIndex) const {
+        return markerOffsetList[markerIndex];
+    }
+    int markerParamEnd(const int markerIndex) const {
+        return markerOffsetList[markerIndex + 1];
+    }
+
+    int paramMarkerBegin(const int paramIndex) const {
+        return paramOffsetList[paramIndex];
+    }
+    int paramMarkerEnd(const int paramIndex) const {
+        return paramOffsetList[paramIndex + 1];
+    }
+
+    // Does the parameter affect the marker error?
+    bool affects(const int markerIndex, const int paramIndex) const;
+
+    void clear() {
+        numberOfMarkers = 0;
+        numberOfParameters = 0;
+        markerOffsetList.clear();
+        markerParamList.clear();
+        paramOffsetList.clear();
+        paramMarkerList.clear();
+    }
+};
+
+// Start a new (empty) index, ready to have markers appended with
+// 'errorToParamIndexAddMarker'.
+void errorToParamIndexBegin(const int numberOfParameters,
+                            const int numberOfMarkersHint,
+                            ErrorToParamIndex &out_index);
+
+// Append the next marker error, with the (sorted) parameter indices
+// that affect it.
+void errorToParamIndexAddMarker(const std::vector<int> &paramList,
+                                ErrorToParamIndex &out_index);
+
+// Finish building the index, computing the transposed
+// parameter-to-marker lists.
+void errorToParamIndexEnd(ErrorToParamIndex &out_index);
+
+#endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_RELATIONSHIP_INDEX_H
@@ -226,8 +226,7 @@ int countUpNumberOfUnknownParameters(
     std::vector<double> &out_paramLowerBoundList,
     std::vector<double> &out_paramUpperBoundList,
     std::vector<double> &out_paramWeightList,
-    IndexPairList &out_paramToAttrList, BoolList2D &out_paramFrameList,
-    MStatus &out_status) {
+    IndexPairList &out_paramToAttrList, MStatus &out_status) {
     out_status = MStatus::kSuccess;
 
     // Count up number of unknown parameters
@@ -238,7 +237,6 @@ int countUpNumberOfUnknownParameters(
     // Reset data structures, because we assume we start with an empty
     // data structure.
     out_paramToAttrList.clear();
-    out_paramFrameList.clear();
     out_paramLowerBoundList.clear();
     out_paramUpperBoundList.clear();
     out_paramWeightList.clear();
@@ -278,11 +276,6 @@ int countUpNumberOfUnknownParameters(
                 IndexPair attrPair(i, j);
                 out_paramToAttrList.push_back(attrPair);
 
-                // Frame to parameter index mapping.
-                std::vector<bool> frameIndexes(frameList.length(), 0);
-                frameIndexes[j] = true;
-                out_paramFrameList.push_back(frameIndexes);
-
                 // Min / max parameter bounds.
                 double minValue = attr->getMinimumValue();
                 double maxValue = attr->getMaximumValue();
@@ -308,10 +301,6 @@ int countUpNumberOfUnknownParameters(
             IndexPair attrPair(i, -1);
             out_paramToAttrList.push_back(attrPair);
 
-            // Frame to parameter index mapping.
-            std::vector<bool> frameIndexes(frameList.length(), 1);
-            out_paramFrameList.push_back(frameIndexes);
-
             // Min / max parameter bounds.
             double minValue = attr->getMinimumValue();
             double maxValue = attr->getMaximumValue();
@@ -559,63 +548,112 @@ void getMarkerToAttributeRelationship(const MarkerPtrList &markerList,
  * all time values, but a dynamic parameter will be split into
  * many parameters at different frames, each of those dynamic
  * parameters will only affect a small number of errors. Our goal
- * is to compute a boolean for each error and parameter
- * combination, if the boolean is true the relationship is
- * positive, if false, the computation is skipped and the error
- * returned is zero.  This combination is only relevant if the
+ * is to compute the list of parameters for each error, if a
+ * parameter is not in the list, the computation is skipped and the
+ * error returned is zero.  This combination is only relevant if the
  * markerToAttrList is already true, otherwise we can assume
  * such error/parameter combinations will not be required.
+ *
+ * Rather than testing every error against every parameter, the
+ * parameters of each attribute are looked up directly, so the cost
+ * is linear in the number of relationships found.
  */
 void findErrorToParameterRelationship(
     const MarkerPtrList &markerList, const AttrPtrList &attrList,
     const MTimeArray &frameList, const int numParameters,
     const int numMarkerErrors, const IndexPairList &paramToAttrList,
     const IndexPairList &errorToMarkerList, const BoolList2D &markerToAttrList,
-    BoolList2D &out_errorToParamList, MStatus &out_status) {
+    ErrorToParamIndex &out_errorToParamList, MStatus &out_status) {
     out_status = MStatus::kSuccess;
 
-    int numberOfMarkers = numMarkerErrors / ERRORS_PER_MARKER;
-    out_errorToParamList.resize(numberOfMarkers);
-    for (int i = 0; i < numberOfMarkers; ++i) {
-        IndexPair markerIndexPair = errorToMarkerList[i];
-        int markerIndex = markerIndexPair.first;
-        int markerFrameIndex = markerIndexPair.second;
+    const int numberOfMarkers = numMarkerErrors / ERRORS_PER_MARKER;
+    const int numberOfAttrs = static_cast<int>(attrList.size());
+    const int frameCount = static_cast<int>(frameList.length());
+    assert(markerToAttrList.size() == markerList.size());
+    assert(paramToAttrList.size() == static_cast<size_t>(numParameters));
+
+    // The first parameter index of each attribute. The parameters of
+    // an animated attribute are contiguous, one per frame, so the
+    // parameter for frame 'k' is 'attrParamStartList[i] + k'.
+    std::vector<int> attrParamStartList(numberOfAttrs, -1);
+    std::vector<bool> attrAnimatedList(numberOfAttrs, false);
+    for (int j = numParameters - 1; j >= 0; --j) {
+        const IndexPair &attrIndexPair = paramToAttrList[j];
+        attrParamStartList[attrIndexPair.first] = j;
+        attrAnimatedList[attrIndexPair.first] = attrIndexPair.second >= 0;
+    }
 
-        // MarkerPtr marker = markerList[markerIndex];
-        // CameraPtr cam = marker->getCamera();
-        // BundlePtr bundle = marker->getBundle();
-        MTime markerFrame = frameList[markerFrameIndex];
+    // Frames with the same time value. Only markers on the current
+    // frame can affect an animated attribute's parameter, and the
+    // frame list may (in theory) contain the same time more than
+    // once.
+    std::vector<int> sortedFrameIndexList(frameCount, 0);
+    for (int k = 0; k < frameCount; ++k) {
+        sortedFrameIndexList[k] = k;
+    }
+    std::stable_sort(sortedFrameIndexList.begin(), sortedFrameIndexList.end(),
+                     [&frameList](const int a, const int b) {
+                         return frameList[a].value() < frameList[b].value();
+                     });
+    std::vector<int> frameGroupList(frameCount, 0);
+    std::vector<std::vector<int>> frameGroupIndexList;
+    for (int k = 0; k < frameCount; ++k) {
+        const int frameIndex = sortedFrameIndexList[k];
+        const bool newGroup =
+            (k == 0) ||
+            !number::isApproxEqual<double>(
+                frameList[sortedFrameIndexList[k - 1]].value(),
+                frameList[frameIndex].value());
+        if (newGroup) {
+            frameGroupIndexList.push_back(std::vector<int>());
+        }
+        const int groupIndex = static_cast<int>(frameGroupIndexList.size()) - 1;
+        frameGroupList[frameIndex] = groupIndex;
+        frameGroupIndexList[groupIndex].push_back(frameIndex);
+    }
+    for (auto &frameIndexList : frameGroupIndexList) {
+        std::sort(frameIndexList.begin(), frameIndexList.end());
+    }
 
-        // Determine if the marker can affect the attribute.
-        out_errorToParamList[i].resize(numParameters, false);
-        for (int j = 0; j < numParameters; ++j) {
-            IndexPair attrIndexPair = paramToAttrList[j];
-            int attrIndex = attrIndexPair.first;
-            int attrFrameIndex = attrIndexPair.second;
-
-            // If the attrFrameIndex is -1, then the attribute is
-            // static, not animated.
-            // AttrPtr attr = attrList[attrIndex];
-            MTime attrFrame(-1.0, MTime::uiUnit());
-            if (attrFrameIndex >= 0) {
-                attrFrame = frameList[attrFrameIndex];
+    // The attributes affected by each marker, in ascending order.
+    std::vector<std::vector<int>> markerAttrList(markerToAttrList.size());
+    for (size_t i = 0; i < markerToAttrList.size(); ++i) {
+        const std::vector<bool> &attrAffectsList = markerToAttrList[i];
+        for (int j = 0; j < numberOfAttrs; ++j) {
+            if (attrAffectsList[j] && (attrParamStartList[j] >= 0)) {
+                markerAttrList[i].push_back(j);
             }
+        }
+    }
 
-            bool markerAffectsAttr = markerToAttrList[markerIndex][attrIndex];
-            bool paramAffectsError = markerAffectsAttr;
-            if (paramAffectsError == true) {
-                // Time based mapping information.
-                // Only markers on the current frame can affect the current
-                // attribute.
-                if (attrFrameIndex >= 0) {
-                    paramAffectsError = number::isApproxEqual<double>(
-                        markerFrame.value(), attrFrame.value());
-                } else {
-                    paramAffectsError = true;
+    errorToParamIndexBegin(numParameters, numberOfMarkers,
+                           out_errorToParamList);
+    std::vector<int> paramList;
+    for (int i = 0; i < numberOfMarkers; ++i) {
+        const IndexPair &markerIndexPair = errorToMarkerList[i];
+        const int markerIndex = markerIndexPair.first;
+        const int markerFrameIndex = markerIndexPair.second;
+        const std::vector<int> &frameIndexList =
+            frameGroupIndexList[frameGroupList[markerFrameIndex]];
+
+        // Attributes (and their parameters) are stored in the same
+        // order, so the parameter list is created sorted.
+        paramList.clear();
+        for (const int attrIndex : markerAttrList[markerIndex]) {
+            const int paramStart = attrParamStartList[attrIndex];
+            if (attrAnimatedList[attrIndex]) {
+                for (const int frameIndex : frameIndexList) {
+                    const int paramIndex = paramStart + frameIndex;
+                    assert(paramToAttrList[paramIndex].first == attrIndex);
+                    assert(paramToAttrList[paramIndex].second == frameIndex);
+                    paramList.push_back(paramIndex);
                 }
+            } else {
+                paramList.push_back(paramStart);
             }
-            out_errorToParamList[i][j] = paramAffectsError;
         }
+        errorToParamIndexAddMarker(paramList, out_errorToParamList);
     }
+    errorToParamIndexEnd(out_errorToParamList);
     return;
 }
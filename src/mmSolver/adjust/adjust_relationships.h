@@ -41,6 +41,7 @@
 // MM Solver
 #include "adjust_data.h"
 #include "adjust_defines.h"
+#include "adjust_relationshipIndex.h"
 #include "adjust_solveFunc.h"
 #include "mmSolver/mayahelper/maya_attr.h"
 #include "mmSolver/mayahelper/maya_bundle.h"
@@ -68,8 +69,7 @@ int countUpNumberOfUnknownParameters(
     std::vector<double> &out_paramLowerBoundList,
     std::vector<double> &out_paramUpperBoundList,
     std::vector<double> &out_paramWeightList,
-    IndexPairList &out_paramToAttrList, BoolList2D &out_paramFrameList,
-    MStatus &out_status);
+    IndexPairList &out_paramToAttrList, MStatus &out_status);
 
 void findMarkerToAttributeRelationship(const MarkerPtrList &markerList,
                                        const AttrPtrList &attrList,
@@ -86,6 +86,6 @@ void findErrorToParameterRelationship(
     const MTimeArray &frameList, const int numParameters,
     const int numMarkerErrors, const IndexPairList &paramToAttrList,
     const IndexPairList &errorToMarkerList, const BoolList2D &markerToAttrList,
-    BoolList2D &out_errorToParamList, MStatus &out_status);
+    ErrorToParamIndex &out_errorToParamList, MStatus &out_status);
 
 #endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_RELATIONSHIPS_H
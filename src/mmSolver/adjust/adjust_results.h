@@ -88,6 +88,8 @@ struct SolverResult {
 
     void add(const Self &other) {
         Self::success = std::min(Self::success, other.success);
+        Self::user_interrupted =
+            Self::user_interrupted || other.user_interrupted;
 
         Self::errorFinal += other.errorFinal;
         Self::errorAvg += other.errorAvg;
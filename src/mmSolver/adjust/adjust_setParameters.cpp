@@ -109,16 +109,20 @@ MStatus setParameters_mayaDag(const int numberOfParameters,
             auto solverAttrType = attr->getSolverAttrType();
             if (frameIndex != -1) {
                 // Animated attribute.
-                auto lensModel =
-                    ud->attrFrameToLensModelList[attrIndex + frameIndex];
+                auto attrFrameIndex = (attrIndex * num_frames) + frameIndex;
+                auto lensModelIndex =
+                    ud->attrFrameToLensModelIndexList[attrFrameIndex];
+                auto &lensModel = ud->lensModelList[lensModelIndex];
                 status = mmsolver::setLensModelAttributeValue(
                     lensModel, solverAttrType, real_value);
                 CHECK_MSTATUS_AND_RETURN_IT(status);
             } else {
                 // Static attribute.
                 for (int j = 0; j < num_frames; ++j) {
-                    auto lensModel =
-                        ud->attrFrameToLensModelList[attrIndex + j];
+                    auto attrFrameIndex = (attrIndex * num_frames) + j;
+                    auto lensModelIndex =
+                        ud->attrFrameToLensModelIndexList[attrFrameIndex];
+                    auto &lensModel = ud->lensModelList[lensModelIndex];
                     status = mmsolver::setLensModelAttributeValue(
                         lensModel, solverAttrType, real_value);
                     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -171,84 +175,163 @@ MStatus setParameters_mayaDag(const int numberOfParameters,
     return status;
 }
 
-MStatus setParameters_mmSceneGraph(const int numberOfParameters,
-                                   const double *parameters, SolverData *ud) {
+void constructSceneGraphParameterList(SolverData &ud) {
+    ud.mmsgParamIndexList.clear();
+    ud.mmsgParamAttrIdList.clear();
+    ud.mmsgParamFrameList.clear();
+    ud.mmsgLensParamIndexList.clear();
+
+    const int numberOfParameters = static_cast<int>(ud.paramToAttrList.size());
+    for (int i = 0; i < numberOfParameters; ++i) {
+        const IndexPair attrPair = ud.paramToAttrList[i];
+        auto attrIndex = attrPair.first;
+        auto frameIndex = attrPair.second;
+
+#if MMSOLVER_LENS_DISTORTION == 1 && \
+    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
+        AttrPtr attr = ud.attrList[attrIndex];
+        const auto object_type = attr->getObjectType();
+        if (object_type == ObjectType::kLens) {
+            ud.mmsgLensParamIndexList.push_back(i);
+            continue;
+        }
+#endif
+
+        mmsg::FrameValue frame = 0;
+        if (frameIndex != -1) {
+            frame = ud.mmsgFrameList[frameIndex];
+        }
+
+        ud.mmsgParamIndexList.push_back(i);
+        ud.mmsgParamAttrIdList.push_back(ud.mmsgAttrIdList[attrIndex]);
+        ud.mmsgParamFrameList.push_back(frame);
+    }
+}
+
+MStatus setParameters_mmSceneGraph(
+    const int numberOfParameters, const double *parameters, SolverData *ud,
+    mmsg::AttrDataBlock &out_attrDataBlock,
+    std::vector<mmsg::Real> &out_paramValueList,
+    std::vector<uint8_t> &out_paramChangedList,
+    std::vector<mmsg::AttrId> &out_dirtyAttrList,
+    std::vector<mmsg::FrameValue> &out_dirtyFrameList) {
     MStatus status = MS::kSuccess;
+    assert(static_cast<size_t>(numberOfParameters) ==
+           (ud->mmsgParamIndexList.size() +
+            ud->mmsgLensParamIndexList.size()));
 
-    uint32_t lensModelAttrsSet = 0;
+#if MMSOLVER_LENS_DISTORTION == 1 && \
+    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
     auto num_frames = ud->mmsgFrameList.size();
-    for (int i = 0; i < numberOfParameters; ++i) {
+    for (const int i : ud->mmsgLensParamIndexList) {
         const IndexPair attrPair = ud->paramToAttrList[i];
         auto attrIndex = attrPair.first;
         auto frameIndex = attrPair.second;
 
         AttrPtr attr = ud->attrList[attrIndex];
-
         const double offset = attr->getOffsetValue();
         const double scale = attr->getScaleValue();
         const double xmin = attr->getMinimumValue();
         const double xmax = attr->getMaximumValue();
-        // The solver value is used inside the solver to compute the
-        // result, but is not the true value that will be set on the
-        // attribute at the end of the solve.
-        const double solver_value = parameters[i];
         const double real_value = parameterBoundFromInternalToExternal(
-            solver_value, xmin, xmax, offset, scale);
+            parameters[i], xmin, xmax, offset, scale);
 
-#if MMSOLVER_LENS_DISTORTION == 1 && \
-    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
-        const auto object_type = attr->getObjectType();
-        if (object_type == ObjectType::kLens) {
-            auto solverAttrType = attr->getSolverAttrType();
-            if (frameIndex != -1) {
-                // Animated attribute.
-                auto lensModel =
-                    ud->attrFrameToLensModelList[attrIndex + frameIndex];
+        auto solverAttrType = attr->getSolverAttrType();
+        if (frameIndex != -1) {
+            // Animated attribute.
+            auto attrFrameIndex = (attrIndex * num_frames) + frameIndex;
+            auto lensModelIndex =
+                ud->attrFrameToLensModelIndexList[attrFrameIndex];
+            auto &lensModel = ud->lensModelList[lensModelIndex];
+            status = mmsolver::setLensModelAttributeValue(
+                lensModel, solverAttrType, real_value);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+        } else {
+            // Static attribute.
+            for (int j = 0; j < num_frames; ++j) {
+                auto attrFrameIndex = (attrIndex * num_frames) + j;
+                auto lensModelIndex =
+                    ud->attrFrameToLensModelIndexList[attrFrameIndex];
+                auto &lensModel = ud->lensModelList[lensModelIndex];
                 status = mmsolver::setLensModelAttributeValue(
                     lensModel, solverAttrType, real_value);
                 CHECK_MSTATUS_AND_RETURN_IT(status);
-            } else {
-                // Static attribute.
-                for (int j = 0; j < num_frames; ++j) {
-                    auto lensModel =
-                        ud->attrFrameToLensModelList[attrIndex + j];
-                    status = mmsolver::setLensModelAttributeValue(
-                        lensModel, solverAttrType, real_value);
-                    CHECK_MSTATUS_AND_RETURN_IT(status);
-                }
             }
-            lensModelAttrsSet += 1;
-            continue;
         }
+    }
 #endif
 
-        mmsg::FrameValue frame = 0;
-        if (frameIndex != -1) {
-            frame = ud->mmsgFrameList[frameIndex];
-        }
+    // The solver value is used inside the solver to compute the
+    // result, but is not the true value that will be set on the
+    // attribute at the end of the solve.
+    const size_t numberOfSceneGraphParameters = ud->mmsgParamIndexList.size();
+    out_paramValueList.resize(numberOfSceneGraphParameters);
+    for (size_t k = 0; k < numberOfSceneGraphParameters; ++k) {
+        const int i = ud->mmsgParamIndexList[k];
+        const IndexPair attrPair = ud->paramToAttrList[i];
+        AttrPtr attr = ud->attrList[attrPair.first];
 
-        mmsg::AttrId attrId = ud->mmsgAttrIdList[attrIndex];
-        auto ok =
-            ud->mmsgAttrDataBlock.set_attr_value(attrId, frame, real_value);
-        if (!ok) {
-            status = MS::kFailure;
+        const double offset = attr->getOffsetValue();
+        const double scale = attr->getScaleValue();
+        const double xmin = attr->getMinimumValue();
+        const double xmax = attr->getMaximumValue();
+        out_paramValueList[k] = parameterBoundFromInternalToExternal(
+            parameters[i], xmin, xmax, offset, scale);
+    }
 
+    // Set all values with a single call into the MM Scene Graph.
+    auto ok = out_attrDataBlock.set_attr_values(
+        ud->mmsgParamAttrIdList, ud->mmsgParamFrameList, out_paramValueList,
+        out_paramChangedList);
+    if (!ok) {
+        status = MS::kFailure;
+        for (size_t k = 0; k < numberOfSceneGraphParameters; ++k) {
+            const double real_value = out_paramValueList[k];
+            if (std::isfinite(real_value)) {
+                continue;
+            }
+
+            const int i = ud->mmsgParamIndexList[k];
+            const IndexPair attrPair = ud->paramToAttrList[i];
+            AttrPtr attr = ud->attrList[attrPair.first];
             MString attr_name = attr->getName();
             auto attr_name_char = attr_name.asChar();
-
             MMSOLVER_MAYA_ERR(
                 "setParameters (MMSG) was given an invalid value to set:"
                 << " attr name=" << attr_name_char
-                << " solver value=" << solver_value
-                << " bound value=" << real_value << " offset=" << offset
-                << " scale=" << scale << " min=" << xmin << " max=" << xmax);
+                << " solver value=" << parameters[i]
+                << " bound value=" << real_value
+                << " offset=" << attr->getOffsetValue()
+                << " scale=" << attr->getScaleValue()
+                << " min=" << attr->getMinimumValue()
+                << " max=" << attr->getMaximumValue());
             break;
         }
+        return status;
+    }
+
+    // Unchanged values do not need to be re-evaluated.
+    for (size_t k = 0; k < numberOfSceneGraphParameters; ++k) {
+        if (out_paramChangedList[k] != 0) {
+            out_dirtyAttrList.push_back(ud->mmsgParamAttrIdList[k]);
+            out_dirtyFrameList.push_back(ud->mmsgParamFrameList[k]);
+        }
     }
 
     return status;
 }
 
+MStatus setParameters_mmSceneGraphWorker(const int numberOfParameters,
+                                         const double *parameters,
+                                         SolverData *ud,
+                                         SceneGraphWorkerData &worker) {
+    assert(ud->solverOptions->sceneGraphMode == SceneGraphMode::kMMSceneGraph);
+    return setParameters_mmSceneGraph(
+        numberOfParameters, parameters, ud, worker.attrDataBlock,
+        worker.paramValueList, worker.paramChangedList, worker.dirtyAttrList,
+        worker.dirtyFrameList);
+}
+
 // Set Parameter values
 MStatus setParameters(const int numberOfParameters, const double *parameters,
                       SolverData *ud) {
@@ -258,7 +341,10 @@ MStatus setParameters(const int numberOfParameters, const double *parameters,
     if (sceneGraphMode == SceneGraphMode::kMayaDag) {
         status = setParameters_mayaDag(numberOfParameters, parameters, ud);
     } else if (sceneGraphMode == SceneGraphMode::kMMSceneGraph) {
-        status = setParameters_mmSceneGraph(numberOfParameters, parameters, ud);
+        status = setParameters_mmSceneGraph(
+            numberOfParameters, parameters, ud, ud->mmsgAttrDataBlock,
+            ud->mmsgParamValueList, ud->mmsgParamChangedList,
+            ud->mmsgDirtyAttrList, ud->mmsgDirtyFrameList);
     } else {
         MMSOLVER_MAYA_ERR("setParameters failed, invalid SceneGraphMode: "
                           << static_cast<int>(sceneGraphMode));
@@ -26,7 +26,19 @@
 
 #include "adjust_data.h"
 
+// Resolve the MM Scene Graph attribute and frame of each parameter,
+// used by 'setParameters' to set all values at once.
+void constructSceneGraphParameterList(SolverData &ud);
+
 MStatus setParameters(const int numberOfParameters, const double *parameters,
                       SolverData *ud);
 
+// Set the parameters into the MM Scene Graph data owned by 'worker',
+// rather than 'ud'. 'ud' is only read, so this may be called from
+// many threads at once, as long as no lens attributes are solved.
+MStatus setParameters_mmSceneGraphWorker(const int numberOfParameters,
+                                         const double *parameters,
+                                         SolverData *ud,
+                                         SceneGraphWorkerData &worker);
+
 #endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_SET_PARAMETERS_H
@@ -28,6 +28,7 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
@@ -36,6 +37,7 @@
 #include <limits>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 // Maya
@@ -188,43 +190,59 @@ double calculateParameterDelta(const double value, const double delta,
  */
 void determineMarkersToBeEvaluated(
     const int numberOfParameters, const int numberOfMarkers, const double delta,
-    const std::vector<double> previousParamList, const double *parameters,
-    const std::vector<std::vector<bool>> &errorToParamList,
+    const std::vector<double> &previousParamList, const double *parameters,
+    const ErrorToParamIndex &errorToParamList,
     std::vector<bool> &out_evalMeasurements) {
-    std::vector<int> evalCount(numberOfMarkers, 0);
+    assert(errorToParamList.numberOfMarkers == numberOfMarkers);
+    assert(errorToParamList.numberOfParameters == numberOfParameters);
+    out_evalMeasurements.assign((unsigned long)numberOfMarkers, false);
 
-    // Get all parameters that have changed.
+    // Find the markers affected by the parameters that have changed.
     double approxDelta = std::fabs(delta) * 0.5;
     bool noneChanged = true;
-    std::vector<bool> paramChangedList(numberOfParameters, false);
     for (int i = 0; i < numberOfParameters; ++i) {
         bool changed = !number::isApproxEqual<double>(
             parameters[i], previousParamList[i], approxDelta);
-        paramChangedList[i] = changed;
         if (changed) {
             noneChanged = false;
+            for (int k = errorToParamList.paramMarkerBegin(i);
+                 k < errorToParamList.paramMarkerEnd(i); ++k) {
+                out_evalMeasurements[errorToParamList.paramMarkerList[k]] =
+                    true;
+            }
         }
     }
 
-    // Find if a marker does not need to be updated at all.
-    for (int i = 0; i < numberOfParameters; ++i) {
-        bool changed = paramChangedList[i];
-        if (noneChanged == true) {
-            changed = true;
-        }
+    // When no parameters have changed, every marker that can be
+    // affected by any parameter is evaluated.
+    if (noneChanged) {
         for (int j = 0; j < numberOfMarkers; ++j) {
-            if (changed && errorToParamList[j][i]) {
-                evalCount[j] = evalCount[j] + 1;
-            }
+            out_evalMeasurements[j] = errorToParamList.markerParamBegin(j) !=
+                                      errorToParamList.markerParamEnd(j);
         }
     }
+    return;
+}
+
+// Set the progress bar value, when the solve is on the main thread.
+void setSolveProgress(SolverData *userData, const int value) {
+    if (userData->computation != nullptr) {
+        userData->computation->setProgress(value);
+    }
+}
 
-    // Convert evalCount to list of bools
-    out_evalMeasurements.resize((unsigned long)numberOfMarkers, false);
-    for (size_t i = 0; i < evalCount.size(); ++i) {
-        out_evalMeasurements[i] = static_cast<bool>(evalCount[i] > 0);
+// Has the user asked to cancel the solve?
+//
+// Only the main thread may query Maya; a solve on another thread
+// is cancelled by the main thread.
+bool isSolveInterruptRequested(SolverData *userData) {
+    if (userData->computation != nullptr) {
+        return userData->computation->isInterruptRequested();
     }
-    return;
+    if (userData->cancelRequested != nullptr) {
+        return userData->cancelRequested->load();
+    }
+    return false;
 }
 
 // Add another 'normal function' evaluation to the count.
@@ -304,6 +322,35 @@ int solveFunc_measureErrors(
     return SOLVE_FUNC_SUCCESS;
 }
 
+// Set the finite-difference values for parameter column 'i' of the
+// Jacobian.
+//
+// Only the errors that the relationship data says can be affected by
+// the parameter are computed and stored in the sparse Jacobian. If a
+// dense 'jacobian' (column-major, 'ldfjac' rows) is given, the column
+// is zeroed and the same non-zero values are written into it.
+void setJacobianColumn(const int i, const int ldfjac,
+                       const int numberOfErrors, const double inv_delta,
+                       const double *errorsA, const double *errorsB,
+                       SparseJacobian &sparseJacobian, double *jacobian) {
+    double *column = nullptr;
+    if (jacobian != nullptr) {
+        column = jacobian + (static_cast<size_t>(i) * ldfjac);
+        std::fill(column, column + numberOfErrors, 0.0);
+    }
+
+    const int start = sparseJacobian.columnOffsetList[i];
+    const int end = sparseJacobian.columnOffsetList[i + 1];
+    for (int k = start; k < end; ++k) {
+        const int j = sparseJacobian.rowIndexList[k];
+        const double x = (errorsA[j] - errorsB[j]) * inv_delta;
+        sparseJacobian.valueList[k] = x;
+        if (column != nullptr) {
+            column[j] = x;
+        }
+    }
+}
+
 int solveFunc_calculateJacobianMatrixForParameter(
     const int i, const int progressMin, const int progressMax,
     std::vector<double> &paramListA, std::vector<double> &errorListA,
@@ -318,9 +365,9 @@ int solveFunc_calculateJacobianMatrixForParameter(
 
     const double ratio = (double)i / (double)numberOfParameters;
     int progressNum = progressMin + static_cast<int>(ratio * progressMax);
-    userData->computation->setProgress(progressNum);
+    setSolveProgress(userData, progressNum);
 
-    if (userData->computation->isInterruptRequested()) {
+    if (isSolveInterruptRequested(userData)) {
         MMSOLVER_MAYA_WRN("User wants to cancel the evaluation!");
         userData->userInterrupted = true;
         return SOLVE_FUNC_FAILURE;
@@ -353,7 +400,14 @@ int solveFunc_calculateJacobianMatrixForParameter(
     const double value = parameters[i];
     const double deltaA = calculateParameterDelta(value, delta, 1, attr);
 
-    std::vector<bool> frameIndexEnabled = userData->paramFrameList[i];
+    // Static parameters affect all frames, animated parameters
+    // affect only their own frame.
+    const int paramFrameIndex = attrPair.second;
+    std::vector<bool> frameIndexEnabled(userData->frameList.length(),
+                                        paramFrameIndex < 0);
+    if (paramFrameIndex >= 0) {
+        frameIndexEnabled[paramFrameIndex] = true;
+    }
 
     incrementJacobianIteration(userData);
     paramListA[i] = paramListA[i] + deltaA;
@@ -397,12 +451,8 @@ int solveFunc_calculateJacobianMatrixForParameter(
         // Set the Jacobian matrix using the previously
         // calculated errors (original and A).
         const double inv_delta = 1.0 / deltaA;
-        for (size_t j = 0; j < errorListA.size(); ++j) {
-            const size_t num = (i * ldfjac) + j;
-            const double x = (errorListA[j] - errors[j]) * inv_delta;
-            userData->jacobianList[num] = x;
-            jacobian[num] = x;
-        }
+        setJacobianColumn(i, ldfjac, numberOfErrors, inv_delta, &errorListA[0],
+                          errors, userData->jacobian, jacobian);
 
     } else if (autoDiffType == AUTO_DIFF_TYPE_CENTRAL) {
         assert(userData->solverOptions->solverSupportsAutoDiffCentral);
@@ -422,12 +472,9 @@ int solveFunc_calculateJacobianMatrixForParameter(
             // Set the Jacobian matrix using the previously
             // calculated errors (original and A).
             const double inv_delta = 1.0 / deltaA;
-            for (size_t j = 0; j < errorListA.size(); ++j) {
-                const size_t num = (i * ldfjac) + j;
-                const double x = (errorListA[j] - errors[j]) * inv_delta;
-                userData->jacobianList[num] = x;
-                jacobian[num] = x;
-            }
+            setJacobianColumn(i, ldfjac, numberOfErrors, inv_delta,
+                              &errorListA[0], errors, userData->jacobian,
+                              jacobian);
         } else {
             incrementJacobianIteration(userData);
             paramListB[i] = paramListB[i] + deltaB;
@@ -468,18 +515,248 @@ int solveFunc_calculateJacobianMatrixForParameter(
             // calculated errors (A and B).
             assert(errorListA.size() == errorListB.size());
             double inv_delta = 0.5 / (std::fabs(deltaA) + std::fabs(deltaB));
-            for (size_t j = 0; j < errorListA.size(); ++j) {
-                size_t num = (i * ldfjac) + j;
-                double x = (errorListA[j] - errorListB[j]) * inv_delta;
-                userData->jacobianList[num] = x;
-                jacobian[num] = x;
-            }
+            setJacobianColumn(i, ldfjac, numberOfErrors, inv_delta,
+                              &errorListA[0], &errorListB[0],
+                              userData->jacobian, jacobian);
         }
     }
 
     return SOLVE_FUNC_SUCCESS;
 }
 
+// Calculate Jacobian column 'i' using the MM Scene Graph data owned
+// by 'worker', with pre-computed delta values.
+//
+// The result is exactly the same as
+// 'solveFunc_calculateJacobianMatrixForParameter', but the shared
+// 'userData' is only read, so many columns can be computed at once.
+void solveFunc_calculateJacobianMatrixForParameterWorker(
+    const int i, const double deltaA, const double deltaB,
+    const std::vector<bool> &evalMeasurements, const int autoDiffType,
+    const int ldfjac, const int numberOfMarkerErrors,
+    const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors, const double imageWidth,
+    const int numberOfParameters, const int numberOfErrors,
+    const double *parameters, double *errors, double *jacobian,
+    SolverData *userData, SceneGraphWorkerData &worker) {
+    MStatus status;
+
+    std::vector<double> &paramListA = worker.paramListA;
+    std::vector<double> &errorListA = worker.errorListA;
+    paramListA.assign(parameters, parameters + numberOfParameters);
+    errorListA.assign(errors, errors + numberOfErrors);
+
+    // Static parameters affect all frames, animated parameters
+    // affect only their own frame.
+    const int paramFrameIndex = userData->paramToAttrList[i].second;
+    std::vector<bool> frameIndexEnabled(userData->frameList.length(),
+                                        paramFrameIndex < 0);
+    if (paramFrameIndex >= 0) {
+        frameIndexEnabled[paramFrameIndex] = true;
+    }
+
+    double error_avg_tmp = 0;
+    double error_max_tmp = 0;
+    double error_min_tmp = 0;
+
+    paramListA[i] = paramListA[i] + deltaA;
+    status = setParameters_mmSceneGraphWorker(numberOfParameters,
+                                              &paramListA[0], userData, worker);
+    measureErrors_mmSceneGraphWorker(
+        numberOfErrors, numberOfMarkerErrors, numberOfAttrStiffnessErrors,
+        numberOfAttrSmoothnessErrors, frameIndexEnabled, evalMeasurements,
+        imageWidth, &errorListA[0], userData, worker, error_avg_tmp,
+        error_max_tmp, error_min_tmp, status);
+
+    if ((autoDiffType == AUTO_DIFF_TYPE_FORWARD) || (deltaA == deltaB)) {
+        const double inv_delta = 1.0 / deltaA;
+        setJacobianColumn(i, ldfjac, numberOfErrors, inv_delta, &errorListA[0],
+                          errors, userData->jacobian, jacobian);
+        return;
+    }
+
+    assert(autoDiffType == AUTO_DIFF_TYPE_CENTRAL);
+    std::vector<double> &paramListB = worker.paramListB;
+    std::vector<double> &errorListB = worker.errorListB;
+    paramListB.assign(parameters, parameters + numberOfParameters);
+    errorListB.assign(numberOfErrors, 0.0);
+
+    paramListB[i] = paramListB[i] + deltaB;
+    status = setParameters_mmSceneGraphWorker(numberOfParameters,
+                                              &paramListB[0], userData, worker);
+    measureErrors_mmSceneGraphWorker(
+        numberOfErrors, numberOfMarkerErrors, numberOfAttrStiffnessErrors,
+        numberOfAttrSmoothnessErrors, frameIndexEnabled, evalMeasurements,
+        imageWidth, &errorListB[0], userData, worker, error_avg_tmp,
+        error_max_tmp, error_min_tmp, status);
+
+    double inv_delta = 0.5 / (std::fabs(deltaA) + std::fabs(deltaB));
+    setJacobianColumn(i, ldfjac, numberOfErrors, inv_delta, &errorListA[0],
+                      &errorListB[0], userData->jacobian, jacobian);
+    return;
+}
+
+// How many threads can be used to calculate the Jacobian matrix?
+//
+// Returns 1 when the Jacobian must be calculated serially.
+int calculateJacobianThreadCount(const int numberOfParameters,
+                                 SolverData *userData) {
+    if (userData->solverOptions->sceneGraphMode !=
+        SceneGraphMode::kMMSceneGraph) {
+        // The Maya DAG can only be evaluated on the main thread.
+        return 1;
+    }
+
+    // Lens models are shared by all threads, and are changed when a
+    // lens attribute is set.
+    for (const AttrPtr &attr : userData->attrList) {
+        if (attr->getObjectType() == ObjectType::kLens) {
+            return 1;
+        }
+    }
+
+    int threadCount = userData->solverOptions->jacobianThreadCount;
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+    }
+
+    // The last parameter is always calculated on the main thread.
+    threadCount = std::min(threadCount, numberOfParameters - 1);
+    return std::max(threadCount, 1);
+}
+
+// Calculate the Jacobian matrix with 'threadCount' threads, each
+// evaluating a copy of the MM Scene Graph.
+//
+// The values are exactly the same as computed serially. Deltas and
+// iteration counts are computed on the main thread in the serial
+// order, and the last parameter is computed with
+// 'solveFunc_calculateJacobianMatrixForParameter' on the shared
+// data, so 'userData' is left exactly as the serial loop leaves it.
+int solveFunc_calculateJacobianMatrixThreaded(
+    const int threadCount, const int progressMin, const int progressMax,
+    const std::vector<bool> &evalMeasurements, const int autoDiffType,
+    const int ldfjac, const int numberOfMarkerErrors,
+    const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors, const double imageWidth,
+    const int numberOfParameters, const int numberOfErrors,
+    const double *parameters, double *errors, double *jacobian,
+    SolverData *userData, SolverTimer &timer) {
+    assert(threadCount > 1);
+    assert(numberOfParameters > threadCount);
+    const int numberOfThreadedParameters = numberOfParameters - 1;
+
+    const double delta = userData->solverOptions->delta;
+    assert(delta > 0.0);
+    std::vector<double> deltaAList(numberOfThreadedParameters, 0.0);
+    std::vector<double> deltaBList(numberOfThreadedParameters, 0.0);
+    for (int i = 0; i < numberOfThreadedParameters; ++i) {
+        IndexPair attrPair = userData->paramToAttrList[i];
+        AttrPtr attr = userData->attrList[attrPair.first];
+        const double value = parameters[i];
+        const double deltaA = calculateParameterDelta(value, delta, 1, attr);
+        double deltaB = deltaA;
+        incrementJacobianIteration(userData);
+        if (autoDiffType == AUTO_DIFF_TYPE_CENTRAL) {
+            deltaB = calculateParameterDelta(value, delta, -1, attr);
+            if (deltaA != deltaB) {
+                incrementJacobianIteration(userData);
+            }
+        }
+        deltaAList[i] = deltaA;
+        deltaBList[i] = deltaB;
+    }
+
+#if MMSOLVER_LENS_DISTORTION == 1 && \
+    MMSOLVER_LENS_DISTORTION_MM_SCENE_GRAPH == 1
+    // Lens models compute cached values on first use; do that now,
+    // so the threads only read the lens models.
+    for (auto &lensModel : userData->lensModelList) {
+        if (lensModel) {
+            double out_x = 0.0;
+            double out_y = 0.0;
+            lensModel->applyModelDistort(0.0, 0.0, out_x, out_y);
+        }
+    }
+#endif
+
+    // The worker data is kept for the next Jacobian evaluation. The
+    // values of all parameters are set for every column, so the
+    // copies never become stale.
+    std::vector<SceneGraphWorkerData> &workerList = userData->mmsgWorkerList;
+    while (workerList.size() < static_cast<size_t>(threadCount)) {
+        SceneGraphWorkerData worker;
+        worker.attrDataBlock = userData->mmsgAttrDataBlock.clone();
+        worker.flatScene = userData->mmsgFlatScene.clone();
+        // The columns are already evaluated concurrently, so each
+        // copy of the scene evaluates all frames on its own thread.
+        worker.flatScene.set_frame_parallel_grain_size(0);
+        worker.dirtyAttrList = userData->mmsgDirtyAttrList;
+        worker.dirtyFrameList = userData->mmsgDirtyFrameList;
+        worker.errorList.resize(userData->errorList.size(), 0.0);
+        worker.errorDistanceList.resize(userData->errorDistanceList.size(),
+                                        0.0);
+        workerList.push_back(std::move(worker));
+    }
+
+    std::atomic<int> nextParameter(0);
+    std::atomic<bool> interrupted(false);
+    auto computeColumns = [&](const int workerIndex) {
+        SceneGraphWorkerData &worker = workerList[workerIndex];
+        while (!interrupted) {
+            const int i = nextParameter.fetch_add(1);
+            if (i >= numberOfThreadedParameters) {
+                break;
+            }
+
+            if (workerIndex == 0) {
+                // Only the main thread may use the Maya API.
+                const double ratio = (double)i / (double)numberOfParameters;
+                int progressNum =
+                    progressMin + static_cast<int>(ratio * progressMax);
+                setSolveProgress(userData, progressNum);
+
+                if (isSolveInterruptRequested(userData)) {
+                    MMSOLVER_MAYA_WRN("User wants to cancel the evaluation!");
+                    userData->userInterrupted = true;
+                    interrupted = true;
+                    break;
+                }
+            }
+
+            solveFunc_calculateJacobianMatrixForParameterWorker(
+                i, deltaAList[i], deltaBList[i], evalMeasurements,
+                autoDiffType, ldfjac, numberOfMarkerErrors,
+                numberOfAttrStiffnessErrors, numberOfAttrSmoothnessErrors,
+                imageWidth, numberOfParameters, numberOfErrors, parameters,
+                errors, jacobian, userData, worker);
+        }
+    };
+
+    std::vector<std::thread> threadList;
+    threadList.reserve(threadCount - 1);
+    for (int t = 1; t < threadCount; ++t) {
+        threadList.push_back(std::thread(computeColumns, t));
+    }
+    computeColumns(0);
+    for (std::thread &thread : threadList) {
+        thread.join();
+    }
+    if (interrupted) {
+        return SOLVE_FUNC_FAILURE;
+    }
+
+    std::vector<double> paramListA(numberOfParameters, 0);
+    std::vector<double> errorListA(numberOfErrors, 0);
+    return solveFunc_calculateJacobianMatrixForParameter(
+        numberOfThreadedParameters, progressMin, progressMax, paramListA,
+        errorListA, evalMeasurements, autoDiffType, ldfjac,
+
+        numberOfMarkerErrors, numberOfAttrStiffnessErrors,
+        numberOfAttrSmoothnessErrors, imageWidth, numberOfParameters,
+        numberOfErrors, parameters, errors, jacobian, userData, timer);
+}
+
 // Calculate Jacobian Matrix
 int solveFunc_calculateJacobianMatrix(
     const int numberOfMarkerErrors, const int numberOfAttrStiffnessErrors,
@@ -488,7 +765,10 @@ int solveFunc_calculateJacobianMatrix(
     const int numberOfParameters, const int numberOfErrors,
     const double *parameters, double *errors, double *jacobian,
     SolverData *userData, SolverTimer &timer) {
-    assert(userData->solverOptions->solverType == SOLVER_TYPE_CMINPACK_LMDER);
+    assert((userData->solverOptions->solverType ==
+            SOLVER_TYPE_CMINPACK_LMDER) ||
+           (userData->solverOptions->solverType ==
+            SOLVER_TYPE_CMINPACK_LMSTR));
     int autoDiffType = userData->solverOptions->autoDiffType;
 
     // Get longest dimension for jacobian matrix
@@ -497,9 +777,13 @@ int solveFunc_calculateJacobianMatrix(
         ldfjac = numberOfParameters;
     }
 
-    const int progressMin = userData->computation->progressMin();
-    const int progressMax = userData->computation->progressMax();
-    userData->computation->setProgress(progressMin);
+    int progressMin = 0;
+    int progressMax = 0;
+    if (userData->computation != nullptr) {
+        progressMin = userData->computation->progressMin();
+        progressMax = userData->computation->progressMax();
+    }
+    setSolveProgress(userData, progressMin);
 
     std::vector<bool> evalMeasurements(numberOfMarkers, false);
     determineMarkersToBeEvaluated(numberOfParameters, numberOfMarkers,
@@ -507,6 +791,17 @@ int solveFunc_calculateJacobianMatrix(
                                   userData->previousParamList, parameters,
                                   userData->errorToParamList, evalMeasurements);
 
+    const int threadCount =
+        calculateJacobianThreadCount(numberOfParameters, userData);
+    if (threadCount > 1) {
+        return solveFunc_calculateJacobianMatrixThreaded(
+            threadCount, progressMin, progressMax, evalMeasurements,
+            autoDiffType, ldfjac, numberOfMarkerErrors,
+            numberOfAttrStiffnessErrors, numberOfAttrSmoothnessErrors,
+            imageWidth, numberOfParameters, numberOfErrors, parameters, errors,
+            jacobian, userData, timer);
+    }
+
     // Calculate the jacobian matrix.
     std::vector<double> paramListA(numberOfParameters, 0);
     std::vector<double> errorListA(numberOfErrors, 0);
@@ -540,15 +835,14 @@ int solveFunc(const int numberOfParameters, const int numberOfErrors,
     const auto frameListLength = userData->frameList.length();
     auto frameCount = frameListLength;
     if (!userData->doCalcJacobian && frameCount > 1) {
-        userData->computation->setProgress(userData->iterNum);
+        setSolveProgress(userData, userData->iterNum);
     }
 
     int numberOfMarkerErrors = userData->numberOfMarkerErrors;
     int numberOfAttrStiffnessErrors = userData->numberOfAttrStiffnessErrors;
     int numberOfAttrSmoothnessErrors = userData->numberOfAttrSmoothnessErrors;
     int numberOfMarkers = numberOfMarkerErrors / ERRORS_PER_MARKER;
-    assert(userData->errorToParamList.size() ==
-           static_cast<size_t>(numberOfMarkers));
+    assert(userData->errorToParamList.numberOfMarkers == numberOfMarkers);
 
     if (userData->isNormalCall) {
         incrementNormalIteration(userData);
@@ -566,7 +860,7 @@ int solveFunc(const int numberOfParameters, const int numberOfErrors,
         return SOLVE_FUNC_SUCCESS;
     }
 
-    if (userData->computation->isInterruptRequested()) {
+    if (isSolveInterruptRequested(userData)) {
         MMSOLVER_MAYA_WRN("User wants to cancel the evaluation!");
         userData->userInterrupted = true;
         return SOLVE_FUNC_FAILURE;
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Sparse Jacobian matrix storage, built from the error-to-parameter
+ * relationships.
+ */
+
+#include "adjust_sparseJacobian.h"
+
+// STL
+#include <algorithm>
+#include <cassert>
+#include <utility>
+#include <vector>
+
+// MM Solver
+#include "adjust_defines.h"
+
+void constructSparseJacobianStructure(
+    const int numberOfParameters, const int numberOfErrors,
+    const int numberOfMarkerErrors, const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors,
+    const std::vector<std::pair<int, int>> &paramToAttrList,
+    const ErrorToParamIndex &errorToParamList,
+    const StiffAttrsPtrList &stiffAttrsList,
+    const SmoothAttrsPtrList &smoothAttrsList, SparseJacobian &out_jacobian) {
+    out_jacobian.clear();
+    out_jacobian.numberOfParameters = numberOfParameters;
+    out_jacobian.numberOfErrors = numberOfErrors;
+
+    const int numberOfMarkers = numberOfMarkerErrors / ERRORS_PER_MARKER;
+    assert(errorToParamList.numberOfMarkers == numberOfMarkers);
+    assert(errorToParamList.numberOfParameters == numberOfParameters);
+    assert(paramToAttrList.size() == static_cast<size_t>(numberOfParameters));
+
+    // Errors computed from attribute values (stiffness and
+    // smoothness), with the index of the attribute that affects
+    // them. The error index order matches 'measureErrors'.
+    //
+    // First index is into the errors array.
+    // Second index is into 'attrList'.
+    std::vector<std::pair<int, int>> attrErrorList;
+    attrErrorList.reserve(numberOfAttrStiffnessErrors +
+                          numberOfAttrSmoothnessErrors);
+    for (int i = 0; i < numberOfAttrStiffnessErrors; ++i) {
+        const int errorIndex = numberOfMarkerErrors + i;
+        attrErrorList.push_back(
+            std::pair<int, int>(errorIndex, stiffAttrsList[i]->attrIndex));
+    }
+    for (int i = 0; i < numberOfAttrSmoothnessErrors; ++i) {
+        const int errorIndex =
+            numberOfMarkerErrors + numberOfAttrStiffnessErrors + i;
+        attrErrorList.push_back(
+            std::pair<int, int>(errorIndex, smoothAttrsList[i]->attrIndex));
+    }
+
+    // The attribute errors of each parameter, in ascending error
+    // order.
+    std::vector<std::vector<int>> paramAttrErrorList;
+    if (!attrErrorList.empty()) {
+        int numberOfAttrs = 0;
+        for (const auto &attrError : attrErrorList) {
+            numberOfAttrs = std::max(numberOfAttrs, attrError.second + 1);
+        }
+        for (const auto &attrPair : paramToAttrList) {
+            numberOfAttrs = std::max(numberOfAttrs, attrPair.first + 1);
+        }
+        std::vector<std::vector<int>> attrErrorIndexList(numberOfAttrs);
+        for (const auto &attrError : attrErrorList) {
+            attrErrorIndexList[attrError.second].push_back(attrError.first);
+        }
+        paramAttrErrorList.resize(numberOfParameters);
+        for (int j = 0; j < numberOfParameters; ++j) {
+            paramAttrErrorList[j] =
+                attrErrorIndexList[paramToAttrList[j].first];
+        }
+    }
+
+    // Count the number of entries in each column.
+    std::vector<int> &columnOffsetList = out_jacobian.columnOffsetList;
+    columnOffsetList.resize(numberOfParameters + 1, 0);
+    for (int j = 0; j < numberOfParameters; ++j) {
+        int count = (errorToParamList.paramMarkerEnd(j) -
+                     errorToParamList.paramMarkerBegin(j)) *
+                    ERRORS_PER_MARKER;
+        if (!paramAttrErrorList.empty()) {
+            count += static_cast<int>(paramAttrErrorList[j].size());
+        }
+        columnOffsetList[j + 1] = columnOffsetList[j] + count;
+    }
+    const int numberOfNonZeros = columnOffsetList[numberOfParameters];
+
+    // Fill the row indices of each column. Marker errors come before
+    // attribute errors and both are sorted, so each column's rows
+    // end up sorted.
+    out_jacobian.rowIndexList.resize(numberOfNonZeros, 0);
+    out_jacobian.valueList.resize(numberOfNonZeros, 0.0);
+    for (int j = 0; j < numberOfParameters; ++j) {
+        int index = columnOffsetList[j];
+        for (int k = errorToParamList.paramMarkerBegin(j);
+             k < errorToParamList.paramMarkerEnd(j); ++k) {
+            const int markerIndex = errorToParamList.paramMarkerList[k];
+            for (int e = 0; e < ERRORS_PER_MARKER; ++e) {
+                const int errorIndex = (markerIndex * ERRORS_PER_MARKER) + e;
+                out_jacobian.rowIndexList[index] = errorIndex;
+                ++index;
+            }
+        }
+        if (!paramAttrErrorList.empty()) {
+            for (const int errorIndex : paramAttrErrorList[j]) {
+                out_jacobian.rowIndexList[index] = errorIndex;
+                ++index;
+            }
+        }
+        assert(index == columnOffsetList[j + 1]);
+    }
+
+    // Build the transposed row index.
+    std::vector<int> &rowOffsetList = out_jacobian.rowOffsetList;
+    rowOffsetList.resize(numberOfErrors + 1, 0);
+    for (int k = 0; k < numberOfNonZeros; ++k) {
+        rowOffsetList[out_jacobian.rowIndexList[k] + 1] += 1;
+    }
+    for (int i = 0; i < numberOfErrors; ++i) {
+        rowOffsetList[i + 1] += rowOffsetList[i];
+    }
+
+    out_jacobian.rowParameterIndexList.resize(numberOfNonZeros, 0);
+    out_jacobian.rowValueIndexList.resize(numberOfNonZeros, 0);
+    std::vector<int> rowFillList(rowOffsetList.begin(),
+                                 rowOffsetList.end() - 1);
+    for (int j = 0; j < numberOfParameters; ++j) {
+        for (int k = columnOffsetList[j]; k < columnOffsetList[j + 1]; ++k) {
+            const int errorIndex = out_jacobian.rowIndexList[k];
+            const int index = rowFillList[errorIndex];
+            out_jacobian.rowParameterIndexList[index] = j;
+            out_jacobian.rowValueIndexList[index] = k;
+            ++rowFillList[errorIndex];
+        }
+    }
+}
+
+void sparseJacobianGetRow(const SparseJacobian &jacobian, const int errorIndex,
+                          double *out_row) {
+    assert(errorIndex >= 0);
+    assert(errorIndex < jacobian.numberOfErrors);
+    std::fill(out_row, out_row + jacobian.numberOfParameters, 0.0);
+
+    const int start = jacobian.rowOffsetList[errorIndex];
+    const int end = jacobian.rowOffsetList[errorIndex + 1];
+    for (int k = start; k < end; ++k) {
+        const int paramIndex = jacobian.rowParameterIndexList[k];
+        const int valueIndex = jacobian.rowValueIndexList[k];
+        out_row[paramIndex] = jacobian.valueList[valueIndex];
+    }
+}
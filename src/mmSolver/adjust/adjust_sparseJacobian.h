@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Sparse Jacobian matrix storage, built from the error-to-parameter
+ * relationships.
+ */
+
+#ifndef MM_SOLVER_CORE_BUNDLE_ADJUST_SPARSE_JACOBIAN_H
+#define MM_SOLVER_CORE_BUNDLE_ADJUST_SPARSE_JACOBIAN_H
+
+// STL
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// MM Solver
+#include "adjust_relationshipIndex.h"
+#include "mmSolver/mayahelper/maya_attr.h"
+
+// The Jacobian matrix stored in Compressed Sparse Column (CSC)
+// format.
+//
+// Each column is a parameter and each row is an error. Only the
+// (error, parameter) entries that the relationship data says can be
+// non-zero are stored, so memory scales with the number of non-zero
+// entries, not 'numberOfParameters * numberOfErrors'.
+struct SparseJacobian {
+    int numberOfParameters;
+    int numberOfErrors;
+
+    // Column 'i' is stored in the range 'columnOffsetList[i]' to
+    // 'columnOffsetList[i + 1]' (exclusive) of 'rowIndexList' and
+    // 'valueList'. Row indices are sorted in each column.
+    std::vector<int> columnOffsetList;
+    std::vector<int> rowIndexList;
+    std::vector<double> valueList;
+
+    // A transposed (CSR) index into 'valueList', so that a single
+    // error row can be read without searching every column. Row 'j'
+    // is stored in the range 'rowOffsetList[j]' to
+    // 'rowOffsetList[j + 1]' (exclusive).
+    std::vector<int> rowOffsetList;
+    std::vector<int> rowParameterIndexList;
+    std::vector<int> rowValueIndexList;
+
+    SparseJacobian() : numberOfParameters(0), numberOfErrors(0) {}
+
+    size_t numberOfNonZeros() const { return valueList.size(); }
+
+    void clear() {
+        numberOfParameters = 0;
+        numberOfErrors = 0;
+        columnOffsetList.clear();
+        rowIndexList.clear();
+        valueList.clear();
+        rowOffsetList.clear();
+        rowParameterIndexList.clear();
+        rowValueIndexList.clear();
+    }
+};
+
+// Build the sparsity structure of the Jacobian, with all values set
+// to zero.
+//
+// Marker errors use 'errorToParamList' (ERRORS_PER_MARKER rows per
+// marker error). Stiffness and smoothness errors depend on every
+// parameter of their attribute.
+void constructSparseJacobianStructure(
+    const int numberOfParameters, const int numberOfErrors,
+    const int numberOfMarkerErrors, const int numberOfAttrStiffnessErrors,
+    const int numberOfAttrSmoothnessErrors,
+    const std::vector<std::pair<int, int>> &paramToAttrList,
+    const ErrorToParamIndex &errorToParamList,
+    const StiffAttrsPtrList &stiffAttrsList,
+    const SmoothAttrsPtrList &smoothAttrsList,
+    SparseJacobian &out_jacobian);
+
+// Copy error row 'errorIndex' into the dense array 'out_row', of
+// length 'numberOfParameters'.
+void sparseJacobianGetRow(const SparseJacobian &jacobian, const int errorIndex,
+                          double *out_row);
+
+#endif  // MM_SOLVER_CORE_BUNDLE_ADJUST_SPARSE_JACOBIAN_H
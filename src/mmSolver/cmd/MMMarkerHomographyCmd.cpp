@@ -329,20 +329,24 @@ MStatus MMMarkerHomographyCmd::parseArgs(const MArgList &args) {
             frameList.append(m_time_a);
             frameList.append(m_time_b);
 
-            std::vector<std::shared_ptr<mmlens::LensModel>>
-                markerFrameToLensModelList;
-            std::vector<std::shared_ptr<mmlens::LensModel>>
-                attrFrameToLensModelList;
+            std::vector<int32_t> markerFrameToLensModelIndexList;
+            std::vector<int32_t> attrFrameToLensModelIndexList;
             std::vector<std::shared_ptr<mmlens::LensModel>> lensModelList;
 
             status = mmsolver::constructLensModelList(
                 cameraList, markerList, attrList, frameList,
-                markerFrameToLensModelList, attrFrameToLensModelList,
+                markerFrameToLensModelIndexList, attrFrameToLensModelIndexList,
                 lensModelList);
             CHECK_MSTATUS_AND_RETURN_IT(status);
 
-            lensModel_a = markerFrameToLensModelList[0];
-            lensModel_b = markerFrameToLensModelList[1];
+            const int32_t lensModelIndex_a = markerFrameToLensModelIndexList[0];
+            const int32_t lensModelIndex_b = markerFrameToLensModelIndexList[1];
+            if (lensModelIndex_a != LENS_MODEL_INDEX_NONE) {
+                lensModel_a = lensModelList[lensModelIndex_a];
+            }
+            if (lensModelIndex_b != LENS_MODEL_INDEX_NONE) {
+                lensModel_b = lensModelList[lensModelIndex_b];
+            }
         }
 
         auto success = ::mmsolver::sfm::add_marker_pair_at_frame(
@@ -93,6 +93,8 @@ MStatus MMSolver2Cmd::parseArgs(const MArgList &args) {
         m_solverOptions.robustLossScale, m_solverOptions.solverType,
         m_solverOptions.sceneGraphMode, m_solverOptions.timeEvalMode,
         m_solverOptions.acceptOnlyBetter, m_solverOptions.frameSolveMode,
+        m_solverOptions.jacobianThreadCount, m_solverOptions.frameThreadCount,
+        m_solverOptions.undistortMarkers,
         m_solverOptions.solverSupportsAutoDiffForward,
         m_solverOptions.solverSupportsAutoDiffCentral,
         m_solverOptions.solverSupportsParameterBounds,
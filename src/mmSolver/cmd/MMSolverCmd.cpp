@@ -95,7 +95,8 @@ MStatus MMSolverCmd::parseArgs(const MArgList &args) {
         argData, m_iterations, m_tau, m_epsilon1, m_epsilon2, m_epsilon3,
         m_delta, m_autoDiffType, m_autoParamScale, m_robustLossType,
         m_robustLossScale, m_solverType, m_sceneGraphMode, m_timeEvalMode,
-        m_acceptOnlyBetter, m_frameSolveMode, m_supportAutoDiffForward,
+        m_acceptOnlyBetter, m_frameSolveMode, m_jacobianThreadCount,
+        m_frameThreadCount, m_undistortMarkers, m_supportAutoDiffForward,
         m_supportAutoDiffCentral, m_supportParameterBounds, m_supportRobustLoss,
         m_removeUnusedMarkers, m_removeUnusedAttributes, m_imageWidth);
     CHECK_MSTATUS_AND_RETURN_IT(status);
@@ -150,6 +151,9 @@ MStatus MMSolverCmd::doIt(const MArgList &args) {
     solverOptions.acceptOnlyBetter = m_acceptOnlyBetter;
     solverOptions.imageWidth = m_imageWidth;
     solverOptions.frameSolveMode = m_frameSolveMode;
+    solverOptions.jacobianThreadCount = m_jacobianThreadCount;
+    solverOptions.frameThreadCount = m_frameThreadCount;
+    solverOptions.undistortMarkers = m_undistortMarkers;
     solverOptions.solverSupportsAutoDiffForward = m_supportAutoDiffForward;
     solverOptions.solverSupportsAutoDiffCentral = m_supportAutoDiffCentral;
     solverOptions.solverSupportsParameterBounds = m_supportParameterBounds;
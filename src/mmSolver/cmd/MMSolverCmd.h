@@ -79,6 +79,9 @@ public:
         , m_removeUnusedMarkers(false)
         , m_removeUnusedAttributes(false)
         , m_imageWidth(2048.0)
+        , m_jacobianThreadCount(JACOBIAN_THREAD_COUNT_DEFAULT_VALUE)
+        , m_frameThreadCount(FRAME_THREAD_COUNT_DEFAULT_VALUE)
+        , m_undistortMarkers(UNDISTORT_MARKERS_DEFAULT_VALUE)
         , m_supportAutoDiffForward(false)
         , m_supportAutoDiffCentral(false)
         , m_supportParameterBounds(false)
@@ -128,6 +131,9 @@ private:
     bool m_removeUnusedAttributes;  // Remove unused Attributes from solve?
     double m_imageWidth;            // Defines pixel size in camera space.
     FrameSolveMode m_frameSolveMode;
+    int m_jacobianThreadCount;  // Threads used for the Jacobian; 0=all.
+    int m_frameThreadCount;     // Threads used to solve frames; 0=all.
+    bool m_undistortMarkers;    // Measure errors in undistorted space?
 
     // What type of features does the given solver type support?
     bool m_supportAutoDiffForward;
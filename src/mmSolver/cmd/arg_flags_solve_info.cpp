@@ -62,6 +62,12 @@ void createSolveInfoSyntax_other(MSyntax &syntax) {
                    MSyntax::kBoolean);
     syntax.addFlag(FRAME_SOLVE_MODE_FLAG, FRAME_SOLVE_MODE_FLAG_LONG,
                    MSyntax::kUnsigned);
+    syntax.addFlag(JACOBIAN_THREAD_COUNT_FLAG, JACOBIAN_THREAD_COUNT_FLAG_LONG,
+                   MSyntax::kLong);
+    syntax.addFlag(FRAME_THREAD_COUNT_FLAG, FRAME_THREAD_COUNT_FLAG_LONG,
+                   MSyntax::kUnsigned);
+    syntax.addFlag(UNDISTORT_MARKERS_FLAG, UNDISTORT_MARKERS_FLAG_LONG,
+                   MSyntax::kBoolean);
 
     syntax.addFlag(IMAGE_WIDTH_FLAG, IMAGE_WIDTH_FLAG_LONG, MSyntax::kDouble);
 
@@ -150,6 +156,24 @@ MStatus parseSolveInfoArguments_solverType(
         out_supportParameterBounds =
             CMINPACK_LMDER_SUPPORT_PARAMETER_BOUNDS_VALUE;
         out_supportRobustLoss = CMINPACK_LMDER_SUPPORT_ROBUST_LOSS_VALUE;
+    } else if (out_solverType == SOLVER_TYPE_CMINPACK_LMSTR) {
+        out_iterations = CMINPACK_LMSTR_ITERATIONS_DEFAULT_VALUE;
+        out_tau = CMINPACK_LMSTR_TAU_DEFAULT_VALUE;
+        out_epsilon1 = CMINPACK_LMSTR_EPSILON1_DEFAULT_VALUE;
+        out_epsilon2 = CMINPACK_LMSTR_EPSILON2_DEFAULT_VALUE;
+        out_epsilon3 = CMINPACK_LMSTR_EPSILON3_DEFAULT_VALUE;
+        out_delta = CMINPACK_LMSTR_DELTA_DEFAULT_VALUE;
+        out_autoDiffType = CMINPACK_LMSTR_AUTO_DIFF_TYPE_DEFAULT_VALUE;
+        out_autoParamScale = CMINPACK_LMSTR_AUTO_PARAM_SCALE_DEFAULT_VALUE;
+        out_robustLossType = CMINPACK_LMSTR_ROBUST_LOSS_TYPE_DEFAULT_VALUE;
+        out_robustLossScale = CMINPACK_LMSTR_ROBUST_LOSS_SCALE_DEFAULT_VALUE;
+        out_supportAutoDiffForward =
+            CMINPACK_LMSTR_SUPPORT_AUTO_DIFF_FORWARD_VALUE;
+        out_supportAutoDiffCentral =
+            CMINPACK_LMSTR_SUPPORT_AUTO_DIFF_CENTRAL_VALUE;
+        out_supportParameterBounds =
+            CMINPACK_LMSTR_SUPPORT_PARAMETER_BOUNDS_VALUE;
+        out_supportRobustLoss = CMINPACK_LMSTR_SUPPORT_ROBUST_LOSS_VALUE;
     } else if (out_solverType == SOLVER_TYPE_LEVMAR) {
         out_iterations = LEVMAR_ITERATIONS_DEFAULT_VALUE;
         out_tau = LEVMAR_TAU_DEFAULT_VALUE;
@@ -276,6 +300,9 @@ MStatus parseSolveInfoArguments_other(const MArgDatabase &argData,
                                       int &out_timeEvalMode,
                                       bool &out_acceptOnlyBetter,
                                       FrameSolveMode &out_frameSolveMode,
+                                      int &out_jacobianThreadCount,
+                                      int &out_frameThreadCount,
+                                      bool &out_undistortMarkers,
                                       double &out_imageWidth) {
     // Get 'Scene Graph Mode'
     MStatus status = parseSolveSceneGraphArguments(argData, out_sceneGraphMode);
@@ -306,6 +333,41 @@ MStatus parseSolveInfoArguments_other(const MArgDatabase &argData,
     }
     out_frameSolveMode = static_cast<FrameSolveMode>(frameSolveMode);
 
+    // Get 'Jacobian Thread Count'
+    out_jacobianThreadCount = JACOBIAN_THREAD_COUNT_DEFAULT_VALUE;
+    if (argData.isFlagSet(JACOBIAN_THREAD_COUNT_FLAG)) {
+        status = argData.getFlagArgument(JACOBIAN_THREAD_COUNT_FLAG, 0,
+                                         out_jacobianThreadCount);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+        if (out_jacobianThreadCount < 0) {
+            MMSOLVER_MAYA_ERR(
+                "Jacobian Thread Count is invalid. "
+                << "Value may be 0 (all hardware threads) or more;"
+                << "value=" << out_jacobianThreadCount);
+            status = MS::kFailure;
+            status.perror(
+                "Jacobian Thread Count is invalid. Value may be 0 (all "
+                "hardware threads) or more.");
+            return status;
+        }
+    }
+
+    // Get 'Frame Thread Count'
+    out_frameThreadCount = FRAME_THREAD_COUNT_DEFAULT_VALUE;
+    if (argData.isFlagSet(FRAME_THREAD_COUNT_FLAG)) {
+        status = argData.getFlagArgument(FRAME_THREAD_COUNT_FLAG, 0,
+                                         out_frameThreadCount);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
+    // Get 'Undistort Markers'
+    out_undistortMarkers = UNDISTORT_MARKERS_DEFAULT_VALUE;
+    if (argData.isFlagSet(UNDISTORT_MARKERS_FLAG)) {
+        status = argData.getFlagArgument(UNDISTORT_MARKERS_FLAG, 0,
+                                         out_undistortMarkers);
+        CHECK_MSTATUS_AND_RETURN_IT(status);
+    }
+
     // Get 'Image Width'
     out_imageWidth = IMAGE_WIDTH_DEFAULT_VALUE;
     if (argData.isFlagSet(IMAGE_WIDTH_FLAG)) {
@@ -323,10 +385,11 @@ MStatus parseSolveInfoArguments_v1(
     int &out_robustLossType, double &out_robustLossScale, int &out_solverType,
     SceneGraphMode &out_sceneGraphMode, int &out_timeEvalMode,
     bool &out_acceptOnlyBetter, FrameSolveMode &out_frameSolveMode,
-    bool &out_supportAutoDiffForward, bool &out_supportAutoDiffCentral,
-    bool &out_supportParameterBounds, bool &out_supportRobustLoss,
-    bool &out_removeUnusedMarkers, bool &out_removeUnusedAttributes,
-    double &out_imageWidth) {
+    int &out_jacobianThreadCount, int &out_frameThreadCount,
+    bool &out_undistortMarkers, bool &out_supportAutoDiffForward,
+    bool &out_supportAutoDiffCentral, bool &out_supportParameterBounds,
+    bool &out_supportRobustLoss, bool &out_removeUnusedMarkers,
+    bool &out_removeUnusedAttributes, double &out_imageWidth) {
     MStatus status = parseSolveInfoArguments_solverType(
         argData, out_iterations, out_tau, out_epsilon1, out_epsilon2,
         out_epsilon3, out_delta, out_autoDiffType, out_autoParamScale,
@@ -337,7 +400,8 @@ MStatus parseSolveInfoArguments_v1(
 
     status = parseSolveInfoArguments_other(
         argData, out_sceneGraphMode, out_timeEvalMode, out_acceptOnlyBetter,
-        out_frameSolveMode, out_imageWidth);
+        out_frameSolveMode, out_jacobianThreadCount, out_frameThreadCount,
+        out_undistortMarkers, out_imageWidth);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     status = parseSolveInfoArguments_removeUnused(
@@ -353,9 +417,10 @@ MStatus parseSolveInfoArguments_v2(
     int &out_robustLossType, double &out_robustLossScale, int &out_solverType,
     SceneGraphMode &out_sceneGraphMode, int &out_timeEvalMode,
     bool &out_acceptOnlyBetter, FrameSolveMode &out_frameSolveMode,
-    bool &out_supportAutoDiffForward, bool &out_supportAutoDiffCentral,
-    bool &out_supportParameterBounds, bool &out_supportRobustLoss,
-    double &out_imageWidth) {
+    int &out_jacobianThreadCount, int &out_frameThreadCount,
+    bool &out_undistortMarkers, bool &out_supportAutoDiffForward,
+    bool &out_supportAutoDiffCentral, bool &out_supportParameterBounds,
+    bool &out_supportRobustLoss, double &out_imageWidth) {
     MStatus status = parseSolveInfoArguments_solverType(
         argData, out_iterations, out_tau, out_epsilon1, out_epsilon2,
         out_epsilon3, out_delta, out_autoDiffType, out_autoParamScale,
@@ -366,7 +431,8 @@ MStatus parseSolveInfoArguments_v2(
 
     status = parseSolveInfoArguments_other(
         argData, out_sceneGraphMode, out_timeEvalMode, out_acceptOnlyBetter,
-        out_frameSolveMode, out_imageWidth);
+        out_frameSolveMode, out_jacobianThreadCount, out_frameThreadCount,
+        out_undistortMarkers, out_imageWidth);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     return status;
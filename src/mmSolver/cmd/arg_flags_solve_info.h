@@ -56,6 +56,27 @@
 #define FRAME_SOLVE_MODE_FLAG "-fsm"
 #define FRAME_SOLVE_MODE_FLAG_LONG "-frameSolveMode"
 
+// The number of threads used to calculate the Jacobian matrix, when
+// the MM Scene Graph is used. Zero uses all hardware threads, one
+// disables threading.
+#define JACOBIAN_THREAD_COUNT_FLAG "-jtc"
+#define JACOBIAN_THREAD_COUNT_FLAG_LONG "-jacobianThreadCount"
+
+// The number of threads used to solve frames, when the frame solve
+// mode is per-frame and each frame can be solved independently with
+// the MM Scene Graph. Zero uses all hardware threads, one disables
+// threading.
+#define FRAME_THREAD_COUNT_FLAG "-ftc"
+#define FRAME_THREAD_COUNT_FLAG_LONG "-frameThreadCount"
+
+// Compare re-projected bundles with undistorted marker positions,
+// rather than distorting every re-projected bundle. The marker
+// positions are undistorted once before solving. This is only used
+// when no lens distortion attributes are solved, otherwise the
+// re-projected bundles are distorted as usual.
+#define UNDISTORT_MARKERS_FLAG "-udm"
+#define UNDISTORT_MARKERS_FLAG_LONG "-undistortMarkers"
+
 // Maximum number of iterations
 //
 // This option does not directly control the number of evaluations the
@@ -185,10 +206,11 @@ MStatus parseSolveInfoArguments_v1(
     int &out_robustLossType, double &out_robustLossScale, int &out_solverType,
     SceneGraphMode &out_sceneGraphMode, int &out_timeEvalMode,
     bool &out_acceptOnlyBetter, FrameSolveMode &out_frameSolveMode,
-    bool &out_supportAutoDiffForward, bool &out_supportAutoDiffCentral,
-    bool &out_supportParameterBounds, bool &out_supportRobustLoss,
-    bool &out_removeUnusedMarkers, bool &out_removeUnusedAttributes,
-    double &out_imageWidth);
+    int &out_jacobianThreadCount, int &out_frameThreadCount,
+    bool &out_undistortMarkers, bool &out_supportAutoDiffForward,
+    bool &out_supportAutoDiffCentral, bool &out_supportParameterBounds,
+    bool &out_supportRobustLoss, bool &out_removeUnusedMarkers,
+    bool &out_removeUnusedAttributes, double &out_imageWidth);
 
 MStatus parseSolveInfoArguments_v2(
     const MArgDatabase &argData, int &out_iterations, double &out_tau,
@@ -197,9 +219,10 @@ MStatus parseSolveInfoArguments_v2(
     int &out_robustLossType, double &out_robustLossScale, int &out_solverType,
     SceneGraphMode &out_sceneGraphMode, int &out_timeEvalMode,
     bool &out_acceptOnlyBetter, FrameSolveMode &out_frameSolveMode,
-    bool &out_supportAutoDiffForward, bool &out_supportAutoDiffCentral,
-    bool &out_supportParameterBounds, bool &out_supportRobustLoss,
-    double &out_imageWidth);
+    int &out_jacobianThreadCount, int &out_frameThreadCount,
+    bool &out_undistortMarkers, bool &out_supportAutoDiffForward,
+    bool &out_supportAutoDiffCentral, bool &out_supportParameterBounds,
+    bool &out_supportRobustLoss, double &out_imageWidth);
 
 }  // namespace mmsolver
 
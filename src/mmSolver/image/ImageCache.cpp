@@ -28,9 +28,12 @@
 // STL
 #include <algorithm>
 #include <cassert>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <string>
+#include <vector>
 
 // Maya
 #include <maya/MImage.h>
@@ -57,6 +60,20 @@
 namespace mmsolver {
 namespace image {
 
+// Only EXR files are decoded without the Maya API, and so can be
+// decoded into the CPU cache pixel format, on any thread.
+static bool has_exr_file_extension(const std::string &file_path) {
+    const size_t dot_char_index = file_path.rfind('.');
+    if (dot_char_index == std::string::npos) {
+        return false;
+    }
+    std::string file_extension = file_path.substr(dot_char_index + 1);
+    std::transform(file_extension.begin(), file_extension.end(),
+                   file_extension.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    return file_extension == "exr";
+}
+
 MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
                                   ImageCache &image_cache, MImage &temp_image,
                                   mmimage::ImagePixelBuffer &temp_pixel_buffer,
@@ -105,7 +122,27 @@ MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
     // Python user code to add the list of valid images into the
     // cache.
 
+    // All group names are normalised to use UNIX-style path
+    // separators, so that the internal values are all consistent.
+    MString normalised_file_pattern(file_pattern);
+    normalised_file_pattern.substitute("\\", "/");
+    const std::string group_name =
+        std::string(normalised_file_pattern.asChar());
+
     ImagePixelData image_pixel_data = image_cache.cpu_find_item(item_key);
+    if (!image_pixel_data.is_valid()) {
+        // Reading the decoded pixels from the disk cache is much
+        // faster than decoding the file again.
+        image_cache.cpu_read_item_from_disk(group_name, item_key,
+                                            image_pixel_data);
+    }
+    if (!image_pixel_data.is_valid() && has_exr_file_extension(item_key)) {
+        // EXR files are decoded straight into the CPU cache pixel
+        // format, so the pixels are only converted once, and are
+        // then used the same as cached pixels.
+        image_cache.cpu_read_item_from_exr(group_name, item_key,
+                                           image_pixel_data);
+    }
 
     uint32_t width = 0;
     uint32_t height = 0;
@@ -124,14 +161,8 @@ MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
         pixel_data_type = image_pixel_data.pixel_data_type();
         bytes_per_channel =
             convert_pixel_data_type_to_bytes_per_channel(pixel_data_type);
-
-        if (pixel_data_type == PixelDataType::kU8) {
-            // Assumes the 8-bit data is "RGBA".
-            texture_format = MHWRender::kR8G8B8A8_UNORM;
-        } else if (pixel_data_type == PixelDataType::kF32) {
-            texture_format = MHWRender::kR32G32B32A32_FLOAT;
-        }
-
+        texture_format = convert_pixel_data_type_to_texture_format(
+            pixel_data_type, num_channels);
     } else {
         status = read_image_file(
             temp_image, temp_pixel_buffer, temp_meta_data, resolved_file_path,
@@ -156,45 +187,210 @@ MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
         ImagePixelData(static_cast<void *>(maya_owned_pixel_data), width,
                        height, num_channels, pixel_data_type);
 
-    // All group names are normalised to use UNIX-style path
-    // separators, so that the internal values are all consistent.
-    MString normalised_file_pattern(file_pattern);
-    normalised_file_pattern.substitute("\\", "/");
-    const std::string group_name =
-        std::string(normalised_file_pattern.asChar());
-
     texture_data = image_cache.gpu_insert_item(texture_manager, group_name,
                                                item_key, gpu_image_pixel_data);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache: read_texture_image_file: "
                       << "gpu_inserted=" << texture_data.texture());
 
+    // Pixels found in (or read into) the CPU cache are already
+    // cached, and are kept alive by 'image_pixel_data' until here,
+    // even if another thread has evicted them.
+    if (image_pixel_data_valid) {
+        MMSOLVER_MAYA_VRB("mmsolver::ImageCache: read_texture_image_file DONE2:"
+                          << " texture=" << texture_data.texture());
+        return texture_data.texture();
+    }
+
     // Duplicate the Maya-owned pixel data for our image cache.
     const size_t pixel_data_byte_count =
         width * height * num_channels * bytes_per_channel;
-    image_pixel_data = ImagePixelData();
-    const bool allocated_ok = image_pixel_data.allocate_pixels(
+    ImagePixelData cpu_image_pixel_data;
+    const bool allocated_ok = cpu_image_pixel_data.allocate_pixels(
         width, height, num_channels, pixel_data_type);
     if (allocated_ok == false) {
         MMSOLVER_MAYA_ERR("mmsolver::ImageCache: read_texture_image_file: "
                           << "Could not allocate pixel data!");
         return nullptr;
     }
-    assert(image_pixel_data.is_valid() == true);
-    assert(image_pixel_data.byte_count() == pixel_data_byte_count);
-    std::memcpy(image_pixel_data.pixel_data(), maya_owned_pixel_data,
+    assert(cpu_image_pixel_data.is_valid() == true);
+    assert(cpu_image_pixel_data.byte_count() == pixel_data_byte_count);
+    std::memcpy(cpu_image_pixel_data.pixel_data(), maya_owned_pixel_data,
                 pixel_data_byte_count);
 
-    const bool cpu_inserted =
-        image_cache.cpu_insert_item(group_name, item_key, image_pixel_data);
+    const bool cpu_inserted = image_cache.cpu_insert_item(
+        group_name, item_key, cpu_image_pixel_data);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache: read_texture_image_file: "
                       << "cpu_inserted=" << cpu_inserted);
 
+    if (cpu_inserted) {
+        // The file was decoded, so the pixels are saved into the disk
+        // cache, off the main thread.
+        const bool background = true;
+        const bool disk_written =
+            image_cache.write_cpu_item_to_disk(item_key, background);
+        MMSOLVER_MAYA_VRB("mmsolver::ImageCache: read_texture_image_file: "
+                          << "disk_written=" << disk_written);
+    }
+
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache: read_texture_image_file DONE2:"
                       << " texture=" << texture_data.texture());
 
     return texture_data.texture();
 }
 
+void prefetch_image_sequence(ImageCache &image_cache,
+                             const MString &file_pattern,
+                             const mmcore::FrameValue frame) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache: prefetch_image_sequence:"
+                      << " file_pattern=" << file_pattern.asChar()
+                      << " frame=" << frame);
+
+    if (image_cache.get_prefetch_thread_count() == 0) {
+        return;
+    }
+
+    // Only EXR files are read off the main thread.
+    MString file_extension = "";
+    const int32_t dot_char_index = file_pattern.rindexW('.');
+    if (dot_char_index >= 0) {
+        file_extension =
+            file_pattern.substringW(dot_char_index + 1, file_pattern.length());
+        file_extension.toLowerCase();
+    }
+    if (file_extension != "exr") {
+        return;
+    }
+
+    // The frame range of the image sequence is not known, so the
+    // frames that do not exist are skipped when resolving the file
+    // paths.
+    const int32_t start_frame = std::numeric_limits<int32_t>::min();
+    const int32_t end_frame = std::numeric_limits<int32_t>::max();
+    std::vector<int32_t> frames;
+    mmimage::prefetch_window_frames(
+        frame, IMAGE_PREFETCH_FRAMES_FORWARD, IMAGE_PREFETCH_FRAMES_BACKWARD,
+        start_frame, end_frame, frames);
+
+    // The file paths are resolved on the main thread, because
+    // resolving uses the Maya API. The current frame is read by the
+    // caller, so it is not queued.
+    const rust::Str file_pattern_rust_str(file_pattern.asChar());
+    ImageCache::CPUVectorString file_paths;
+    file_paths.reserve(frames.size());
+    for (const int32_t prefetch_frame : frames) {
+        if (prefetch_frame == frame) {
+            continue;
+        }
+
+        rust::String expanded_file_path_rust_string =
+            mmcore::expand_file_path_string(file_pattern_rust_str,
+                                            prefetch_frame);
+        MString file_path(expanded_file_path_rust_string.data(),
+                          expanded_file_path_rust_string.length());
+        if (file_path == file_pattern) {
+            // Only image sequences (with frame numbers in the file
+            // pattern) can be prefetched.
+            break;
+        }
+
+        MStatus status = mmpath::resolve_input_file_path(file_path);
+        if (status != MS::kSuccess) {
+            continue;
+        }
+        file_paths.push_back(std::string(file_path.asChar()));
+    }
+
+    // All group names are normalised to use UNIX-style path
+    // separators, the same as 'read_texture_image_file()'.
+    MString normalised_file_pattern(file_pattern);
+    normalised_file_pattern.substitute("\\", "/");
+    const std::string group_name =
+        std::string(normalised_file_pattern.asChar());
+
+    image_cache.cpu_prefetch(group_name, file_paths);
+}
+
+// Parse the pixel format names of IMAGE_CACHE_PIXEL_FORMAT_ENV_VAR_NAME.
+static bool parse_pixel_format(const std::string &value,
+                               PixelDataType &out_pixel_data_type,
+                               uint8_t &out_num_channels) {
+    if (value == "rgba_f32") {
+        out_pixel_data_type = PixelDataType::kF32;
+        out_num_channels = 4;
+    } else if (value == "rgb_f32") {
+        out_pixel_data_type = PixelDataType::kF32;
+        out_num_channels = 3;
+    } else if (value == "rgba_f16") {
+        out_pixel_data_type = PixelDataType::kF16;
+        out_num_channels = 4;
+    } else if (value == "rgba_u8") {
+        out_pixel_data_type = PixelDataType::kU8;
+        out_num_channels = 4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// 32-bit floats are the default pixel format, so EXR images are
+// cached without any loss of precision.
+ImageCache::ImageCache()
+    : m_gpu_capacity_bytes(0)
+    , m_gpu_item_count_minumum(1)
+    , m_cpu_pixel_data_type(PixelDataType::kF32)
+    , m_cpu_num_channels(4)
+    , m_disk_capacity_bytes(IMAGE_DISK_CACHE_CAPACITY_BYTES)
+    , m_prefetch_thread_count(IMAGE_PREFETCH_THREAD_COUNT) {
+    m_cpu_cache.set_item_count_minimum(1);
+
+    const char *pixel_format_ptr =
+        std::getenv(IMAGE_CACHE_PIXEL_FORMAT_ENV_VAR_NAME);
+    if ((pixel_format_ptr != nullptr) && (pixel_format_ptr[0] != '\0')) {
+        const std::string pixel_format(pixel_format_ptr);
+        PixelDataType pixel_data_type = PixelDataType::kUnknown;
+        uint8_t num_channels = 0;
+        if (parse_pixel_format(pixel_format, pixel_data_type,
+                               num_channels)) {
+            m_cpu_pixel_data_type = pixel_data_type;
+            m_cpu_num_channels = num_channels;
+        } else {
+            MMSOLVER_MAYA_WRN("mmsolver::ImageCache: "
+                              << IMAGE_CACHE_PIXEL_FORMAT_ENV_VAR_NAME
+                              << " value \"" << pixel_format.c_str()
+                              << "\" is invalid, expected \"rgba_f32\", "
+                              << "\"rgb_f32\", \"rgba_f16\" or "
+                              << "\"rgba_u8\".");
+        }
+    }
+
+    const char *prefetch_thread_count_ptr =
+        std::getenv(IMAGE_PREFETCH_THREAD_COUNT_ENV_VAR_NAME);
+    if ((prefetch_thread_count_ptr != nullptr) &&
+        (prefetch_thread_count_ptr[0] != '\0')) {
+        char *end_ptr = nullptr;
+        const long thread_count =
+            std::strtol(prefetch_thread_count_ptr, &end_ptr, 10);
+        if ((*end_ptr == '\0') && (thread_count >= 0)) {
+            m_prefetch_thread_count = static_cast<size_t>(thread_count);
+        } else {
+            MMSOLVER_MAYA_WRN("mmsolver::ImageCache: "
+                              << IMAGE_PREFETCH_THREAD_COUNT_ENV_VAR_NAME
+                              << " value \"" << prefetch_thread_count_ptr
+                              << "\" is invalid, expected 0 or more.");
+        }
+    }
+
+    const char *disk_directory_ptr =
+        std::getenv(IMAGE_DISK_CACHE_DIRECTORY_ENV_VAR_NAME);
+    if (disk_directory_ptr != nullptr) {
+        // The memory may change under our feet, we copy the data into
+        // a string for save keeping.
+        const std::string disk_directory(disk_directory_ptr);
+        ImageCache::set_disk_directory(disk_directory);
+    }
+}
+
 void ImageCache::set_gpu_capacity_bytes(
     MHWRender::MTextureManager *texture_manager, const size_t value) {
     const bool verbose = false;
@@ -208,9 +404,9 @@ void ImageCache::set_gpu_capacity_bytes(
     // If we are at capacity remove the least recently used items
     // until our capacity is under 'new_used_bytes' or we reach the minimum
     // number of items
-    while (!m_gpu_item_map.empty() &&
-           (m_gpu_item_map.size() > m_gpu_item_count_minumum) &&
-           (m_gpu_used_bytes > m_gpu_capacity_bytes)) {
+    while (!m_gpu_cache.empty() &&
+           (m_gpu_cache.item_count() > m_gpu_item_count_minumum) &&
+           (m_gpu_cache.used_bytes() > m_gpu_capacity_bytes)) {
         const CacheEvictionResult result =
             ImageCache::gpu_evict_one_item(texture_manager);
         if (result != CacheEvictionResult::kSuccess) {
@@ -219,26 +415,71 @@ void ImageCache::set_gpu_capacity_bytes(
     }
 }
 
+static void deallocate_pixels(
+    std::vector<ImageCache::CPUCacheValue> &image_pixel_datas) {
+    for (ImageCache::CPUCacheValue &image_pixel_data : image_pixel_datas) {
+        image_pixel_data.deallocate_pixels();
+    }
+    image_pixel_datas.clear();
+}
+
 void ImageCache::set_cpu_capacity_bytes(const size_t value) {
     const bool verbose = false;
-    m_cpu_capacity_bytes = value;
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::set_cpu_capacity_bytes: "
-                      << "m_cpu_capacity_bytes=" << m_cpu_capacity_bytes);
+                      << "capacity_bytes=" << value);
+
+    // The cache removes the least recently used items until the used
+    // memory is under the new capacity, or the minimum number of
+    // items is reached.
+    std::vector<CPUCacheValue> evicted_values;
+    m_cpu_cache.set_capacity_bytes(value, evicted_values);
+    deallocate_pixels(evicted_values);
+}
 
-    // Because we must always ensure our used memory is less than
-    // the given capacity.
-    //
-    // If we are at capacity remove the least recently used items
-    // until our capacity is under 'new_used_bytes' or we reach the minimum
-    // number of items
-    while (!m_cpu_item_map.empty() &&
-           (m_cpu_item_map.size() > m_cpu_item_count_minumum) &&
-           (m_cpu_used_bytes > m_cpu_capacity_bytes)) {
-        const CacheEvictionResult result = ImageCache::cpu_evict_one_item();
-        if (result != CacheEvictionResult::kSuccess) {
-            break;
-        }
+void ImageCache::cpu_pixel_format(PixelDataType &out_pixel_data_type,
+                                  uint8_t &out_num_channels) const {
+    std::lock_guard<std::mutex> lock(m_cpu_pixel_format_mutex);
+    out_pixel_data_type = m_cpu_pixel_data_type;
+    out_num_channels = m_cpu_num_channels;
+}
+
+PixelDataType ImageCache::get_cpu_pixel_data_type() const {
+    std::lock_guard<std::mutex> lock(m_cpu_pixel_format_mutex);
+    return m_cpu_pixel_data_type;
+}
+
+void ImageCache::set_cpu_pixel_data_type(const PixelDataType value) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::set_cpu_pixel_data_type: "
+                      << "pixel_data_type=" << static_cast<int>(value));
+    if ((value != PixelDataType::kU8) && (value != PixelDataType::kF16) &&
+        (value != PixelDataType::kF32)) {
+        MMSOLVER_MAYA_ERR("mmsolver::ImageCache::set_cpu_pixel_data_type: "
+                          << "Invalid pixel type is "
+                          << static_cast<int>(value));
+        return;
     }
+    std::lock_guard<std::mutex> lock(m_cpu_pixel_format_mutex);
+    m_cpu_pixel_data_type = value;
+}
+
+uint8_t ImageCache::get_cpu_num_channels() const {
+    std::lock_guard<std::mutex> lock(m_cpu_pixel_format_mutex);
+    return m_cpu_num_channels;
+}
+
+void ImageCache::set_cpu_num_channels(const uint8_t value) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::set_cpu_num_channels: "
+                      << "num_channels=" << static_cast<int>(value));
+    if ((value != 3) && (value != 4)) {
+        MMSOLVER_MAYA_ERR("mmsolver::ImageCache::set_cpu_num_channels: "
+                          << "Invalid number of channels is "
+                          << static_cast<int>(value));
+        return;
+    }
+    std::lock_guard<std::mutex> lock(m_cpu_pixel_format_mutex);
+    m_cpu_num_channels = value;
 }
 
 inline std::string generate_cache_brief(const char *prefix_str,
@@ -273,14 +514,22 @@ inline std::string generate_cache_brief(const char *prefix_str,
 
 MString ImageCache::generate_cache_brief_text() const {
     std::string gpu_cache_text = generate_cache_brief(
-        "GPU cache | ", m_gpu_item_map.size(), m_gpu_item_count_minumum,
-        m_gpu_capacity_bytes, m_gpu_used_bytes);
+        "GPU cache | ", m_gpu_cache.item_count(), m_gpu_item_count_minumum,
+        m_gpu_capacity_bytes, m_gpu_cache.used_bytes());
     std::string cpu_cache_text = generate_cache_brief(
-        "CPU cache | ", m_cpu_item_map.size(), m_cpu_item_count_minumum,
-        m_cpu_capacity_bytes, m_cpu_used_bytes);
+        "CPU cache | ", m_cpu_cache.item_count(),
+        m_cpu_cache.item_count_minimum(), m_cpu_cache.capacity_bytes(),
+        m_cpu_cache.used_bytes());
+
+    std::string disk_cache_text = generate_cache_brief(
+        "Disk cache | ", ImageCache::get_disk_item_count(), 0,
+        ImageCache::get_disk_capacity_bytes(),
+        ImageCache::get_disk_used_bytes());
 
     std::stringstream ss;
-    ss << gpu_cache_text << std::endl << cpu_cache_text << std::endl;
+    ss << gpu_cache_text << std::endl
+       << cpu_cache_text << std::endl
+       << disk_cache_text << std::endl;
 
     std::string string = ss.str();
     MString mstring = MString(string.c_str());
@@ -289,16 +538,24 @@ MString ImageCache::generate_cache_brief_text() const {
 
 void ImageCache::print_cache_brief() const {
     std::string gpu_cache_text = generate_cache_brief(
-        "GPU cache | ", m_gpu_item_map.size(), m_gpu_item_count_minumum,
-        m_gpu_capacity_bytes, m_gpu_used_bytes);
+        "GPU cache | ", m_gpu_cache.item_count(), m_gpu_item_count_minumum,
+        m_gpu_capacity_bytes, m_gpu_cache.used_bytes());
     std::string cpu_cache_text = generate_cache_brief(
-        "CPU cache | ", m_cpu_item_map.size(), m_gpu_item_count_minumum,
-        m_cpu_capacity_bytes, m_cpu_used_bytes);
+        "CPU cache | ", m_cpu_cache.item_count(),
+        m_cpu_cache.item_count_minimum(), m_cpu_cache.capacity_bytes(),
+        m_cpu_cache.used_bytes());
+
+    std::string disk_cache_text = generate_cache_brief(
+        "Disk cache | ", ImageCache::get_disk_item_count(), 0,
+        ImageCache::get_disk_capacity_bytes(),
+        ImageCache::get_disk_used_bytes());
 
     MMSOLVER_MAYA_INFO(
         "mmsolver::ImageCache::print_cache_brief: " << gpu_cache_text);
     MMSOLVER_MAYA_INFO(
         "mmsolver::ImageCache::print_cache_brief: " << cpu_cache_text);
+    MMSOLVER_MAYA_INFO(
+        "mmsolver::ImageCache::print_cache_brief: " << disk_cache_text);
     return;
 }
 
@@ -306,12 +563,7 @@ void ImageCache::gpu_group_names(GPUVectorString &out_group_names) const {
     const bool verbose = false;
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_group_names: ");
 
-    out_group_names.clear();
-    out_group_names.reserve(m_gpu_group_map.size());
-    for (auto it = m_gpu_group_map.begin(); it != m_gpu_group_map.end(); it++) {
-        const GPUCacheString value = it->first;
-        out_group_names.push_back(value);
-    }
+    m_gpu_cache.group_names(out_group_names);
     // The set is unordered, so lets make the output of this function
     // consistent for end users.
     std::sort(out_group_names.begin(), out_group_names.end());
@@ -323,12 +575,7 @@ void ImageCache::cpu_group_names(CPUVectorString &out_group_names) const {
     const bool verbose = false;
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_group_names: ");
 
-    out_group_names.clear();
-    out_group_names.reserve(m_cpu_group_map.size());
-    for (auto it = m_cpu_group_map.begin(); it != m_cpu_group_map.end(); it++) {
-        const CPUCacheString value = it->first;
-        out_group_names.push_back(value);
-    }
+    m_cpu_cache.group_names(out_group_names);
     // The set is unordered, so lets make the output of this function
     // consistent for end users.
     std::sort(out_group_names.begin(), out_group_names.end());
@@ -338,44 +585,26 @@ void ImageCache::cpu_group_names(CPUVectorString &out_group_names) const {
 
 size_t ImageCache::gpu_group_item_count(
     const GPUCacheString &group_name) const {
-    const auto group_search = m_gpu_group_map.find(group_name);
-    const bool group_found = group_search != m_gpu_group_map.end();
-    if (!group_found) {
-        return 0;
-    }
-
-    const GPUGroupSet &values_set = group_search->second;
-    return values_set.size();
+    const GPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    return m_gpu_cache.group_item_count(group_key);
 }
 
 size_t ImageCache::cpu_group_item_count(
     const CPUCacheString &group_name) const {
-    const auto group_search = m_cpu_group_map.find(group_name);
-    const bool group_found = group_search != m_cpu_group_map.end();
-    if (!group_found) {
-        return 0;
-    }
-
-    const CPUGroupSet &values_set = group_search->second;
-    return values_set.size();
+    const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    return m_cpu_cache.group_item_count(group_key);
 }
 
 bool ImageCache::gpu_group_item_names(
     const GPUCacheString &group_name,
     GPUVectorString &out_group_item_names) const {
-    out_group_item_names.clear();
-    const auto group_search = m_gpu_group_map.find(group_name);
-    const bool group_found = group_search != m_gpu_group_map.end();
+    const GPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    const bool group_found =
+        m_gpu_cache.group_item_names(group_key, out_group_item_names);
     if (!group_found) {
         return false;
     }
 
-    const GPUGroupSet &values_set = group_search->second;
-    out_group_item_names.reserve(values_set.size());
-    for (auto it = values_set.begin(); it != values_set.end(); it++) {
-        GPUCacheString value = *it;
-        out_group_item_names.push_back(value);
-    }
     // The set is unordered, so lets make the output of this function
     // consistent for end users.
     std::sort(out_group_item_names.begin(), out_group_item_names.end());
@@ -386,19 +615,13 @@ bool ImageCache::gpu_group_item_names(
 bool ImageCache::cpu_group_item_names(
     const CPUCacheString &group_name,
     CPUVectorString &out_group_item_names) const {
-    out_group_item_names.clear();
-    const auto group_search = m_cpu_group_map.find(group_name);
-    const bool group_found = group_search != m_cpu_group_map.end();
+    const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    const bool group_found =
+        m_cpu_cache.group_item_names(group_key, out_group_item_names);
     if (!group_found) {
         return false;
     }
 
-    const CPUGroupSet &values_set = group_search->second;
-    out_group_item_names.reserve(values_set.size());
-    for (auto it = values_set.begin(); it != values_set.end(); it++) {
-        CPUCacheString value = *it;
-        out_group_item_names.push_back(value);
-    }
     // The set is unordered, so lets make the output of this function
     // consistent for end users.
     std::sort(out_group_item_names.begin(), out_group_item_names.end());
@@ -406,44 +629,6 @@ bool ImageCache::cpu_group_item_names(
     return true;
 }
 
-bool ImageCache::gpu_insert_group(const GPUCacheString &group_name,
-                                  const GPUCacheString &file_path) {
-    const GPUGroupMapIt group_search = m_gpu_group_map.find(group_name);
-    const bool group_found = group_search != m_gpu_group_map.end();
-    if (!group_found) {
-        GPUGroupSet values_set;
-        values_set.insert(file_path);
-
-        const auto group_map_pair =
-            m_gpu_group_map.insert(std::make_pair(group_name, values_set));
-        const bool group_map_ok = group_map_pair.second;
-        assert(group_map_ok == true);
-    } else {
-        GPUGroupSet &values_set = group_search->second;
-        values_set.insert(file_path);
-    }
-    return true;
-}
-
-bool ImageCache::cpu_insert_group(const CPUCacheString &group_name,
-                                  const CPUCacheString &file_path) {
-    const CPUGroupMapIt group_search = m_cpu_group_map.find(group_name);
-    const bool group_found = group_search != m_cpu_group_map.end();
-    if (!group_found) {
-        CPUGroupSet values_set;
-        values_set.insert(file_path);
-
-        const auto group_map_pair =
-            m_cpu_group_map.insert(std::make_pair(group_name, values_set));
-        const bool group_map_ok = group_map_pair.second;
-        assert(group_map_ok == true);
-    } else {
-        CPUGroupSet &values_set = group_search->second;
-        values_set.insert(file_path);
-    }
-    return true;
-}
-
 static void update_texture(MTexture *texture,
                            const ImageCache::CPUCacheValue &image_pixel_data) {
     const bool verbose = false;
@@ -474,7 +659,7 @@ ImageCache::GPUCacheValue ImageCache::gpu_insert_item(
     assert(image_pixel_data.is_valid());
     const bool verbose = false;
 
-    const GPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const GPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
 
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_insert_item: "
                       << "item_key=" << item_key
@@ -482,9 +667,14 @@ ImageCache::GPUCacheValue ImageCache::gpu_insert_item(
                       << " file_path=" << file_path.c_str());
 
     GPUCacheValue texture_data = GPUCacheValue();
-    const ImageCache::GPUMapIt item_search = m_gpu_item_map.find(item_key);
-    const bool item_found = item_search != m_gpu_item_map.end();
-    if (!item_found) {
+    GPUCacheValue *found_texture_data = m_gpu_cache.find(item_key, file_path);
+    if (found_texture_data == nullptr) {
+        // A different file path with the same hash value is replaced.
+        GPUCacheValue replaced_texture_data;
+        if (m_gpu_cache.erase(item_key, replaced_texture_data)) {
+            replaced_texture_data.deallocate_texture(texture_manager);
+        }
+
         // If we are at capacity, make room for new entry.
         const size_t image_data_size = image_pixel_data.byte_count();
 
@@ -513,29 +703,17 @@ ImageCache::GPUCacheValue ImageCache::gpu_insert_item(
             return GPUCacheValue();
         }
 
-        m_gpu_used_bytes += texture_data.byte_count();
-        assert(m_gpu_used_bytes <= m_gpu_capacity_bytes);
-
-        // Make 'item_key' the most-recently-used item key, because when we
-        // insert an item into the cache, it's used most recently.
-        ImageCache::GPUKeyListIt item_key_iterator =
-            m_gpu_key_list.insert(m_gpu_key_list.end(), item_key);
-
-        // Create the key-value entry, linked to the usage record.
-        const auto item_map_pair = m_gpu_item_map.insert(std::make_pair(
-            item_key, std::make_pair(item_key_iterator, texture_data)));
-
-        const auto inserted_key_iterator = item_map_pair.first;
-        const bool item_ok = item_map_pair.second;
+        // Inserting an item into the cache makes 'item_key' the
+        // most-recently-used item key.
+        const GPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+        const bool item_ok =
+            m_gpu_cache.insert(group_key, group_name, item_key, file_path,
+                               texture_data, texture_data.byte_count());
         assert(item_ok == true);
-
-        const bool group_ok =
-            ImageCache::gpu_insert_group(group_name, file_path);
-        assert(group_ok == true);
+        assert(m_gpu_cache.used_bytes() <= m_gpu_capacity_bytes);
 
     } else {
-        ImageCache::GPUKeyListIt item_iterator = item_search->second.first;
-        texture_data = item_search->second.second;
+        texture_data = *found_texture_data;
         if (!texture_data.is_valid()) {
             MMSOLVER_MAYA_ERR(
                 "mmsolver::ImageCache: gpu_insert_item: "
@@ -543,8 +721,6 @@ ImageCache::GPUCacheValue ImageCache::gpu_insert_item(
             return ImageCache::GPUCacheValue();
         }
 
-        move_iterator_to_back_of_key_list(m_gpu_key_list, item_iterator);
-
         update_texture(texture_data.texture(), image_pixel_data);
     }
 
@@ -556,47 +732,306 @@ bool ImageCache::cpu_insert_item(const CPUCacheString &group_name,
                                  const CPUCacheValue &image_pixel_data) {
     const bool verbose = false;
 
-    const CPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const CPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
 
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_insert_item: "
                       << "item_key=" << item_key
                       << " group_name=" << group_name.c_str()
                       << " file_path=" << file_path.c_str());
 
-    const CPUMapIt item_search = m_cpu_item_map.find(item_key);
-    const bool item_found = item_search != m_cpu_item_map.end();
-    if (item_found) {
-        ImageCache::cpu_erase_item(item_key);
+    // Because we are inserting into the cache, the 'key' is the
+    // most-recently-used item. Any previous value with the same key
+    // is replaced, and the least recently used items are evicted to
+    // make room for the new entry.
+    //
+    // The cache's references to the removed pixels are released after
+    // the cache is unlocked; the pixels are deallocated once no other
+    // copy (held by a reader) uses them.
+    const size_t image_data_size = image_pixel_data.byte_count();
+    const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    std::vector<CPUCacheValue> evicted_values;
+    m_cpu_cache.insert(group_key, group_name, item_key, file_path,
+                       image_pixel_data, image_data_size, evicted_values);
+    deallocate_pixels(evicted_values);
+
+    return true;
+}
+
+bool ImageCache::cpu_prefetch_read_item(const CPUCacheString &group_name,
+                                        const CPUCacheString &file_path) {
+    const CPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
+    if (m_cpu_cache.contains(item_key, file_path)) {
+        return true;
     }
 
-    // If we are at capacity, make room for new entry.
-    const size_t image_data_size = image_pixel_data.byte_count();
-    const CacheEvictionResult evict_result =
-        ImageCache::cpu_evict_enough_for_new_item(image_data_size);
-    if (evict_result == CacheEvictionResult::kFailed) {
-        MMSOLVER_MAYA_WRN(
-            "mmsolver::ImageCache::cpu_insert_item: evicting memory failed!");
-        ImageCache::print_cache_brief();
+    ImagePixelData image_pixel_data;
+    if (ImageCache::cpu_read_item_from_disk(group_name, file_path,
+                                            image_pixel_data)) {
+        return true;
     }
+    return ImageCache::cpu_read_item_from_exr(group_name, file_path,
+                                              image_pixel_data);
+}
 
-    m_cpu_used_bytes += image_data_size;
-    assert(m_cpu_used_bytes <= m_cpu_capacity_bytes);
+bool ImageCache::cpu_read_item_from_exr(const CPUCacheString &group_name,
+                                        const CPUCacheString &file_path,
+                                        CPUCacheValue &out_image_pixel_data) {
+    const bool verbose = false;
 
-    // Because we are inserting into the cache, the 'key' is the
-    // most-recently-used item.
-    CPUKeyListIt item_key_iterator =
-        m_cpu_key_list.insert(m_cpu_key_list.end(), item_key);
+    PixelDataType pixel_data_type = PixelDataType::kUnknown;
+    uint8_t num_channels = 0;
+    ImageCache::cpu_pixel_format(pixel_data_type, num_channels);
+
+    CPUCacheValue image_pixel_data;
+    const bool read_ok = read_exr_image_pixel_data(
+        file_path, pixel_data_type, num_channels, image_pixel_data);
+    if (!read_ok) {
+        image_pixel_data.deallocate_pixels();
+        return false;
+    }
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_read_item_from_exr: "
+                      << "file_path=\"" << file_path.c_str() << "\""
+                      << " pixel_data_type="
+                      << static_cast<int>(pixel_data_type));
+
+    // The disk cache copies the pixels before they are inserted, so
+    // the background write does not depend on the CPU cache.
+    const bool background = true;
+    ImageCache::disk_write_pixels(file_path, image_pixel_data, background);
+    ImageCache::cpu_insert_item(group_name, file_path, image_pixel_data);
+    out_image_pixel_data = image_pixel_data;
+    return true;
+}
+
+void ImageCache::cpu_prefetch(const CPUCacheString &group_name,
+                              const CPUVectorString &file_paths) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_prefetch: "
+                      << "group_name=" << group_name.c_str()
+                      << " file_paths=" << file_paths.size());
+
+    if (m_prefetch_thread_count == 0) {
+        return;
+    }
+    if (!m_prefetcher) {
+        auto read_function = [this](const CPUCacheString &item_group_name,
+                                    const CPUCacheString &file_path) {
+            return ImageCache::cpu_prefetch_read_item(item_group_name,
+                                                      file_path);
+        };
+        m_prefetcher = std::unique_ptr<mmimage::ImagePrefetcher>(
+            new mmimage::ImagePrefetcher(read_function,
+                                         m_prefetch_thread_count));
+    }
+    m_prefetcher->prefetch(group_name, file_paths);
+}
+
+void ImageCache::cpu_cancel_prefetch(const CPUCacheString &group_name) {
+    if (m_prefetcher) {
+        m_prefetcher->cancel(group_name);
+    }
+}
+
+void ImageCache::wait_for_prefetch() {
+    if (m_prefetcher) {
+        m_prefetcher->wait_for_prefetch();
+    }
+}
+
+std::shared_ptr<mmimage::ImageDiskCache> ImageCache::disk_cache() const {
+    std::lock_guard<std::mutex> lock(m_disk_cache_mutex);
+    return m_disk_cache;
+}
+
+void ImageCache::set_disk_directory(const std::string &directory_path) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::set_disk_directory: "
+                      << "directory_path=\"" << directory_path.c_str()
+                      << "\"");
+
+    std::shared_ptr<mmimage::ImageDiskCache> new_disk_cache;
+    if (!directory_path.empty()) {
+        const size_t capacity_bytes = ImageCache::get_disk_capacity_bytes();
+        new_disk_cache = std::make_shared<mmimage::ImageDiskCache>(
+            directory_path, capacity_bytes, IMAGE_DISK_CACHE_THREAD_COUNT);
+    }
+
+    std::shared_ptr<mmimage::ImageDiskCache> old_disk_cache;
+    {
+        std::lock_guard<std::mutex> lock(m_disk_cache_mutex);
+        old_disk_cache = m_disk_cache;
+        m_disk_cache = new_disk_cache;
+    }
+
+    // The old disk cache waits for the queued writes when it is
+    // destroyed, so the lock is not held while waiting.
+    old_disk_cache.reset();
+}
+
+std::string ImageCache::get_disk_directory() const {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    if (!cache) {
+        return std::string();
+    }
+    return cache->directory_path();
+}
+
+size_t ImageCache::get_disk_capacity_bytes() const {
+    std::lock_guard<std::mutex> lock(m_disk_cache_mutex);
+    return m_disk_capacity_bytes;
+}
+
+void ImageCache::set_disk_capacity_bytes(const size_t value) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::set_disk_capacity_bytes: "
+                      << "capacity_bytes=" << value);
+
+    std::shared_ptr<mmimage::ImageDiskCache> cache;
+    {
+        std::lock_guard<std::mutex> lock(m_disk_cache_mutex);
+        m_disk_capacity_bytes = value;
+        cache = m_disk_cache;
+    }
+    if (cache) {
+        cache->set_capacity_bytes(value);
+    }
+}
+
+size_t ImageCache::get_disk_used_bytes() const {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    if (!cache) {
+        return 0;
+    }
+    return cache->used_bytes();
+}
+
+size_t ImageCache::get_disk_item_count() const {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    if (!cache) {
+        return 0;
+    }
+    return cache->item_count();
+}
+
+bool ImageCache::disk_write_pixels(const CPUCacheString &file_path,
+                                   const CPUCacheValue &image_pixel_data,
+                                   const bool background) {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    if (!cache || !image_pixel_data.is_valid()) {
+        return false;
+    }
+
+    mmimage::ImageDiskCache::Key disk_key = 0;
+    if (!mmimage::ImageDiskCache::make_key(file_path, disk_key)) {
+        return false;
+    }
+
+    mmimage::DiskCacheImageInfo info;
+    info.width = image_pixel_data.width();
+    info.height = image_pixel_data.height();
+    info.num_channels = image_pixel_data.num_channels();
+    info.bytes_per_channel = convert_pixel_data_type_to_bytes_per_channel(
+        image_pixel_data.pixel_data_type());
+    return cache->write(disk_key, info, image_pixel_data.pixel_data(),
+                        background);
+}
+
+bool ImageCache::write_cpu_item_to_disk(const CPUCacheString &file_path,
+                                        const bool background) {
+    const bool verbose = false;
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::write_cpu_item_to_disk: "
+                      << "file_path=\"" << file_path.c_str()
+                      << "\" background=" << background);
+
+    const CPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
+    CPUCacheValue image_pixel_data;
+    if (!m_cpu_cache.find(item_key, file_path, image_pixel_data)) {
+        return false;
+    }
+    return ImageCache::disk_write_pixels(file_path, image_pixel_data,
+                                         background);
+}
 
-    const auto item_map_pair = m_cpu_item_map.insert(std::make_pair(
-        item_key, std::make_pair(item_key_iterator, image_pixel_data)));
+void ImageCache::wait_for_disk_writes() {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    if (cache) {
+        cache->wait_for_writes();
+    }
+}
 
-    const auto inserted_key_iterator = item_map_pair.first;
-    const bool item_map_ok = item_map_pair.second;
-    assert(item_map_ok == true);
+bool ImageCache::disk_find(const CPUCacheString &file_path) {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    mmimage::ImageDiskCache::Key disk_key = 0;
+    return cache && mmimage::ImageDiskCache::make_key(file_path, disk_key) &&
+           cache->find(disk_key);
+}
 
-    const bool group_ok = ImageCache::cpu_insert_group(group_name, file_path);
-    assert(group_ok == true);
+bool ImageCache::disk_find_file_path(const CPUCacheString &file_path,
+                                     std::string &out_disk_file_path) {
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    mmimage::ImageDiskCache::Key disk_key = 0;
+    if (!cache || !mmimage::ImageDiskCache::make_key(file_path, disk_key) ||
+        !cache->find(disk_key)) {
+        return false;
+    }
+    out_disk_file_path = cache->file_path(disk_key);
+    return true;
+}
+
+bool ImageCache::cpu_read_item_from_disk(const CPUCacheString &group_name,
+                                         const CPUCacheString &file_path,
+                                         CPUCacheValue &out_image_pixel_data) {
+    const bool verbose = false;
 
+    std::shared_ptr<mmimage::ImageDiskCache> cache = ImageCache::disk_cache();
+    mmimage::ImageDiskCache::Key disk_key = 0;
+    if (!cache || !mmimage::ImageDiskCache::make_key(file_path, disk_key) ||
+        !cache->find(disk_key)) {
+        return false;
+    }
+
+    mmimage::DiskCacheImageInfo info;
+    if (!cache->read_info(disk_key, info)) {
+        return false;
+    }
+    const PixelDataType pixel_data_type =
+        convert_bytes_per_channel_to_pixel_data_type(info.bytes_per_channel);
+    if (pixel_data_type == PixelDataType::kUnknown) {
+        return false;
+    }
+
+    // EXR images are (re-)read when the CPU cache pixel format has
+    // changed since the disk cache file was written.
+    if (has_exr_file_extension(file_path)) {
+        PixelDataType cpu_pixel_data_type = PixelDataType::kUnknown;
+        uint8_t cpu_num_channels = 0;
+        ImageCache::cpu_pixel_format(cpu_pixel_data_type, cpu_num_channels);
+        if (!pixel_data_type_supports_rgb(cpu_pixel_data_type)) {
+            cpu_num_channels = 4;
+        }
+        if ((pixel_data_type != cpu_pixel_data_type) ||
+            (info.num_channels != cpu_num_channels)) {
+            return false;
+        }
+    }
+
+    CPUCacheValue image_pixel_data;
+    const bool allocated_ok = image_pixel_data.allocate_pixels(
+        info.width, info.height, info.num_channels, pixel_data_type);
+    if (!allocated_ok) {
+        MMSOLVER_MAYA_ERR("mmsolver::ImageCache::cpu_read_item_from_disk: "
+                          << "Could not allocate pixel data!");
+        return false;
+    }
+    if (!cache->read_pixels(disk_key, info, image_pixel_data.pixel_data())) {
+        image_pixel_data.deallocate_pixels();
+        return false;
+    }
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_read_item_from_disk: "
+                      << "file_path=\"" << file_path.c_str() << "\"");
+
+    ImageCache::cpu_insert_item(group_name, file_path, image_pixel_data);
+    out_image_pixel_data = image_pixel_data;
     return true;
 }
 
@@ -604,11 +1039,17 @@ ImageCache::GPUCacheValue ImageCache::gpu_find_item(
     const GPUCacheString &file_path) {
     const bool verbose = false;
 
-    const GPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const GPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_find_item: "
                       << "item_key=" << item_key << " file_path=\""
                       << file_path.c_str() << "\"");
-    return ImageCache::gpu_find_item(item_key);
+
+    // Finding the item makes it the most recently used item.
+    const GPUCacheValue *item_value = m_gpu_cache.find(item_key, file_path);
+    if (item_value != nullptr) {
+        return *item_value;
+    }
+    return GPUCacheValue();
 }
 
 ImageCache::GPUCacheValue ImageCache::gpu_find_item(
@@ -618,13 +1059,10 @@ ImageCache::GPUCacheValue ImageCache::gpu_find_item(
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_find_item: "
                       << "item_key=" << item_key);
 
-    const GPUMapIt item_search = m_gpu_item_map.find(item_key);
-    const bool item_found = item_search != m_gpu_item_map.end();
-    if (item_found) {
-        GPUKeyListIt item_iterator = item_search->second.first;
-        GPUCacheValue item_value = item_search->second.second;
-        move_iterator_to_back_of_key_list(m_gpu_key_list, item_iterator);
-        return item_value;
+    // Finding the item makes it the most recently used item.
+    const GPUCacheValue *item_value = m_gpu_cache.find(item_key);
+    if (item_value != nullptr) {
+        return *item_value;
     }
     return GPUCacheValue();
 }
@@ -633,11 +1071,15 @@ ImageCache::CPUCacheValue ImageCache::cpu_find_item(
     const CPUCacheString &file_path) {
     const bool verbose = false;
 
-    const CPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const CPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_find_item: "
                       << "item_key=" << item_key << " file_path=\""
                       << file_path.c_str() << "\"");
-    return ImageCache::cpu_find_item(item_key);
+
+    // Finding the item makes it the most recently used item.
+    CPUCacheValue item_value;
+    m_cpu_cache.find(item_key, file_path, item_value);
+    return item_value;
 }
 
 ImageCache::CPUCacheValue ImageCache::cpu_find_item(
@@ -647,15 +1089,10 @@ ImageCache::CPUCacheValue ImageCache::cpu_find_item(
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_find_item: "
                       << "item_key=" << item_key);
 
-    const CPUMapIt item_search = m_cpu_item_map.find(item_key);
-    const bool item_found = item_search != m_cpu_item_map.end();
-    if (item_found) {
-        CPUKeyListIt item_iterator = item_search->second.first;
-        CPUCacheValue item_value = item_search->second.second;
-        move_iterator_to_back_of_key_list(m_cpu_key_list, item_iterator);
-        return item_value;
-    }
-    return CPUCacheValue();
+    // Finding the item makes it the most recently used item.
+    CPUCacheValue item_value;
+    m_cpu_cache.find(item_key, item_value);
+    return item_value;
 }
 
 CacheEvictionResult ImageCache::gpu_evict_one_item(
@@ -665,35 +1102,28 @@ CacheEvictionResult ImageCache::gpu_evict_one_item(
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_evict_one_item: ");
     MMSOLVER_MAYA_VRB(
         "mmsolver::ImageCache::gpu_evict_one_item: "
-        "before m_gpu_used_bytes="
-        << m_gpu_used_bytes);
+        "before used_bytes="
+        << m_gpu_cache.used_bytes());
 
     assert(texture_manager != nullptr);
-    if (m_gpu_key_list.empty() ||
-        (m_gpu_item_map.size() <= m_gpu_item_count_minumum)) {
+    if (m_gpu_cache.empty() ||
+        (m_gpu_cache.item_count() <= m_gpu_item_count_minumum)) {
         return CacheEvictionResult::kNotNeeded;
     }
 
-    const GPUCacheKey item_key = m_gpu_key_list.front();
-    if (item_key == 0) {
+    GPUCacheKey item_key = 0;
+    GPUCacheValue texture_data;
+    const bool evicted =
+        m_gpu_cache.evict_least_recently_used(item_key, texture_data);
+    if (!evicted) {
         return CacheEvictionResult::kFailed;
     }
-    const GPUMapIt item_key_iterator = m_gpu_item_map.find(item_key);
-    assert(item_key_iterator != m_gpu_item_map.end());
-
-    GPUCacheValue texture_data = item_key_iterator->second.second;
-    m_gpu_used_bytes -= texture_data.byte_count();
     texture_data.deallocate_texture(texture_manager);
 
-    m_gpu_item_map.erase(item_key_iterator);
-    m_gpu_key_list.pop_front();
-
-    gpu_remove_item_from_group(item_key);
-
     MMSOLVER_MAYA_VRB(
         "mmsolver::ImageCache::gpu_evict_one_item: "
-        "after m_gpu_used_bytes="
-        << m_gpu_used_bytes);
+        "after used_bytes="
+        << m_gpu_cache.used_bytes());
     return CacheEvictionResult::kSuccess;
 }
 
@@ -703,34 +1133,27 @@ CacheEvictionResult ImageCache::cpu_evict_one_item() {
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_evict_one_item: ");
     MMSOLVER_MAYA_VRB(
         "mmsolver::ImageCache::cpu_evict_one_item: "
-        "before m_cpu_used_bytes="
-        << m_cpu_used_bytes);
+        "before used_bytes="
+        << m_cpu_cache.used_bytes());
 
-    if (m_cpu_key_list.empty() ||
-        (m_cpu_item_map.size() <= m_cpu_item_count_minumum)) {
+    if (m_cpu_cache.empty() ||
+        (m_cpu_cache.item_count() <= m_cpu_cache.item_count_minimum())) {
         return CacheEvictionResult::kNotNeeded;
     }
 
-    const CPUCacheKey item_key = m_cpu_key_list.front();
-    if (item_key == 0) {
+    CPUCacheKey item_key = 0;
+    CPUCacheValue image_pixel_data;
+    const bool evicted =
+        m_cpu_cache.evict_least_recently_used(item_key, image_pixel_data);
+    if (!evicted) {
         return CacheEvictionResult::kFailed;
     }
-    const CPUMapIt item_key_iterator = m_cpu_item_map.find(item_key);
-    assert(item_key_iterator != m_cpu_item_map.end());
-
-    CPUCacheValue image_pixel_data = item_key_iterator->second.second;
-    m_cpu_used_bytes -= image_pixel_data.byte_count();
     image_pixel_data.deallocate_pixels();
 
-    m_cpu_item_map.erase(item_key_iterator);
-    m_cpu_key_list.pop_front();
-
-    cpu_remove_item_from_group(item_key);
-
     MMSOLVER_MAYA_VRB(
         "mmsolver::ImageCache::cpu_evict_one_item: "
-        "after m_cpu_used_bytes="
-        << m_cpu_used_bytes);
+        "after used_bytes="
+        << m_cpu_cache.used_bytes());
     return CacheEvictionResult::kSuccess;
 }
 
@@ -741,21 +1164,21 @@ CacheEvictionResult ImageCache::gpu_evict_enough_for_new_item(
 
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_evict_enough_for_new_item: ");
 
-    if (m_gpu_key_list.empty() ||
-        (m_gpu_item_map.size() <= m_gpu_item_count_minumum)) {
+    if (m_gpu_cache.empty() ||
+        (m_gpu_cache.item_count() <= m_gpu_item_count_minumum)) {
         return CacheEvictionResult::kNotNeeded;
     }
 
     CacheEvictionResult result = CacheEvictionResult::kSuccess;
     // If we are at capacity remove the least recently used items
     // until we have enough room to store 'new_memory_chunk_size'.
-    size_t new_used_bytes = m_gpu_used_bytes + new_memory_chunk_size;
+    size_t new_used_bytes = m_gpu_cache.used_bytes() + new_memory_chunk_size;
     MMSOLVER_MAYA_VRB(
         "mmsolver::ImageCache::gpu_evict_enough_for_new_item: "
         "new_used_bytes="
         << new_used_bytes);
-    while (!m_gpu_item_map.empty() &&
-           (m_gpu_item_map.size() > m_gpu_item_count_minumum) &&
+    while (!m_gpu_cache.empty() &&
+           (m_gpu_cache.item_count() > m_gpu_item_count_minumum) &&
            (new_used_bytes > m_gpu_capacity_bytes)) {
         const CacheEvictionResult evict_result =
             ImageCache::gpu_evict_one_item(texture_manager);
@@ -763,7 +1186,7 @@ CacheEvictionResult ImageCache::gpu_evict_enough_for_new_item(
             result = evict_result;
             break;
         }
-        new_used_bytes = m_gpu_used_bytes + new_memory_chunk_size;
+        new_used_bytes = m_gpu_cache.used_bytes() + new_memory_chunk_size;
         MMSOLVER_MAYA_VRB(
             "mmsolver::ImageCache::gpu_evict_enough_for_new_item: "
             "new_used_bytes="
@@ -777,155 +1200,41 @@ CacheEvictionResult ImageCache::cpu_evict_enough_for_new_item(
     const size_t new_memory_chunk_size) {
     const bool verbose = false;
 
-    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_evict_enough_for_new_item: ");
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_evict_enough_for_new_item: "
+                      << "new_memory_chunk_size=" << new_memory_chunk_size);
 
-    if (m_cpu_key_list.empty() ||
-        (m_cpu_item_map.size() <= m_cpu_item_count_minumum)) {
+    if (m_cpu_cache.empty() ||
+        (m_cpu_cache.item_count() <= m_cpu_cache.item_count_minimum())) {
         return CacheEvictionResult::kNotNeeded;
     }
 
-    CacheEvictionResult result = CacheEvictionResult::kSuccess;
     // If we are at capacity remove the least recently used items
     // until we have enough room to store 'new_memory_chunk_size'.
-    size_t new_used_bytes = m_cpu_used_bytes + new_memory_chunk_size;
-    MMSOLVER_MAYA_VRB(
-        "mmsolver::ImageCache::cpu_evict_enough_for_new_item: "
-        "new_used_bytes="
-        << new_used_bytes);
-    while (!m_cpu_item_map.empty() &&
-           (m_cpu_item_map.size() > m_cpu_item_count_minumum) &&
-           (new_used_bytes > m_cpu_capacity_bytes)) {
-        const CacheEvictionResult evict_result =
-            ImageCache::cpu_evict_one_item();
-        if (evict_result != CacheEvictionResult::kSuccess) {
-            result = evict_result;
-            break;
-        }
-        new_used_bytes = m_cpu_used_bytes + new_memory_chunk_size;
-        MMSOLVER_MAYA_VRB(
-            "mmsolver::ImageCache::cpu_evict_enough_for_new_item: "
-            "new_used_bytes="
-            << new_used_bytes);
-    }
-
-    return result;
-}
-
-size_t ImageCache::gpu_remove_item_from_group(const GPUCacheKey item_key) {
-    const bool verbose = false;
-
-    MMSOLVER_MAYA_VRB(
-        "mmsolver::ImageCache::gpu_remove_item_from_group: "
-        "item_key="
-        << item_key);
-
-    size_t count = 0;
-    for (auto it = m_gpu_group_map.begin(); it != m_gpu_group_map.end();
-         /* no increment */) {
-        const GPUCacheString group_name = it->first;
-        GPUGroupSet &values_set = it->second;
-
-        // NOTE: This is a O(n) linear operation.
-        for (auto it2 = values_set.begin(); it2 != values_set.end();
-             /* no increment */) {
-            const GPUGroupKey item_value_hash = mmsolver::hash::make_hash(*it2);
-
-            if (item_key == item_value_hash) {
-                it2 = values_set.erase(it2);
-                count += 1;
-                if (verbose) {
-                    const GPUGroupKey group_key =
-                        mmsolver::hash::make_hash(group_name);
-                    MMSOLVER_MAYA_VRB(
-                        "mmsolver::ImageCache::gpu_remove_item_from_group: "
-                        << "group_key=" << group_key << " item_key=" << item_key
-                        << " item_value_hash=" << item_value_hash
-                        << " - got it");
-                }
-            } else {
-                MMSOLVER_MAYA_VRB(
-                    "mmsolver::ImageCache::gpu_remove_item_from_group: "
-                    << "item_key=" << item_key
-                    << " item_value_hash=" << item_value_hash);
-                ++it2;
-            }
-        }
-
-        MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_remove_item_from_group: "
-                          << "values_set.size()=" << values_set.size());
-
-        if (values_set.size() == 0) {
-            it = m_gpu_group_map.erase(it);
-        } else {
-            ++it;
-        }
-    }
-    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_remove_item_from_group: "
-                      << "count=" << count);
-
-    return count;
-}
-
-size_t ImageCache::cpu_remove_item_from_group(const CPUCacheKey item_key) {
-    const bool verbose = false;
-
-    MMSOLVER_MAYA_VRB(
-        "mmsolver::ImageCache::cpu_remove_item_from_group: "
-        "item_key="
-        << item_key);
-
-    size_t count = 0;
-    for (auto it = m_cpu_group_map.begin(); it != m_cpu_group_map.end();
-         /* no increment */) {
-        const CPUCacheString group_name = it->first;
-        CPUGroupSet &values_set = it->second;
-
-        const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
-
-        // NOTE: This is a O(n) linear operation.
-        for (auto it2 = values_set.begin(); it2 != values_set.end();
-             /* no increment */) {
-            const CPUGroupKey item_value_hash = mmsolver::hash::make_hash(*it2);
-
-            if (item_key == item_value_hash) {
-                it2 = values_set.erase(it2);
-                count += 1;
-                MMSOLVER_MAYA_VRB(
-                    "mmsolver::ImageCache::cpu_remove_item_from_group: "
-                    << "group_key=" << group_key << " item_key=" << item_key
-                    << " item_value_hash=" << item_value_hash << " - got it");
-            } else {
-                MMSOLVER_MAYA_VRB(
-                    "mmsolver::ImageCache::cpu_remove_item_from_group: "
-                    << "item_key=" << item_key
-                    << " item_value_hash=" << item_value_hash);
-                ++it2;
-            }
-        }
-
-        MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_remove_item_from_group: "
-                          << "values_set.size()=" << values_set.size());
-
-        if (values_set.size() == 0) {
-            it = m_cpu_group_map.erase(it);
-        } else {
-            ++it;
-        }
+    std::vector<CPUCacheValue> evicted_values;
+    const bool evict_ok = m_cpu_cache.evict_enough_for_new_item(
+        new_memory_chunk_size, evicted_values);
+    deallocate_pixels(evicted_values);
+    if (!evict_ok &&
+        (m_cpu_cache.item_count() > m_cpu_cache.item_count_minimum())) {
+        return CacheEvictionResult::kFailed;
     }
-    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_remove_item_from_group: "
-                      << "count=" << count);
-
-    return count;
+    return CacheEvictionResult::kSuccess;
 }
 
 bool ImageCache::gpu_erase_item(MHWRender::MTextureManager *texture_manager,
                                 const GPUCacheString &file_path) {
     const bool verbose = false;
-    const GPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const GPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_erase_item: "
                       << "item_key=" << item_key << " file_path=\""
                       << file_path.c_str() << "\"");
-    return ImageCache::gpu_erase_item(texture_manager, item_key);
+    GPUCacheValue texture_data;
+    const bool item_found =
+        m_gpu_cache.erase(item_key, file_path, texture_data);
+    if (item_found) {
+        texture_data.deallocate_texture(texture_manager);
+    }
+    return item_found;
 }
 
 bool ImageCache::gpu_erase_item(MHWRender::MTextureManager *texture_manager,
@@ -934,32 +1243,27 @@ bool ImageCache::gpu_erase_item(MHWRender::MTextureManager *texture_manager,
 
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_erase_item: "
                       << "item_key=" << item_key);
-    const GPUMapIt item_search = m_gpu_item_map.find(item_key);
-    const bool item_found = item_search != m_gpu_item_map.end();
+    GPUCacheValue texture_data;
+    const bool item_found = m_gpu_cache.erase(item_key, texture_data);
     if (item_found) {
-        GPUCacheValue texture_data = item_search->second.second;
-        m_gpu_used_bytes -= texture_data.byte_count();
         texture_data.deallocate_texture(texture_manager);
-
-        m_gpu_item_map.erase(item_search);
-
-        // NOTE: This is a O(n) linear operation, and can be very
-        // slow since the list items is spread out in memory.
-        m_gpu_key_list.remove(item_key);
-
-        // NOTE: This is a O(n) linear operation.
-        gpu_remove_item_from_group(item_key);
     }
     return item_found;
 }
 
 bool ImageCache::cpu_erase_item(const CPUCacheString &file_path) {
     const bool verbose = false;
-    const CPUGroupKey item_key = mmsolver::hash::make_hash(file_path);
+    const CPUCacheKey item_key = mmsolver::hash::make_hash(file_path);
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_erase_item: "
                       << "item_key=" << item_key << " file_path=\""
                       << file_path.c_str() << "\"");
-    return ImageCache::cpu_erase_item(item_key);
+    CPUCacheValue image_pixel_data;
+    const bool item_found =
+        m_cpu_cache.erase(item_key, file_path, image_pixel_data);
+    if (item_found) {
+        image_pixel_data.deallocate_pixels();
+    }
+    return item_found;
 }
 
 bool ImageCache::cpu_erase_item(const CPUCacheKey item_key) {
@@ -967,21 +1271,10 @@ bool ImageCache::cpu_erase_item(const CPUCacheKey item_key) {
 
     MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_erase_item: "
                       << "item_key=" << item_key);
-    const CPUMapIt item_search = m_cpu_item_map.find(item_key);
-    const bool item_found = item_search != m_cpu_item_map.end();
+    CPUCacheValue image_pixel_data;
+    const bool item_found = m_cpu_cache.erase(item_key, image_pixel_data);
     if (item_found) {
-        CPUCacheValue image_pixel_data = item_search->second.second;
-        m_cpu_used_bytes -= image_pixel_data.byte_count();
         image_pixel_data.deallocate_pixels();
-
-        m_cpu_item_map.erase(item_search);
-
-        // NOTE: This is a O(n) linear operation, and can be very
-        // slow since the list items is spread out in memory.
-        m_cpu_key_list.remove(item_key);
-
-        // NOTE: This is a O(n) linear operation.
-        cpu_remove_item_from_group(item_key);
     }
     return item_found;
 }
@@ -991,44 +1284,25 @@ size_t ImageCache::gpu_erase_group_items(
     const GPUCacheString &group_name) {
     const bool verbose = false;
 
-    if (verbose) {
-        const GPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
-        MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_erase_group_items: "
-                          << "group_key=" << group_key << " group_name=\""
-                          << group_name.c_str() << "\"");
+    const GPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::gpu_erase_group_items: "
+                      << "group_key=" << group_key << " group_name=\""
+                      << group_name.c_str() << "\"");
+
+    std::vector<GPUCacheKey> item_keys;
+    const bool group_found = m_gpu_cache.group_item_keys(group_key, item_keys);
+    if (!group_found) {
+        MMSOLVER_MAYA_WRN(
+            "mmsolver::ImageCache: gpu_erase_group_items: "
+            "Group name \""
+            << group_name << "\" not found!");
+        return 0;
     }
 
-    // Loop until all items in the group are removed.
-    size_t iteration = 0;
     size_t count = 0;
-    while (true) {
-        const GPUGroupMapIt group_search = m_gpu_group_map.find(group_name);
-        const bool group_found = group_search != m_gpu_group_map.end();
-        if (!group_found) {
-            if (iteration == 0) {
-                // When a user gives the wrong group name, we will
-                // print the warning, but if the group name is not
-                // valid after a removal (iteration > 0), then the
-                // user shouldn't be notified of that the group is not
-                // available.
-                MMSOLVER_MAYA_WRN(
-                    "mmsolver::ImageCache: gpu_erase_group_items: "
-                    "Group name \""
-                    << group_name << "\" not found!");
-            }
-            break;
-        }
-
-        GPUGroupSet &values_set = group_search->second;
-        GPUCacheString value = *values_set.begin();
-        // NOTE: This call will invalidate the 'values_set' value,
-        // because 'ImageCache::m_gpu_group_map' is changed by
-        // 'ImageCache::gpu_remove_item_from_group()' via
-        // 'ImageCache::gpu_erase_item()'.
-        const bool ok = ImageCache::gpu_erase_item(texture_manager, value);
+    for (const GPUCacheKey item_key : item_keys) {
+        const bool ok = ImageCache::gpu_erase_item(texture_manager, item_key);
         count += static_cast<size_t>(ok);
-
-        iteration++;
     }
 
     return count;
@@ -1037,46 +1311,23 @@ size_t ImageCache::gpu_erase_group_items(
 size_t ImageCache::cpu_erase_group_items(const CPUCacheString &group_name) {
     const bool verbose = false;
 
-    if (verbose) {
-        const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
-        MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_erase_group_items: "
-                          << "group_key=" << group_key << " group_name=\""
-                          << group_name.c_str() << "\"");
-    }
-
-    // Loop until all items in the group are removed.
-    size_t iteration = 0;
-    size_t count = 0;
-    while (true) {
-        const CPUGroupMapIt group_search = m_cpu_group_map.find(group_name);
-        const bool group_found = group_search != m_cpu_group_map.end();
-        if (!group_found) {
-            if (iteration == 0) {
-                // When a user gives the wrong group name, we will
-                // print the warning, but if the group name is not
-                // valid after a removal (iteration > 0), then the
-                // user shouldn't be notified of that the group is not
-                // available.
-                MMSOLVER_MAYA_WRN(
-                    "mmsolver::ImageCache: cpu_erase_group_items: "
-                    "Group name \""
-                    << group_name << "\" not found!");
-            }
-            break;
-        }
+    const CPUGroupKey group_key = mmsolver::hash::make_hash(group_name);
+    MMSOLVER_MAYA_VRB("mmsolver::ImageCache::cpu_erase_group_items: "
+                      << "group_key=" << group_key << " group_name=\""
+                      << group_name.c_str() << "\"");
 
-        CPUGroupSet &values_set = group_search->second;
-        CPUCacheString value = *values_set.begin();
-        // NOTE: This call will invalidate the 'values_set' value,
-        // because 'ImageCache::m_cpu_group_map' is changed by
-        // 'ImageCache::cpu_remove_item_from_group()' via
-        // 'ImageCache::cpu_erase_item()'.
-        const bool ok = ImageCache::cpu_erase_item(value);
-        count += static_cast<size_t>(ok);
-
-        iteration++;
+    std::vector<CPUCacheValue> erased_values;
+    const bool group_found = m_cpu_cache.erase_group(group_key, erased_values);
+    if (!group_found) {
+        MMSOLVER_MAYA_WRN(
+            "mmsolver::ImageCache: cpu_erase_group_items: "
+            "Group name \""
+            << group_name << "\" not found!");
+        return 0;
     }
 
+    const size_t count = erased_values.size();
+    deallocate_pixels(erased_values);
     return count;
 }
 
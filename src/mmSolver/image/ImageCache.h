@@ -24,10 +24,10 @@
 
 // STL
 #include <algorithm>
-#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 // Maya
 #include <maya/MImage.h>
@@ -38,6 +38,10 @@
 
 // MM Solver
 #include <mmcore/lib.h>
+#include <mmimage/image_cache_core.h>
+#include <mmimage/image_cache_sharded.h>
+#include <mmimage/image_disk_cache.h>
+#include <mmimage/image_prefetch.h>
 #include <mmimage/lib.h>
 
 #include "ImagePixelData.h"
@@ -46,22 +50,57 @@
 #include "mmSolver/utilities/debug_utils.h"
 #include "mmSolver/utilities/number_utils.h"
 
+// The number of frames after and before the current frame that are
+// read into the CPU cache in the background.
+#define IMAGE_PREFETCH_FRAMES_FORWARD (12)
+#define IMAGE_PREFETCH_FRAMES_BACKWARD (4)
+
+// The default number of threads used to read the prefetched
+// images. Reading EXR files is slow enough that a few threads keep
+// ahead of playback, without taking all the cores away from Maya.
+#define IMAGE_PREFETCH_THREAD_COUNT (4)
+
+// The environment variable with the number of threads used to read
+// the prefetched images. A value of 0 disables prefetching.
+#define IMAGE_PREFETCH_THREAD_COUNT_ENV_VAR_NAME \
+    "MMSOLVER_IMAGE_PREFETCH_THREAD_COUNT"
+
+// The environment variable with the directory of the disk cache. The
+// disk cache is disabled when the variable is not set (or empty).
+#define IMAGE_DISK_CACHE_DIRECTORY_ENV_VAR_NAME \
+    "MMSOLVER_IMAGE_DISK_CACHE_DIRECTORY"
+
+// The default capacity of the disk cache (16 GB), and the number of
+// threads writing images to the disk cache.
+#define IMAGE_DISK_CACHE_CAPACITY_BYTES \
+    (static_cast<size_t>(16) * 1024 * 1024 * 1024)
+#define IMAGE_DISK_CACHE_THREAD_COUNT (2)
+
+// The environment variable with the pixel format of the EXR images
+// stored in the CPU (and disk) cache; "rgba_f32" (the default),
+// "rgb_f32", "rgba_f16" or "rgba_u8".
+#define IMAGE_CACHE_PIXEL_FORMAT_ENV_VAR_NAME \
+    "MMSOLVER_IMAGE_CACHE_PIXEL_FORMAT"
+
 namespace mmsolver {
 namespace image {
 
 // The ImageCache, used to load and cache images into GPU, CPU and
 // Disk.
 //
-// Least-Recently-Used (LRU) Cache using standard C++11 data
-// structures.
+// Least-Recently-Used (LRU) Cache. The LRU and group bookkeeping is
+// done by 'mmimage::ImageCacheCore', this class owns the GPU/CPU
+// memory of the cached values.
 //
-// Inspired by:
-// https://web.archive.org/web/20161203001546/http://timday.bitbucket.org/lru.html
+// The CPU cache methods are thread-safe ('mmimage::ImageCacheSharded'
+// locks per shard of the key space), so images may be decoded and
+// inserted from many threads at once. The GPU cache methods must only
+// be called from the main thread, like the Maya texture manager.
 //
 // Singleton design pattern for C++11:
 // https://stackoverflow.com/a/1008289
 //
-// TODO: Use 4 layers of reading textures.
+// There are 4 layers of reading textures.
 //
 // Layer 0: The texture is GPU memory, in the
 // MHWRender::MTextureManager. If the texture is not in GPU memory,
@@ -71,21 +110,24 @@ namespace image {
 // Image Cache. If the texture pixel data cannot be found in the Image
 // Cache, look in the Disk Cache.
 //
-// Layer 2: The texture pixel data is stored on disk in a fast-to-read
-// (8-bit) image format (https://qoiformat.org/
-// https://crates.io/crates/qoi) which as been converted to sRGB
-// colour space. If the file cannot be found, read the original file
-// path.
+// Layer 2: The texture pixel data is stored on disk, as raw
+// (uncompressed) decoded pixels ('mmimage::ImageDiskCache'), so a
+// cache file is read with a single copy. If the file cannot be found,
+// read the original file path.
+//
+// Layer 3: The original file path is read and decoded, and then
+// placed into a queue to be saved into the disk cache. The queue of
+// images are processed off the main thread, so that the interactive
+// session does not slow down.
 //
-// Layer 3: The original file path should be read and decoded, and
-// then placed into a queue to be saved into the disk cache. The queue
-// of images are processed off the main thread, so that the
-// interactive session does not slow down.
+// EXR images are converted to the CPU cache pixel format (see
+// 'set_cpu_pixel_data_type()') once, as they are decoded. The CPU
+// and disk caches then store (and the GPU is given) the converted
+// pixels, so more frames fit into the same capacity.
 //
-// TODO: Support converting to 8-bit LDR image pixels before
-// storing. For example converting to sRGB colour space, and applying
-// tone-mapping to avoid clipping colours, so that as much detail is
-// retained - even if it's not colour accurate.
+// TODO: Convert 8-bit LDR image pixels to the sRGB colour space,
+// and apply tone-mapping to avoid clipping colours, so that as much
+// detail is retained - even if it's not colour accurate.
 //
 
 enum class CacheEvictionResult : uint8_t { kSuccess = 0, kNotNeeded, kFailed };
@@ -103,29 +145,11 @@ struct ImageCache {
     using GPUVectorString = std::vector<GPUCacheString>;
     using CPUVectorString = std::vector<CPUCacheString>;
 
-    using GPUKeyList = std::list<GPUCacheKey>;
-    using CPUKeyList = std::list<CPUCacheKey>;
-    using GPUKeyListIt = GPUKeyList::iterator;
-    using CPUKeyListIt = CPUKeyList::iterator;
-
-    using GPUMap =
-        std::unordered_map<GPUCacheKey, std::pair<GPUKeyListIt, GPUCacheValue>>;
-    using CPUMap =
-        std::unordered_map<CPUCacheKey, std::pair<CPUKeyListIt, CPUCacheValue>>;
-    using GPUMapIt = GPUMap::iterator;
-    using CPUMapIt = CPUMap::iterator;
-
     using GPUGroupKey = HashValue;
     using CPUGroupKey = HashValue;
-    using GPUGroupSet = std::unordered_set<GPUCacheString>;
-    using CPUGroupSet = std::unordered_set<CPUCacheString>;
-    using GPUGroupSetIt = GPUGroupSet::iterator;
-    using CPUGroupSetIt = CPUGroupSet::iterator;
 
-    using GPUGroupMap = std::unordered_map<GPUCacheString, GPUGroupSet>;
-    using CPUGroupMap = std::unordered_map<GPUCacheString, CPUGroupSet>;
-    using GPUGroupMapIt = GPUGroupMap::iterator;
-    using CPUGroupMapIt = CPUGroupMap::iterator;
+    using GPUCacheCore = mmimage::ImageCacheCore<GPUCacheValue>;
+    using CPUCacheSharded = mmimage::ImageCacheSharded<CPUCacheValue>;
 
 public:
     static ImageCache &getInstance() {
@@ -135,21 +159,12 @@ public:
     }
 
 private:
-    // Constructor. The {} brackets are needed here.
-    ImageCache()
-        : m_gpu_capacity_bytes(0)
-        , m_cpu_capacity_bytes(0)
-        , m_gpu_item_count_minumum(1)
-        , m_cpu_item_count_minumum(1)
-        , m_gpu_used_bytes(0)
-        , m_cpu_used_bytes(0) {}
-
-    template <typename KeyList, typename KeyListIt>
-    void move_iterator_to_back_of_key_list(KeyList &key_list,
-                                           KeyListIt key_list_iterator) {
-        // The back of the list is the "most recently used" key.
-        key_list.splice(key_list.end(), key_list, key_list_iterator);
-    }
+    // Constructor. The disk cache is enabled when the environment
+    // variable (IMAGE_DISK_CACHE_DIRECTORY_ENV_VAR_NAME) is set, the
+    // CPU cache pixel format may be set with
+    // IMAGE_CACHE_PIXEL_FORMAT_ENV_VAR_NAME, and the number of
+    // prefetching threads with IMAGE_PREFETCH_THREAD_COUNT_ENV_VAR_NAME.
+    ImageCache();
 
     // Evict cached items until a new memory chunk can fit in.
     CacheEvictionResult gpu_evict_enough_for_new_item(
@@ -158,17 +173,26 @@ private:
     CacheEvictionResult cpu_evict_enough_for_new_item(
         const size_t new_memory_chunk_size);
 
-    // Add group name into cache, associated with the file path.
-    //
-    // This is only used internally as a helper method.
-    bool gpu_insert_group(const GPUCacheString &group_name,
-                          const GPUCacheString &file_path);
-    bool cpu_insert_group(const CPUCacheString &group_name,
-                          const CPUCacheString &file_path);
+    // Read a prefetched image file into the CPU cache. Called on the
+    // prefetching threads.
+    bool cpu_prefetch_read_item(const CPUCacheString &group_name,
+                                const CPUCacheString &file_path);
+
+    // The pixel data type and number of channels EXR images are
+    // converted to, read together so a concurrent change of the
+    // format is never half seen.
+    void cpu_pixel_format(PixelDataType &out_pixel_data_type,
+                          uint8_t &out_num_channels) const;
+
+    // The disk cache, or nullptr when the disk cache is disabled. The
+    // disk cache is kept alive by the returned pointer, even if the
+    // disk cache directory is changed by another thread.
+    std::shared_ptr<mmimage::ImageDiskCache> disk_cache() const;
 
-    // Removes the given item key from the groups.
-    size_t gpu_remove_item_from_group(const GPUCacheKey item_key);
-    size_t cpu_remove_item_from_group(const CPUCacheKey item_key);
+    // Write the pixels of the (source) file path into the disk cache.
+    bool disk_write_pixels(const CPUCacheString &file_path,
+                           const CPUCacheValue &image_pixel_data,
+                           const bool background);
 
 public:
     // Get the capacity of the cache.
@@ -181,36 +205,37 @@ public:
     size_t get_cpu_capacity_bytes() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_cpu_capacity_bytes: "
-                          << "m_cpu_capacity_bytes=" << m_cpu_capacity_bytes);
-        return m_cpu_capacity_bytes;
+                          << "capacity_bytes="
+                          << m_cpu_cache.capacity_bytes());
+        return m_cpu_cache.capacity_bytes();
     }
 
     // Get amount of bytes used by the cache.
     size_t get_gpu_used_bytes() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_gpu_used_bytes: "
-                          << "m_gpu_used_bytes=" << m_gpu_used_bytes);
-        return m_gpu_used_bytes;
+                          << "used_bytes=" << m_gpu_cache.used_bytes());
+        return m_gpu_cache.used_bytes();
     }
     size_t get_cpu_used_bytes() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_cpu_used_bytes: "
-                          << "m_cpu_used_bytes=" << m_cpu_used_bytes);
-        return m_cpu_used_bytes;
+                          << "used_bytes=" << m_cpu_cache.used_bytes());
+        return m_cpu_cache.used_bytes();
     }
 
     // Get the number of items in the cache.
     size_t get_gpu_item_count() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_gpu_item_count: "
-                          << "m_gpu_item_map.size()=" << m_gpu_item_map.size());
-        return m_gpu_item_map.size();
+                          << "item_count=" << m_gpu_cache.item_count());
+        return m_gpu_cache.item_count();
     }
     size_t get_cpu_item_count() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_cpu_item_count: "
-                          << "m_cpu_item_map.size()=" << m_cpu_item_map.size());
-        return m_cpu_item_map.size();
+                          << "item_count=" << m_cpu_cache.item_count());
+        return m_cpu_cache.item_count();
     }
 
     // Set the capacity of the cache.
@@ -226,16 +251,14 @@ public:
     size_t get_gpu_group_count() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_gpu_group_count: "
-                          << "m_gpu_group_map.size()="
-                          << m_gpu_group_map.size());
-        return m_gpu_group_map.size();
+                          << "group_count=" << m_gpu_cache.group_count());
+        return m_gpu_cache.group_count();
     }
     size_t get_cpu_group_count() const {
         const bool verbose = false;
         MMSOLVER_MAYA_VRB("mmsolver::ImageCache::get_cpu_group_count: "
-                          << "m_cpu_group_map.size()="
-                          << m_cpu_group_map.size());
-        return m_cpu_group_map.size();
+                          << "group_count=" << m_cpu_cache.group_count());
+        return m_cpu_cache.group_count();
     }
 
     // Get sorted vector of group names.
@@ -252,23 +275,85 @@ public:
     bool cpu_group_item_names(const CPUCacheString &group_name,
                               CPUVectorString &out_group_item_names) const;
 
-    // TODO: Set/Get Disk cache location. Used to find disk-cached
+    // Get/Set the pixel data type and number of channels that EXR
+    // images are converted to, when read into the CPU cache. Half
+    // floats use half the memory of 32-bit floats, and 8-bit pixels
+    // use a quarter.
+    //
+    // Only 32-bit float pixels can have 3 channels (see
+    // 'pixel_data_type_supports_rgb()'), otherwise 4 channels are
+    // used. Images already in the caches are not converted.
+    PixelDataType get_cpu_pixel_data_type() const;
+    void set_cpu_pixel_data_type(const PixelDataType value);
+    uint8_t get_cpu_num_channels() const;
+    void set_cpu_num_channels(const uint8_t value);
+
+    // Set/Get the Disk cache location. Used to find disk-cached
     // files. This should be a directory on a very fast disk.
     //
-    // This class should allow a set of threads used for writing CPU
-    // cache data to image files. These files should be very fast to
-    // read into the CPU memory.
+    // An empty directory path disables the disk cache. Queued disk
+    // writes to the previous directory are finished before the
+    // previous disk cache is released.
+    void set_disk_directory(const std::string &directory_path);
+    std::string get_disk_directory() const;
+
+    // Get/Set the capacity of the disk cache. Setting the capacity
+    // deletes the least recently used files, until the disk cache
+    // fits.
+    size_t get_disk_capacity_bytes() const;
+    void set_disk_capacity_bytes(const size_t value);
+
+    // Get the bytes used and the number of files in the disk cache.
+    size_t get_disk_used_bytes() const;
+    size_t get_disk_item_count() const;
+
+    // Write the pixels of the CPU cache item into the disk cache.
+    //
+    // With 'background' the pixels are copied and written by the
+    // disk cache threads, otherwise the file is written before
+    // returning.
     //
-    // We would need methods such as:
+    // Returns false if the item is not in the CPU cache, the disk
+    // cache is disabled, or the pixels could not be written.
+    bool write_cpu_item_to_disk(const CPUCacheString &file_path,
+                                const bool background = true);
+
+    // Block until all queued disk cache writes have finished.
+    void wait_for_disk_writes();
+
+    // Is the (source) file path in the disk cache?
+    //
+    // A disk cache file is only found if the source file has not
+    // changed (the modification time and size are the same) since the
+    // disk cache file was written.
+    bool disk_find(const CPUCacheString &file_path);
+
+    // Get the path of the disk cache file of the (source) file path.
+    bool disk_find_file_path(const CPUCacheString &file_path,
+                             std::string &out_disk_file_path);
+
+    // Read the (source) file path from the disk cache and insert the
+    // pixels into the CPU cache.
     //
-    // bool write_cpu_item_to_disk(const CPUCacheKey &key, const bool
-    // background=true);
+    // EXR images stored in the disk cache with a different pixel
+    // format than the CPU cache pixel format are not read.
     //
-    // bool wait_for_disk_writes();
+    // Returns true/false, if the pixels were read or not.
+    bool cpu_read_item_from_disk(const CPUCacheString &group_name,
+                                 const CPUCacheString &file_path,
+                                 CPUCacheValue &out_image_pixel_data);
+
+    // Read the (source) EXR file, converted to the CPU cache pixel
+    // format, and insert the pixels into the CPU cache. The pixels
+    // are also written into the disk cache, in the background.
     //
-    // bool disk_find(const DiskCacheKey &key);
+    // The Maya API is not used, so this method may be called from
+    // any thread.
     //
-    // bool disk_find_file_path(const DiskCacheKey &key);
+    // Returns true/false, if the pixels were read or not.
+    bool cpu_read_item_from_exr(const CPUCacheString &group_name,
+                                const CPUCacheString &file_path,
+                                CPUCacheValue &out_image_pixel_data);
 
     // Insert pixels into CPU cache.
     //
@@ -288,7 +373,9 @@ public:
                                   const GPUCacheString &file_path,
                                   const CPUCacheValue &image_pixel_data);
 
-    // Find the item key in the GPU/CPU cache.
+    // Find the item key in the GPU/CPU cache. When a file path is
+    // given, an item with the same key but a different file path (a
+    // hash collision) is not found.
     //
     // Returns the GPUCacheValue at the item key, or nullptr.
     //
@@ -299,17 +386,37 @@ public:
     CPUCacheValue cpu_find_item(const CPUCacheString &file_path);
     CPUCacheValue cpu_find_item(const CPUCacheKey item_key);
 
-    // TODO: Add a 'gpu/cpu_prefetch()' method, used to add the images
-    // into a prefetching queue.
+    // Read the image files into the CPU cache on background threads,
+    // in the order given (highest priority first).
     //
-    // For the GPU, the images are uploaded to the GPU,
-    // asynchronously.
+    // Any file paths of the group that are queued but not yet read are
+    // replaced, so when the playhead jumps the frames around the old
+    // playhead are cancelled. File paths already in the CPU cache are
+    // skipped.
     //
-    // For the CPU, the images are read from disk cache, if they are
-    // not in memory.
+    // Only EXR files are prefetched, because the Maya API (MImage) is
+    // not safe to use off the main thread.
     //
-    // There must also be a way to wait for all prefetched images to
-    // be loaded before continuing - a "blocking" function call.
+    // Must be called from the main thread.
+    //
+    // TODO: Add a 'gpu_prefetch()' method, to upload the images to
+    // the GPU asynchronously.
+    void cpu_prefetch(const CPUCacheString &group_name,
+                      const CPUVectorString &file_paths);
+
+    // The number of threads used to read the prefetched images. When
+    // 0, 'cpu_prefetch()' does nothing.
+    size_t get_prefetch_thread_count() const {
+        return m_prefetch_thread_count;
+    }
+
+    // Remove the queued file paths of the group from the prefetch
+    // queue.
+    void cpu_cancel_prefetch(const CPUCacheString &group_name);
+
+    // Block until all the prefetched images are loaded into the CPU
+    // cache.
+    void wait_for_prefetch();
 
     // Evict the least recently used item from the GPU cache.
     //
@@ -319,10 +426,9 @@ public:
         MHWRender::MTextureManager *texture_manager);
     CacheEvictionResult cpu_evict_one_item();
 
-    // Remove the file path from the image GPU/CPU cache.
-    //
-    // NOTE: Due to the way the LRU cache works, this can be quite
-    // slow to to remove a specific file path from the cache.
+    // Remove the file path from the image GPU/CPU cache. When a file
+    // path is given, an item with the same key but a different file
+    // path is not removed.
     //
     // Returns true/false, if the item was removed or not.
     bool gpu_erase_item(MHWRender::MTextureManager *texture_manager,
@@ -348,53 +454,43 @@ public:
     void operator=(ImageCache const &) = delete;
 
 private:
-    // Amount of memory capacity.
+    // Amount of memory capacity. The CPU cache stores its own
+    // capacity.
     size_t m_gpu_capacity_bytes;
-    size_t m_cpu_capacity_bytes;
-
-    // How much memory is currently stored in the cached?
-    size_t m_gpu_used_bytes;
-    size_t m_cpu_used_bytes;
 
     // The minimum number of items that are allowed in the cache.  We
     // want to retain a fixed number of images, to avoid invalid
-    // conditions in the cache.
+    // conditions in the cache. The CPU cache stores its own minimum.
     size_t m_gpu_item_count_minumum;
-    size_t m_cpu_item_count_minumum;
-
-    // A Map of keys to values.
-    //
-    // An unordered hash map is used to map file path strings to CPU
-    // Image Data and GPU texture resources.
-    //
-    // These maps also contain pointers into the 'key list' data
-    // structures, allowing us to map from the values to the 'key
-    // list's.
-    GPUMap m_gpu_item_map;
-    CPUMap m_cpu_item_map;
 
-    // List of keys.
-    //
-    // A double-ended linked list (std::list) is used because we want
-    // to be able to push/pop and access the (front/back) ends of the
-    // list as fast as possible.
-    //
-    // Additionally, the linked list ensure that the pointers of each
-    // item in the list stays consistent over time, so that pointers
-    // into the memory can be used directly without fear that the
-    // underlying memory will be cleared.
+    // The cached items, the least-recently-used order of the items,
+    // and the groups of items (such as all the images used by an
+    // image sequence).
     //
-    // The 'front' of the list is the "least recently used" key.  The
-    // 'back' of the list is the "most recently used" key.
-    GPUKeyList m_gpu_key_list;
-    CPUKeyList m_cpu_key_list;
-
-    // A Map of groups to a Set of key values.
-    //
-    // This map can be used to find all the loaded values used by an
-    // image sequence.
-    GPUGroupMap m_gpu_group_map;
-    CPUGroupMap m_cpu_group_map;
+    // The cores also keep count of the memory currently used by the
+    // cached items.
+    GPUCacheCore m_gpu_cache;
+    CPUCacheSharded m_cpu_cache;
+
+    // The pixel format EXR images are converted to. Read by the
+    // prefetching threads, so the values are guarded by the mutex.
+    mutable std::mutex m_cpu_pixel_format_mutex;
+    PixelDataType m_cpu_pixel_data_type;
+    uint8_t m_cpu_num_channels;
+
+    // The disk cache may be replaced while the prefetching threads
+    // are using it, so the pointer is guarded by the mutex.
+    mutable std::mutex m_disk_cache_mutex;
+    size_t m_disk_capacity_bytes;
+    std::shared_ptr<mmimage::ImageDiskCache> m_disk_cache;
+
+    // The prefetcher is created on first use (with
+    // 'm_prefetch_thread_count' threads), so no threads are started
+    // until images are prefetched. Declared after 'm_cpu_cache' and
+    // 'm_disk_cache', so the threads are stopped before the caches
+    // are destroyed.
+    size_t m_prefetch_thread_count;
+    std::unique_ptr<mmimage::ImagePrefetcher> m_prefetcher;
 };
 
 MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
@@ -404,6 +500,12 @@ MTexture *read_texture_image_file(MHWRender::MTextureManager *texture_manager,
                                   const MString &file_pattern,
                                   const MString &file_path,
                                   const bool do_texture_update);
+
+// Queue the frames around 'frame' of the image sequence
+// 'file_pattern' to be read into the CPU cache in the background.
+void prefetch_image_sequence(ImageCache &image_cache,
+                             const MString &file_pattern,
+                             const mmcore::FrameValue frame);
 }  // namespace image
 }  // namespace mmsolver
 
@@ -75,7 +75,7 @@ bool ImagePixelData::allocate_pixels(const uint32_t width,
     bool ok = false;
     void *data = std::malloc(pixel_data_byte_count);
     if (data) {
-        m_pixel_data = data;
+        m_pixel_data = std::shared_ptr<void>(data, std::free);
         ok = true;
     } else {
         ok = false;
@@ -90,7 +90,7 @@ bool ImagePixelData::allocate_pixels(const uint32_t width,
     return ok;
 }
 
-void ImagePixelData::deallocate_pixels() { std::free(m_pixel_data); }
+void ImagePixelData::deallocate_pixels() { m_pixel_data.reset(); }
 
 }  // namespace image
 }  // namespace mmsolver
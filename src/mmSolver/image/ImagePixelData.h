@@ -25,6 +25,7 @@
 // STL
 #include <algorithm>
 #include <list>
+#include <memory>
 #include <string>
 #include <unordered_map>
 
@@ -44,6 +45,10 @@
 namespace mmsolver {
 namespace image {
 
+// The pixels are shared by all copies of an 'ImagePixelData', and are
+// deallocated when the last copy holding them releases them. A copy
+// taken from the CPU image cache therefore stays valid after the cache
+// evicts the item on another thread.
 struct ImagePixelData {
     ImagePixelData()
         : m_pixel_data(nullptr)
@@ -52,10 +57,12 @@ struct ImagePixelData {
         , m_num_channels(0)
         , m_pixel_data_type(PixelDataType::kUnknown){};
 
+    // Wraps pixels owned by someone else (for example Maya); the
+    // pixels are never deallocated by 'ImagePixelData'.
     ImagePixelData(void *pixel_data, const uint32_t width,
                    const uint32_t height, const uint8_t num_channels,
                    const PixelDataType pixel_data_type)
-        : m_pixel_data(pixel_data)
+        : m_pixel_data(pixel_data, [](void *) {})
         , m_width(width)
         , m_height(height)
         , m_num_channels(num_channels)
@@ -66,6 +73,8 @@ struct ImagePixelData {
     bool allocate_pixels(const uint32_t width, const uint32_t height,
                          const uint8_t num_channels,
                          const PixelDataType pixel_data_type);
+
+    // Release this copy's reference to the pixels.
     void deallocate_pixels();
 
     bool is_valid() const {
@@ -74,7 +83,7 @@ struct ImagePixelData {
                (m_pixel_data_type != PixelDataType::kUnknown);
     };
 
-    void *pixel_data() const { return m_pixel_data; };
+    void *pixel_data() const { return m_pixel_data.get(); };
     uint32_t width() const { return m_width; }
     uint32_t height() const { return m_height; }
     uint8_t num_channels() const { return m_num_channels; }
@@ -88,7 +97,7 @@ struct ImagePixelData {
     }
 
 private:
-    void *m_pixel_data;
+    std::shared_ptr<void> m_pixel_data;
     uint32_t m_width;
     uint32_t m_height;
     uint8_t m_num_channels;
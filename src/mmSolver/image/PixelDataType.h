@@ -47,6 +47,9 @@ enum class PixelDataType : uint8_t {
     kU8 = 0,
     kF32,
 
+    // 16-bit (half) floats.
+    kF16,
+
     // Always the second to last, so it's equal to the number of
     // options.
     kCount,
@@ -64,6 +67,9 @@ static uint8_t convert_pixel_data_type_to_bytes_per_channel(
     } else if (pixel_data_type == PixelDataType::kF32) {
         // 32-bit floats use 4 bytes.
         bytes_per_channel = 4;
+    } else if (pixel_data_type == PixelDataType::kF16) {
+        // 16-bit floats use 2 bytes.
+        bytes_per_channel = 2;
     } else {
         bytes_per_channel = 0;
         MMSOLVER_MAYA_ERR(
@@ -73,13 +79,36 @@ static uint8_t convert_pixel_data_type_to_bytes_per_channel(
     return bytes_per_channel;
 }
 
+static PixelDataType convert_bytes_per_channel_to_pixel_data_type(
+    const uint8_t bytes_per_channel) {
+    if (bytes_per_channel == 1) {
+        return PixelDataType::kU8;
+    } else if (bytes_per_channel == 4) {
+        return PixelDataType::kF32;
+    } else if (bytes_per_channel == 2) {
+        return PixelDataType::kF16;
+    }
+    return PixelDataType::kUnknown;
+}
+
+// Viewport 2.0 only has a 3-channel "RGB" texture format for 32-bit
+// floats, so other pixel data types are always "RGBA".
+static bool pixel_data_type_supports_rgb(const PixelDataType pixel_data_type) {
+    return pixel_data_type == PixelDataType::kF32;
+}
+
 static MHWRender::MRasterFormat convert_pixel_data_type_to_texture_format(
-    const PixelDataType pixel_data_type) {
+    const PixelDataType pixel_data_type, const uint8_t num_channels) {
     if (pixel_data_type == PixelDataType::kU8) {
         // Assumes the 8-bit data is "RGBA".
         return MHWRender::kR8G8B8A8_UNORM;
     } else if (pixel_data_type == PixelDataType::kF32) {
+        if (num_channels == 3) {
+            return MHWRender::kR32G32B32_FLOAT;
+        }
         return MHWRender::kR32G32B32A32_FLOAT;
+    } else if (pixel_data_type == PixelDataType::kF16) {
+        return MHWRender::kR16G16B16A16_FLOAT;
     }
 
     return MHWRender::MRasterFormat();
@@ -89,8 +89,8 @@ bool TextureData::allocate_texture(MHWRender::MTextureManager *texture_manager,
     texture_desc.fMipmaps = 1;
     texture_desc.fArraySlices = 1;
     texture_desc.fTextureType = MHWRender::kImage2D;
-    texture_desc.fFormat =
-        convert_pixel_data_type_to_texture_format(m_pixel_data_type);
+    texture_desc.fFormat = convert_pixel_data_type_to_texture_format(
+        m_pixel_data_type, m_num_channels);
 
     texture_desc.fBytesPerRow = m_num_channels * bytes_per_channel * m_width;
     texture_desc.fBytesPerSlice = texture_desc.fBytesPerRow * m_height;
@@ -41,6 +41,7 @@
 
 // MM Solver
 #include <mmcore/lib.h>
+#include <mmimage/image_pixel_convert.h>
 #include <mmimage/lib.h>
 
 #include "PixelDataType.h"
@@ -339,5 +340,87 @@ MStatus read_image_file(MImage &maya_mimage,
     return status;
 }
 
+bool read_exr_image_pixel_data(const std::string &file_path,
+                               const PixelDataType pixel_data_type,
+                               const uint8_t num_channels,
+                               ImagePixelData &out_image_pixel_data) {
+    const bool verbose = false;
+
+    mmimage::ImagePixelBuffer pixel_buffer;
+    mmimage::ImageMetaData meta_data;
+    const rust::Str input_file_path(file_path.c_str());
+
+    // Read the same way as 'read_exr_with_mmimage()', so the cached
+    // pixels are the same as pixels read on the main thread.
+    //
+    // Half float pixels are read directly by the EXR reader, 8-bit
+    // pixels are converted from 32-bit floats.
+    const bool vertical_flip = true;
+    bool read_ok = false;
+    if (pixel_data_type == PixelDataType::kF16) {
+        read_ok = mmimage::image_read_pixels_exr_f16x4(
+            input_file_path, vertical_flip, meta_data, pixel_buffer);
+    } else if ((pixel_data_type == PixelDataType::kF32) ||
+               (pixel_data_type == PixelDataType::kU8)) {
+        read_ok = mmimage::image_read_pixels_exr_f32x4(
+            input_file_path, vertical_flip, meta_data, pixel_buffer);
+    } else {
+        MMSOLVER_MAYA_ERR("mmsolver::image_io::read_exr_image_pixel_data: "
+                          << "Invalid pixel type is "
+                          << static_cast<int>(pixel_data_type));
+        return false;
+    }
+    if (!read_ok) {
+        return false;
+    }
+
+    // The pixel buffer always stores 4 values per-pixel.
+    const size_t in_num_channels = 4;
+    uint8_t out_num_channels = 4;
+    if ((num_channels == 3) && pixel_data_type_supports_rgb(pixel_data_type)) {
+        out_num_channels = 3;
+    }
+
+    const uint32_t width = static_cast<uint32_t>(pixel_buffer.image_width());
+    const uint32_t height =
+        static_cast<uint32_t>(pixel_buffer.image_height());
+    const bool allocated_ok = out_image_pixel_data.allocate_pixels(
+        width, height, out_num_channels, pixel_data_type);
+    if (!allocated_ok) {
+        return false;
+    }
+
+    MMSOLVER_MAYA_VRB(
+        "mmsolver::image_io::read_exr_image_pixel_data:"
+        << " width=" << width << " height=" << height
+        << " num_channels=" << static_cast<int32_t>(out_num_channels)
+        << " pixel_data_type=" << static_cast<int32_t>(pixel_data_type));
+
+    const size_t pixel_count = static_cast<size_t>(width) * height;
+    if (pixel_data_type == PixelDataType::kF16) {
+        const rust::Slice<const mmimage::PixelF16x4> slice =
+            pixel_buffer.as_slice_f16x4();
+        std::memcpy(out_image_pixel_data.pixel_data(), slice.data(),
+                    out_image_pixel_data.byte_count());
+    } else {
+        const rust::Slice<const mmimage::PixelF32x4> slice =
+            pixel_buffer.as_slice_f32x4();
+        const float *in_pixels = reinterpret_cast<const float *>(slice.data());
+        if (pixel_data_type == PixelDataType::kF32) {
+            float *out_pixels =
+                static_cast<float *>(out_image_pixel_data.pixel_data());
+            mmimage::copy_pixels_f32(in_pixels, pixel_count, in_num_channels,
+                                     out_num_channels, out_pixels);
+        } else {
+            uint8_t *out_pixels =
+                static_cast<uint8_t *>(out_image_pixel_data.pixel_data());
+            mmimage::convert_pixels_f32_to_u8(in_pixels, pixel_count,
+                                              in_num_channels,
+                                              out_num_channels, out_pixels);
+        }
+    }
+    return true;
+}
+
 }  // namespace image
 }  // namespace mmsolver
@@ -39,6 +39,7 @@
 #include <mmcore/lib.h>
 #include <mmimage/lib.h>
 
+#include "ImagePixelData.h"
 #include "PixelDataType.h"
 #include "mmSolver/utilities/debug_utils.h"
 
@@ -55,6 +56,22 @@ MStatus read_image_file(MImage &maya_mimage,
                         PixelDataType &out_pixel_data_type,
                         void *&out_pixel_data);
 
+// Read the EXR file into newly allocated pixels, owned by the caller.
+//
+// The pixels are converted to 'pixel_data_type' and 'num_channels'
+// (3 or 4) as they are read, so the pixels do not need converting
+// again later. Only 32-bit float pixels can have 3 channels (see
+// 'pixel_data_type_supports_rgb()'), other pixel data types always
+// have 4 channels. 8-bit pixels are clamped between 0.0 and 1.0
+// without any colour space conversion.
+//
+// The Maya API is not used, so this function may be called from any
+// thread (such as the image prefetching threads).
+bool read_exr_image_pixel_data(const std::string &file_path,
+                               const PixelDataType pixel_data_type,
+                               const uint8_t num_channels,
+                               ImagePixelData &out_image_pixel_data);
+
 }  // namespace image
 }  // namespace mmsolver
 
@@ -31,10 +31,12 @@
 #include <ctime>
 #include <iostream>
 #include <limits>
+#include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 // Maya
@@ -65,6 +67,7 @@
 
 // MM Solver
 #include <mmcore/mmdata.h>
+#include <mmcore/mmhash.h>
 #include <mmcore/mmmath.h>
 #include <mmlens/lens_model.h>
 #include <mmlens/lens_model_3de_anamorphic_deg_4_rotate_squeeze_xy.h>
@@ -750,129 +753,191 @@ MStatus getAttrsFromLensNode(const MObject &node, const MString &nodeName,
 // and be 'shared' across cameras. In such a case, when an attribute
 // on a single lens node is adjusted, the lens distortion should
 // change for all connected cameras.
-MStatus constructLenses(
-    const std::vector<MString> &lensNodeNames, const CameraPtrList &cameraList,
+//
+// The lenses are constructed in connection order (first to last),
+// so the input LensModel of each frame is constructed before the
+// LensModel using it, and is connected as the frame is constructed.
+//
+// Lens models of different frames are interned (shared), when the
+// lens values (hash value) and the input LensModel are the same, so
+// a static lens uses a single LensModel for all frames. A LensModel
+// is only shared when the whole input chain is also shared. Lens
+// nodes with solved attributes are changed per-frame by the solver,
+// so each frame is given a unique LensModel (and so are all the
+// lenses using it as an input).
+MStatus constructLens(
+    const MString &lensNodeName, const MString &inputLensNodeName,
+    const std::unordered_set<std::string> &solvedLensNodeNames,
     const MTimeArray &frameList,
-    const std::vector<std::vector<MString>> &cameraLensNodeNames,
     const std::unordered_map<std::string, std::shared_ptr<mmlens::LensModel>>
         &lensNodeNameToLensModel,
-    std::unordered_map<std::string, uint32_t> &out_lensNodeNameToLensModelIndex,
+    std::unordered_map<std::string, uint32_t> &out_lensNodeNameToLensFrameIndex,
+    std::vector<int32_t> &out_lensFrameToLensModelIndexList,
     std::vector<std::shared_ptr<mmlens::LensModel>> &out_lensModelList) {
     MStatus status = MS::kSuccess;
 
-    auto num_cameras = cameraList.size();
     auto num_frames = frameList.length();
-    out_lensModelList.clear();
+    std::string lensNodeNameStr(lensNodeName.asChar());
 
-    // Loop over all Lenses (including the "input" Lenses) and query
-    // the attribute values per-frame.
-    for (uint32_t i = 0; i < lensNodeNames.size(); i++) {
-        MString lensNodeName = lensNodeNames[i];
-        std::string lensNodeNameStr(lensNodeName.asChar());
+    MObject node;
+    status = getAsObject(lensNodeName, node);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    if (node.isNull()) {
+        MMSOLVER_MAYA_ERR("Node name "
+                          << "\"" << lensNodeNameStr
+                          << "\""
+                             " is not valid, skipping.");
+        return status;
+    }
 
-        MObject node;
-        status = getAsObject(lensNodeName, node);
-        CHECK_MSTATUS_AND_RETURN_IT(status);
-        if (node.isNull()) {
-            MMSOLVER_MAYA_ERR("Node name "
-                              << "\"" << lensNodeNameStr
-                              << "\""
-                                 " is not valid, skipping.");
-            continue;
-        }
+    auto search = lensNodeNameToLensModel.find(lensNodeNameStr);
+    if (search == lensNodeNameToLensModel.end()) {
+        MMSOLVER_MAYA_ERR("Lens node name "
+                          << "\"" << lensNodeNameStr << "\""
+                          << " does not have a LensModel object, this should "
+                             "not happen. ");
+        return status;
+    }
+    std::shared_ptr<mmlens::LensModel> lensModel = search->second;
+    if (!lensModel) {
+        return status;
+    }
 
-        auto search = lensNodeNameToLensModel.find(lensNodeNameStr);
-        if (search == lensNodeNameToLensModel.end()) {
-            MMSOLVER_MAYA_ERR(
-                "Lens node name "
-                << "\"" << lensNodeNameStr << "\""
-                << " does not have a LensModel object, this should "
-                   "not happen. ");
-            continue;
+    // The input lens has already been constructed (if it is valid).
+    bool hasInputLens = false;
+    uint32_t inputLensFrameIndex = 0;
+    if (inputLensNodeName.length() > 0) {
+        std::string inputLensNodeNameStr(inputLensNodeName.asChar());
+        auto inputSearch =
+            out_lensNodeNameToLensFrameIndex.find(inputLensNodeNameStr);
+        if (inputSearch != out_lensNodeNameToLensFrameIndex.end()) {
+            hasInputLens = true;
+            inputLensFrameIndex = inputSearch->second;
         }
-        std::shared_ptr<mmlens::LensModel> lensModel = search->second;
+    }
 
-        auto lensIndex = static_cast<int32_t>(out_lensModelList.size());
-        out_lensNodeNameToLensModelIndex.insert({lensNodeNameStr, lensIndex});
+    auto lensFrameIndex =
+        static_cast<uint32_t>(out_lensFrameToLensModelIndexList.size());
+    out_lensNodeNameToLensFrameIndex.insert({lensNodeNameStr, lensFrameIndex});
 
-        // Fill out_lensModelList.
-        for (uint32_t j = 0; j < num_frames; j++) {
-            std::shared_ptr<mmlens::LensModel> lensModelClone =
-                lensModel->cloneAsSharedPtr();
-            out_lensModelList.push_back(lensModelClone);
-        }
+    // Determine what type of lens node we have and find plugs on
+    // the lens node.
+    std::vector<Attr> lensAttrs;
+    status = getAttrsFromLensNode(node, lensNodeName, lensAttrs);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    auto num_lens_attrs = lensAttrs.size();
 
-        // Determine what type of lens node we have and find plugs on
-        // the lens node.
-        std::vector<Attr> lensAttrs;
-        status = getAttrsFromLensNode(node, lensNodeName, lensAttrs);
-        CHECK_MSTATUS_AND_RETURN_IT(status);
-        auto num_lens_attrs = lensAttrs.size();
+    const bool isSolved = solvedLensNodeNames.count(lensNodeNameStr) > 0;
 
-        for (uint32_t j = 0; j < num_frames; j++) {
-            auto lensFrameIndex = lensIndex + j;
-            std::shared_ptr<mmlens::LensModel> lensModel =
-                out_lensModelList[lensFrameIndex];
-            if (!lensModel) {
-                continue;
-            }
+    // The interned lens models, keyed by the lens hash value and the
+    // index of the input lens model.
+    using InternKey = std::pair<mmhash::HashValue, int32_t>;
+    std::map<InternKey, int32_t> internKeyToLensModelIndex;
 
-            const MTime frame = frameList[j];
-            for (uint32_t k = 0; k < num_lens_attrs; k++) {
-                // Query values from attrs
-                double value = 0.0;
-                const auto timeEvalMode = TIME_EVAL_MODE_DG_CONTEXT;
-                status = lensAttrs[k].getValue(value, frame, timeEvalMode);
-                CHECK_MSTATUS_AND_RETURN_IT(status);
-                const auto solverAttrType = lensAttrs[k].getSolverAttrType();
+    std::shared_ptr<mmlens::LensModel> frameLensModel;
+    for (uint32_t j = 0; j < num_frames; j++) {
+        if (!frameLensModel) {
+            frameLensModel = lensModel->cloneAsSharedPtr();
+        }
 
-                // Set attribute on the LensModel object.
-                status = setLensModelAttributeValue(lensModel, solverAttrType,
-                                                    value);
-                CHECK_MSTATUS_AND_RETURN_IT(status);
+        int32_t inputLensModelIndex = LENS_MODEL_INDEX_NONE;
+        std::shared_ptr<mmlens::LensModel> inputLensModel;
+        if (hasInputLens) {
+            inputLensModelIndex =
+                out_lensFrameToLensModelIndexList[inputLensFrameIndex + j];
+            inputLensModel = out_lensModelList[inputLensModelIndex];
+        }
+        frameLensModel->setInputLensModel(inputLensModel);
+
+        const MTime frame = frameList[j];
+        for (uint32_t k = 0; k < num_lens_attrs; k++) {
+            // Query values from attrs
+            double value = 0.0;
+            const auto timeEvalMode = TIME_EVAL_MODE_DG_CONTEXT;
+            status = lensAttrs[k].getValue(value, frame, timeEvalMode);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+            const auto solverAttrType = lensAttrs[k].getSolverAttrType();
+
+            // Set attribute on the LensModel object.
+            status = setLensModelAttributeValue(frameLensModel,
+                                                solverAttrType, value);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+        }
+
+        auto lensModelIndex = static_cast<int32_t>(out_lensModelList.size());
+        if (!isSolved) {
+            // A unique (not shared) input lens model has a different
+            // index on each frame, so this lens model is only shared
+            // when the input lens model is also shared.
+            //
+            // The un-used clone is re-used for the next frame.
+            const InternKey key(frameLensModel->hashValue(),
+                                inputLensModelIndex);
+            auto inserted =
+                internKeyToLensModelIndex.insert({key, lensModelIndex});
+            if (!inserted.second) {
+                out_lensFrameToLensModelIndexList.push_back(
+                    inserted.first->second);
+                continue;
             }
         }
+
+        out_lensModelList.push_back(frameLensModel);
+        out_lensFrameToLensModelIndexList.push_back(lensModelIndex);
+        frameLensModel.reset();
     }
 
     return status;
 }
 
-// Connect up the lenses, in reverse connection order (last to first).
-MStatus connectLensModels(
-    const std::vector<MString> &lensNodeNames, const MTimeArray &frameList,
+MStatus constructLenses(
+    const AttrPtrList &attrList, const MTimeArray &frameList,
     const std::vector<std::vector<MString>> &cameraLensNodeNames,
-    const std::unordered_map<std::string, uint32_t>
-        &lensNodeNameToLensModelIndex,
-    std::vector<std::shared_ptr<mmlens::LensModel>> &inout_lensModelList) {
+    const std::unordered_map<std::string, std::shared_ptr<mmlens::LensModel>>
+        &lensNodeNameToLensModel,
+    std::unordered_map<std::string, uint32_t> &out_lensNodeNameToLensFrameIndex,
+    std::vector<int32_t> &out_lensFrameToLensModelIndexList,
+    std::vector<std::shared_ptr<mmlens::LensModel>> &out_lensModelList) {
     MStatus status = MS::kSuccess;
 
-    auto num_frames = frameList.length();
-
-    for (uint32_t i = 0; i < cameraLensNodeNames.size(); ++i) {
-        std::vector<std::shared_ptr<mmlens::LensModel>> previousLensModels;
-        previousLensModels.resize(num_frames);
-
-        std::vector<MString> lensNodeNames = cameraLensNodeNames[i];
-        for (uint32_t j = lensNodeNames.size(); j < 0; --j) {
-            MString lensNodeName = lensNodeNames[j];
-            std::string lensNodeNameStr = lensNodeName.asChar();
-
-            auto search = lensNodeNameToLensModelIndex.find(lensNodeNameStr);
-            if (search != lensNodeNameToLensModelIndex.end()) {
-                auto lensIndex = search->second;
+    out_lensNodeNameToLensFrameIndex.clear();
+    out_lensFrameToLensModelIndexList.clear();
+    out_lensModelList.clear();
 
-                for (uint32_t j = 0; j < num_frames; j++) {
-                    std::shared_ptr<mmlens::LensModel> previousLensModel =
-                        previousLensModels[j];
+    // Lens nodes that will be changed by the solver.
+    std::unordered_set<std::string> solvedLensNodeNames;
+    for (const AttrPtr &attr : attrList) {
+        if (attr->getObjectType() == ObjectType::kLens) {
+            std::string nodeNameStr(attr->getNodeName().asChar());
+            solvedLensNodeNames.insert(nodeNameStr);
+        }
+    }
 
-                    auto lensFrameIndex = lensIndex + j;
-                    std::shared_ptr<mmlens::LensModel> lensModel =
-                        inout_lensModelList[lensFrameIndex];
-                    lensModel->setInputLensModel(previousLensModel);
+    // The lens node names of each camera are ordered from the lens
+    // connected to the camera (index zero) to the most upstream
+    // lens, so each lens is constructed in reverse order (the input
+    // lens of 'lensNodeNames[i]' is 'lensNodeNames[i + 1]').
+    for (const std::vector<MString> &lensNodeNames : cameraLensNodeNames) {
+        const int32_t num_lenses = static_cast<int32_t>(lensNodeNames.size());
+        for (int32_t i = num_lenses - 1; i >= 0; --i) {
+            const MString &lensNodeName = lensNodeNames[i];
+            std::string lensNodeNameStr(lensNodeName.asChar());
+            if (out_lensNodeNameToLensFrameIndex.count(lensNodeNameStr) > 0) {
+                // The lens is shared with another camera.
+                continue;
+            }
 
-                    previousLensModels[j] = lensModel;
-                }
+            MString inputLensNodeName;
+            if ((i + 1) < num_lenses) {
+                inputLensNodeName = lensNodeNames[i + 1];
             }
+
+            status = constructLens(
+                lensNodeName, inputLensNodeName, solvedLensNodeNames,
+                frameList, lensNodeNameToLensModel,
+                out_lensNodeNameToLensFrameIndex,
+                out_lensFrameToLensModelIndexList, out_lensModelList);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
         }
     }
 
@@ -885,16 +950,16 @@ MStatus constructMarkerToLensModelMap(
     const std::unordered_map<std::string, int32_t> &cameraNodeNameToCameraIndex,
     const std::vector<std::vector<MString>> &cameraLensNodeNames,
     const std::unordered_map<std::string, uint32_t>
-        &lensNodeNameToLensModelIndex,
-    const std::vector<std::shared_ptr<mmlens::LensModel>> &lensModelList,
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_markerFrameToLensModelList) {
+        &lensNodeNameToLensFrameIndex,
+    const std::vector<int32_t> &lensFrameToLensModelIndexList,
+    std::vector<int32_t> &out_markerFrameToLensModelIndexList) {
     MStatus status = MS::kSuccess;
 
     auto num_markers = markerList.size();
     auto num_frames = frameList.length();
-    out_markerFrameToLensModelList.clear();
-    out_markerFrameToLensModelList.resize(num_markers * num_frames);
+    out_markerFrameToLensModelIndexList.clear();
+    out_markerFrameToLensModelIndexList.resize(num_markers * num_frames,
+                                               LENS_MODEL_INDEX_NONE);
 
     for (uint32_t i = 0; i < num_markers; ++i) {
         MarkerPtr marker = markerList[i];
@@ -918,27 +983,21 @@ MStatus constructMarkerToLensModelMap(
         std::vector<MString> lensNodeNames = cameraLensNodeNames[cameraIndex];
         if (lensNodeNames.size() == 0) {
             // No Lens distortion.
-            std::shared_ptr<mmlens::LensModel> lensModel;
+            continue;
+        }
+
+        MString lensNodeName = lensNodeNames[0];
+        std::string lensNodeNameStr(lensNodeName.asChar());
+
+        auto lensSearch = lensNodeNameToLensFrameIndex.find(lensNodeNameStr);
+        if (lensSearch != lensNodeNameToLensFrameIndex.end()) {
+            auto lensIndex = lensSearch->second;
+
             for (uint32_t j = 0; j < num_frames; j++) {
                 auto markerFrameIndex = (i * num_frames) + j;
-                out_markerFrameToLensModelList[markerFrameIndex] = lensModel;
-            }
-        } else {
-            MString lensNodeName = lensNodeNames[0];
-            std::string lensNodeNameStr(lensNodeName.asChar());
-
-            auto search = lensNodeNameToLensModelIndex.find(lensNodeNameStr);
-            if (search != lensNodeNameToLensModelIndex.end()) {
-                auto lensIndex = search->second;
-
-                for (uint32_t j = 0; j < num_frames; j++) {
-                    auto markerFrameIndex = (i * num_frames) + j;
-                    auto lensFrameIndex = lensIndex + j;
-                    std::shared_ptr<mmlens::LensModel> lensModel =
-                        lensModelList[lensFrameIndex];
-                    out_markerFrameToLensModelList[markerFrameIndex] =
-                        lensModel;
-                }
+                auto lensFrameIndex = lensIndex + j;
+                out_markerFrameToLensModelIndexList[markerFrameIndex] =
+                    lensFrameToLensModelIndexList[lensFrameIndex];
             }
         }
     }
@@ -951,16 +1010,16 @@ MStatus constructMarkerToLensModelMap(
 MStatus constructAttributeToLensModelMap(
     const AttrPtrList &attrList, const MTimeArray &frameList,
     const std::unordered_map<std::string, uint32_t>
-        &lensNodeNameToLensModelIndex,
-    const std::vector<std::shared_ptr<mmlens::LensModel>> &lensModelList,
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_attrFrameToLensModelList) {
+        &lensNodeNameToLensFrameIndex,
+    const std::vector<int32_t> &lensFrameToLensModelIndexList,
+    std::vector<int32_t> &out_attrFrameToLensModelIndexList) {
     MStatus status = MS::kSuccess;
 
     auto num_attrs = attrList.size();
     auto num_frames = frameList.length();
-    out_attrFrameToLensModelList.clear();
-    out_attrFrameToLensModelList.resize(num_attrs * num_frames);
+    out_attrFrameToLensModelIndexList.clear();
+    out_attrFrameToLensModelIndexList.resize(num_attrs * num_frames,
+                                             LENS_MODEL_INDEX_NONE);
 
     for (uint32_t i = 0; i < num_attrs; ++i) {
         AttrPtr attr = attrList[i];
@@ -973,8 +1032,8 @@ MStatus constructAttributeToLensModelMap(
         MString nodeName = attr->getNodeName();
         std::string nodeNameStr(nodeName.asChar());
 
-        auto search = lensNodeNameToLensModelIndex.find(nodeNameStr);
-        if (search == lensNodeNameToLensModelIndex.end()) {
+        auto search = lensNodeNameToLensFrameIndex.find(nodeNameStr);
+        if (search == lensNodeNameToLensFrameIndex.end()) {
             MMSOLVER_MAYA_WRN(
                 "Lens node name \""
                 << nodeName
@@ -987,8 +1046,8 @@ MStatus constructAttributeToLensModelMap(
         for (uint32_t j = 0; j < num_frames; j++) {
             auto attrFrameIndex = (i * num_frames) + j;
             auto lensFrameIndex = lensIndex + j;
-            auto lensModel = lensModelList[lensFrameIndex];
-            out_attrFrameToLensModelList[attrFrameIndex] = lensModel;
+            out_attrFrameToLensModelIndexList[attrFrameIndex] =
+                lensFrameToLensModelIndexList[lensFrameIndex];
         }
     }
 
@@ -1000,14 +1059,8 @@ MStatus constructAttributeToLensModelMap(
 MStatus constructLensModelList(
     const CameraPtrList &cameraList, const MarkerPtrList &markerList,
     const AttrPtrList &attrList, const MTimeArray &frameList,
-    // TODO: Can we reduce the indirection by one level and store the direct
-    // pointer?
-    //  If so, we must ensure out_lensList is not destroyed until we are
-    //  finished solving.
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_markerFrameToLensModelList,
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_attrFrameToLensModelList,
+    std::vector<int32_t> &out_markerFrameToLensModelIndexList,
+    std::vector<int32_t> &out_attrFrameToLensModelIndexList,
     std::vector<std::shared_ptr<mmlens::LensModel>> &out_lensModelList) {
     std::unordered_map<std::string, int32_t> cameraNodeNameToCameraIndex;
     std::vector<std::vector<MString>> cameraLensNodeNames;
@@ -1019,25 +1072,23 @@ MStatus constructLensModelList(
         lensNodeNamesVec, lensNodeNameToLensModel);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
-    std::unordered_map<std::string, uint32_t> lensNodeNameToLensModelIndex;
-    status = constructLenses(lensNodeNamesVec, cameraList, frameList,
-                             cameraLensNodeNames, lensNodeNameToLensModel,
-                             lensNodeNameToLensModelIndex, out_lensModelList);
-    CHECK_MSTATUS_AND_RETURN_IT(status);
-
-    status = connectLensModels(lensNodeNamesVec, frameList, cameraLensNodeNames,
-                               lensNodeNameToLensModelIndex, out_lensModelList);
+    std::unordered_map<std::string, uint32_t> lensNodeNameToLensFrameIndex;
+    std::vector<int32_t> lensFrameToLensModelIndexList;
+    status = constructLenses(attrList, frameList, cameraLensNodeNames,
+                             lensNodeNameToLensModel,
+                             lensNodeNameToLensFrameIndex,
+                             lensFrameToLensModelIndexList, out_lensModelList);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     status = constructMarkerToLensModelMap(
         markerList, frameList, cameraNodeNameToCameraIndex, cameraLensNodeNames,
-        lensNodeNameToLensModelIndex, out_lensModelList,
-        out_markerFrameToLensModelList);
+        lensNodeNameToLensFrameIndex, lensFrameToLensModelIndexList,
+        out_markerFrameToLensModelIndexList);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     status = constructAttributeToLensModelMap(
-        attrList, frameList, lensNodeNameToLensModelIndex, out_lensModelList,
-        out_attrFrameToLensModelList);
+        attrList, frameList, lensNodeNameToLensFrameIndex,
+        lensFrameToLensModelIndexList, out_attrFrameToLensModelIndexList);
     CHECK_MSTATUS_AND_RETURN_IT(status);
 
     return status;
@@ -24,6 +24,7 @@
 #define MM_SOLVER_MAYA_HELPER_MAYA_LENS_MODEL_H
 
 // STL
+#include <cstdint>
 #include <memory>
 #include <vector>
 
@@ -37,6 +38,10 @@
 #include "mmSolver/mayahelper/maya_camera.h"
 #include "mmSolver/mayahelper/maya_marker.h"
 
+// The lens model index of markers and attributes without a lens
+// model.
+#define LENS_MODEL_INDEX_NONE (-1)
+
 namespace mmsolver {
 
 MStatus getLensModelFromCamera(
@@ -46,13 +51,15 @@ MStatus setLensModelAttributeValue(
     std::shared_ptr<mmlens::LensModel> &lensModel,
     const AttrSolverType attrType, const double value);
 
+// Lens models with the same values on different frames are shared,
+// unless an attribute of the lens is solved. The marker/frame and
+// attribute/frame tables are indices into 'out_lensModelList', or
+// LENS_MODEL_INDEX_NONE.
 MStatus constructLensModelList(
     const CameraPtrList &cameraList, const MarkerPtrList &markerList,
     const AttrPtrList &attrList, const MTimeArray &frameList,
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_markerFrameToLensModelList,
-    std::vector<std::shared_ptr<mmlens::LensModel>>
-        &out_attrFrameToLensModelList,
+    std::vector<int32_t> &out_markerFrameToLensModelIndexList,
+    std::vector<int32_t> &out_attrFrameToLensModelIndexList,
     std::vector<std::shared_ptr<mmlens::LensModel>> &out_lensModelList);
 
 }  // namespace mmsolver
@@ -22,12 +22,15 @@
 #include "maya_scene_graph.h"
 
 // STL
+#include <cmath>
 #include <limits>
 #include <unordered_map>
+#include <vector>
 
 // Maya
 #include <maya/MComputation.h>
 #include <maya/MDagPath.h>
+#include <maya/MFnAnimCurve.h>
 #include <maya/MFnAttribute.h>
 #include <maya/MFnDependencyNode.h>
 #include <maya/MFnTransform.h>
@@ -169,6 +172,85 @@ bool attribute_has_complex_connection(MFnDependencyNode &depend_node,
     return false;
 }
 
+bool anim_curve_tangent_is_flat_when_values_equal(
+    const MFnAnimCurve::TangentType tangent_type) {
+    return (tangent_type == MFnAnimCurve::kTangentFlat) ||
+           (tangent_type == MFnAnimCurve::kTangentLinear) ||
+           (tangent_type == MFnAnimCurve::kTangentClamped) ||
+           (tangent_type == MFnAnimCurve::kTangentStep) ||
+           (tangent_type == MFnAnimCurve::kTangentStepNext);
+}
+
+// Find the frames where the value of a flat or stepped animation
+// curve can change, between 'start_frame' and 'end_frame'
+// (inclusive), so the curve does not need to be evaluated at every
+// frame.
+//
+// Returns false if the curve is not flat or stepped, and may change
+// value at any frame.
+bool anim_curve_run_frames(Attr &mayaAttr, const mmsg::FrameValue start_frame,
+                           const mmsg::FrameValue end_frame,
+                           std::vector<mmsg::FrameValue> &out_run_frames) {
+    MStatus status = MS::kSuccess;
+    MPlug plug = mayaAttr.getPlug();
+    MFnAnimCurve curveFn(plug, &status);
+    if (status != MS::kSuccess) {
+        return false;
+    }
+    const unsigned int num_keys = curveFn.numKeys();
+    if ((num_keys == 0) || !curveFn.isTimeInput() ||
+        (curveFn.preInfinityType() != MFnAnimCurve::kConstant) ||
+        (curveFn.postInfinityType() != MFnAnimCurve::kConstant)) {
+        return false;
+    }
+
+    // Flat curves have the same value on every key, with tangents
+    // that cannot overshoot between keys. Stepped curves hold each
+    // key value until the next key.
+    bool is_flat = true;
+    bool is_stepped = true;
+    const double first_value = curveFn.value(0);
+    for (unsigned int i = 0; i < num_keys; ++i) {
+        const bool is_last_key = (i + 1) == num_keys;
+        const MFnAnimCurve::TangentType in_tangent = curveFn.inTangentType(i);
+        const MFnAnimCurve::TangentType out_tangent =
+            curveFn.outTangentType(i);
+        if (!is_last_key && (out_tangent != MFnAnimCurve::kTangentStep)) {
+            is_stepped = false;
+        }
+        if ((curveFn.value(i) != first_value) ||
+            !anim_curve_tangent_is_flat_when_values_equal(in_tangent) ||
+            !anim_curve_tangent_is_flat_when_values_equal(out_tangent)) {
+            is_flat = false;
+        }
+        if (!is_flat && !is_stepped) {
+            return false;
+        }
+    }
+
+    out_run_frames.clear();
+    out_run_frames.push_back(start_frame);
+    if (is_flat) {
+        return true;
+    }
+
+    // A stepped value changes at the first whole frame on, or after,
+    // each key.
+    const MTime::Unit uiUnit = MTime::uiUnit();
+    for (unsigned int i = 0; i < num_keys; ++i) {
+        const double key_frame = curveFn.time(i).as(uiUnit);
+        const double run_frame = std::ceil(key_frame);
+        if (run_frame <= static_cast<double>(out_run_frames.back())) {
+            continue;
+        }
+        if (run_frame > static_cast<double>(end_frame)) {
+            break;
+        }
+        out_run_frames.push_back(static_cast<mmsg::FrameValue>(run_frame));
+    }
+    return true;
+}
+
 MStatus add_attribute(Attr &mayaAttr, const MString &attr_name,
                       const MTimeArray &frameList,
                       const mmsg::FrameValue start_frame,
@@ -195,7 +277,23 @@ MStatus add_attribute(Attr &mayaAttr, const MString &attr_name,
 
     MStatus status = MS::kSuccess;
     double value = 0.0;
-    if (animated) {
+    std::vector<mmsg::FrameValue> run_frames;
+    if (animated &&
+        anim_curve_run_frames(mayaAttr, start_frame, end_frame, run_frames)) {
+        // The curve is flat or stepped, so only the frames where the
+        // value changes are evaluated.
+        auto uiUnit = MTime::uiUnit();
+        auto run_values = std::vector<mmsg::Real>();
+        run_values.reserve(run_frames.size());
+        for (const mmsg::FrameValue f : run_frames) {
+            auto frame_time = MTime(static_cast<double>(f), uiUnit);
+            status = mayaAttr.getValue(value, frame_time, timeEvalMode);
+            CHECK_MSTATUS_AND_RETURN_IT(status);
+            run_values.push_back(value * scaleFactor);
+        }
+        out_attrId = out_attrDataBlock.create_attr_anim_rle(
+            run_frames, run_values, start_frame, end_frame);
+    } else if (animated) {
         // Dense attributes expect the frame and values to be
         // contiguous. Therefore if frames [1, 4, 6] (with size of 3)
         // are wanted, we must allocate memory for frames 1 to 6 (size
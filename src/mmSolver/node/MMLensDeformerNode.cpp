@@ -27,12 +27,19 @@
 
 #include "MMLensDeformerNode.h"
 
+// STL
+#include <cmath>
+#include <vector>
+
 // Maya
 #include <maya/MFnNumericAttribute.h>
 #include <maya/MFnNumericData.h>
 #include <maya/MFnTypedAttribute.h>
+#include <maya/MPointArray.h>
 
 // MM Solver
+#include <mmlens/lens_model_batch.h>
+
 #include "MMLensData.h"
 #include "mmSolver/nodeTypeIds.h"
 #include "mmSolver/utilities/debug_utils.h"
@@ -200,28 +207,46 @@ MStatus MMLensDeformerNode::deform(MDataBlock& data, MItGeometry& iter,
     lensModel->setLensCenterOffsetX(lensCenterOffsetX);
     lensModel->setLensCenterOffsetY(lensCenterOffsetY);
 
-    // Deform each point on the input geometry.
-    for (; !iter.isDone(); iter.next()) {
-        MPoint pt = iter.position();
-
-        // Evaluate the lens distortion at (pt.x, pt.y).
-        double out_x = pt.x;
-        double out_y = pt.y;
-        double temp_out_x = pt.x;
-        double temp_out_y = pt.y;
-        lensModel->applyModelUndistort(pt.x, pt.y, temp_out_x, temp_out_y);
-        if (std::isfinite(temp_out_x)) {
-            out_x = temp_out_x;
-        }
-        if (std::isfinite(temp_out_y)) {
-            out_y = temp_out_y;
-        }
-
-        pt.x = lerp(pt.x, out_x, env);
-        pt.y = lerp(pt.y, out_y, env);
-        iter.setPosition(pt);
+    // Deform all points of the input geometry at once.
+    //
+    // The points are evaluated with a single batched call (split
+    // across many threads), rather than once per-point, so the lens
+    // distortion is only set up once per-thread.
+    MPointArray points;
+    status = iter.allPositions(points);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+    const size_t pointCount = static_cast<size_t>(points.length());
+    if (pointCount == 0) {
+        return status;
     }
 
+    std::vector<double> in_x(pointCount);
+    std::vector<double> in_y(pointCount);
+    for (size_t i = 0; i < pointCount; i++) {
+        const MPoint& pt = points[static_cast<unsigned int>(i)];
+        in_x[i] = pt.x;
+        in_y[i] = pt.y;
+    }
+
+    // Evaluate the lens distortion at (pt.x, pt.y).
+    std::vector<double> out_x(pointCount);
+    std::vector<double> out_y(pointCount);
+    const int32_t num_threads = 0;  // 0 == all hardware threads.
+    mmlens::apply_model_undistort_batch_multithread(
+        *lensModel, &in_x[0], &in_y[0], pointCount, &out_x[0], &out_y[0],
+        num_threads);
+
+    for (size_t i = 0; i < pointCount; i++) {
+        MPoint& pt = points[static_cast<unsigned int>(i)];
+        const double x = std::isfinite(out_x[i]) ? out_x[i] : pt.x;
+        const double y = std::isfinite(out_y[i]) ? out_y[i] : pt.y;
+        pt.x = lerp(pt.x, x, env);
+        pt.y = lerp(pt.y, y, env);
+    }
+
+    status = iter.setAllPositions(points);
+    CHECK_MSTATUS_AND_RETURN_IT(status);
+
     return status;
 }
 
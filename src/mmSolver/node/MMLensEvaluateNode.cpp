@@ -86,13 +86,15 @@ MStatus MMLensEvaluateNode::compute(const MPlug &plug, MDataBlock &data) {
         CHECK_MSTATUS_AND_RETURN_IT(status);
         MMLensData *inputLensData = (MMLensData *)inLensHandle.asPluginData();
         if (inputLensData != nullptr) {
-            // Evaluate the lens distortion, at (x, y)
+            // Evaluate the lens distortion, at (x, y). The node has a
+            // single point, so the batch is one point long.
             std::shared_ptr<mmlens::LensModel> lensModel =
                 inputLensData->getValue();
             if (lensModel != nullptr) {
                 double temp_out_x = out_x;
                 double temp_out_y = out_y;
-                lensModel->applyModelUndistort(x, y, temp_out_x, temp_out_y);
+                lensModel->applyModelUndistortBatch(&x, &y, 1, &temp_out_x,
+                                                    &temp_out_y);
                 if (std::isfinite(temp_out_x)) {
                     out_x = temp_out_x;
                 }
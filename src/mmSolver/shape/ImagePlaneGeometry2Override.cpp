@@ -94,7 +94,9 @@ ImagePlaneGeometry2Override::ImagePlaneGeometry2Override(const MObject &obj)
     , m_shader(nullptr)
     , m_update_shader(false)
     , m_color_texture(nullptr)
-    , m_texture_sampler(nullptr) {
+    , m_texture_sampler(nullptr)
+    , m_prefetch_frame(0)
+    , m_prefetch_file_path() {
     m_model_editor_changed_callback_id = MEventMessage::addEventCallback(
         "modelEditorChanged",
         ImagePlaneGeometry2Override::on_model_editor_changed_func, this);
@@ -482,6 +484,15 @@ void ImagePlaneGeometry2Override::set_shader_instance_parameters(
             texture_manager, image_cache, m_temp_image, m_temp_pixel_buffer,
             m_temp_meta_data, file_path, expanded_file_path, do_texture_update);
 
+        // Read the frames around the current frame in the background,
+        // so they are in the CPU cache before the playhead gets there.
+        if ((frame != m_prefetch_frame) ||
+            (file_path != m_prefetch_file_path)) {
+            image::prefetch_image_sequence(image_cache, file_path, frame);
+            m_prefetch_frame = frame;
+            m_prefetch_file_path = file_path;
+        }
+
         if (out_color_texture) {
             const MString texture_name = out_color_texture->name();
             MMSOLVER_MAYA_VRB("mmImagePlaneGeometry2Override: texture->name()="
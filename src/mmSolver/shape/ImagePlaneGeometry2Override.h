@@ -192,6 +192,11 @@ protected:
     MHWRender::MTexture *m_color_texture;
     const MHWRender::MSamplerState *m_texture_sampler;
 
+    // The frame and file path that the image prefetching was last
+    // started for.
+    mmcore::FrameValue m_prefetch_frame;
+    MString m_prefetch_file_path;
+
 #if MAYA_API_VERSION >= 20220000
     ShaderLinkLostUserData2Ptr m_shader_link_lost_user_data_ptr;
 #else
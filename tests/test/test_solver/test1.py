@@ -157,6 +157,20 @@ class TestSolver1(solverUtils.SolverTestCase):
             mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
         )
 
+    def test_init_cminpack_lmstr_maya_dag(self):
+        self.do_solve(
+            'cminpack_lmstr',
+            mmapi.SOLVER_TYPE_CMINPACK_LMSTR,
+            mmapi.SCENE_GRAPH_MODE_MAYA_DAG,
+        )
+
+    def test_init_cminpack_lmstr_mmscenegraph(self):
+        self.do_solve(
+            'cminpack_lmstr',
+            mmapi.SOLVER_TYPE_CMINPACK_LMSTR,
+            mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+        )
+
 
 if __name__ == '__main__':
     prog = unittest.main()
@@ -150,6 +150,23 @@ class TestSolver11(solverUtils.SolverTestCase):
         results = [mmapi.SolveResult(result)]
         self.checkSolveResults(results, allow_max_avg_error=3.5, allow_max_error=3.5)
 
+        values = [maya.cmds.getAttr(node_attr[0]) for node_attr in node_attrs]
+        return values
+
+    def do_solve_compare_lmstr(self, scene_graph_mode):
+        # 'lmstr' stores the Jacobian one row at a time, but solves
+        # the same problem, so it must reach the same solution as
+        # 'lmder'.
+        values_lmder = self.do_solve(
+            'cminpack_lmder', mmapi.SOLVER_TYPE_CMINPACK_LMDER, scene_graph_mode
+        )
+        values_lmstr = self.do_solve(
+            'cminpack_lmstr', mmapi.SOLVER_TYPE_CMINPACK_LMSTR, scene_graph_mode
+        )
+        self.assertEqual(len(values_lmder), len(values_lmstr))
+        for value_lmder, value_lmstr in zip(values_lmder, values_lmstr):
+            self.assertApproxEqual(value_lmder, value_lmstr, eps=0.001)
+
     # def test_ceres_maya_dag(self):
     #     self.do_solve('ceres', mmapi.SOLVER_TYPE_CERES, mmapi.SCENE_GRAPH_MODE_MAYA_DAG)
 
@@ -186,6 +203,12 @@ class TestSolver11(solverUtils.SolverTestCase):
             mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
         )
 
+    def test_cminpack_lmstr_maya_dag(self):
+        self.do_solve_compare_lmstr(mmapi.SCENE_GRAPH_MODE_MAYA_DAG)
+
+    def test_cminpack_lmstr_mmscenegraph(self):
+        self.do_solve_compare_lmstr(mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH)
+
 
 if __name__ == '__main__':
     prog = unittest.main()
@@ -0,0 +1,185 @@
+# Copyright (C) 2024 David Cattermole.
+#
+# This file is part of mmSolver.
+#
+# mmSolver is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# mmSolver is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+Solve animated bundles one frame at a time with the MM Scene Graph,
+where each frame is solved independently, on one or many threads.
+
+The solved values and solver results must not depend on the number
+of threads, including when a frame cannot be solved.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import unittest
+
+try:
+    import maya.standalone
+
+    maya.standalone.initialize()
+except RuntimeError:
+    pass
+import maya.cmds
+
+import mmSolver.api as mmapi
+import test.test_solver.solverutils as solverUtils
+
+FRAMES = list(range(1, 11))
+THREAD_COUNT = 4
+
+
+# @unittest.skip
+class TestFrameThreads(solverUtils.SolverTestCase):
+    def create_scene(self):
+        if self.haveSolverType(name='cminpack_lmdif') is False:
+            msg = '%r solver is not available!' % 'cminpack_lmdif'
+            raise unittest.SkipTest(msg)
+
+        cam_tfm, cam_shp = self.create_camera('cam')
+        maya.cmds.setAttr(cam_tfm + '.tz', 5.0)
+
+        mkr_grp = self.create_marker_group('marker_group', cam_tfm)
+        marker_positions = [
+            (-0.243056042, 0.189583713),
+            (0.312469117, -0.227186005),
+            (-0.401273624, -0.318710259),
+        ]
+        bundles = []
+        markers = []
+        node_attrs = []
+        for i, (mkr_x, mkr_y) in enumerate(marker_positions):
+            name = 'bundle_{}'.format(i)
+            bundle_tfm, bundle_shp = self.create_bundle(name)
+            maya.cmds.setAttr(bundle_tfm + '.tz', -10.0)
+
+            name = 'marker_{}'.format(i)
+            marker_tfm, marker_shp = self.create_marker(
+                name, mkr_grp, bnd_tfm=bundle_tfm
+            )
+            maya.cmds.setAttr(marker_tfm + '.tz', -1)
+
+            # Each frame has a different marker position, so each
+            # frame solves to different bundle values.
+            for frame in FRAMES:
+                offset = frame * 0.01
+                maya.cmds.setKeyframe(
+                    marker_tfm, attribute='tx', time=frame, value=mkr_x + offset
+                )
+                maya.cmds.setKeyframe(
+                    marker_tfm, attribute='ty', time=frame, value=mkr_y - offset
+                )
+
+            bundles.append(bundle_tfm)
+            markers.append((marker_tfm, cam_shp, bundle_tfm))
+            node_attrs.append((bundle_tfm + '.tx', 'None', 'None', 'None', 'None'))
+            node_attrs.append((bundle_tfm + '.ty', 'None', 'None', 'None', 'None'))
+
+        cameras = ((cam_tfm, cam_shp),)
+        kwargs = {
+            'camera': cameras,
+            'marker': markers,
+            'attr': node_attrs,
+        }
+
+        affects_mode = 'addAttrsToMarkers'
+        self.runSolverAffects(affects_mode, **kwargs)
+        return kwargs, bundles
+
+    def reset_bundles(self, bundles):
+        for bundle_tfm in bundles:
+            for frame in FRAMES:
+                for attr in ['tx', 'ty']:
+                    maya.cmds.setKeyframe(
+                        bundle_tfm, attribute=attr, time=frame, value=0.0
+                    )
+
+    def get_bundle_values(self, bundles):
+        values = []
+        for bundle_tfm in bundles:
+            for frame in FRAMES:
+                values.append(maya.cmds.getAttr(bundle_tfm + '.tx', time=frame))
+                values.append(maya.cmds.getAttr(bundle_tfm + '.ty', time=frame))
+        return values
+
+    def run_solve(self, kwargs, bundles, frame_thread_count):
+        self.reset_bundles(bundles)
+        result = maya.cmds.mmSolver(
+            frame=FRAMES,
+            solverType=mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            sceneGraphMode=mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+            frameSolveMode=mmapi.FRAME_SOLVE_MODE_PER_FRAME,
+            frameThreadCount=frame_thread_count,
+            jacobianThreadCount=1,
+            iterations=1000,
+            verbose=True,
+            **kwargs
+        )
+
+        # The time taken is different on every solve.
+        result = [x for x in result if not x.startswith(('timer_', 'ticks_'))]
+        values = self.get_bundle_values(bundles)
+        return result, values
+
+    def do_solve(self, kwargs, bundles):
+        result_a, values_a = self.run_solve(kwargs, bundles, 1)
+        result_b, values_b = self.run_solve(kwargs, bundles, THREAD_COUNT)
+        print('single thread result:', result_a)
+        print('many threads result:', result_b)
+        return result_a, values_a, result_b, values_b
+
+    def test_frame_thread_count(self):
+        kwargs, bundles = self.create_scene()
+        result_a, values_a, result_b, values_b = self.do_solve(kwargs, bundles)
+        self.assertEqual(result_a[0], 'success=1')
+        self.assertEqual(result_a, result_b)
+        self.assertEqual(values_a, values_b)
+
+        # Every frame is solved.
+        for value in values_a:
+            self.assertNotEqual(value, 0.0)
+
+    def test_frame_thread_count_prepare_failure(self):
+        # No markers are enabled on the middle frame, so the frame
+        # cannot be solved and the solve stops at that frame.
+        kwargs, bundles = self.create_scene()
+        failed_frame = FRAMES[len(FRAMES) // 2]
+        for marker_tfm, _, _ in kwargs['marker']:
+            for frame in FRAMES:
+                value = int(frame != failed_frame)
+                maya.cmds.setKeyframe(
+                    marker_tfm, attribute='enable', time=frame, value=value
+                )
+
+        result_a, values_a, result_b, values_b = self.do_solve(kwargs, bundles)
+        self.assertEqual(result_a[0], 'success=0')
+        self.assertEqual(result_a, result_b)
+        self.assertEqual(values_a, values_b)
+
+        # The frames before the failed frame are solved, and the
+        # other frames are unchanged.
+        values_per_frame = len(FRAMES) * 2
+        for i in range(0, len(values_a), 2):
+            frame = FRAMES[(i % values_per_frame) // 2]
+            solved = frame < failed_frame
+            self.assertEqual(values_a[i] != 0.0, solved)
+            self.assertEqual(values_a[i + 1] != 0.0, solved)
+
+
+if __name__ == '__main__':
+    prog = unittest.main()
@@ -0,0 +1,149 @@
+# Copyright (C) 2024 David Cattermole.
+#
+# This file is part of mmSolver.
+#
+# mmSolver is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# mmSolver is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+Solve bundles with the MM Scene Graph, calculating the Jacobian
+matrix on one or many threads.
+
+The Jacobian matrix is exactly the same on any number of threads, so
+the solved values and solver results must be identical.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import unittest
+
+try:
+    import maya.standalone
+
+    maya.standalone.initialize()
+except RuntimeError:
+    pass
+import maya.cmds
+
+import mmSolver.api as mmapi
+import test.test_solver.solverutils as solverUtils
+
+THREAD_COUNT = 4
+
+
+# @unittest.skip
+class TestJacobianThreads(solverUtils.SolverTestCase):
+    def create_scene(self):
+        cam_tfm, cam_shp = self.create_camera('cam')
+        maya.cmds.setAttr(cam_tfm + '.tz', 5.0)
+
+        mkr_grp = self.create_marker_group('marker_group', cam_tfm)
+        marker_positions = [
+            (-0.243056042, 0.189583713),
+            (0.312469117, -0.227186005),
+            (-0.401273624, -0.318710259),
+            (0.176041258, 0.352918734),
+            (0.021379265, -0.097348512),
+            (-0.128503446, 0.043871290),
+        ]
+        bundles = []
+        markers = []
+        node_attrs = []
+        for i, (mkr_x, mkr_y) in enumerate(marker_positions):
+            name = 'bundle_{}'.format(i)
+            bundle_tfm, bundle_shp = self.create_bundle(name)
+            maya.cmds.setAttr(bundle_tfm + '.tz', -10.0 - i)
+
+            name = 'marker_{}'.format(i)
+            marker_tfm, marker_shp = self.create_marker(
+                name, mkr_grp, bnd_tfm=bundle_tfm
+            )
+            maya.cmds.setAttr(marker_tfm + '.tx', mkr_x)
+            maya.cmds.setAttr(marker_tfm + '.ty', mkr_y)
+            maya.cmds.setAttr(marker_tfm + '.tz', -1)
+
+            bundles.append(bundle_tfm)
+            markers.append((marker_tfm, cam_shp, bundle_tfm))
+            node_attrs.append((bundle_tfm + '.tx', 'None', 'None', 'None', 'None'))
+            node_attrs.append((bundle_tfm + '.ty', 'None', 'None', 'None', 'None'))
+
+        cameras = ((cam_tfm, cam_shp),)
+        kwargs = {
+            'camera': cameras,
+            'marker': markers,
+            'attr': node_attrs,
+        }
+
+        affects_mode = 'addAttrsToMarkers'
+        self.runSolverAffects(affects_mode, **kwargs)
+        return kwargs, bundles
+
+    def run_solve(self, solver_index, auto_diff_type, thread_count, kwargs, bundles):
+        for bundle_tfm in bundles:
+            maya.cmds.setAttr(bundle_tfm + '.tx', 0.0)
+            maya.cmds.setAttr(bundle_tfm + '.ty', 0.0)
+
+        result = maya.cmds.mmSolver(
+            frame=[1],
+            solverType=solver_index,
+            sceneGraphMode=mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+            autoDiffType=auto_diff_type,
+            jacobianThreadCount=thread_count,
+            iterations=1000,
+            verbose=True,
+            **kwargs
+        )
+
+        # The time taken is different on every solve.
+        result = [x for x in result if not x.startswith(('timer_', 'ticks_'))]
+        values = []
+        for bundle_tfm in bundles:
+            values.append(maya.cmds.getAttr(bundle_tfm + '.tx'))
+            values.append(maya.cmds.getAttr(bundle_tfm + '.ty'))
+        return result, values
+
+    def do_solve(self, solver_name, solver_index, auto_diff_type):
+        if self.haveSolverType(name=solver_name) is False:
+            msg = '%r solver is not available!' % solver_name
+            raise unittest.SkipTest(msg)
+
+        kwargs, bundles = self.create_scene()
+        result_a, values_a = self.run_solve(
+            solver_index, auto_diff_type, 1, kwargs, bundles
+        )
+        result_b, values_b = self.run_solve(
+            solver_index, auto_diff_type, THREAD_COUNT, kwargs, bundles
+        )
+        print('single thread result:', result_a)
+        print('many threads result:', result_b)
+        self.assertEqual(result_a[0], 'success=1')
+        self.assertEqual(result_a, result_b)
+        self.assertEqual(values_a, values_b)
+
+    def test_cminpack_lmder_forward(self):
+        self.do_solve('cminpack_lmder', mmapi.SOLVER_TYPE_CMINPACK_LMDER, 0)
+
+    def test_cminpack_lmder_central(self):
+        self.do_solve('cminpack_lmder', mmapi.SOLVER_TYPE_CMINPACK_LMDER, 1)
+
+    def test_ceres_forward(self):
+        self.do_solve('ceres', mmapi.SOLVER_TYPE_CERES, 0)
+
+    def test_ceres_central(self):
+        self.do_solve('ceres', mmapi.SOLVER_TYPE_CERES, 1)
+
+
+if __name__ == '__main__':
+    prog = unittest.main()
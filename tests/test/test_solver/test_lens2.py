@@ -23,6 +23,7 @@ from __future__ import absolute_import
 from __future__ import division
 from __future__ import print_function
 
+import time
 import unittest
 
 try:
@@ -98,6 +99,78 @@ class TestLens2(solverUtils.SolverTestCase):
         maya.cmds.file(save=True, type='mayaAscii', force=True)
         return
 
+    def test_lens_deformer_dense_mesh(self):
+        """
+        Deform a dense mesh (100,000 vertices), and check the deformed
+        vertex positions are the same as evaluating each vertex with
+        a mmLensEvaluate node.
+
+        The evaluation after each lens attribute change is timed, but
+        the time is only printed.
+        """
+        tfm, creator = maya.cmds.polyPlane(
+            axis=(0.0, 0.0, 1.0),
+            subdivisionsWidth=399,
+            subdivisionsHeight=249,
+        )
+        lens_node = maya.cmds.createNode('mmLensModel3de')
+        eval_node = maya.cmds.createNode('mmLensEvaluate')
+        deform_node = maya.cmds.deformer(tfm, type='mmLensDeformer')[0]
+
+        plug = lens_node + '.lensModel'
+        maya.cmds.setAttr(plug, 2)  # 2 == k3deClassic
+
+        # The mmLensEvaluate node does not have camera attributes, so
+        # the deformer uses the default camera of the lens model;
+        # 30mm focal length and a 36mm x 24mm film back.
+        maya.cmds.setAttr(deform_node + '.focalLength', 30.0)
+
+        src = lens_node + '.outLens'
+        for dst in [deform_node + '.inLens', eval_node + '.inLens']:
+            maya.cmds.connectAttr(src, dst)
+
+        vertex_count = maya.cmds.polyEvaluate(tfm, vertex=True)
+        self.assertEqual(vertex_count, 400 * 250)
+
+        # Corners, edges, the center and some other vertices. The
+        # mesh stores single-precision positions, so the positions are
+        # compared within single-precision.
+        vertex_indices = [0, 399, 12345, 50200, 54321, 87654, 99600, 99999]
+        vertices = [tfm + '.vtx[{}]'.format(i) for i in vertex_indices]
+
+        # The vertex positions before deformation.
+        maya.cmds.setAttr(deform_node + '.envelope', 0.0)
+        in_positions = [maya.cmds.pointPosition(v, local=True) for v in vertices]
+        maya.cmds.setAttr(deform_node + '.envelope', 1.0)
+
+        plug = lens_node + '.tdeClassic_distortion'
+        vertex = vertices[0]
+        s = time.time()
+        iterations = 10
+        for i in range(iterations):
+            maya.cmds.setAttr(plug, 0.01 * (i + 1))
+            maya.cmds.pointPosition(vertex, local=True)
+        e = time.time()
+        print('Deform time per-evaluation:', (e - s) / iterations)
+
+        for distortion in [0.0, 0.05, -0.1, 0.2]:
+            maya.cmds.setAttr(plug, distortion)
+            for vertex, in_pos in zip(vertices, in_positions):
+                out_pos = maya.cmds.pointPosition(vertex, local=True)
+
+                maya.cmds.setAttr(eval_node + '.inX', in_pos[0])
+                maya.cmds.setAttr(eval_node + '.inY', in_pos[1])
+                expected_x = maya.cmds.getAttr(eval_node + '.outX')
+                expected_y = maya.cmds.getAttr(eval_node + '.outY')
+                self.assertApproxEqual(out_pos[0], expected_x, eps=1e-6)
+                self.assertApproxEqual(out_pos[1], expected_y, eps=1e-6)
+                self.assertApproxEqual(out_pos[2], in_pos[2], eps=1e-6)
+
+                # The corners are always moved by the distortion.
+                if distortion != 0.0 and vertex in vertices[:2]:
+                    self.assertNotEqual(out_pos[0], in_pos[0])
+        return
+
 
 if __name__ == '__main__':
     prog = unittest.main()
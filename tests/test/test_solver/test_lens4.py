@@ -0,0 +1,238 @@
+# Copyright (C) 2024 David Cattermole.
+#
+# This file is part of mmSolver.
+#
+# mmSolver is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# mmSolver is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+Solve bundles seen through a distorted lens, measuring the errors
+with and without undistorting the markers before solving.
+
+The animated lens tests solve many markers over many frames, with a
+different lens distortion on each frame, so each marker must be
+undistorted with the lens model of its own frame.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import time
+import unittest
+
+try:
+    import maya.standalone
+
+    maya.standalone.initialize()
+except RuntimeError:
+    pass
+import maya.cmds
+
+import mmSolver.api as mmapi
+import test.test_solver.solverutils as solverUtils
+
+
+# @unittest.skip
+class TestLens4(solverUtils.SolverTestCase):
+    def create_scene(self, frames):
+        cam_tfm, cam_shp = self.create_camera('cam')
+        maya.cmds.setAttr(cam_tfm + '.tx', -1.0)
+        maya.cmds.setAttr(cam_tfm + '.ty', 1.0)
+        maya.cmds.setAttr(cam_tfm + '.tz', -5.0)
+
+        # The lens distortion is not solved, so the markers can be
+        # undistorted before solving.
+        lens = mmapi.Lens().create_node()
+        lens_node = lens.get_node()
+        maya.cmds.setAttr(lens_node + '.lensModel', 2)  # 2 == k3deClassic
+        maya.cmds.setAttr(lens_node + '.tdeClassic_distortion', 0.2)
+        maya.cmds.setAttr(lens_node + '.tdeClassic_quarticDistortion', 0.05)
+        if len(frames) > 1:
+            attr = 'tdeClassic_distortion'
+            start, end = frames[0], frames[-1]
+            maya.cmds.setKeyframe(lens_node, attribute=attr, time=start, value=-0.1)
+            maya.cmds.setKeyframe(lens_node, attribute=attr, time=end, value=0.2)
+        cam = mmapi.Camera(shape=cam_shp)
+        cam.set_lens(lens)
+
+        mkr_grp = self.create_marker_group('marker_group', cam_tfm)
+        marker_positions = [
+            (-0.243056042, 0.189583713),
+            (0.312469117, -0.227186005),
+            (-0.401273624, -0.318710259),
+            (0.176041258, 0.352918734),
+        ]
+        bundles = []
+        markers = []
+        node_attrs = []
+        for i, (mkr_x, mkr_y) in enumerate(marker_positions):
+            name = 'bundle_{}'.format(i)
+            bundle_tfm, bundle_shp = self.create_bundle(name)
+            maya.cmds.setAttr(bundle_tfm + '.tx', 0.0)
+            maya.cmds.setAttr(bundle_tfm + '.ty', 0.0)
+            maya.cmds.setAttr(bundle_tfm + '.tz', -25.0)
+            if len(frames) > 1:
+                for frame in frames:
+                    maya.cmds.setKeyframe(bundle_tfm, attribute='tx', time=frame)
+                    maya.cmds.setKeyframe(bundle_tfm, attribute='ty', time=frame)
+
+            name = 'marker_{}'.format(i)
+            marker_tfm, marker_shp = self.create_marker(
+                name, mkr_grp, bnd_tfm=bundle_tfm
+            )
+            maya.cmds.setAttr(marker_tfm + '.tx', mkr_x)
+            maya.cmds.setAttr(marker_tfm + '.ty', mkr_y)
+            maya.cmds.setAttr(marker_tfm + '.tz', -1)
+
+            bundles.append(bundle_tfm)
+            markers.append((marker_tfm, cam_shp, bundle_tfm))
+            node_attrs.append((bundle_tfm + '.tx', 'None', 'None', 'None', 'None'))
+            node_attrs.append((bundle_tfm + '.ty', 'None', 'None', 'None', 'None'))
+
+        cameras = ((cam_tfm, cam_shp),)
+        return cameras, markers, node_attrs, bundles
+
+    def run_solve(
+        self, solver_index, scene_graph_mode, undistort_markers, kwargs, bundles, frames
+    ):
+        for bundle_tfm in bundles:
+            for frame in frames:
+                for attr in ['tx', 'ty']:
+                    if len(frames) > 1:
+                        maya.cmds.setKeyframe(
+                            bundle_tfm, attribute=attr, time=frame, value=0.0
+                        )
+                    else:
+                        maya.cmds.setAttr(bundle_tfm + '.' + attr, 0.0)
+
+        s = time.time()
+        result = maya.cmds.mmSolver(
+            frame=frames,
+            solverType=solver_index,
+            sceneGraphMode=scene_graph_mode,
+            undistortMarkers=undistort_markers,
+            iterations=1000,
+            verbose=True,
+            **kwargs
+        )
+        e = time.time()
+        print('total time:', e - s)
+        self.assertEqual(result[0], 'success=1')
+
+        values = []
+        for bundle_tfm in bundles:
+            for frame in frames:
+                values.append(maya.cmds.getAttr(bundle_tfm + '.tx', time=frame))
+                values.append(maya.cmds.getAttr(bundle_tfm + '.ty', time=frame))
+        return values
+
+    def do_solve(self, solver_name, solver_index, scene_graph_mode, frames=None):
+        if frames is None:
+            frames = [1]
+        if self.haveSolverType(name=solver_name) is False:
+            msg = '%r solver is not available!' % solver_name
+            raise unittest.SkipTest(msg)
+        scene_graph_name = mmapi.SCENE_GRAPH_MODE_NAME_LIST[scene_graph_mode]
+        scene_graph_label = mmapi.SCENE_GRAPH_MODE_LABEL_LIST[scene_graph_mode]
+        print('Scene Graph:', scene_graph_label)
+
+        cameras, markers, node_attrs, bundles = self.create_scene(frames)
+        kwargs = {
+            'camera': cameras,
+            'marker': markers,
+            'attr': node_attrs,
+        }
+
+        affects_mode = 'addAttrsToMarkers'
+        self.runSolverAffects(affects_mode, **kwargs)
+
+        # save the output
+        file_name = 'lens4_{}_{}_{}_before.ma'.format(
+            solver_name, scene_graph_name, len(frames)
+        )
+        path = self.get_data_path(file_name)
+        maya.cmds.file(rename=path)
+        maya.cmds.file(save=True, type='mayaAscii', force=True)
+
+        # Run solver, distorting the re-projected bundles (the
+        # reference values), then with undistorted markers.
+        distorted_values = self.run_solve(
+            solver_index, scene_graph_mode, False, kwargs, bundles, frames
+        )
+        undistorted_values = self.run_solve(
+            solver_index, scene_graph_mode, True, kwargs, bundles, frames
+        )
+
+        # save the output
+        file_name = 'lens4_{}_{}_{}_after.ma'.format(
+            solver_name, scene_graph_name, len(frames)
+        )
+        path = self.get_data_path(file_name)
+        maya.cmds.file(rename=path)
+        maya.cmds.file(save=True, type='mayaAscii', force=True)
+
+        # Each bundle can match its marker exactly, so both ways of
+        # measuring the errors must find the same bundle positions.
+        print('distorted values:', distorted_values)
+        print('undistorted values:', undistorted_values)
+        for distorted, undistorted in zip(distorted_values, undistorted_values):
+            self.assertApproxEqual(distorted, undistorted, eps=0.001)
+
+    def test_init_cminpack_lmdif_maya_dag(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MAYA_DAG,
+        )
+
+    def test_init_cminpack_lmdif_mmscenegraph(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+        )
+
+    def test_init_cminpack_lmder_maya_dag(self):
+        self.do_solve(
+            'cminpack_lmder',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDER,
+            mmapi.SCENE_GRAPH_MODE_MAYA_DAG,
+        )
+
+    def test_init_cminpack_lmder_mmscenegraph(self):
+        self.do_solve(
+            'cminpack_lmder',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDER,
+            mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+        )
+
+    def test_animated_lens_cminpack_lmdif_maya_dag(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MAYA_DAG,
+            frames=[1, 2, 3, 4, 5],
+        )
+
+    def test_animated_lens_cminpack_lmdif_mmscenegraph(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+            frames=[1, 2, 3, 4, 5],
+        )
+
+
+if __name__ == '__main__':
+    prog = unittest.main()
@@ -0,0 +1,192 @@
+# Copyright (C) 2024 David Cattermole.
+#
+# This file is part of mmSolver.
+#
+# mmSolver is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# mmSolver is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+Solve animated bundles seen through two lens layers; an animated
+(upstream) lens and a static (downstream) lens.
+
+The static lens must use the animated input lens of each frame, so
+each frame's solved bundle must re-project onto the marker
+undistorted by the full lens chain of that frame.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import time
+import unittest
+
+try:
+    import maya.standalone
+
+    maya.standalone.initialize()
+except RuntimeError:
+    pass
+import maya.cmds
+
+import mmSolver.api as mmapi
+import test.test_solver.solverutils as solverUtils
+
+
+# @unittest.skip
+class TestLens5(solverUtils.SolverTestCase):
+    def create_scene(self, frames):
+        cam_tfm, cam_shp = self.create_camera('cam')
+
+        # The upstream lens distortion changes every frame.
+        input_lens = mmapi.Lens().create_node(name='input_lens')
+        input_lens_node = input_lens.get_node()
+        maya.cmds.setAttr(input_lens_node + '.lensModel', 2)  # 2 == k3deClassic
+        attr = 'tdeClassic_distortion'
+        start, end = frames[0], frames[-1]
+        maya.cmds.setKeyframe(input_lens_node, attribute=attr, time=start, value=-0.1)
+        maya.cmds.setKeyframe(input_lens_node, attribute=attr, time=end, value=0.2)
+
+        # The downstream lens distortion is static.
+        lens = mmapi.Lens().create_node(name='lens')
+        lens_node = lens.get_node()
+        maya.cmds.setAttr(lens_node + '.lensModel', 2)  # 2 == k3deClassic
+        maya.cmds.setAttr(lens_node + '.tdeClassic_distortion', 0.1)
+        maya.cmds.setAttr(lens_node + '.tdeClassic_quarticDistortion', 0.02)
+        lens.set_input_lens(input_lens)
+
+        cam = mmapi.Camera(shape=cam_shp)
+        cam.set_lens(lens)
+
+        mkr_grp = self.create_marker_group('marker_group', cam_tfm)
+        marker_positions = [
+            (-0.243056042, 0.189583713),
+            (0.312469117, -0.227186005),
+            (-0.401273624, -0.318710259),
+        ]
+        bundles = []
+        markers = []
+        node_attrs = []
+        for i, (mkr_x, mkr_y) in enumerate(marker_positions):
+            name = 'bundle_{}'.format(i)
+            bundle_tfm, bundle_shp = self.create_bundle(name)
+            maya.cmds.setAttr(bundle_tfm + '.tz', -10.0)
+            for frame in frames:
+                maya.cmds.setKeyframe(bundle_tfm, attribute='tx', time=frame, value=0.0)
+                maya.cmds.setKeyframe(bundle_tfm, attribute='ty', time=frame, value=0.0)
+
+            name = 'marker_{}'.format(i)
+            marker_tfm, marker_shp = self.create_marker(
+                name, mkr_grp, bnd_tfm=bundle_tfm
+            )
+            maya.cmds.setAttr(marker_tfm + '.tx', mkr_x)
+            maya.cmds.setAttr(marker_tfm + '.ty', mkr_y)
+            maya.cmds.setAttr(marker_tfm + '.tz', -1)
+
+            bundles.append(bundle_tfm)
+            markers.append((marker_tfm, cam_shp, bundle_tfm))
+            node_attrs.append((bundle_tfm + '.tx', 'None', 'None', 'None', 'None'))
+            node_attrs.append((bundle_tfm + '.ty', 'None', 'None', 'None', 'None'))
+
+        cameras = ((cam_tfm, cam_shp),)
+        return cameras, markers, node_attrs, bundles, lens_node
+
+    def do_solve(self, solver_name, solver_index, scene_graph_mode):
+        if self.haveSolverType(name=solver_name) is False:
+            msg = '%r solver is not available!' % solver_name
+            raise unittest.SkipTest(msg)
+        scene_graph_name = mmapi.SCENE_GRAPH_MODE_NAME_LIST[scene_graph_mode]
+        scene_graph_label = mmapi.SCENE_GRAPH_MODE_LABEL_LIST[scene_graph_mode]
+        print('Scene Graph:', scene_graph_label)
+
+        frames = [1, 2, 3, 4, 5]
+        cameras, markers, node_attrs, bundles, lens_node = self.create_scene(frames)
+        kwargs = {
+            'camera': cameras,
+            'marker': markers,
+            'attr': node_attrs,
+        }
+
+        affects_mode = 'addAttrsToMarkers'
+        self.runSolverAffects(affects_mode, **kwargs)
+
+        # save the output
+        file_name = 'lens5_{}_{}_before.ma'.format(solver_name, scene_graph_name)
+        path = self.get_data_path(file_name)
+        maya.cmds.file(rename=path)
+        maya.cmds.file(save=True, type='mayaAscii', force=True)
+
+        s = time.time()
+        result = maya.cmds.mmSolver(
+            frame=frames,
+            solverType=solver_index,
+            sceneGraphMode=scene_graph_mode,
+            iterations=1000,
+            verbose=True,
+            **kwargs
+        )
+        e = time.time()
+        print('total time:', e - s)
+        self.assertEqual(result[0], 'success=1')
+
+        # save the output
+        file_name = 'lens5_{}_{}_after.ma'.format(solver_name, scene_graph_name)
+        path = self.get_data_path(file_name)
+        maya.cmds.file(rename=path)
+        maya.cmds.file(save=True, type='mayaAscii', force=True)
+
+        # The reference undistorted marker positions, evaluated
+        # through the full lens chain by Maya, on each frame.
+        cam_tfm, cam_shp = cameras[0]
+        eval_node = maya.cmds.createNode('mmLensEvaluate')
+        maya.cmds.connectAttr(lens_node + '.outLens', eval_node + '.inLens')
+        for marker_tfm, _, bundle_tfm in markers:
+            maya.cmds.setAttr(eval_node + '.inX', maya.cmds.getAttr(marker_tfm + '.tx'))
+            maya.cmds.setAttr(eval_node + '.inY', maya.cmds.getAttr(marker_tfm + '.ty'))
+            for frame in frames:
+                undistort_x = maya.cmds.getAttr(eval_node + '.outX', time=frame)
+                undistort_y = maya.cmds.getAttr(eval_node + '.outY', time=frame)
+                values = maya.cmds.mmReprojection(
+                    bundle_tfm,
+                    camera=(cam_tfm, cam_shp),
+                    time=[frame],
+                    asMarkerCoordinate=True,
+                )
+                print(
+                    'frame:',
+                    frame,
+                    'undistorted marker:',
+                    (undistort_x, undistort_y),
+                    'reprojected bundle:',
+                    values[:2],
+                )
+                self.assertApproxEqual(values[0], undistort_x, eps=0.0001)
+                self.assertApproxEqual(values[1], undistort_y, eps=0.0001)
+
+    def test_init_cminpack_lmdif_maya_dag(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MAYA_DAG,
+        )
+
+    def test_init_cminpack_lmdif_mmscenegraph(self):
+        self.do_solve(
+            'cminpack_lmdif',
+            mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH,
+        )
+
+
+if __name__ == '__main__':
+    prog = unittest.main()
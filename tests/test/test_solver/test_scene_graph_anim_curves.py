@@ -0,0 +1,195 @@
+# Copyright (C) 2024 David Cattermole.
+#
+# This file is part of mmSolver.
+#
+# mmSolver is free software: you can redistribute it and/or modify it
+# under the terms of the GNU Lesser General Public License as
+# published by the Free Software Foundation, either version 3 of the
+# License, or (at your option) any later version.
+#
+# mmSolver is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU Lesser General Public License for more details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+#
+"""
+Solve a scene with flat and stepped animation curves, using the Maya
+DAG and the MM Scene Graph.
+
+The MM Scene Graph only evaluates flat and stepped animation curves
+on the frames where the value changes, so the solved values must be
+the same as the Maya DAG, which evaluates every frame.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import unittest
+
+try:
+    import maya.standalone
+
+    maya.standalone.initialize()
+except RuntimeError:
+    pass
+import maya.cmds
+
+import mmSolver.api as mmapi
+import test.test_solver.solverutils as solverUtils
+
+FRAMES = list(range(1, 11))
+
+
+# @unittest.skip
+class TestSceneGraphAnimCurves(solverUtils.SolverTestCase):
+    def create_scene(self, animated_bundles):
+        if self.haveSolverType(name='cminpack_lmdif') is False:
+            msg = '%r solver is not available!' % 'cminpack_lmdif'
+            raise unittest.SkipTest(msg)
+
+        cam_tfm, cam_shp = self.create_camera('cam')
+        maya.cmds.setAttr(cam_tfm + '.tz', 5.0)
+
+        # The camera steps to the side on frames 4 and 7.
+        for frame, value in [(1, 0.0), (4, 0.5), (7, 1.0)]:
+            maya.cmds.setKeyframe(cam_tfm, attribute='tx', time=frame, value=value)
+        maya.cmds.keyTangent(cam_tfm, attribute='tx', outTangentType='step')
+
+        # The camera height is keyed, but never changes.
+        for frame in [FRAMES[0], FRAMES[-1]]:
+            maya.cmds.setKeyframe(cam_tfm, attribute='ty', time=frame, value=0.25)
+        maya.cmds.keyTangent(
+            cam_tfm, attribute='ty', inTangentType='flat', outTangentType='flat'
+        )
+
+        mkr_grp = self.create_marker_group('marker_group', cam_tfm)
+        marker_positions = [
+            (-0.243056042, 0.189583713),
+            (0.312469117, -0.227186005),
+            (-0.401273624, -0.318710259),
+        ]
+        bundles = []
+        markers = []
+        node_attrs = []
+        for i, (mkr_x, mkr_y) in enumerate(marker_positions):
+            name = 'bundle_{}'.format(i)
+            bundle_tfm, bundle_shp = self.create_bundle(name)
+            maya.cmds.setAttr(bundle_tfm + '.tz', -10.0)
+            if animated_bundles is True:
+                # Stepped bundles are solved on every frame, which
+                # splits the runs of values.
+                for attr in ['tx', 'ty']:
+                    for frame in [FRAMES[0], FRAMES[len(FRAMES) // 2]]:
+                        maya.cmds.setKeyframe(
+                            bundle_tfm, attribute=attr, time=frame, value=0.0
+                        )
+                    maya.cmds.keyTangent(
+                        bundle_tfm, attribute=attr, outTangentType='step'
+                    )
+
+            name = 'marker_{}'.format(i)
+            marker_tfm, marker_shp = self.create_marker(
+                name, mkr_grp, bnd_tfm=bundle_tfm
+            )
+            maya.cmds.setAttr(marker_tfm + '.tz', -1)
+            for frame in FRAMES:
+                offset = frame * 0.01
+                maya.cmds.setKeyframe(
+                    marker_tfm, attribute='tx', time=frame, value=mkr_x + offset
+                )
+                maya.cmds.setKeyframe(
+                    marker_tfm, attribute='ty', time=frame, value=mkr_y - offset
+                )
+
+            bundles.append(bundle_tfm)
+            markers.append((marker_tfm, cam_shp, bundle_tfm))
+            node_attrs.append((bundle_tfm + '.tx', 'None', 'None', 'None', 'None'))
+            node_attrs.append((bundle_tfm + '.ty', 'None', 'None', 'None', 'None'))
+
+        cameras = ((cam_tfm, cam_shp),)
+        kwargs = {
+            'camera': cameras,
+            'marker': markers,
+            'attr': node_attrs,
+        }
+
+        affects_mode = 'addAttrsToMarkers'
+        self.runSolverAffects(affects_mode, **kwargs)
+        return kwargs, bundles
+
+    def reset_bundles(self, bundles, animated_bundles):
+        for bundle_tfm in bundles:
+            for attr in ['tx', 'ty']:
+                if animated_bundles is True:
+                    maya.cmds.cutKey(bundle_tfm, attribute=attr)
+                    for frame in [FRAMES[0], FRAMES[len(FRAMES) // 2]]:
+                        maya.cmds.setKeyframe(
+                            bundle_tfm, attribute=attr, time=frame, value=0.0
+                        )
+                    maya.cmds.keyTangent(
+                        bundle_tfm, attribute=attr, outTangentType='step'
+                    )
+                else:
+                    maya.cmds.setAttr(bundle_tfm + '.' + attr, 0.0)
+
+    def get_bundle_values(self, bundles):
+        values = []
+        for bundle_tfm in bundles:
+            for frame in FRAMES:
+                values.append(maya.cmds.getAttr(bundle_tfm + '.tx', time=frame))
+                values.append(maya.cmds.getAttr(bundle_tfm + '.ty', time=frame))
+        return values
+
+    def run_solve(self, kwargs, bundles, animated_bundles, scene_graph_mode):
+        self.reset_bundles(bundles, animated_bundles)
+        frame_solve_mode = mmapi.FRAME_SOLVE_MODE_ALL_FRAMES_AT_ONCE
+        if animated_bundles is True:
+            frame_solve_mode = mmapi.FRAME_SOLVE_MODE_PER_FRAME
+        result = maya.cmds.mmSolver(
+            frame=FRAMES,
+            solverType=mmapi.SOLVER_TYPE_CMINPACK_LMDIF,
+            sceneGraphMode=scene_graph_mode,
+            frameSolveMode=frame_solve_mode,
+            iterations=1000,
+            verbose=True,
+            **kwargs
+        )
+        values = self.get_bundle_values(bundles)
+        return result, values
+
+    def do_solve(self, animated_bundles):
+        kwargs, bundles = self.create_scene(animated_bundles)
+        result_a, values_a = self.run_solve(
+            kwargs, bundles, animated_bundles, mmapi.SCENE_GRAPH_MODE_MAYA_DAG
+        )
+        result_b, values_b = self.run_solve(
+            kwargs, bundles, animated_bundles, mmapi.SCENE_GRAPH_MODE_MM_SCENE_GRAPH
+        )
+        print('maya dag result:', result_a)
+        print('mmscenegraph result:', result_b)
+        self.assertEqual(result_a[0], 'success=1')
+        self.assertEqual(result_b[0], 'success=1')
+        for value_a, value_b in zip(values_a, values_b):
+            self.assertApproxEqual(value_a, value_b)
+        return values_b
+
+    def test_static_bundles(self):
+        self.do_solve(False)
+
+    def test_stepped_bundles(self):
+        values = self.do_solve(True)
+
+        # Each frame is solved to a different value, including the
+        # frames that were held by a step.
+        values_per_bundle = len(FRAMES) * 2
+        for i in range(0, len(values), values_per_bundle):
+            bundle_values_tx = values[i : i + values_per_bundle : 2]
+            self.assertEqual(len(set(bundle_values_tx)), len(FRAMES))
+
+
+if __name__ == '__main__':
+    prog = unittest.main()
@@ -89,6 +89,7 @@ struct Arguments {
     ExrCompressionMode exr_compression;
     Direction direction;
     int32_t num_threads;
+    bool verify;
     bool verbose;
 };
 
@@ -124,6 +125,7 @@ void print_flags() {
         << "      --exr-compress   OpenEXR compression method;\n"
         << "                       ZIP1, ZIP16, RLE, or PIZ\n"
         << "                       (default is ZIP16)\n"
+        << "      --verify         Re-read each image after it is written.\n"
         << "      --verbose        Print detailed information.\n"
         << "      --num-threads    Number of threads;\n"
         << "                       -1=physical, 0=logical, 1=single\n"
@@ -187,6 +189,7 @@ bool parse_arguments(const int argc, const char* argv[], Arguments& args) {
         const bool is_frame_range_flag = std::strcmp(arg, "--frame-range") == 0;
         const bool is_direction_flag = std::strcmp(arg, "--direction") == 0;
         const bool is_num_threads_flag = std::strcmp(arg, "--num-threads") == 0;
+        const bool is_verify_flag = std::strcmp(arg, "--verify") == 0;
         const bool is_verbose_flag = std::strcmp(arg, "--verbose") == 0;
 
         if (is_help_flag) {
@@ -195,6 +198,8 @@ bool parse_arguments(const int argc, const char* argv[], Arguments& args) {
         } else if (is_version_flag) {
             print_version();
             return false;
+        } else if (is_verify_flag) {
+            args.verify = true;
         } else if (is_verbose_flag) {
             args.verbose = true;
         } else if (is_frame_range_flag) {
@@ -25,18 +25,136 @@
 #include <mmsolverlibs/assert.h>
 #include <mmsolverlibs/debug.h>
 
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 #include "apply.h"
 #include "arguments.h"
 #include "buffer.h"
 #include "constants.h"
+#include "pipeline.h"
 #include "steps.h"
 
+// The results of the write stage, read by the compute stage.
+struct WriteStageResult {
+    std::atomic<bool> failed{false};
+    std::chrono::duration<float> total_duration =
+        std::chrono::duration<float>::zero();
+};
+
+// Encode and write (or copy) images in the order they are queued,
+// until a 'WriteJobKind::kStop' job is received.
+//
+// This runs on its own thread, so that the next frame can be computed
+// while the current frame is being encoded and written.
+void run_write_stage(WriteJobQueue& write_queue,
+                     PixelBufferPool& pixel_buffer_pool,
+                     const ExrCompressionMode exr_compression_mode,
+                     const bool reread_image, const bool verbose,
+                     WriteStageResult& stage_result) {
+    // Only used when the written image is read back to be verified.
+    auto reread_pixel_buffer = mmimage::ImagePixelBuffer();
+    auto reread_meta_data = mmimage::ImageMetaData();
+
+    while (true) {
+        WriteJob job = write_queue.pop();
+        if (job.kind == WriteJobKind::kStop) {
+            break;
+        }
+
+        // Once a job has failed, the remaining jobs are drained from
+        // the queue without being written.
+        if (stage_result.failed.load()) {
+            if (job.kind == WriteJobKind::kWriteImage) {
+                pixel_buffer_pool.release(job.pixel_buffer);
+            }
+            continue;
+        }
+
+        const rust::Str output_file_path(job.output_file_path.c_str());
+        std::stringstream log;
+
+        bool job_result = false;
+        std::chrono::duration<float> write_duration;
+        if (job.kind == WriteJobKind::kCopyImage) {
+            job_result =
+                copy_image_file(job.source_file_path, job.output_file_path,
+                                write_duration, verbose);
+            if (verbose) {
+                log << std::fixed << std::setprecision(3)
+                    << "Frame " << job.frame
+                    << " copy time: " << write_duration.count()
+                    << " seconds\n";
+            }
+        } else {
+            auto meta_data = mmimage::ImageMetaData();
+            job_result = save_exr_image(
+                job.display_window, job.layer_position, exr_compression_mode,
+                *job.pixel_buffer, meta_data, output_file_path,
+                write_duration, verbose);
+            pixel_buffer_pool.release(job.pixel_buffer);
+
+            auto reread_duration = std::chrono::duration<float>::zero();
+            if (job_result && reread_image) {
+                auto reread_start = std::chrono::high_resolution_clock::now();
+                const bool vertical_flip = false;
+                job_result = mmimage::image_read_pixels_exr_f32x4(
+                    output_file_path, vertical_flip, reread_meta_data,
+                    reread_pixel_buffer);
+                auto reread_end = std::chrono::high_resolution_clock::now();
+                reread_duration = reread_end - reread_start;
+                log << "Re-read image file path: " << output_file_path << '\n'
+                    << "        image read result: "
+                    << static_cast<uint32_t>(job_result) << '\n'
+                    << "        image width x height: "
+                    << reread_pixel_buffer.image_width() << 'x'
+                    << reread_pixel_buffer.image_height() << '\n';
+                if (!job_result) {
+                    std::cerr << "Failed to re-read image: "
+                              << output_file_path << std::endl;
+                }
+            }
+
+            if (verbose) {
+                log << std::fixed << std::setprecision(3) << "Frame "
+                    << job.frame << " write time: " << write_duration.count()
+                    << " seconds\n"
+                    << "Frame " << job.frame
+                    << " re-read time: " << reread_duration.count()
+                    << " seconds\n";
+            }
+            write_duration += reread_duration;
+        }
+        stage_result.total_duration += write_duration;
+
+        // Written in one call to avoid interleaving with the output of
+        // the compute stage.
+        const std::string log_string = log.str();
+        if (!log_string.empty()) {
+            std::cout << log_string << std::flush;
+        }
+
+        if (!job_result) {
+            std::cerr << "Failed to write image: " << output_file_path
+                      << std::endl;
+            stage_result.failed.store(true);
+        }
+    }
+}
+
+// Compute the ST-Map image for a frame, and queue it to be written.
+//
+// The pixel buffer is taken from the pool, and is given back by the
+// write stage once the image is written.
 bool run_frame(mmlens::FrameNumber frame,
                const mmlens::DistortionDirection distortion_direction,
                const size_t image_width, const size_t image_height,
@@ -46,17 +164,11 @@ bool run_frame(mmlens::FrameNumber frame,
 
                const uint8_t layer_count, mmlens::DistortionLayers& lens_layers,
 
-               const ExrCompressionMode exr_compression_mode,
-               std::string output_file_path_string, int32_t num_threads,
+               PixelBufferPool& pixel_buffer_pool, WriteJobQueue& write_queue,
+               const std::string& output_file_pattern, int32_t num_threads,
+               std::chrono::duration<float>& compute_duration,
                const bool verbose) {
-    auto bbox_in_data_ptr = &BOUNDING_BOX_IDENTITY_COORDS[0];
-    const size_t bbox_in_data_stride = 2;
-    const size_t bbox_out_data_stride = 4;
-    const size_t bbox_in_data_size =
-        BOUNDING_BOX_COORD_COUNT * bbox_in_data_stride;
-    const size_t bbox_out_data_size =
-        BOUNDING_BOX_COORD_COUNT * bbox_out_data_stride;
-
+    compute_duration = std::chrono::duration<float>::zero();
     for (uint8_t layer_num = 0; layer_num < layer_count; layer_num++) {
         std::cout << "layer_num: " << static_cast<int>(layer_num) << std::endl;
         const auto lens_model_type =
@@ -72,73 +184,38 @@ bool run_frame(mmlens::FrameNumber frame,
             mmimage::ImageRegionRectangle{0, 0, image_width, image_height};
         auto layer_position = mmimage::Vec2I32{0, 0};
 
+        // Blocks until the write stage has finished with a buffer.
+        mmimage::ImagePixelBuffer* pixel_buffer = pixel_buffer_pool.acquire();
+
         std::chrono::duration<float> create_duration;
         std::chrono::duration<float> process_duration;
-        auto pixel_buffer = mmimage::ImagePixelBuffer();
         calculate_image(distortion_direction, layer_num, frame, lens_model_type,
                         camera_parameters, film_back_radius_cm, lens_layers,
                         //
-                        image_width, image_height, num_channels, pixel_buffer,
+                        image_width, image_height, num_channels, *pixel_buffer,
                         num_threads,
                         //
                         create_duration, process_duration);
 
-        const std::string output_file_path_string =
-            compute_output_file_path(output_file_path_string, frame, verbose);
-        const rust::Str output_file_path(output_file_path_string.c_str());
-
-        auto meta_data = mmimage::ImageMetaData();
-        std::chrono::duration<float> write_duration;
-        bool save_result = save_exr_image(
-            display_window, layer_position, exr_compression_mode, pixel_buffer,
-            meta_data, output_file_path, write_duration, verbose);
-
-        // Controls if the image will be double checked by reading the
-        // saved image file just after being written. This is a validation
-        // test that is not needed for anything other than testing.
-        const bool reread_image = false;
-
-        auto reread_duration = std::chrono::duration<float>::zero();
-        bool reread_result = true;
-        if (reread_image) {
-            auto reread_start = std::chrono::high_resolution_clock::now();
-            const bool vertical_flip = false;
-            reread_result = mmimage::image_read_pixels_exr_f32x4(
-                output_file_path, vertical_flip, meta_data, pixel_buffer);
-            auto reread_end = std::chrono::high_resolution_clock::now();
-            reread_duration = reread_end - reread_start;
-            std::cout << "Re-read image file path: " << output_file_path << '\n'
-                      << "        image read result: "
-                      << static_cast<uint32_t>(reread_result) << '\n'
-                      << "        image width x height: "
-                      << pixel_buffer.image_width() << 'x'
-                      << pixel_buffer.image_height() << std::endl;
-        }
-
+        WriteJob job;
+        job.kind = WriteJobKind::kWriteImage;
+        job.frame = frame;
+        job.output_file_path =
+            compute_output_file_path(output_file_pattern, frame, verbose);
+        job.pixel_buffer = pixel_buffer;
+        job.display_window = display_window;
+        job.layer_position = layer_position;
+        write_queue.push(std::move(job));
+
+        compute_duration += bbox_duration + create_duration + process_duration;
         if (verbose) {
             std::cout << std::fixed << std::setprecision(3)
                       << "Create time: " << create_duration.count()
                       << " seconds\n"
                       << "BBox time: " << bbox_duration.count() << " seconds\n"
                       << "Process time: " << process_duration.count()
-                      << " seconds\n"
-                      << "Write time: " << write_duration.count()
-                      << " seconds\n"
-                      << "Re-Read time: " << reread_duration.count()
                       << " seconds" << std::endl;
         }
-
-        if (!save_result) {
-            std::cerr << "Failed to write image." << output_file_path
-                      << std::endl;
-            return false;
-        }
-
-        if (!reread_result) {
-            std::cerr << "Failed to re-read image: " << output_file_path
-                      << std::endl;
-            return false;
-        }
     }
     return true;
 }
@@ -156,6 +233,7 @@ bool run(const Arguments& args) {
             << "ExrCompression : " << static_cast<int>(args.exr_compression)
             << '\n'
             << "NumThreads     : " << static_cast<int>(args.num_threads) << '\n'
+            << "Verify         : " << static_cast<int>(args.verify) << '\n'
             << "Verbose        : " << static_cast<int>(args.verbose) << '\n'
             << std::endl;
     }
@@ -202,21 +280,39 @@ bool run(const Arguments& args) {
     const mmlens::DistortionDirection distortion_direction =
         convert_distortion_direction(args.direction);
 
-    mmlens::HashValue64 last_frame_hash = 0;
+    // The output file path of the first frame written for each
+    // unique lens distortion hash. Frames with the same hash produce
+    // identical images, so the written file is copied instead of
+    // calculating, encoding and writing the image again.
+    std::unordered_map<mmlens::HashValue64, std::string> frame_hash_file_paths;
+    size_t written_frame_count = 0;
+    size_t cached_frame_count = 0;
+
+    // Frames are computed on this thread while the previous frames
+    // are encoded and written on the write stage thread, so the
+    // frame rate is limited by the slowest stage, rather than the sum
+    // of both stages.
+    PixelBufferPool pixel_buffer_pool(PIPELINE_PIXEL_BUFFER_COUNT);
+    WriteJobQueue write_queue(PIPELINE_WRITE_QUEUE_CAPACITY);
+    WriteStageResult write_stage_result;
+    std::thread write_thread(run_write_stage, std::ref(write_queue),
+                             std::ref(pixel_buffer_pool), args.exr_compression,
+                             args.verify, args.verbose,
+                             std::ref(write_stage_result));
+
+    bool compute_result = true;
+    auto compute_stage_duration = std::chrono::duration<float>::zero();
     const mmlens::FrameNumber start_frame = args.start_frame;
     const mmlens::FrameNumber end_frame = args.end_frame;
     for (mmlens::FrameNumber frame = start_frame; frame <= end_frame; frame++) {
+        if (write_stage_result.failed.load()) {
+            break;
+        }
         std::cout << "frame: " << frame << std::endl;
 
         const mmlens::HashValue64 frame_hash = lens_layers.frame_hash(frame);
         std::cout << "frame_hash: " << frame_hash << std::endl;
 
-        if (last_frame_hash == frame_hash) {
-            // TODO: Re-use the computed values from last frame if so.
-        } else {
-            last_frame_hash = frame_hash;
-        }
-
         bool frame_valid = lens_layers_frame_is_valid(lens_layers, frame);
         if (!frame_valid) {
             std::cerr << "Warning: Skipping frame. Frame " << frame
@@ -224,7 +320,24 @@ bool run(const Arguments& args) {
             continue;
         }
 
-        const bool result =
+        const std::string output_file_path_string = compute_output_file_path(
+            args.output_file_path, frame, args.verbose);
+
+        const auto search = frame_hash_file_paths.find(frame_hash);
+        if (search != frame_hash_file_paths.end()) {
+            WriteJob job;
+            job.kind = WriteJobKind::kCopyImage;
+            job.frame = frame;
+            job.output_file_path = output_file_path_string;
+            job.source_file_path = search->second;
+            job.pixel_buffer = nullptr;
+            write_queue.push(std::move(job));
+            cached_frame_count++;
+            continue;
+        }
+
+        std::chrono::duration<float> compute_duration;
+        compute_result =
             run_frame(frame, distortion_direction, image_width, image_height,
                       num_channels, camera_parameters, film_back_radius_cm,
 
@@ -232,14 +345,39 @@ bool run(const Arguments& args) {
                       layer_count, lens_layers,
 
                       // Out to write out data.
-                      args.exr_compression, args.output_file_path,
-                      args.num_threads, args.verbose);
+                      pixel_buffer_pool, write_queue, args.output_file_path,
+                      args.num_threads, compute_duration, args.verbose);
+        compute_stage_duration += compute_duration;
 
-        if (!result) {
-            return result;
+        if (!compute_result) {
+            break;
         }
+        written_frame_count++;
+        frame_hash_file_paths.emplace(frame_hash, output_file_path_string);
     }
 
+    // Wait for all the queued images to be written.
+    WriteJob stop_job;
+    stop_job.kind = WriteJobKind::kStop;
+    stop_job.pixel_buffer = nullptr;
+    write_queue.push(std::move(stop_job));
+    write_thread.join();
+
+    std::cout << "Frames written: " << written_frame_count
+              << ", frames reused from cache: " << cached_frame_count
+              << std::endl;
+    if (args.verbose) {
+        std::cout << std::fixed << std::setprecision(3)
+                  << "Compute stage time: " << compute_stage_duration.count()
+                  << " seconds\n"
+                  << "Write stage time: "
+                  << write_stage_result.total_duration.count() << " seconds"
+                  << std::endl;
+    }
+
+    if (!compute_result || write_stage_result.failed.load()) {
+        return false;
+    }
     return true;
 }
 
@@ -250,6 +388,7 @@ int main(const int argc, const char* argv[]) {
     args.direction = Direction::kBoth;
     args.exr_compression = ExrCompressionMode::kZIP16;
     args.num_threads = 0;
+    args.verify = false;
     args.verbose = false;
 
     const bool parse_succeeded = parse_arguments(argc, argv, args);
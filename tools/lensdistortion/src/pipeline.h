@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Helpers to overlap computing an ST-Map image with the encoding and
+ * writing of the previous image.
+ */
+
+#ifndef MM_SOLVER_LENS_DISTORTION_PIPELINE_H
+#define MM_SOLVER_LENS_DISTORTION_PIPELINE_H
+
+#include <mmimage/mmimage.h>
+#include <mmlens/mmlens.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The number of pixel buffers shared between the compute and write
+// stages. Two buffers allows one frame to be computed while the
+// previous frame is written.
+const size_t PIPELINE_PIXEL_BUFFER_COUNT = 2;
+
+// The maximum number of jobs waiting to be written.
+const size_t PIPELINE_WRITE_QUEUE_CAPACITY = 4;
+
+// A fixed set of pixel buffers that are re-used from frame to frame.
+//
+// A released buffer keeps its memory allocation, so re-sizing it to
+// the same image dimensions for the next frame does not allocate.
+//
+// 'acquire' blocks until a buffer is available, which stops the
+// compute stage from running too far ahead of the write stage.
+class PixelBufferPool {
+public:
+    explicit PixelBufferPool(const size_t buffer_count) {
+        buffers_.reserve(buffer_count);
+        available_.reserve(buffer_count);
+        for (size_t i = 0; i < buffer_count; i++) {
+            buffers_.push_back(std::unique_ptr<mmimage::ImagePixelBuffer>(
+                new mmimage::ImagePixelBuffer()));
+            available_.push_back(buffers_.back().get());
+        }
+    }
+
+    mmimage::ImagePixelBuffer* acquire() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        condition_.wait(lock, [this] { return !available_.empty(); });
+        mmimage::ImagePixelBuffer* buffer = available_.back();
+        available_.pop_back();
+        return buffer;
+    }
+
+    void release(mmimage::ImagePixelBuffer* buffer) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            available_.push_back(buffer);
+        }
+        condition_.notify_one();
+    }
+
+private:
+    std::vector<std::unique_ptr<mmimage::ImagePixelBuffer>> buffers_;
+    std::vector<mmimage::ImagePixelBuffer*> available_;
+    std::mutex mutex_;
+    std::condition_variable condition_;
+};
+
+enum class WriteJobKind : uint8_t {
+    // Encode and write the pixel buffer to the output file path.
+    kWriteImage = 0,
+
+    // Copy an already written file to the output file path.
+    kCopyImage = 1,
+
+    // No more jobs will be added; the write stage should finish.
+    kStop = 2,
+};
+
+struct WriteJob {
+    WriteJobKind kind;
+    mmlens::FrameNumber frame;
+    std::string output_file_path;
+
+    // Only used by 'WriteJobKind::kCopyImage'.
+    std::string source_file_path;
+
+    // Only used by 'WriteJobKind::kWriteImage'. The buffer is
+    // released back to the pool once the image has been written.
+    mmimage::ImagePixelBuffer* pixel_buffer;
+    mmimage::ImageRegionRectangle display_window;
+    mmimage::Vec2I32 layer_position;
+};
+
+// A first-in-first-out queue of write jobs, with a maximum size.
+//
+// Jobs are written in the order they are pushed, so a copy job is
+// always run after the job that writes the file being copied.
+class WriteJobQueue {
+public:
+    explicit WriteJobQueue(const size_t capacity) : capacity_(capacity) {}
+
+    void push(WriteJob job) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return jobs_.size() < capacity_; });
+            jobs_.push_back(std::move(job));
+        }
+        not_empty_.notify_one();
+    }
+
+    WriteJob pop() {
+        WriteJob job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_empty_.wait(lock, [this] { return !jobs_.empty(); });
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+        not_full_.notify_one();
+        return job;
+    }
+
+private:
+    const size_t capacity_;
+    std::deque<WriteJob> jobs_;
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+};
+
+#endif  // MM_SOLVER_LENS_DISTORTION_PIPELINE_H
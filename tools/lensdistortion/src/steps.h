@@ -27,6 +27,7 @@
 
 #include <chrono>
 #include <cmath>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <limits>
@@ -130,10 +131,6 @@ mmimage::Box2F32 calculate_lens_distortion_bbox_region(
     std::chrono::duration<float>& bbox_duration, const bool verbose) {
     auto bbox_start = std::chrono::high_resolution_clock::now();
 
-    // TODO: Generate a hash for the lens parameters. If the
-    // hash has not changed since the last frame we can re-use
-    // the results from last frame.
-
     mmimage::Box2F32 box_region = mmimage::Box2F32{0.0, 0.0, 0.0, 0.0};
 
     if (lens_model_type == mmlens::LensModelType::k3deClassic) {
@@ -252,9 +249,8 @@ void calculate_image(const mmlens::DistortionDirection distortion_direction,
 
     // Create image pixel data.
     //
-    // TODO: Save processing time by re-using the last frame's
-    // result if the lens distortion has not changed between
-    // runs.
+    // Frames with a lens distortion hash that has already been
+    // written are copied by the caller and never reach this point.
     {
         auto create_start = std::chrono::high_resolution_clock::now();
 
@@ -427,3 +423,39 @@ bool save_exr_image(const mmimage::ImageRegionRectangle display_window,
 
     return save_result;
 }
+
+// Copy a previously written image file to a new file path.
+//
+// Frames that share the same lens distortion hash produce exactly the
+// same image, so the encoded bytes of an earlier frame can be copied
+// byte-for-byte, rather than computing and encoding the image again.
+bool copy_image_file(const std::string& source_file_path,
+                     const std::string& destination_file_path,
+                     std::chrono::duration<float>& copy_duration,
+                     const bool verbose) {
+    auto copy_start = std::chrono::high_resolution_clock::now();
+    bool copy_result = false;
+    {
+        std::ifstream source(source_file_path,
+                             std::ios::in | std::ios::binary);
+        std::ofstream destination(
+            destination_file_path,
+            std::ios::out | std::ios::binary | std::ios::trunc);
+        if (source.is_open() && destination.is_open()) {
+            destination << source.rdbuf();
+            destination.flush();
+            copy_result = source.good() && destination.good();
+        }
+    }
+    auto copy_end = std::chrono::high_resolution_clock::now();
+    copy_duration = copy_end - copy_start;
+
+    if (!copy_result) {
+        std::cerr << "ERROR: Failed to copy image: " << source_file_path
+                  << " -> " << destination_file_path << std::endl;
+    } else if (verbose) {
+        std::cout << "Successfully copied: " << source_file_path << " -> "
+                  << destination_file_path << std::endl;
+    }
+    return copy_result;
+}
@@ -0,0 +1,338 @@
+/*
+ * Copyright (C) 2024 David Cattermole.
+ *
+ * This file is part of mmSolver.
+ *
+ * mmSolver is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * mmSolver is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with mmSolver.  If not, see <https://www.gnu.org/licenses/>.
+ * ====================================================================
+ *
+ * Benchmark building and querying the relationships between marker
+ * errors and parameters, comparing a dense
+ * 'std::vector<std::vector<bool>>' (markers x parameters) with the
+ * sparse 'ErrorToParamIndex'.
+ *
+ * Usage:
+ *
+ *   mmsolver-relationshipindexbench [markers] [frames] [loops]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "adjust_relationshipIndex.h"
+
+namespace {
+
+using BoolList2D = std::vector<std::vector<bool>>;
+
+const int BUNDLE_ATTR_COUNT = 3;
+const int CAMERA_STATIC_ATTR_COUNT = 1;
+const int CAMERA_ANIM_ATTR_COUNT = 6;
+const int AFFECTS_QUERY_COUNT = 1000000;
+
+// A typical animated solve; each marker has a bundle with static
+// translate attributes, and all markers are seen by a camera with a
+// static focal length and animated translate/rotate attributes.
+//
+// Marker error 'i' is the marker 'i % numberOfMarkers' on the frame
+// 'i / numberOfMarkers'. The static parameters are first (the bundle
+// attributes of each marker, then the camera attributes), followed
+// by the animated camera parameters of each attribute and frame.
+struct Scene {
+    int numberOfMarkers;
+    int numberOfFrames;
+
+    int numberOfMarkerErrors() const {
+        return numberOfMarkers * numberOfFrames;
+    }
+    int numberOfStaticParameters() const {
+        return (numberOfMarkers * BUNDLE_ATTR_COUNT) +
+               CAMERA_STATIC_ATTR_COUNT;
+    }
+    int numberOfParameters() const {
+        return numberOfStaticParameters() +
+               (CAMERA_ANIM_ATTR_COUNT * numberOfFrames);
+    }
+
+    // The same test as the dense relationship was built with; does
+    // the attribute of the parameter affect the marker, and is the
+    // parameter on the frame of the marker error?
+    bool affects(const int markerErrorIndex, const int paramIndex) const {
+        const int markerIndex = markerErrorIndex % numberOfMarkers;
+        const int frameIndex = markerErrorIndex / numberOfMarkers;
+        const int numberOfBundleParams = numberOfMarkers * BUNDLE_ATTR_COUNT;
+        if (paramIndex < numberOfBundleParams) {
+            return (paramIndex / BUNDLE_ATTR_COUNT) == markerIndex;
+        } else if (paramIndex < numberOfStaticParameters()) {
+            return true;
+        }
+        const int animParamIndex = paramIndex - numberOfStaticParameters();
+        return (animParamIndex % numberOfFrames) == frameIndex;
+    }
+
+    // The (sorted) parameters affecting the marker error, found
+    // directly, the same as the sparse relationship is built with.
+    void markerErrorParams(const int markerErrorIndex,
+                           std::vector<int> &out_paramList) const {
+        const int markerIndex = markerErrorIndex % numberOfMarkers;
+        const int frameIndex = markerErrorIndex / numberOfMarkers;
+        out_paramList.clear();
+        for (int k = 0; k < BUNDLE_ATTR_COUNT; ++k) {
+            out_paramList.push_back((markerIndex * BUNDLE_ATTR_COUNT) + k);
+        }
+        for (int k = 0; k < CAMERA_STATIC_ATTR_COUNT; ++k) {
+            out_paramList.push_back((numberOfMarkers * BUNDLE_ATTR_COUNT) +
+                                    k);
+        }
+        for (int k = 0; k < CAMERA_ANIM_ATTR_COUNT; ++k) {
+            out_paramList.push_back(numberOfStaticParameters() +
+                                    (k * numberOfFrames) + frameIndex);
+        }
+    }
+};
+
+void buildDense(const Scene &scene, BoolList2D &out_errorToParamList) {
+    const int numberOfMarkerErrors = scene.numberOfMarkerErrors();
+    const int numberOfParameters = scene.numberOfParameters();
+    out_errorToParamList.assign(numberOfMarkerErrors,
+                                std::vector<bool>(numberOfParameters, false));
+    for (int i = 0; i < numberOfMarkerErrors; ++i) {
+        for (int j = 0; j < numberOfParameters; ++j) {
+            out_errorToParamList[i][j] = scene.affects(i, j);
+        }
+    }
+}
+
+void buildSparse(const Scene &scene, ErrorToParamIndex &out_index) {
+    const int numberOfMarkerErrors = scene.numberOfMarkerErrors();
+    errorToParamIndexBegin(scene.numberOfParameters(), numberOfMarkerErrors,
+                           out_index);
+    std::vector<int> paramList;
+    for (int i = 0; i < numberOfMarkerErrors; ++i) {
+        scene.markerErrorParams(i, paramList);
+        errorToParamIndexAddMarker(paramList, out_index);
+    }
+    errorToParamIndexEnd(out_index);
+}
+
+// Visit all the relationships of each marker error, as when the
+// sparse Jacobian structure is constructed.
+uint64_t queryRowsDense(const BoolList2D &errorToParamList) {
+    uint64_t checksum = 0;
+    for (size_t i = 0; i < errorToParamList.size(); ++i) {
+        const std::vector<bool> &row = errorToParamList[i];
+        for (size_t j = 0; j < row.size(); ++j) {
+            if (row[j]) {
+                checksum += (i * 31) + j;
+            }
+        }
+    }
+    return checksum;
+}
+
+uint64_t queryRowsSparse(const ErrorToParamIndex &index) {
+    uint64_t checksum = 0;
+    for (int i = 0; i < index.numberOfMarkers; ++i) {
+        for (int k = index.markerParamBegin(i); k < index.markerParamEnd(i);
+             ++k) {
+            const int j = index.markerParamList[k];
+            checksum += (static_cast<uint64_t>(i) * 31) + j;
+        }
+    }
+    return checksum;
+}
+
+// Visit the marker errors affected by each parameter, as when the
+// marker errors to be evaluated for a changed parameter are found.
+uint64_t queryColumnsDense(const BoolList2D &errorToParamList,
+                           const int numberOfParameters) {
+    uint64_t checksum = 0;
+    for (int j = 0; j < numberOfParameters; ++j) {
+        for (size_t i = 0; i < errorToParamList.size(); ++i) {
+            if (errorToParamList[i][j]) {
+                checksum += (i * 31) + j;
+            }
+        }
+    }
+    return checksum;
+}
+
+uint64_t queryColumnsSparse(const ErrorToParamIndex &index) {
+    uint64_t checksum = 0;
+    for (int j = 0; j < index.numberOfParameters; ++j) {
+        for (int k = index.paramMarkerBegin(j); k < index.paramMarkerEnd(j);
+             ++k) {
+            const int i = index.paramMarkerList[k];
+            checksum += (static_cast<uint64_t>(i) * 31) + j;
+        }
+    }
+    return checksum;
+}
+
+// Test single (marker error, parameter) pairs.
+uint64_t queryAffectsDense(const BoolList2D &errorToParamList,
+                           const std::vector<int> &queryPairList) {
+    uint64_t checksum = 0;
+    for (size_t k = 0; k < queryPairList.size(); k += 2) {
+        const int i = queryPairList[k];
+        const int j = queryPairList[k + 1];
+        checksum += errorToParamList[i][j] ? 1 : 0;
+    }
+    return checksum;
+}
+
+uint64_t queryAffectsSparse(const ErrorToParamIndex &index,
+                            const std::vector<int> &queryPairList) {
+    uint64_t checksum = 0;
+    for (size_t k = 0; k < queryPairList.size(); k += 2) {
+        const int i = queryPairList[k];
+        const int j = queryPairList[k + 1];
+        checksum += index.affects(i, j) ? 1 : 0;
+    }
+    return checksum;
+}
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(const Clock::time_point start) {
+    const std::chrono::duration<double> duration = Clock::now() - start;
+    return duration.count();
+}
+
+void printRow(const std::string &name, const double dense_seconds,
+              const double sparse_seconds) {
+    std::cout << std::left << std::setw(16) << name << std::right
+              << std::setw(14) << dense_seconds << std::setw(14)
+              << sparse_seconds << std::setw(12)
+              << (dense_seconds / sparse_seconds) << "x" << std::endl;
+}
+
+int parseArgument(const int argc, char **argv, const int index,
+                  const int default_value) {
+    if (index >= argc) {
+        return default_value;
+    }
+    const int value = std::atoi(argv[index]);
+    return (value > 0) ? value : default_value;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Scene scene;
+    scene.numberOfMarkers = parseArgument(argc, argv, 1, 100);
+    scene.numberOfFrames = parseArgument(argc, argv, 2, 500);
+    const int loops = parseArgument(argc, argv, 3, 3);
+
+    const int numberOfMarkerErrors = scene.numberOfMarkerErrors();
+    const int numberOfParameters = scene.numberOfParameters();
+    std::cout << "Markers: " << scene.numberOfMarkers
+              << " Frames: " << scene.numberOfFrames
+              << " Marker Errors: " << numberOfMarkerErrors
+              << " Parameters: " << numberOfParameters << " Loops: " << loops
+              << std::endl;
+
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> errorDistribution(
+        0, numberOfMarkerErrors - 1);
+    std::uniform_int_distribution<int> paramDistribution(
+        0, numberOfParameters - 1);
+    std::vector<int> queryPairList;
+    queryPairList.reserve(AFFECTS_QUERY_COUNT * 2);
+    for (int k = 0; k < AFFECTS_QUERY_COUNT; ++k) {
+        queryPairList.push_back(errorDistribution(generator));
+        queryPairList.push_back(paramDistribution(generator));
+    }
+
+    double buildDenseSeconds = 0.0;
+    double buildSparseSeconds = 0.0;
+    double rowsDenseSeconds = 0.0;
+    double rowsSparseSeconds = 0.0;
+    double columnsDenseSeconds = 0.0;
+    double columnsSparseSeconds = 0.0;
+    double affectsDenseSeconds = 0.0;
+    double affectsSparseSeconds = 0.0;
+    bool checksumsMatch = true;
+    size_t numberOfRelationships = 0;
+    for (int loop = 0; loop < loops; ++loop) {
+        auto errorToParamList = BoolList2D();
+        auto start = Clock::now();
+        buildDense(scene, errorToParamList);
+        buildDenseSeconds += secondsSince(start);
+
+        auto errorToParamIndex = ErrorToParamIndex();
+        start = Clock::now();
+        buildSparse(scene, errorToParamIndex);
+        buildSparseSeconds += secondsSince(start);
+        numberOfRelationships = errorToParamIndex.numberOfRelationships();
+
+        start = Clock::now();
+        const uint64_t rowsDense = queryRowsDense(errorToParamList);
+        rowsDenseSeconds += secondsSince(start);
+
+        start = Clock::now();
+        const uint64_t rowsSparse = queryRowsSparse(errorToParamIndex);
+        rowsSparseSeconds += secondsSince(start);
+
+        start = Clock::now();
+        const uint64_t columnsDense =
+            queryColumnsDense(errorToParamList, numberOfParameters);
+        columnsDenseSeconds += secondsSince(start);
+
+        start = Clock::now();
+        const uint64_t columnsSparse = queryColumnsSparse(errorToParamIndex);
+        columnsSparseSeconds += secondsSince(start);
+
+        start = Clock::now();
+        const uint64_t affectsDense =
+            queryAffectsDense(errorToParamList, queryPairList);
+        affectsDenseSeconds += secondsSince(start);
+
+        start = Clock::now();
+        const uint64_t affectsSparse =
+            queryAffectsSparse(errorToParamIndex, queryPairList);
+        affectsSparseSeconds += secondsSince(start);
+
+        // Both relationships must be the same.
+        checksumsMatch = checksumsMatch && (rowsDense == rowsSparse) &&
+                         (columnsDense == columnsSparse) &&
+                         (rowsDense == columnsDense) &&
+                         (affectsDense == affectsSparse);
+    }
+
+    std::cout << "Relationships: " << numberOfRelationships << std::endl;
+    std::cout << "Seconds per-loop:" << std::endl;
+    std::cout << std::left << std::setw(16) << "" << std::right
+              << std::setw(14) << "dense" << std::setw(14) << "sparse"
+              << std::setw(13) << "speed up" << std::endl;
+    printRow("build", buildDenseSeconds / loops, buildSparseSeconds / loops);
+    printRow("query rows", rowsDenseSeconds / loops, rowsSparseSeconds / loops);
+    printRow("query columns", columnsDenseSeconds / loops,
+             columnsSparseSeconds / loops);
+    printRow("query affects", affectsDenseSeconds / loops,
+             affectsSparseSeconds / loops);
+
+    if (!checksumsMatch) {
+        std::cerr << "ERROR: Dense and sparse relationships are different."
+                  << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}